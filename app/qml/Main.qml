@@ -35,6 +35,7 @@ ApplicationWindow {
                 model: [
                     { text: "Telemetrie", icon: "qrc:/icons/plane.png" },
                     { text: "Logs",       icon: "qrc:/icons/log.png" },
+                    { text: "Statistik",  icon: "qrc:/icons/log.png" },
                     { text: "Settings",   icon: "qrc:/icons/settings.png" }
                 ]
 
@@ -93,20 +94,292 @@ ApplicationWindow {
             Rectangle {
                 color: "white"
                 anchors.fill: parent
-                Text {
-                    text: "Telemetrie-Daten"
-                    anchors.centerIn: parent
-                    font.pixelSize: 18
+
+                ColumnLayout {
+                    anchors.fill: parent
+                    anchors.margins: 10
+                    spacing: 6
+
+                    // Aktuelle Werte, das Model aktualisiert nur die geänderten Zeilen einmal pro Frame
+                    Flow {
+                        Layout.fillWidth: true
+                        spacing: 12
+
+                        Repeater {
+                            model: TelemetryModel {
+                                channels: ["attitude/roll", "attitude/pitch", "attitude/yaw",
+                                           "battery/voltage", "battery/remaining",
+                                           "gps/altitude", "gps/ground_speed", "gps/satellites"]
+                            }
+
+                            delegate: Label {
+                                required property string name
+                                required property double value
+                                text: name + ": " + value.toFixed(2)
+                                font.pixelSize: 12
+                            }
+                        }
+                    }
+
+                    Label {
+                        text: "Beschleunigung [m/s²]"
+                        font.bold: true
+                    }
+
+                    TelemetryPlot {
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+                        channels: ["imu/acc_x", "imu/acc_y", "imu/acc_z"]
+                        timeWindow: 10
+                    }
+
+                    Label {
+                        text: "Drehrate [rad/s]"
+                        font.bold: true
+                    }
+
+                    TelemetryPlot {
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+                        channels: ["imu/gyro_x", "imu/gyro_y", "imu/gyro_z"]
+                        timeWindow: 10
+                    }
                 }
             }
 
             Rectangle {
                 color: "white"
                 anchors.fill: parent
-                Text {
-                    text: "Logs hier"
-                    anchors.centerIn: parent
-                    font.pixelSize: 18
+
+                // Logdatei, die ListView fragt nur die sichtbaren Zeilen ab
+                LogModel {
+                    id: logModel
+                    path: "logs/logs.txt"
+                    interval: 500
+                    filterText: logFilter.text
+                    levelMask: (errorBox.checked ? LogModel.ErrorLevel : 0)
+                               | (warningBox.checked ? LogModel.WarningLevel : 0)
+                               | (infoBox.checked ? LogModel.InfoLevel : 0)
+                               | (debugBox.checked ? LogModel.DebugLevel : 0)
+                               | (errorBox.checked && warningBox.checked && infoBox.checked && debugBox.checked ? LogModel.OtherLevel : 0)
+                }
+
+                ColumnLayout {
+                    anchors.fill: parent
+                    anchors.margins: 10
+                    spacing: 6
+
+                    // Filterleiste
+                    RowLayout {
+                        Layout.fillWidth: true
+                        spacing: 8
+
+                        TextField {
+                            id: logFilter
+                            placeholderText: "Filter"
+                            Layout.fillWidth: true
+                        }
+
+                        CheckBox { id: errorBox; text: "Error"; checked: true }
+                        CheckBox { id: warningBox; text: "Warning"; checked: true }
+                        CheckBox { id: infoBox; text: "Info"; checked: true }
+                        CheckBox { id: debugBox; text: "Debug"; checked: true }
+                        CheckBox { id: followBox; text: "Folgen"; checked: true }
+
+                        Label {
+                            text: logList.count + " / " + logModel.totalLines + (logModel.busy ? " …" : "")
+                            color: "gray"
+                        }
+                    }
+
+                    ListView {
+                        id: logList
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+                        clip: true
+                        model: logModel
+                        reuseItems: true
+                        boundsBehavior: Flickable.StopAtBounds
+
+                        ScrollBar.vertical: ScrollBar {
+                            policy: ScrollBar.AlwaysOn
+                        }
+
+                        // Neue Zeilen am Ende anzeigen, solange "Folgen" aktiv ist
+                        onCountChanged: if (followBox.checked) positionViewAtEnd()
+
+                        // Feste Zeilenhöhe, damit die ListView nie alle Zeilen vermessen muss
+                        delegate: Rectangle {
+                            width: ListView.view.width
+                            height: 20
+                            color: index % 2 === 0 ? "#f5f5f5" : "white"
+
+                            RowLayout {
+                                anchors.fill: parent
+                                anchors.leftMargin: 6
+                                anchors.rightMargin: 6
+                                spacing: 10
+
+                                Text {
+                                    text: model.time
+                                    font.pixelSize: 12
+                                    font.family: "Consolas"
+                                    color: "gray"
+                                    Layout.preferredWidth: 170
+                                }
+
+                                Text {
+                                    text: model.level
+                                    font.pixelSize: 12
+                                    font.family: "Consolas"
+                                    font.bold: model.level === "ERROR" || model.level === "WARNING"
+                                    color: model.level === "ERROR" ? "#c62828" : (model.level === "WARNING" ? "#ef6c00" : "black")
+                                    Layout.preferredWidth: 60
+                                }
+
+                                Text {
+                                    text: model.message
+                                    font.pixelSize: 12
+                                    font.family: "Consolas"
+                                    elide: Text.ElideRight
+                                    Layout.fillWidth: true
+                                    ToolTip.text: model.source
+                                    ToolTip.visible: lineHover.containsMouse && model.source.length > 0
+
+                                    MouseArea {
+                                        id: lineHover
+                                        anchors.fill: parent
+                                        hoverEnabled: true
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            Rectangle {
+                color: "white"
+                anchors.fill: parent
+
+                ColumnLayout {
+                    anchors.fill: parent
+                    anchors.margins: 10
+                    spacing: 6
+
+                    // Statistik und Spektren der analysierten Kanäle aus dem SignalAnalyzer
+                    Label {
+                        text: "Signalanalyse" + (analysisModel.kernels.length > 0 ? " (" + analysisModel.kernels + ")" : "")
+                        font.bold: true
+                        visible: analysisView.count > 0
+                    }
+
+                    ListView {
+                        id: analysisView
+                        Layout.fillWidth: true
+                        Layout.preferredHeight: count * 26
+                        interactive: false
+                        spacing: 2
+
+                        model: AnalysisModel {
+                            id: analysisModel
+                            interval: 100
+                        }
+
+                        delegate: Rectangle {
+                            width: ListView.view.width
+                            height: 24
+                            color: index % 2 === 0 ? "#f5f5f5" : "white"
+
+                            RowLayout {
+                                anchors.fill: parent
+                                anchors.leftMargin: 6
+                                anchors.rightMargin: 6
+                                spacing: 10
+
+                                Text {
+                                    text: model.name
+                                    elide: Text.ElideRight
+                                    font.pixelSize: 13
+                                    Layout.fillWidth: true
+                                }
+
+                                Text {
+                                    text: "Mittel " + model.mean.toFixed(3) + "  RMS " + model.rms.toFixed(3) +
+                                          "  σ " + model.deviation.toFixed(3) +
+                                          "  [" + model.min.toFixed(2) + ", " + model.max.toFixed(2) + "]"
+                                    font.pixelSize: 13
+                                    font.family: "Consolas"
+                                    Layout.preferredWidth: 430
+                                }
+
+                                Text {
+                                    text: model.sampleRate > 0 ? "Peak " + model.peakFrequency.toFixed(1) + " Hz @ " +
+                                                                 model.sampleRate.toFixed(0) + " Hz" : ""
+                                    font.pixelSize: 13
+                                    font.family: "Consolas"
+                                    color: "gray"
+                                    Layout.preferredWidth: 200
+                                }
+                            }
+                        }
+                    }
+
+                    // Kennzahlen der Pipeline aus der MetricsRegistry
+                    ListView {
+                        Layout.fillWidth: true
+                        Layout.fillHeight: true
+                        clip: true
+                        spacing: 2
+
+                        model: MetricsModel {
+                            interval: 1000
+                        }
+
+                        delegate: Rectangle {
+                            width: ListView.view.width
+                            height: 24
+                            color: index % 2 === 0 ? "#f5f5f5" : "white"
+
+                            RowLayout {
+                                anchors.fill: parent
+                                anchors.leftMargin: 6
+                                anchors.rightMargin: 6
+                                spacing: 10
+
+                                Text {
+                                    text: model.labels.length > 0 ? model.name + " {" + model.labels + "}" : model.name
+                                    elide: Text.ElideRight
+                                    font.pixelSize: 13
+                                    Layout.fillWidth: true
+                                    ToolTip.text: model.help
+                                    ToolTip.visible: hoverArea.containsMouse
+
+                                    MouseArea {
+                                        id: hoverArea
+                                        anchors.fill: parent
+                                        hoverEnabled: true
+                                    }
+                                }
+
+                                Text {
+                                    text: model.value
+                                    font.pixelSize: 13
+                                    font.family: "Consolas"
+                                    horizontalAlignment: Text.AlignRight
+                                    Layout.preferredWidth: 110
+                                }
+
+                                Text {
+                                    text: model.detail
+                                    font.pixelSize: 13
+                                    font.family: "Consolas"
+                                    color: "gray"
+                                    Layout.preferredWidth: 320
+                                }
+                            }
+                        }
+                    }
                 }
             }
 
@@ -0,0 +1,150 @@
+#include "AnalysisModel.h"
+
+#include <cmath>
+
+using namespace aerolab::App;
+
+std::shared_ptr<aerolab::Core::SignalAnalyzer> AnalysisModel::s_pAnalyzer = nullptr;
+
+/**
+ * @brief Constructor of the AnalysisModel
+ * @param parent The parent object
+ */
+AnalysisModel::AnalysisModel(QObject *parent) : QAbstractListModel(parent)
+{
+    // Matches the default update interval of the analyzer
+    m_timer.setInterval(100);
+    connect(&m_timer, &QTimer::timeout, this, &AnalysisModel::refresh);
+    m_timer.start();
+
+    refresh();
+}
+
+/**
+ * @brief Sets the analyzer all models read from
+ * @details Has to be called before the QML engine creates the first model.
+ * @param pAnalyzer The running analyzer, nullptr if the analysis is disabled
+ */
+void AnalysisModel::SetAnalyzer(std::shared_ptr<Core::SignalAnalyzer> pAnalyzer)
+{
+    s_pAnalyzer = std::move(pAnalyzer);
+}
+
+// ============================================================================
+// Model interface
+// ============================================================================
+
+int AnalysisModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_results.size());
+}
+
+QVariant AnalysisModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(m_results.size()))
+        return {};
+
+    const Core::AnalysisResult &result = m_results[static_cast<std::size_t>(index.row())];
+    switch (role)
+    {
+    case NameRole:
+        return QString::fromStdString(result.channel);
+    case MeanRole:
+        return static_cast<double>(result.stats.mean);
+    case RmsRole:
+        return static_cast<double>(result.stats.rms);
+    case DeviationRole:
+        return std::sqrt(static_cast<double>(result.stats.variance));
+    case MinRole:
+        return static_cast<double>(result.stats.min);
+    case MaxRole:
+        return static_cast<double>(result.stats.max);
+    case PeakFrequencyRole:
+        return static_cast<double>(result.spectrum.peakFrequency);
+    case SampleRateRole:
+        return static_cast<double>(result.sampleRate);
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> AnalysisModel::roleNames() const
+{
+    return {{NameRole, "name"},
+            {MeanRole, "mean"},
+            {RmsRole, "rms"},
+            {DeviationRole, "deviation"},
+            {MinRole, "min"},
+            {MaxRole, "max"},
+            {PeakFrequencyRole, "peakFrequency"},
+            {SampleRateRole, "sampleRate"}};
+}
+
+void AnalysisModel::setInterval(int milliseconds)
+{
+    if (milliseconds <= 0 || milliseconds == m_timer.interval())
+        return;
+
+    m_timer.setInterval(milliseconds);
+    emit intervalChanged();
+}
+
+QString AnalysisModel::kernels() const
+{
+    return s_pAnalyzer ? QString::fromLatin1(s_pAnalyzer->Kernels().name) : QString();
+}
+
+// ============================================================================
+// Refresh
+// ============================================================================
+
+/**
+ * @brief Power spectral density of an analyzed channel
+ * @param channel Name of the channel, e.g. "imu/acc_x"
+ * @return Density per bin from 0 Hz to the Nyquist frequency, empty if the channel is not analyzed yet
+ */
+QVariantList AnalysisModel::spectrum(const QString &channel) const
+{
+    QVariantList result;
+    const std::string name = channel.toStdString();
+    for (const Core::AnalysisResult &analysis : m_results)
+    {
+        if (analysis.channel != name)
+            continue;
+
+        result.reserve(static_cast<qsizetype>(analysis.spectrum.psd.size()));
+        for (float density : analysis.spectrum.psd)
+            result.append(static_cast<double>(density));
+        break;
+    }
+    return result;
+}
+
+/**
+ * @brief Copies the latest results of the analyzer
+ * @details Channels are only added to the analyzer, so an unchanged number of channels means unchanged rows
+ *          and only the values are updated. New channels reset the model.
+ */
+void AnalysisModel::refresh()
+{
+    if (!s_pAnalyzer)
+        return;
+
+    const std::vector<std::string> channels = s_pAnalyzer->Channels();
+    std::vector<Core::AnalysisResult> results(channels.size());
+    for (std::size_t i = 0; i < channels.size(); i++)
+        s_pAnalyzer->GetResult(channels[i], results[i]);
+
+    if (results.size() == m_results.size())
+    {
+        m_results = std::move(results);
+        if (!m_results.empty())
+            emit dataChanged(index(0), index(static_cast<int>(m_results.size()) - 1),
+                             {MeanRole, RmsRole, DeviationRole, MinRole, MaxRole, PeakFrequencyRole, SampleRateRole});
+        return;
+    }
+
+    beginResetModel();
+    m_results = std::move(results);
+    endResetModel();
+}
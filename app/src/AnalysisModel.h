@@ -0,0 +1,72 @@
+#pragma once
+
+#include <SignalAnalysis.h>
+
+#include <QAbstractListModel>
+#include <QTimer>
+#include <QVariantList>
+#include <QtQml/qqmlregistration.h>
+
+#include <memory>
+#include <vector>
+
+namespace aerolab::App
+{
+    /**
+     * @brief The AnalysisModel class
+     * @details List model of the SignalAnalyzer results for the statistics page, one row per analyzed channel.
+     *          The analyzer computes on its own thread, the model only copies the latest results on a timer.
+     */
+    class AnalysisModel : public QAbstractListModel
+    {
+        Q_OBJECT
+        QML_ELEMENT
+
+        Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+        Q_PROPERTY(QString kernels READ kernels CONSTANT)
+
+    public:
+        /// Roles of the model
+        enum E_Role
+        {
+            NameRole = Qt::UserRole + 1,
+            MeanRole,
+            RmsRole,
+            DeviationRole,
+            MinRole,
+            MaxRole,
+            PeakFrequencyRole,
+            SampleRateRole
+        };
+
+        explicit AnalysisModel(QObject *parent = nullptr);
+
+        static void SetAnalyzer(std::shared_ptr<Core::SignalAnalyzer> pAnalyzer);
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex &index, int role) const override;
+        QHash<int, QByteArray> roleNames() const override;
+
+        /// @brief Refresh interval in milliseconds
+        int interval() const { return m_timer.interval(); }
+        void setInterval(int milliseconds);
+
+        /// @brief Instruction set of the analysis, e.g. "avx2"
+        QString kernels() const;
+
+        Q_INVOKABLE QVariantList spectrum(const QString &channel) const;
+        Q_INVOKABLE void refresh();
+
+    signals:
+        void intervalChanged();
+
+    private:
+        /// Analyzer shared by all models
+        static std::shared_ptr<Core::SignalAnalyzer> s_pAnalyzer;
+
+        /// Latest results in analyzer order
+        std::vector<Core::AnalysisResult> m_results;
+        /// Polls the analyzer
+        QTimer m_timer;
+    };
+}
@@ -0,0 +1,572 @@
+#include "LogModel.h"
+
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstring>
+#include <string_view>
+
+using namespace aerolab::App;
+
+namespace
+{
+    /// Displayed characters of a line, hex dumps of whole datagrams are cut
+    constexpr qint64 MAX_DISPLAY_BYTES = 2000;
+
+    /// @brief Offset of the next line break in [begin, end), end if there is none
+    qint64 findLineBreak(const char *pData, qint64 begin, qint64 end)
+    {
+        const void *pBreak = std::memchr(pData + begin, '\n', static_cast<std::size_t>(end - begin));
+        return pBreak ? static_cast<const char *>(pBreak) - pData : end;
+    }
+
+    /// @brief Splits a line "time|level|file:line|function|message" at its first separators
+    std::array<std::string_view, 5> splitLine(std::string_view line)
+    {
+        std::array<std::string_view, 5> fields{};
+        std::size_t position = 0;
+        for (std::size_t i = 0; i < 4; i++)
+        {
+            const std::size_t separator = line.find('|', position);
+            if (separator == std::string_view::npos)
+            {
+                // Not written by the Logger, e.g. a continuation line
+                fields = {};
+                fields[4] = line;
+                return fields;
+            }
+            fields[i] = line.substr(position, separator - position);
+            position = separator + 1;
+        }
+        fields[4] = line.substr(position);
+        return fields;
+    }
+
+    QString toQString(std::string_view text)
+    {
+        return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+    }
+}
+
+/**
+ * @brief Constructor of the LogModel
+ * @param parent The parent object
+ */
+LogModel::LogModel(QObject *parent) : QAbstractListModel(parent)
+{
+    connect(&m_watcher, &QFutureWatcher<ChunkResult>::finished, this, &LogModel::onJobFinished);
+
+    m_pollTimer.setInterval(500);
+    connect(&m_pollTimer, &QTimer::timeout, this, &LogModel::poll);
+    m_pollTimer.start();
+}
+
+/**
+ * @brief Destructor of the LogModel
+ * @details Waits for the running task, it reads the mapping.
+ */
+LogModel::~LogModel()
+{
+    m_pollTimer.stop();
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+}
+
+// ============================================================================
+// Model interface
+// ============================================================================
+
+int LogModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    const qint64 rows = m_filtered ? static_cast<qint64>(m_matches.size()) : m_totalLines;
+    return static_cast<int>(std::min<qint64>(rows, INT_MAX));
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const
+{
+    qint64 begin = 0;
+    qint64 length = 0;
+    if (!index.isValid() || !findLine(index.row(), begin, length))
+        return {};
+
+    std::string_view line(m_pData + begin, static_cast<std::size_t>(length));
+    if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
+    const bool cut = line.size() > static_cast<std::size_t>(MAX_DISPLAY_BYTES);
+    if (cut)
+        line = line.substr(0, static_cast<std::size_t>(MAX_DISPLAY_BYTES));
+
+    if (role == LineRole)
+        return toQString(line) + (cut ? QStringLiteral(" …") : QString());
+
+    const auto fields = splitLine(line);
+    switch (role)
+    {
+    case TimeRole:
+        return toQString(fields[0]);
+    case LevelRole:
+        return toQString(fields[1]);
+    case SourceRole:
+        return fields[2].empty() ? QString() : toQString(fields[2]) + QStringLiteral(" ") + toQString(fields[3]);
+    case MessageRole:
+        return toQString(fields[4]) + (cut ? QStringLiteral(" …") : QString());
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> LogModel::roleNames() const
+{
+    return {{LineRole, "line"},
+            {TimeRole, "time"},
+            {LevelRole, "level"},
+            {SourceRole, "source"},
+            {MessageRole, "message"}};
+}
+
+void LogModel::setPath(const QString &path)
+{
+    if (path == m_file.fileName())
+        return;
+
+    m_file.setFileName(path);
+    emit pathChanged();
+    reload();
+}
+
+void LogModel::setFilterText(const QString &text)
+{
+    if (text == m_filterText)
+        return;
+
+    m_filterText = text;
+    emit filterChanged();
+
+    m_filterDirty = true;
+    if (m_job == E_Job::Filter)
+        m_watcher.cancel();
+    else if (m_job == E_Job::None)
+        startFiltering();
+}
+
+void LogModel::setLevelMask(int mask)
+{
+    mask &= AllLevels;
+    if (mask == m_levelMask)
+        return;
+
+    m_levelMask = mask;
+    emit filterChanged();
+
+    m_filterDirty = true;
+    if (m_job == E_Job::Filter)
+        m_watcher.cancel();
+    else if (m_job == E_Job::None)
+        startFiltering();
+}
+
+void LogModel::setInterval(int milliseconds)
+{
+    if (milliseconds <= 0 || milliseconds == m_pollTimer.interval())
+        return;
+
+    m_pollTimer.setInterval(milliseconds);
+    emit intervalChanged();
+}
+
+// ============================================================================
+// Indexing
+// ============================================================================
+
+/**
+ * @brief Drops the index and loads the file again
+ */
+void LogModel::reload()
+{
+    if (m_job != E_Job::None)
+    {
+        m_watcher.cancel();
+        m_watcher.waitForFinished();
+        m_job = E_Job::None;
+    }
+
+    beginResetModel();
+    if (m_pData)
+        m_file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(m_pData)));
+    m_pData = nullptr;
+    m_mappedSize = 0;
+    m_file.close();
+
+    m_chunks.clear();
+    m_totalLines = 0;
+    m_indexedEnd = 0;
+    m_matches.clear();
+    m_filtered = !currentFilter().IsEmpty();
+    m_filterDirty = false;
+    m_cachedRow = -1;
+    endResetModel();
+
+    emit progressChanged();
+    poll();
+}
+
+/**
+ * @brief Checks the file for appended lines and indexes them
+ * @details Called by the poll timer and after every task, so large files are indexed step by step.
+ */
+void LogModel::poll()
+{
+    if (m_job != E_Job::None || m_file.fileName().isEmpty())
+        return;
+
+    // The file may not exist yet, e.g. before the first message
+    if (!m_file.isOpen() && !m_file.open(QIODevice::ReadOnly))
+        return;
+
+    const qint64 size = m_file.size();
+    if (size < m_mappedSize)
+    {
+        // Truncated or replaced, the index is invalid
+        reload();
+        return;
+    }
+
+    if (size > m_mappedSize && !remap(size))
+        return;
+
+    startIndexing();
+}
+
+/**
+ * @brief Maps the file with its current size
+ * @details The mapping is only replaced while no task runs, the tasks read it.
+ */
+bool LogModel::remap(qint64 size)
+{
+    if (m_pData)
+        m_file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(m_pData)));
+
+    m_pData = reinterpret_cast<const char *>(m_file.map(0, size));
+    m_mappedSize = m_pData ? size : 0;
+    m_cachedRow = -1;
+    if (!m_pData)
+    {
+        // Indexed rows must not be read without mapping
+        beginResetModel();
+        m_chunks.clear();
+        m_totalLines = 0;
+        m_indexedEnd = 0;
+        m_matches.clear();
+        endResetModel();
+        emit progressChanged();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Starts indexing the complete lines behind the indexed part, at most INDEX_STEP_BYTES
+ * @details The range is split into chunks of about CHUNK_BYTES at line breaks, one task per chunk.
+ *          A line still being written has no line break yet and is indexed with the next poll.
+ */
+void LogModel::startIndexing()
+{
+    if (!m_pData || m_indexedEnd >= m_mappedSize)
+        return;
+
+    qint64 lastBreak = m_mappedSize - 1;
+    while (lastBreak >= m_indexedEnd && m_pData[lastBreak] != '\n')
+        lastBreak--;
+    if (lastBreak < m_indexedEnd)
+        return;
+    const qint64 available = lastBreak + 1;
+
+    // Ends the range behind the first line break at or after the given offset
+    const auto endAtLineBreak = [this, available](qint64 offset)
+    { return offset >= available ? available : findLineBreak(m_pData, offset, available) + 1; };
+
+    const qint64 stepEnd = endAtLineBreak(m_indexedEnd + INDEX_STEP_BYTES - 1);
+
+    std::vector<std::pair<qint64, qint64>> ranges;
+    for (qint64 begin = m_indexedEnd; begin < stepEnd;)
+    {
+        const qint64 end = std::min(endAtLineBreak(begin + CHUNK_BYTES - 1), stepEnd);
+        ranges.emplace_back(begin, end);
+        begin = end;
+    }
+
+    startJob(E_Job::Index, ranges);
+}
+
+/**
+ * @brief Starts filtering all indexed lines with the current filter
+ */
+void LogModel::startFiltering()
+{
+    m_filterDirty = false;
+
+    const Filter filter = currentFilter();
+    if (filter.IsEmpty() || m_chunks.empty())
+    {
+        beginResetModel();
+        m_matches.clear();
+        m_filtered = !filter.IsEmpty();
+        m_cachedRow = -1;
+        endResetModel();
+        return;
+    }
+
+    std::vector<std::pair<qint64, qint64>> ranges;
+    ranges.reserve(m_chunks.size());
+    for (const Chunk &chunk : m_chunks)
+        ranges.emplace_back(chunk.begin, chunk.end);
+
+    startJob(E_Job::Filter, ranges);
+}
+
+/**
+ * @brief Runs scanChunk() for every range on the thread pool
+ * @details The tasks capture the filter, later changes mark the results as outdated.
+ */
+void LogModel::startJob(E_Job job, const std::vector<std::pair<qint64, qint64>> &ranges)
+{
+    m_job = job;
+    m_jobFilter = currentFilter();
+
+    const char *pData = m_pData;
+    const Filter filter = m_jobFilter;
+    m_watcher.setFuture(QtConcurrent::mapped(ranges, [pData, filter](const std::pair<qint64, qint64> &range)
+                                             { return scanChunk(pData, range.first, range.second, filter); }));
+    emit progressChanged();
+}
+
+void LogModel::onJobFinished()
+{
+    // Ignores the signal of a task replaced by reload()
+    if (m_job == E_Job::None || m_watcher.isRunning())
+        return;
+
+    const E_Job job = m_job;
+    m_job = E_Job::None;
+
+    if (!m_watcher.isCanceled())
+    {
+        const QList<ChunkResult> results = m_watcher.future().results();
+        if (job == E_Job::Index)
+            appendChunks(results);
+        else if (!m_filterDirty)
+            applyMatches(results);
+    }
+
+    emit progressChanged();
+
+    if (m_filterDirty)
+        startFiltering();
+    if (m_job == E_Job::None)
+        poll();
+}
+
+/**
+ * @brief Appends the chunks of an index task and inserts their rows
+ */
+void LogModel::appendChunks(const QList<ChunkResult> &results)
+{
+    if (results.isEmpty())
+        return;
+
+    // Matches of an outdated filter are dropped, the filter task started afterwards covers the new chunks
+    const bool useMatches = m_filtered && !m_filterDirty;
+
+    qint64 firstRow = m_totalLines;
+    std::vector<quint32> newMatches;
+    for (const ChunkResult &result : results)
+    {
+        if (useMatches)
+            for (quint32 line : result.matches)
+                newMatches.push_back(static_cast<quint32>(firstRow + line));
+        firstRow += result.chunk.lineCount;
+    }
+
+    const int oldRows = rowCount();
+    const qint64 newRows = m_filtered ? static_cast<qint64>(m_matches.size() + newMatches.size()) : firstRow;
+    const int insertedEnd = static_cast<int>(std::min<qint64>(newRows, INT_MAX));
+    const bool insert = insertedEnd > oldRows;
+
+    if (insert)
+        beginInsertRows(QModelIndex(), oldRows, insertedEnd - 1);
+
+    for (const ChunkResult &result : results)
+    {
+        m_chunks.push_back(result.chunk);
+        m_chunks.back().firstRow = m_totalLines;
+        m_totalLines += result.chunk.lineCount;
+    }
+    m_indexedEnd = m_chunks.back().end;
+    m_matches.insert(m_matches.end(), newMatches.begin(), newMatches.end());
+
+    if (insert)
+        endInsertRows();
+}
+
+/**
+ * @brief Replaces the rows with the matches of a filter task
+ */
+void LogModel::applyMatches(const QList<ChunkResult> &results)
+{
+    std::vector<quint32> matches;
+    for (qsizetype i = 0; i < results.size() && static_cast<std::size_t>(i) < m_chunks.size(); i++)
+    {
+        const qint64 firstRow = m_chunks[static_cast<std::size_t>(i)].firstRow;
+        for (quint32 line : results[i].matches)
+            matches.push_back(static_cast<quint32>(firstRow + line));
+    }
+
+    beginResetModel();
+    m_matches = std::move(matches);
+    m_filtered = true;
+    m_cachedRow = -1;
+    endResetModel();
+}
+
+LogModel::Filter LogModel::currentFilter() const
+{
+    return Filter{m_filterText.toUtf8(), m_levelMask};
+}
+
+/**
+ * @brief Indexes the lines of a chunk and filters them
+ * @details Runs on the thread pool. The range starts at a line start and ends behind a line break.
+ * @param pData The mapped file
+ * @param begin Offset of the first byte
+ * @param end Offset behind the last byte
+ * @param filter Lines passing the filter are added to the matches, nothing is added for an empty filter
+ */
+LogModel::ChunkResult LogModel::scanChunk(const char *pData, qint64 begin, qint64 end, const Filter &filter)
+{
+    ChunkResult result;
+    result.chunk.begin = begin;
+    result.chunk.end = end;
+
+    const bool filtering = !filter.IsEmpty();
+    quint32 line = 0;
+    for (qint64 position = begin; position < end; line++)
+    {
+        if (line % INDEX_STRIDE == 0)
+            result.chunk.checkpoints.push_back(position);
+
+        const qint64 lineEnd = findLineBreak(pData, position, end);
+        if (filtering && matches(pData + position, lineEnd - position, filter))
+            result.matches.push_back(line);
+        position = lineEnd + 1;
+    }
+
+    result.chunk.lineCount = line;
+    return result;
+}
+
+/**
+ * @brief Checks a line against the filter
+ */
+bool LogModel::matches(const char *pLine, qint64 length, const Filter &filter)
+{
+    if ((lineLevel(pLine, length) & filter.levelMask) == 0)
+        return false;
+    if (filter.text.isEmpty())
+        return true;
+
+    const std::string_view line(pLine, static_cast<std::size_t>(length));
+    return line.find(std::string_view(filter.text.constData(), static_cast<std::size_t>(filter.text.size()))) != std::string_view::npos;
+}
+
+/**
+ * @brief Level of a line written by the Logger, the field behind the timestamp
+ * @return The E_LevelFlag of the line, OtherLevel for lines without a level
+ */
+int LogModel::lineLevel(const char *pLine, qint64 length)
+{
+    // The ISO timestamp is shorter than this, anything else is no Logger line
+    const qint64 limit = std::min<qint64>(length, 40);
+    const void *pSeparator = std::memchr(pLine, '|', static_cast<std::size_t>(limit));
+    if (!pSeparator)
+        return OtherLevel;
+
+    const qint64 levelStart = static_cast<const char *>(pSeparator) - pLine + 1;
+    if (levelStart >= length)
+        return OtherLevel;
+
+    switch (pLine[levelStart])
+    {
+    case 'E':
+        return ErrorLevel;
+    case 'W':
+        return WarningLevel;
+    case 'I':
+        return InfoLevel;
+    case 'D':
+        return DebugLevel;
+    default:
+        return OtherLevel;
+    }
+}
+
+// ============================================================================
+// Row lookup
+// ============================================================================
+
+/**
+ * @brief Locates a row in the mapped file
+ * @param row Row of the model, i.e. of the matches while filtered
+ * @param begin Receives the offset of the line
+ * @param length Receives the length of the line without the line break
+ * @return False if the row does not exist
+ */
+bool LogModel::findLine(qint64 row, qint64 &begin, qint64 &length) const
+{
+    if (!m_pData || row < 0)
+        return false;
+
+    qint64 line = row;
+    if (m_filtered)
+    {
+        if (row >= static_cast<qint64>(m_matches.size()))
+            return false;
+        line = m_matches[static_cast<std::size_t>(row)];
+    }
+    if (line >= m_totalLines)
+        return false;
+
+    if (line == m_cachedRow)
+    {
+        begin = m_cachedBegin;
+        length = m_cachedLength;
+        return true;
+    }
+
+    if (line == m_cachedRow + 1 && m_cachedRow >= 0)
+    {
+        // The next line, as asked for while the view scrolls
+        begin = m_cachedBegin + m_cachedLength + 1;
+    }
+    else
+    {
+        const auto chunk = std::upper_bound(m_chunks.begin(), m_chunks.end(), line, [](qint64 value, const Chunk &entry)
+                                            { return value < entry.firstRow; }) -
+                           1;
+        const qint64 local = line - chunk->firstRow;
+        begin = chunk->checkpoints[static_cast<std::size_t>(local / INDEX_STRIDE)];
+        for (qint64 skip = local % INDEX_STRIDE; skip > 0; skip--)
+            begin = findLineBreak(m_pData, begin, m_indexedEnd) + 1;
+    }
+
+    length = findLineBreak(m_pData, begin, m_indexedEnd) - begin;
+
+    m_cachedRow = line;
+    m_cachedBegin = begin;
+    m_cachedLength = length;
+    return true;
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QtQml/qqmlregistration.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace aerolab::App
+{
+    /**
+     * @brief The LogModel class
+     * @details List model of the lines of a log file for the logs page, built for files of several gigabytes.
+     *          The file is memory-mapped and never copied, the model only keeps a sparse index: the file is
+     *          split into chunks and every chunk stores the offset of every INDEX_STRIDE-th line.
+     *          A row is located by a binary search over the chunks and a scan of at most INDEX_STRIDE lines,
+     *          so only the rows the ListView asks for are ever read.
+     *
+     *          Indexing and filtering run on the QtConcurrent thread pool, one task per chunk, and never block
+     *          the GUI thread. Large files are indexed in steps of INDEX_STEP_BYTES, so the first rows are
+     *          available right away and the rest is appended while the user already scrolls.
+     *          The file is polled for appended lines, only the appended bytes are indexed. A file which shrank
+     *          (e.g. replaced by a new log) is loaded again.
+     */
+    class LogModel : public QAbstractListModel
+    {
+        Q_OBJECT
+        QML_ELEMENT
+
+        Q_PROPERTY(QString path READ path WRITE setPath NOTIFY pathChanged)
+        Q_PROPERTY(QString filterText READ filterText WRITE setFilterText NOTIFY filterChanged)
+        Q_PROPERTY(int levelMask READ levelMask WRITE setLevelMask NOTIFY filterChanged)
+        Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+        Q_PROPERTY(qint64 totalLines READ totalLines NOTIFY progressChanged)
+        Q_PROPERTY(bool busy READ busy NOTIFY progressChanged)
+
+    public:
+        /// Roles of the model
+        enum E_Role
+        {
+            LineRole = Qt::UserRole + 1,
+            TimeRole,
+            LevelRole,
+            SourceRole,
+            MessageRole
+        };
+
+        /// Flags of the log levels for the level mask
+        enum E_LevelFlag
+        {
+            ErrorLevel = 0x01,
+            WarningLevel = 0x02,
+            InfoLevel = 0x04,
+            DebugLevel = 0x08,
+            /// Lines without a level, e.g. continuation lines, only shown without level filter
+            OtherLevel = 0x10,
+            AllLevels = 0x1F
+        };
+        Q_ENUM(E_LevelFlag)
+
+        explicit LogModel(QObject *parent = nullptr);
+        ~LogModel() override;
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex &index, int role) const override;
+        QHash<int, QByteArray> roleNames() const override;
+
+        /// @brief Path of the log file
+        QString path() const { return m_file.fileName(); }
+        void setPath(const QString &path);
+
+        /// @brief Case-sensitive text the shown lines have to contain, empty to show all lines
+        QString filterText() const { return m_filterText; }
+        void setFilterText(const QString &text);
+
+        /// @brief Levels of the shown lines, combination of E_LevelFlag
+        int levelMask() const { return m_levelMask; }
+        void setLevelMask(int mask);
+
+        /// @brief Poll interval for appended lines in milliseconds
+        int interval() const { return m_pollTimer.interval(); }
+        void setInterval(int milliseconds);
+
+        /// @brief Number of indexed lines of the file, regardless of the filter
+        qint64 totalLines() const { return m_totalLines; }
+        /// @brief True while the file is indexed or filtered
+        bool busy() const { return m_watcher.isRunning(); }
+
+    signals:
+        void pathChanged();
+        void filterChanged();
+        void intervalChanged();
+        void progressChanged();
+
+    private:
+        /// Lines per index entry
+        static constexpr int INDEX_STRIDE = 64;
+        /// Bytes per chunk, the unit of the parallel tasks
+        static constexpr qint64 CHUNK_BYTES = 16 << 20;
+        /// Maximum number of bytes indexed per step
+        static constexpr qint64 INDEX_STEP_BYTES = 256 << 20;
+
+        /// Index of a contiguous part of the file
+        struct Chunk
+        {
+            /// Offset of the first byte
+            qint64 begin = 0;
+            /// Offset behind the last byte, always behind a line break
+            qint64 end = 0;
+            /// Row of the first line starting in the chunk
+            qint64 firstRow = 0;
+            /// Number of lines starting in the chunk
+            qint64 lineCount = 0;
+            /// Offsets of every INDEX_STRIDE-th line, starting with the first line of the chunk
+            std::vector<qint64> checkpoints;
+        };
+
+        /// Result of a task, the index of a chunk and its lines passing the filter
+        struct ChunkResult
+        {
+            /// The chunk, firstRow is set by the GUI thread
+            Chunk chunk;
+            /// Lines of the chunk passing the filter, relative to the first line of the chunk
+            std::vector<quint32> matches;
+        };
+
+        /// Filter settings captured when a task is started
+        struct Filter
+        {
+            /// Text the lines have to contain, empty for any
+            QByteArray text;
+            /// Accepted levels
+            int levelMask = AllLevels;
+
+            /// @brief True if every line passes
+            bool IsEmpty() const { return text.isEmpty() && (levelMask & AllLevels) == AllLevels; }
+        };
+
+        /// Kind of the running task
+        enum class E_Job
+        {
+            None,
+            Index,
+            Filter
+        };
+
+        void reload();
+        void poll();
+        void startIndexing();
+        void startFiltering();
+        void startJob(E_Job job, const std::vector<std::pair<qint64, qint64>> &ranges);
+        void onJobFinished();
+        void appendChunks(const QList<ChunkResult> &results);
+        void applyMatches(const QList<ChunkResult> &results);
+        bool remap(qint64 size);
+        Filter currentFilter() const;
+        bool findLine(qint64 row, qint64 &begin, qint64 &length) const;
+
+        static ChunkResult scanChunk(const char *pData, qint64 begin, qint64 end, const Filter &filter);
+        static bool matches(const char *pLine, qint64 length, const Filter &filter);
+        static int lineLevel(const char *pLine, qint64 length);
+
+        /// The log file
+        QFile m_file;
+        /// Mapping of the file, nullptr if the file is empty or not open
+        const char *m_pData = nullptr;
+        /// Number of mapped bytes
+        qint64 m_mappedSize = 0;
+        /// Offset behind the last indexed line
+        qint64 m_indexedEnd = 0;
+        /// Index of the file in file order
+        std::vector<Chunk> m_chunks;
+        /// Number of indexed lines
+        qint64 m_totalLines = 0;
+
+        /// Current filter text
+        QString m_filterText;
+        /// Current level mask
+        int m_levelMask = AllLevels;
+        /// Rows passing the filter, only used while a filter is set
+        std::vector<quint32> m_matches;
+        /// The filter changed since the matches were built
+        bool m_filterDirty = false;
+        /// A filter is set and the rows are the matches
+        bool m_filtered = false;
+
+        /// The running task
+        QFutureWatcher<ChunkResult> m_watcher;
+        /// Kind of the running task
+        E_Job m_job = E_Job::None;
+        /// Filter of the running task
+        Filter m_jobFilter;
+        /// Polls the file for appended lines
+        QTimer m_pollTimer;
+
+        /// Last located row, ListViews ask for neighboring rows
+        mutable qint64 m_cachedRow = -1;
+        /// Offset of the last located row
+        mutable qint64 m_cachedBegin = 0;
+        /// Length of the last located row without the line break
+        mutable qint64 m_cachedLength = 0;
+    };
+}
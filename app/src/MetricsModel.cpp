@@ -0,0 +1,173 @@
+#include "MetricsModel.h"
+
+using namespace aerolab::App;
+
+namespace
+{
+    /// @brief Formats a duration given in seconds with a readable unit
+    QString formatSeconds(double seconds)
+    {
+        if (seconds < 1e-3)
+            return QString::number(seconds * 1e6, 'f', 1) + QStringLiteral(" µs");
+        if (seconds < 1.0)
+            return QString::number(seconds * 1e3, 'f', 2) + QStringLiteral(" ms");
+        return QString::number(seconds, 'f', 2) + QStringLiteral(" s");
+    }
+}
+
+/**
+ * @brief Constructor of the MetricsModel
+ * @param parent The parent object
+ */
+MetricsModel::MetricsModel(QObject *parent) : QAbstractListModel(parent),
+                                              m_pRegistry(Core::MetricsRegistry::GetInstance())
+{
+    m_timer.setInterval(1000);
+    connect(&m_timer, &QTimer::timeout, this, &MetricsModel::refresh);
+    m_timer.start();
+
+    m_sinceRefresh.start();
+    refresh();
+}
+
+// ============================================================================
+// Model interface
+// ============================================================================
+
+int MetricsModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+QVariant MetricsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(m_rows.size()))
+        return {};
+
+    const Row &row = m_rows[static_cast<std::size_t>(index.row())];
+    switch (role)
+    {
+    case NameRole:
+        return QString::fromStdString(row.metric.name);
+    case LabelsRole:
+        return QString::fromStdString(row.metric.labels);
+    case HelpRole:
+        return QString::fromStdString(row.metric.help);
+    case TypeRole:
+        return static_cast<int>(row.metric.type);
+    case ValueRole:
+        return row.value;
+    case DetailRole:
+        return row.detail;
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> MetricsModel::roleNames() const
+{
+    return {{NameRole, "name"},
+            {LabelsRole, "labels"},
+            {HelpRole, "help"},
+            {TypeRole, "type"},
+            {ValueRole, "value"},
+            {DetailRole, "detail"}};
+}
+
+void MetricsModel::setInterval(int milliseconds)
+{
+    if (milliseconds <= 0 || milliseconds == m_timer.interval())
+        return;
+
+    m_timer.setInterval(milliseconds);
+    emit intervalChanged();
+}
+
+// ============================================================================
+// Refresh
+// ============================================================================
+
+/**
+ * @brief Reads all metrics from the registry
+ * @details The registry never removes a metric and keeps them sorted, so an unchanged number of metrics
+ *          means unchanged rows and only the values are updated. New metrics reset the model.
+ */
+void MetricsModel::refresh()
+{
+    const double seconds = static_cast<double>(m_sinceRefresh.restart()) / 1000.0;
+    auto metrics = m_pRegistry->Snapshot();
+
+    if (metrics.size() == m_rows.size())
+    {
+        for (std::size_t i = 0; i < metrics.size(); i++)
+        {
+            const Core::MetricSnapshot previous = std::move(m_rows[i].metric);
+            m_rows[i].metric = std::move(metrics[i]);
+            format(m_rows[i], &previous, seconds);
+        }
+
+        if (!m_rows.empty())
+            emit dataChanged(index(0), index(static_cast<int>(m_rows.size()) - 1), {ValueRole, DetailRole});
+        return;
+    }
+
+    beginResetModel();
+    m_rows.clear();
+    m_rows.reserve(metrics.size());
+    for (auto &metric : metrics)
+    {
+        Row row;
+        row.metric = std::move(metric);
+        format(row, nullptr, seconds);
+        m_rows.push_back(std::move(row));
+    }
+    endResetModel();
+}
+
+/**
+ * @brief Formats the displayed texts of a row
+ * @param row The row to format
+ * @param pPrevious The metric at the last refresh, nullptr if unknown
+ * @param seconds Time since the last refresh
+ */
+void MetricsModel::format(Row &row, const Core::MetricSnapshot *pPrevious, double seconds)
+{
+    const auto &metric = row.metric;
+
+    switch (metric.type)
+    {
+    case Core::E_MetricType::Counter:
+        row.value = QString::number(metric.value, 'f', 0);
+        if (pPrevious && seconds > 0.0)
+            row.detail = QString::number((metric.value - pPrevious->value) / seconds, 'f', 1) + QStringLiteral(" /s");
+        else
+            row.detail.clear();
+        break;
+
+    case Core::E_MetricType::Gauge:
+        row.value = QString::number(metric.value, 'f', 0);
+        row.detail.clear();
+        break;
+
+    case Core::E_MetricType::Histogram:
+    {
+        const auto &histogram = metric.histogram;
+        row.value = QString::number(histogram.count);
+        if (histogram.count == 0)
+        {
+            row.detail.clear();
+            break;
+        }
+
+        // Only the seconds histograms are durations, other units are shown as plain numbers
+        const bool isDuration = metric.name.ends_with("_seconds");
+        const auto text = [isDuration](double value)
+        { return isDuration ? formatSeconds(value) : QString::number(value, 'g', 4); };
+
+        row.detail = QStringLiteral("p50 ") + text(histogram.Quantile(0.5)) +
+                     QStringLiteral("  p99 ") + text(histogram.Quantile(0.99)) +
+                     QStringLiteral("  p99.9 ") + text(histogram.Quantile(0.999));
+        break;
+    }
+    }
+}
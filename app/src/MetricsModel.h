@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Metrics.h>
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QtQml/qqmlregistration.h>
+
+#include <memory>
+#include <vector>
+
+namespace aerolab::App
+{
+    /**
+     * @brief The MetricsModel class
+     * @details List model of all metrics in the MetricsRegistry for the statistics page.
+     *          The registry is polled on a timer, so recording a metric never touches the GUI thread.
+     *          Counters show their rate since the last refresh, histograms their count and quantiles.
+     */
+    class MetricsModel : public QAbstractListModel
+    {
+        Q_OBJECT
+        QML_ELEMENT
+
+        Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+
+    public:
+        /// Roles of the model
+        enum E_Role
+        {
+            NameRole = Qt::UserRole + 1,
+            LabelsRole,
+            HelpRole,
+            TypeRole,
+            ValueRole,
+            DetailRole
+        };
+
+        explicit MetricsModel(QObject *parent = nullptr);
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex &index, int role) const override;
+        QHash<int, QByteArray> roleNames() const override;
+
+        /// @brief Refresh interval in milliseconds
+        int interval() const { return m_timer.interval(); }
+        void setInterval(int milliseconds);
+
+        Q_INVOKABLE void refresh();
+
+    signals:
+        void intervalChanged();
+
+    private:
+        /// Displayed state of a metric
+        struct Row
+        {
+            /// Latest copy of the metric
+            Core::MetricSnapshot metric;
+            /// Formatted value
+            QString value;
+            /// Rate of counters, quantiles of histograms
+            QString detail;
+        };
+
+        static void format(Row &row, const Core::MetricSnapshot *pPrevious, double seconds);
+
+        /// Registry the metrics are read from
+        std::shared_ptr<Core::MetricsRegistry> m_pRegistry;
+        /// Displayed metrics in registry order
+        std::vector<Row> m_rows;
+        /// Polls the registry
+        QTimer m_timer;
+        /// Time since the last refresh, for the counter rates
+        QElapsedTimer m_sinceRefresh;
+    };
+}
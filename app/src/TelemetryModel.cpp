@@ -0,0 +1,191 @@
+#include "TelemetryModel.h"
+
+#include <limits>
+
+using namespace aerolab::App;
+
+std::shared_ptr<aerolab::Core::TelemetrySnapshotBuffer> TelemetryModel::s_pBuffer = nullptr;
+
+namespace
+{
+    /// @brief Names of all snapshot fields
+    const QStringList &fieldNames()
+    {
+        static const QStringList names = []()
+        {
+            QStringList result;
+            for (const std::string &name : aerolab::Core::SnapshotFieldNames())
+                result.append(QString::fromStdString(name));
+            return result;
+        }();
+        return names;
+    }
+}
+
+/**
+ * @brief Constructor of the TelemetryModel
+ * @param parent The parent object
+ */
+TelemetryModel::TelemetryModel(QObject *parent) : QAbstractListModel(parent)
+{
+    resolveChannels();
+
+    // One snapshot per frame, like the repaints of the TelemetryPlot
+    m_timer.setInterval(16);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &TelemetryModel::poll);
+    m_timer.start();
+}
+
+/**
+ * @brief Sets the buffer all models read from
+ * @details Has to be called before the QML engine creates the first model.
+ * @param pBuffer The buffer the ingest publishes to
+ */
+void TelemetryModel::SetSnapshotBuffer(std::shared_ptr<Core::TelemetrySnapshotBuffer> pBuffer)
+{
+    s_pBuffer = std::move(pBuffer);
+}
+
+// ============================================================================
+// Model interface
+// ============================================================================
+
+int TelemetryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : static_cast<int>(m_fields.size());
+}
+
+QVariant TelemetryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= static_cast<int>(m_fields.size()))
+        return {};
+
+    const std::size_t row = static_cast<std::size_t>(index.row());
+    switch (role)
+    {
+    case NameRole:
+        return fieldNames()[static_cast<qsizetype>(m_fields[row])];
+    case ValueRole:
+        return m_values[row];
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> TelemetryModel::roleNames() const
+{
+    return {{NameRole, "name"},
+            {ValueRole, "value"}};
+}
+
+// ============================================================================
+// Properties
+// ============================================================================
+
+void TelemetryModel::setChannels(const QStringList &channels)
+{
+    if (channels == m_channelNames)
+        return;
+
+    m_channelNames = channels;
+    resolveChannels();
+    emit channelsChanged();
+}
+
+void TelemetryModel::setInterval(int milliseconds)
+{
+    if (milliseconds <= 0 || milliseconds == m_timer.interval())
+        return;
+
+    m_timer.setInterval(milliseconds);
+    emit intervalChanged();
+}
+
+/**
+ * @brief Value of a shown field
+ * @details Bindings calling it are not notified of new values, they have to depend on snapshotChanged.
+ * @param channel Name of the field, e.g. "attitude/roll"
+ * @return The latest value, NaN if the field is not shown
+ */
+double TelemetryModel::value(const QString &channel) const
+{
+    for (std::size_t row = 0; row < m_fields.size(); row++)
+    {
+        if (fieldNames()[static_cast<qsizetype>(m_fields[row])] == channel)
+            return m_values[row];
+    }
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+// ============================================================================
+// Snapshots
+// ============================================================================
+
+/**
+ * @brief Maps the channel names to snapshot fields and resets the model
+ */
+void TelemetryModel::resolveChannels()
+{
+    beginResetModel();
+    m_fields.clear();
+
+    const QStringList &names = fieldNames();
+    if (m_channelNames.isEmpty())
+    {
+        for (qsizetype i = 0; i < names.size(); i++)
+            m_fields.push_back(static_cast<std::size_t>(i));
+    }
+    else
+    {
+        for (const QString &channel : m_channelNames)
+        {
+            const qsizetype field = names.indexOf(channel);
+            if (field >= 0)
+                m_fields.push_back(static_cast<std::size_t>(field));
+        }
+    }
+
+    m_values.assign(m_fields.size(), 0.0);
+    // The next poll fills the rows, even without a new snapshot
+    m_sequence = std::numeric_limits<uint64_t>::max();
+    endResetModel();
+}
+
+/**
+ * @brief Takes the newest snapshot and notifies the views once about all changed rows
+ * @details The rows between the first and the last changed row are covered by a single dataChanged,
+ *          the views only rebind the value role.
+ */
+void TelemetryModel::poll()
+{
+    if (!s_pBuffer)
+        return;
+
+    // Every model calls Update(), the first one per frame takes the snapshot and the others see it in Read()
+    s_pBuffer->Update();
+    const Core::TelemetrySnapshot &snapshot = s_pBuffer->Read();
+    if (snapshot.sequence == m_sequence)
+        return;
+
+    m_sequence = snapshot.sequence;
+    m_timestampNs = snapshot.timestampNs;
+
+    int firstChanged = -1;
+    int lastChanged = -1;
+    for (std::size_t row = 0; row < m_fields.size(); row++)
+    {
+        const double value = snapshot.values[m_fields[row]];
+        if (value == m_values[row])
+            continue;
+
+        m_values[row] = value;
+        if (firstChanged < 0)
+            firstChanged = static_cast<int>(row);
+        lastChanged = static_cast<int>(row);
+    }
+
+    if (firstChanged >= 0)
+        emit dataChanged(index(firstChanged), index(lastChanged), {ValueRole});
+    emit snapshotChanged();
+}
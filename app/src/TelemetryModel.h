@@ -0,0 +1,87 @@
+#pragma once
+
+#include <TelemetrySnapshot.h>
+
+#include <QAbstractListModel>
+#include <QStringList>
+#include <QTimer>
+#include <QtQml/qqmlregistration.h>
+
+#include <memory>
+#include <vector>
+
+namespace aerolab::App
+{
+    /**
+     * @brief The TelemetryModel class
+     * @details List model of the latest telemetry values for the QML pages, one row per field.
+     *          The ingest publishes a snapshot of all fields per datagram into a lock-free TripleBuffer, the model
+     *          takes the newest snapshot once per frame and emits a single dataChanged over the rows whose value
+     *          changed. Snapshots published in between are skipped, so the GUI load does not depend on the packet
+     *          rate and the shown values are never older than one frame.
+     *          All models share the buffer, it is read only on the GUI thread.
+     */
+    class TelemetryModel : public QAbstractListModel
+    {
+        Q_OBJECT
+        QML_ELEMENT
+
+        Q_PROPERTY(QStringList channels READ channels WRITE setChannels NOTIFY channelsChanged)
+        Q_PROPERTY(int interval READ interval WRITE setInterval NOTIFY intervalChanged)
+        Q_PROPERTY(double timestamp READ timestamp NOTIFY snapshotChanged)
+
+    public:
+        /// Roles of the model
+        enum E_Role
+        {
+            NameRole = Qt::UserRole + 1,
+            ValueRole
+        };
+
+        explicit TelemetryModel(QObject *parent = nullptr);
+
+        static void SetSnapshotBuffer(std::shared_ptr<Core::TelemetrySnapshotBuffer> pBuffer);
+
+        int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+        QVariant data(const QModelIndex &index, int role) const override;
+        QHash<int, QByteArray> roleNames() const override;
+
+        /// @brief Names of the shown fields, e.g. "attitude/roll", empty to show all fields
+        QStringList channels() const { return m_channelNames; }
+        void setChannels(const QStringList &channels);
+
+        /// @brief Poll interval in milliseconds, one frame by default
+        int interval() const { return m_timer.interval(); }
+        void setInterval(int milliseconds);
+
+        /// @brief Receive time of the shown snapshot in seconds
+        double timestamp() const { return static_cast<double>(m_timestampNs) * 1e-9; }
+
+        Q_INVOKABLE double value(const QString &channel) const;
+
+    signals:
+        void channelsChanged();
+        void intervalChanged();
+        void snapshotChanged();
+
+    private:
+        void resolveChannels();
+        void poll();
+
+        /// Buffer shared by all models
+        static std::shared_ptr<Core::TelemetrySnapshotBuffer> s_pBuffer;
+
+        /// Names of the shown fields
+        QStringList m_channelNames;
+        /// Snapshot index of every row
+        std::vector<std::size_t> m_fields;
+        /// Shown value of every row
+        std::vector<double> m_values;
+        /// Sequence of the shown snapshot
+        uint64_t m_sequence = 0;
+        /// Receive time of the shown snapshot
+        int64_t m_timestampNs = 0;
+        /// Polls the buffer
+        QTimer m_timer;
+    };
+}
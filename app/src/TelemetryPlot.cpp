@@ -0,0 +1,368 @@
+#include "TelemetryPlot.h"
+
+#include <QMatrix4x4>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGTransformNode>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+using namespace aerolab::App;
+
+std::shared_ptr<aerolab::Core::TelemetryStore> TelemetryPlot::s_pStore = nullptr;
+
+namespace
+{
+    /// Colors assigned to the channels in order
+    const std::array<QColor, 6> PALETTE{QColor("#1f77b4"), QColor("#d62728"), QColor("#2ca02c"),
+                                        QColor("#ff7f0e"), QColor("#9467bd"), QColor("#8c564b")};
+
+    /// Vertex data is rebased after this time to keep the float precision of the x coordinates
+    constexpr int64_t REBASE_AFTER_NS = 3600LL * 1000000000LL;
+}
+
+/**
+ * @brief Constructor of the TelemetryPlot
+ * @param parent The parent item
+ */
+TelemetryPlot::TelemetryPlot(QQuickItem *parent) : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+    setClip(true);
+
+    // Repaint every frame, the scene graph throttles to the display refresh rate
+    m_frameTimer.setInterval(16);
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_frameTimer, &QTimer::timeout, this, &QQuickItem::update);
+    m_frameTimer.start();
+}
+
+/**
+ * @brief Sets the store all plots read from
+ * @details Has to be called before the QML engine creates the first plot.
+ * @param pStore The telemetry store
+ */
+void TelemetryPlot::SetStore(std::shared_ptr<Core::TelemetryStore> pStore)
+{
+    s_pStore = std::move(pStore);
+}
+
+// ============================================================================
+// Properties
+// ============================================================================
+
+void TelemetryPlot::setChannels(const QStringList &channels)
+{
+    if (channels == m_channelNames)
+        return;
+
+    m_channelNames = channels;
+    m_resetPending = true;
+    emit channelsChanged();
+    update();
+}
+
+void TelemetryPlot::setTimeWindow(double seconds)
+{
+    if (seconds <= 0.0 || seconds == m_timeWindow)
+        return;
+
+    m_timeWindow = seconds;
+    m_resetPending = true;
+    emit timeWindowChanged();
+    update();
+}
+
+void TelemetryPlot::setYMin(double value)
+{
+    if (value == m_yMin)
+        return;
+
+    m_yMin = value;
+    emit yRangeChanged();
+    update();
+}
+
+void TelemetryPlot::setYMax(double value)
+{
+    if (value == m_yMax)
+        return;
+
+    m_yMax = value;
+    emit yRangeChanged();
+    update();
+}
+
+void TelemetryPlot::setPaused(bool paused)
+{
+    if (paused == m_paused)
+        return;
+
+    m_paused = paused;
+    emit pausedChanged();
+}
+
+/**
+ * @brief Rebuilds the vertex data when the width changes, one vertex pair per pixel column
+ */
+void TelemetryPlot::geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+
+    if (newGeometry.width() != oldGeometry.width())
+    {
+        m_resetPending = true;
+        update();
+    }
+}
+
+// ============================================================================
+// Rendering
+// ============================================================================
+
+/**
+ * @brief Updates the scene graph nodes
+ * @details Runs on the render thread while the GUI thread is blocked. Only the pixel columns completed
+ *          since the last frame, and per series the columns after its latest sample, are queried,
+ *          everything else is done by the transform matrix.
+ */
+QSGNode *TelemetryPlot::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
+{
+    auto *pRoot = static_cast<QSGTransformNode *>(oldNode);
+    if (!pRoot)
+    {
+        pRoot = new QSGTransformNode;
+        m_resetPending = true;
+    }
+
+    const int columnCount = std::max(1, static_cast<int>(width()));
+
+    if (m_resetPending)
+    {
+        while (QSGNode *pChild = pRoot->firstChild())
+        {
+            pRoot->removeChildNode(pChild);
+            delete pChild;
+        }
+
+        resolveChannels();
+
+        // Room for two windows, old columns are dropped when it runs full
+        const int capacity = 4 * columnCount;
+        for (auto &series : m_series)
+        {
+            auto *pGeometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), capacity);
+            pGeometry->setDrawingMode(QSGGeometry::DrawLineStrip);
+            pGeometry->setVertexDataPattern(QSGGeometry::StreamPattern);
+            pGeometry->setLineWidth(1.0f);
+
+            auto *pMaterial = new QSGFlatColorMaterial;
+            pMaterial->setColor(series.color);
+
+            series.pNode = new QSGGeometryNode;
+            series.pNode->setGeometry(pGeometry);
+            series.pNode->setMaterial(pMaterial);
+            series.pNode->setFlags(QSGNode::OwnsGeometry | QSGNode::OwnsMaterial);
+            series.vertexCount = 0;
+
+            // Collapse all vertices into one point until data arrives
+            std::fill_n(pGeometry->vertexDataAsPoint2D(), capacity, QSGGeometry::Point2D{0.0f, 0.0f});
+
+            pRoot->appendChildNode(series.pNode);
+        }
+
+        m_coveredUntilNs = 0;
+        m_resetPending = false;
+    }
+
+    if (m_series.empty() || width() <= 0.0 || height() <= 0.0)
+        return pRoot;
+
+    const auto windowNs = static_cast<int64_t>(m_timeWindow * 1e9);
+    const int64_t columnNs = std::max<int64_t>(1, windowNs / columnCount);
+
+    if (!m_paused)
+    {
+        // The newest sample of all channels defines the right edge, so replayed data scrolls as well
+        int64_t nowNs = std::numeric_limits<int64_t>::min();
+        double nowValue = 0.0;
+        for (const auto &series : m_series)
+        {
+            Core::TelemetrySample latest;
+            if (series.pChannel->Latest(latest) && latest.timestampNs > nowNs)
+            {
+                nowNs = latest.timestampNs;
+                nowValue = latest.value;
+            }
+        }
+
+        if (nowNs == std::numeric_limits<int64_t>::min())
+            return pRoot;
+
+        const int64_t alignedNowNs = nowNs / columnNs * columnNs;
+
+        // Start over on the first sample, for precision after a long time and on jumps in time
+        if (m_coveredUntilNs == 0 || alignedNowNs - m_baseNs > REBASE_AFTER_NS || alignedNowNs < m_coveredUntilNs ||
+            alignedNowNs - m_coveredUntilNs > windowNs)
+        {
+            m_baseNs = alignedNowNs - windowNs;
+            m_baseValue = std::isfinite(nowValue) ? nowValue : 0.0;
+            m_coveredUntilNs = m_baseNs;
+            for (auto &series : m_series)
+            {
+                QSGGeometry *pGeometry = series.pNode->geometry();
+                std::fill_n(pGeometry->vertexDataAsPoint2D(), pGeometry->vertexCount(), QSGGeometry::Point2D{0.0f, 0.0f});
+                series.pNode->markDirty(QSGNode::DirtyGeometry);
+                series.vertexCount = 0;
+                series.completeUntilNs = m_baseNs;
+                series.completeVertexCount = 0;
+            }
+        }
+
+        const float windowStartX = static_cast<float>(static_cast<double>(alignedNowNs - windowNs - m_baseNs) * 1e-9);
+        for (auto &series : m_series)
+        {
+            if (series.completeUntilNs >= alignedNowNs)
+                continue;
+            dropOldVertices(series, windowStartX);
+            appendColumns(series, std::max(series.completeUntilNs, alignedNowNs - windowNs), alignedNowNs, columnNs);
+        }
+        m_coveredUntilNs = alignedNowNs;
+        m_viewEndNs = alignedNowNs;
+    }
+
+    // Map the window to the item, the vertex values are relative to m_baseValue
+    const double startX = static_cast<double>(m_viewEndNs - windowNs - m_baseNs) * 1e-9;
+
+    double yMin = m_yMin - m_baseValue;
+    double yMax = m_yMax - m_baseValue;
+    if (m_yMin == m_yMax)
+    {
+        yMin = std::numeric_limits<double>::max();
+        yMax = std::numeric_limits<double>::lowest();
+        for (const auto &series : m_series)
+        {
+            const QSGGeometry::Point2D *pVertices = series.pNode->geometry()->vertexDataAsPoint2D();
+            for (int i = 0; i < series.vertexCount; i++)
+            {
+                if (pVertices[i].x < startX)
+                    continue;
+                yMin = std::min<double>(yMin, pVertices[i].y);
+                yMax = std::max<double>(yMax, pVertices[i].y);
+            }
+        }
+
+        if (yMin > yMax)
+        {
+            yMin = -1.0;
+            yMax = 1.0;
+        }
+
+        // Keep a margin and avoid a degenerated range for constant signals
+        const double margin = std::max(0.05 * (yMax - yMin), 1e-3);
+        yMin -= margin;
+        yMax += margin;
+    }
+
+    QMatrix4x4 matrix;
+    matrix.translate(0.0f, static_cast<float>(height()));
+    matrix.scale(static_cast<float>(width() / m_timeWindow), static_cast<float>(-height() / (yMax - yMin)));
+    matrix.translate(static_cast<float>(-startX), static_cast<float>(-yMin));
+    pRoot->setMatrix(matrix);
+
+    return pRoot;
+}
+
+/**
+ * @brief Looks up the channels of the plotted names
+ */
+void TelemetryPlot::resolveChannels()
+{
+    m_series.clear();
+
+    if (!s_pStore)
+        return;
+
+    for (int i = 0; i < m_channelNames.size(); i++)
+    {
+        Series series;
+        series.pChannel = s_pStore->GetOrAddChannel(m_channelNames[i].toStdString());
+        series.color = PALETTE[i % PALETTE.size()];
+        m_series.push_back(series);
+    }
+}
+
+/**
+ * @brief Appends pixel columns to the vertex data of a series
+ * @details Vertices of columns at or after startNs are replaced, they were queried before all their samples arrived.
+ *          Afterwards the columns before the one with the latest sample of the channel are complete.
+ * @param series The series to extend
+ * @param startNs Start of the first column
+ * @param endNs End of the last column (exclusive)
+ * @param columnNs Width of a column
+ */
+void TelemetryPlot::appendColumns(Series &series, int64_t startNs, int64_t endNs, int64_t columnNs)
+{
+    QSGGeometry *pGeometry = series.pNode->geometry();
+    QSGGeometry::Point2D *pVertices = pGeometry->vertexDataAsPoint2D();
+    const int capacity = pGeometry->vertexCount();
+
+    // The latest sample is read first, samples arriving during the query only make later columns incomplete
+    Core::TelemetrySample latest;
+    const int64_t completeUntilNs = series.pChannel->Latest(latest) ? std::clamp(latest.timestampNs / columnNs * columnNs, startNs, endNs) : startNs;
+
+    const int previousCount = series.vertexCount;
+    series.vertexCount = series.completeVertexCount;
+
+    const auto columns = static_cast<std::size_t>((endNs - startNs) / columnNs);
+    series.pChannel->Query(startNs, endNs - 1, columns, m_buckets);
+
+    for (const auto &bucket : m_buckets)
+    {
+        if (series.vertexCount + 2 > capacity)
+            break;
+
+        const auto x = static_cast<float>(static_cast<double>(bucket.timestampNs - m_baseNs) * 1e-9);
+        pVertices[series.vertexCount++].set(x, static_cast<float>(bucket.min - m_baseValue));
+        pVertices[series.vertexCount++].set(x, static_cast<float>(bucket.max - m_baseValue));
+        if (bucket.timestampNs < completeUntilNs)
+            series.completeVertexCount = series.vertexCount;
+    }
+    series.completeUntilNs = completeUntilNs;
+
+    if (series.vertexCount == 0 && previousCount == 0)
+        return;
+
+    // Unused vertices repeat the last one, so the strip ends there without reallocating the geometry
+    const QSGGeometry::Point2D last = series.vertexCount > 0 ? pVertices[series.vertexCount - 1] : QSGGeometry::Point2D{0.0f, 0.0f};
+    std::fill(pVertices + series.vertexCount, pVertices + capacity, last);
+
+    series.pNode->markDirty(QSGNode::DirtyGeometry);
+}
+
+/**
+ * @brief Drops the vertices left of the visible window if the geometry runs full
+ * @param series The series to compact
+ * @param minX Left edge of the visible window in vertex coordinates
+ */
+void TelemetryPlot::dropOldVertices(Series &series, float minX)
+{
+    QSGGeometry *pGeometry = series.pNode->geometry();
+
+    if (series.vertexCount < pGeometry->vertexCount() / 2)
+        return;
+
+    QSGGeometry::Point2D *pVertices = pGeometry->vertexDataAsPoint2D();
+
+    // Keep one column left of the window so the line enters from the edge
+    int first = 0;
+    while (first + 2 < series.vertexCount && pVertices[first + 2].x < minX)
+        first += 2;
+
+    std::copy(pVertices + first, pVertices + series.vertexCount, pVertices);
+    series.vertexCount -= first;
+    series.completeVertexCount = std::max(0, series.completeVertexCount - first);
+}
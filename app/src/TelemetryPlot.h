@@ -0,0 +1,128 @@
+#pragma once
+
+#include <TelemetryStore.h>
+
+#include <QColor>
+#include <QQuickItem>
+#include <QStringList>
+#include <QTimer>
+#include <QtQml/qqmlregistration.h>
+
+#include <memory>
+#include <vector>
+
+class QSGGeometryNode;
+
+namespace aerolab::App
+{
+    /**
+     * @brief The TelemetryPlot class
+     * @details Scene graph item plotting telemetry channels over a scrolling time window.
+     *          Every channel is drawn as one line strip of min/max pairs, one pair per pixel column,
+     *          queried from the decimation levels of the TelemetryStore. Each frame only the columns
+     *          which became complete since the last frame are queried and appended to the vertex data,
+     *          scrolling and scaling is done by a transform node. Columns after the latest sample of a channel
+     *          are queried again on the next frames, so channels lagging behind the others are filled once
+     *          their samples arrive. Vertex values are relative to a base value, so channels with a large
+     *          constant part like positions keep their resolution in the float vertices.
+     */
+    class TelemetryPlot : public QQuickItem
+    {
+        Q_OBJECT
+        QML_ELEMENT
+
+        Q_PROPERTY(QStringList channels READ channels WRITE setChannels NOTIFY channelsChanged)
+        Q_PROPERTY(double timeWindow READ timeWindow WRITE setTimeWindow NOTIFY timeWindowChanged)
+        Q_PROPERTY(double yMin READ yMin WRITE setYMin NOTIFY yRangeChanged)
+        Q_PROPERTY(double yMax READ yMax WRITE setYMax NOTIFY yRangeChanged)
+        Q_PROPERTY(bool paused READ paused WRITE setPaused NOTIFY pausedChanged)
+
+    public:
+        explicit TelemetryPlot(QQuickItem *parent = nullptr);
+
+        static void SetStore(std::shared_ptr<Core::TelemetryStore> pStore);
+
+        /// @brief Names of the plotted channels
+        QStringList channels() const { return m_channelNames; }
+        void setChannels(const QStringList &channels);
+
+        /// @brief Visible time window in seconds
+        double timeWindow() const { return m_timeWindow; }
+        void setTimeWindow(double seconds);
+
+        /// @brief Lower bound of the value axis, equal bounds scale automatically
+        double yMin() const { return m_yMin; }
+        void setYMin(double value);
+
+        /// @brief Upper bound of the value axis, equal bounds scale automatically
+        double yMax() const { return m_yMax; }
+        void setYMax(double value);
+
+        /// @brief Freezes the plot
+        bool paused() const { return m_paused; }
+        void setPaused(bool paused);
+
+    signals:
+        void channelsChanged();
+        void timeWindowChanged();
+        void yRangeChanged();
+        void pausedChanged();
+
+    protected:
+        QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+        void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+
+    private:
+        /// Vertex data of a single channel
+        struct Series
+        {
+            /// Plotted channel
+            std::shared_ptr<Core::TelemetryChannel> pChannel;
+            /// Scene graph node owning the geometry, owned by the scene graph
+            QSGGeometryNode *pNode = nullptr;
+            /// Number of valid vertices in the geometry
+            int vertexCount = 0;
+            /// End of the columns which contained all their samples when queried, later columns are queried again
+            int64_t completeUntilNs = 0;
+            /// Number of vertices of the complete columns
+            int completeVertexCount = 0;
+            /// Color of the line
+            QColor color;
+        };
+
+        void resolveChannels();
+        void appendColumns(Series &series, int64_t startNs, int64_t endNs, int64_t columnNs);
+        void dropOldVertices(Series &series, float minX);
+
+        /// Store the channels are read from
+        static std::shared_ptr<Core::TelemetryStore> s_pStore;
+
+        /// Names of the plotted channels
+        QStringList m_channelNames;
+        /// Visible time window in seconds
+        double m_timeWindow = 10.0;
+        /// Lower bound of the value axis
+        double m_yMin = 0.0;
+        /// Upper bound of the value axis
+        double m_yMax = 0.0;
+        /// Frozen plot
+        bool m_paused = false;
+
+        /// Triggers a repaint every frame
+        QTimer m_frameTimer;
+        /// Series are rebuilt on the next paint
+        bool m_resetPending = true;
+        /// Plotted series, only accessed while the scene graph syncs
+        std::vector<Series> m_series;
+        /// Time the vertex x coordinates are relative to
+        int64_t m_baseNs = 0;
+        /// Value the vertex y coordinates are relative to
+        double m_baseValue = 0.0;
+        /// End of the last appended pixel column, 0 before the first sample
+        int64_t m_coveredUntilNs = 0;
+        /// Right edge of the visible window
+        int64_t m_viewEndNs = 0;
+        /// Scratch buffer for the queried buckets
+        std::vector<Core::TelemetryBucket> m_buckets;
+    };
+}
@@ -1,24 +1,58 @@
+#include "AnalysisModel.h"
+#include "TelemetryModel.h"
+#include "TelemetryPlot.h"
+
+#include <CommandUplink.h>
+#include <FlightRecorder.h>
+#include <InputManager.h>
 #include <JsonConfig.h>
 #include <Logger.h>
+#include <Metrics.h>
+#include <ReplaySource.h>
+#include <SignalAnalysis.h>
+#include <TelemetryArchive.h>
+#include <TelemetryIngest.h>
+#include <TelemetryStore.h>
+#include <VehicleDemux.h>
+#include <WorkStealingPool.h>
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <map>
+#include <thread>
 using namespace aerolab::Core;
 
+namespace
+{
+    /// Period at which the derived channels of streams that went quiet are evaluated
+    constexpr std::chrono::milliseconds DERIVED_IDLE_INTERVAL{100};
+
+    /**
+     * @brief Evaluates the pending derived samples of idle streams every DERIVED_IDLE_INTERVAL
+     * @details Re-arms itself until the timer is cancelled or running is cleared, both on the IO thread.
+     */
+    void flushDerivedPeriodically(boost::asio::steady_timer &timer, const bool &running, TelemetryIngest &ingest, const std::unique_ptr<VehicleDemux> &pDemux)
+    {
+        timer.expires_after(DERIVED_IDLE_INTERVAL);
+        timer.async_wait([&timer, &running, &ingest, &pDemux](const boost::system::error_code &ec)
+                         {
+                             if (ec || !running)
+                                 return;
+                             ingest.FlushIdle();
+                             if (pDemux)
+                                 pDemux->FlushIdle();
+                             flushDerivedPeriodically(timer, running, ingest, pDemux); });
+    }
+}
+
 int main(int argc, char *argv[])
 {
     QGuiApplication app(argc, argv);
 
     LOG_INIT("logs.txt");
-
-    QQmlApplicationEngine engine;
-    QObject::connect(
-        &engine,
-        &QQmlApplicationEngine::objectCreationFailed,
-        &app,
-        []()
-        { QCoreApplication::exit(-1); },
-        Qt::QueuedConnection);
-    engine.loadFromModule("Telemetry", "Main");
+    // The receive threads must not wait for the disk or the terminal
+    Logger::GetInstance()->SetAsync(true);
 
     // Config test
     std::string configPath = ".\\config\\config.json";
@@ -29,11 +63,306 @@ int main(int argc, char *argv[])
     try
     {
         config = JsonConfig::GetInstance();
+        // Edits of the config file are picked up while the application is running
+        config->StartWatching();
     }
     catch (...)
     {
         LOG_ERROR("Could not fetch Instance");
     }
 
-    return app.exec();
+    // Telemetry ingest: InputManager -> decoder -> store, on its own IO thread
+    auto pStore = std::make_shared<TelemetryStore>();
+    aerolab::App::TelemetryPlot::SetStore(pStore);
+    // Latest values for the QML pages, the GUI takes one snapshot per frame
+    auto pSnapshot = std::make_shared<TelemetrySnapshotBuffer>();
+    aerolab::App::TelemetryModel::SetSnapshotBuffer(pSnapshot);
+
+    std::string ip = "0.0.0.0";
+    int port = 5005;
+    try
+    {
+        if (config)
+        {
+            ip = config->GetParameter<std::string>("inputManager/ip");
+            port = config->GetParameter<int>("inputManager/port");
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Using default input endpoint: ") + e.what());
+    }
+
+    // Optional export of the pipeline metrics for a Prometheus textfile collector
+    auto pMetrics = MetricsRegistry::GetInstance();
+    try
+    {
+        if (config && config->GetParameter<bool>("metrics/enabled"))
+            pMetrics->StartExport(config->GetParameter<std::string>("metrics/path"),
+                                  std::chrono::milliseconds(config->GetParameter<int>("metrics/intervalMs")));
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Metrics export disabled: ") + e.what());
+    }
+
+    // Optional per-vehicle pipelines for several aircraft on the same port
+    bool perVehicle = false;
+    std::size_t pipelineThreads = 0;
+    try
+    {
+        if (config)
+        {
+            perVehicle = config->GetParameter<bool>("pipelines/perVehicle");
+            pipelineThreads = static_cast<std::size_t>(std::max(config->GetParameter<int>("pipelines/threads"), 0));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Per-vehicle pipelines disabled: ") + e.what());
+    }
+
+    // Optional derived channels, compiled once and shared by all vehicles
+    std::shared_ptr<const DerivedProgram> pDerived;
+    try
+    {
+        if (config && config->GetParameter<bool>("derived/enabled"))
+        {
+            const auto channels = config->GetParameter<std::map<std::string, std::string>>("derived/channels");
+            pDerived = std::make_shared<DerivedProgram>(std::vector<std::pair<std::string, std::string>>(channels.begin(), channels.end()));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Derived channels disabled: ") + e.what());
+    }
+
+    // Optional live statistics and spectra of single channels, e.g. the IMU for tuning the flight controller
+    std::shared_ptr<SignalAnalyzer> pAnalyzer;
+    try
+    {
+        if (config && config->GetParameter<bool>("analysis/enabled"))
+        {
+            AnalysisOptions options;
+            options.window = static_cast<std::size_t>(config->GetParameter<int>("analysis/window"));
+            options.fftSize = static_cast<std::size_t>(config->GetParameter<int>("analysis/fftSize"));
+            options.interval = std::chrono::milliseconds(config->GetParameter<int>("analysis/intervalMs"));
+            pAnalyzer = std::make_shared<SignalAnalyzer>(pStore, options);
+            for (const std::string &channel : config->GetParameter<std::vector<std::string>>("analysis/channels"))
+                pAnalyzer->AddChannel(channel);
+            pAnalyzer->Start();
+        }
+    }
+    catch (const std::exception &e)
+    {
+        pAnalyzer.reset();
+        LOG_WARNING(std::string("Signal analysis disabled: ") + e.what());
+    }
+    aerolab::App::AnalysisModel::SetAnalyzer(pAnalyzer);
+
+    // Optional raw recording of everything received, one file per vehicle with per-vehicle pipelines
+    std::unique_ptr<FlightRecorder> pRecorder;
+    std::string recorderPath;
+    try
+    {
+        if (config && config->GetParameter<bool>("recorder/enabled"))
+        {
+            recorderPath = config->GetParameter<std::string>("recorder/path");
+            if (!perVehicle)
+            {
+                pRecorder = std::make_unique<FlightRecorder>(recorderPath);
+                if (!pRecorder->Start())
+                    pRecorder.reset();
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Recorder disabled: ") + e.what());
+        recorderPath.clear();
+    }
+
+    // Optional replay of a recording instead of the live input
+    std::unique_ptr<ReplaySource> pReplay;
+    try
+    {
+        if (config && config->GetParameter<bool>("replay/enabled"))
+        {
+            pReplay = std::make_unique<ReplaySource>(config->GetParameter<std::string>("replay/path"));
+
+            const double speed = config->GetParameter<double>("replay/speed");
+            if (speed <= 0.0)
+                pReplay->SetMode(E_ReplayMode::AsFastAsPossible);
+            else if (speed == 1.0)
+                pReplay->SetMode(E_ReplayMode::RealTime);
+            else
+                pReplay->SetMode(E_ReplayMode::Scaled, speed);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Replay disabled: ") + e.what());
+        pReplay.reset();
+    }
+
+    boost::asio::io_context ioContext;
+    auto workGuard = boost::asio::make_work_guard(ioContext);
+    TelemetryIngest ingest(pStore);
+    ingest.SetDerivedProgram(pDerived);
+    ingest.SetSnapshotBuffer(pSnapshot);
+    InputManager inputManager(ioContext.get_executor(), ip, port);
+
+    // Optional compressed history of all channels beyond the store rings, saved on shutdown.
+    // It replaces the raw recorder only if that is disabled, the recorder does not compress.
+    std::unique_ptr<TelemetryArchive> pArchive;
+    std::string archivePath;
+    try
+    {
+        if (config && config->GetParameter<bool>("archive/enabled"))
+        {
+            archivePath = config->GetParameter<std::string>("archive/path");
+            if (!recorderPath.empty())
+                LOG_WARNING("Recorder and archive are both enabled, the raw recording is written uncompressed in addition to the archive");
+            pArchive = std::make_unique<TelemetryArchive>(pStore);
+            pArchive->Start(std::chrono::milliseconds(config->GetParameter<int>("archive/intervalMs")));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Archive disabled: ") + e.what());
+        pArchive.reset();
+    }
+
+    // Vehicles share the store, their channels are prefixed with the system ID, e.g. "v1/imu/acc_x".
+    // The snapshot buffer has a single writer, the first vehicle feeds the live values.
+    std::unique_ptr<WorkStealingPool> pPool;
+    std::unique_ptr<VehicleDemux> pDemux;
+    if (perVehicle)
+    {
+        pPool = std::make_unique<WorkStealingPool>(pipelineThreads);
+        pDemux = std::make_unique<VehicleDemux>(*pPool, E_DemuxKey::SystemId, [pStore, recorderPath, pSnapshot, pDerived](const std::string &name) mutable
+                                                {
+                                                    VehicleParts parts{.pStore = pStore, .channelPrefix = name + "/", .pRecorder = nullptr, .pSnapshot = std::move(pSnapshot), .pDerived = pDerived};
+                                                    if (!recorderPath.empty())
+                                                    {
+                                                        const std::size_t extension = recorderPath.find_last_of('.');
+                                                        std::string path = recorderPath;
+                                                        path.insert(extension == std::string::npos ? path.size() : extension, "_" + name);
+
+                                                        parts.pRecorder = std::make_shared<FlightRecorder>(path);
+                                                        if (!parts.pRecorder->Start())
+                                                            parts.pRecorder.reset();
+                                                    }
+                                                    return parts; });
+
+        inputManager.SetCallback([&pDemux](const Datagram &datagram)
+                                 { pDemux->Dispatch(datagram); });
+    }
+    else
+    {
+        inputManager.SetCallback([&ingest, &pRecorder](const Datagram &datagram)
+                                 {
+                                     if (pRecorder)
+                                         pRecorder->Record(datagram);
+                                     ingest.Process(datagram); });
+    }
+
+    // Optional command uplink to the aircraft, shares the IO thread with the input
+    std::unique_ptr<CommandUplink> pUplink;
+    try
+    {
+        if (config && config->GetParameter<bool>("uplink/enabled"))
+        {
+            UplinkOptions uplinkOptions;
+            uplinkOptions.target = boost::asio::ip::udp::endpoint(boost::asio::ip::make_address_v4(config->GetParameter<std::string>("uplink/ip")),
+                                                                  static_cast<unsigned short>(config->GetParameter<int>("uplink/port")));
+            uplinkOptions.heartbeatInterval = std::chrono::milliseconds(config->GetParameter<int>("uplink/heartbeatMs"));
+
+            pUplink = std::make_unique<CommandUplink>(ioContext.get_executor(), uplinkOptions);
+            if (!pUplink->Start())
+                pUplink.reset();
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Uplink disabled: ") + e.what());
+        pUplink.reset();
+    }
+
+    // The ingest has a single writer, so either the replay or the live input feeds it
+    if (pReplay)
+    {
+        pReplay->SetCallback([&ingest, &pDemux](const Datagram &datagram)
+                             {
+                                 if (pDemux)
+                                     pDemux->Dispatch(datagram);
+                                 else
+                                     ingest.Process(datagram); });
+        pReplay->Start();
+    }
+    else
+    {
+        inputManager.Start();
+    }
+
+    // Samples held back for a stream that stopped are evaluated once it stays quiet
+    boost::asio::steady_timer idleTimer(ioContext);
+    bool idleTimerRunning = pDerived != nullptr;
+    if (idleTimerRunning)
+        flushDerivedPeriodically(idleTimer, idleTimerRunning, ingest, pDemux);
+
+    std::thread ioThread([&ioContext]()
+                         { ioContext.run(); });
+
+    QQmlApplicationEngine engine;
+    QObject::connect(
+        &engine,
+        &QQmlApplicationEngine::objectCreationFailed,
+        &app,
+        []()
+        { QCoreApplication::exit(-1); },
+        Qt::QueuedConnection);
+    engine.loadFromModule("Telemetry", "Main");
+
+    const int result = app.exec();
+
+    // Waits for its strand, so it is stopped from here while the IO thread still runs
+    if (pUplink)
+        pUplink->Stop();
+
+    boost::asio::post(ioContext, [&inputManager, &idleTimer, &idleTimerRunning]()
+                      {
+                          inputManager.Stop();
+                          idleTimerRunning = false;
+                          idleTimer.cancel(); });
+    workGuard.reset();
+    ioThread.join();
+
+    if (pReplay)
+        pReplay->Stop();
+
+    // Stops the pipelines before their recorders
+    if (pPool)
+        pPool->Stop();
+    pDemux.reset();
+
+    if (pAnalyzer)
+        pAnalyzer->Stop();
+
+    // The last update archives the samples received until the pipelines stopped
+    if (pArchive)
+    {
+        pArchive->Stop();
+        pArchive->Save(archivePath);
+    }
+
+    if (config)
+        config->StopWatching();
+
+    if (pRecorder)
+        pRecorder->Stop();
+
+    pMetrics->StopExport();
+
+    return result;
 }
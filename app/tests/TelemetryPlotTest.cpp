@@ -0,0 +1,144 @@
+#include "TelemetryPlot.h"
+
+#include <QGuiApplication>
+#include <QImage>
+#include <QQuickWindow>
+#include <QSGRendererInterface>
+#include <QtTest>
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace aerolab::App;
+
+/**
+ * @brief Renders TelemetryPlot items with the software scene graph backend and checks the pixels
+ * @details Runs without display and GPU, the test sets the offscreen platform (see CMakeLists.txt).
+ *          Item 200 x 100 px, 1 s window, so a column is 5 ms and a value of the range [-1, 1] maps to row 50 - 50 * value.
+ */
+class TelemetryPlotTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void laggingChannelIsFilled();
+    void positionKeepsResolution();
+
+private:
+    QImage render(TelemetryPlot &plot);
+    int countColumns(const QImage &image, const QColor &color, int firstX, int lastX, int centerRow) const;
+
+    /// Store of the plots
+    std::shared_ptr<aerolab::Core::TelemetryStore> m_pStore;
+    /// Window of the rendered plots
+    std::unique_ptr<QQuickWindow> m_pWindow;
+};
+
+void TelemetryPlotTest::initTestCase()
+{
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+
+    m_pStore = std::make_shared<aerolab::Core::TelemetryStore>(1 << 14);
+    TelemetryPlot::SetStore(m_pStore);
+
+    m_pWindow = std::make_unique<QQuickWindow>();
+    m_pWindow->resize(200, 100);
+    m_pWindow->setColor(Qt::white);
+    m_pWindow->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_pWindow.get()));
+}
+
+/**
+ * @brief Renders a frame of the plot
+ */
+QImage TelemetryPlotTest::render(TelemetryPlot &plot)
+{
+    plot.update();
+    return m_pWindow->grabWindow();
+}
+
+/**
+ * @brief Counts the pixel columns which contain the color within 5 rows of a row
+ */
+int TelemetryPlotTest::countColumns(const QImage &image, const QColor &color, int firstX, int lastX, int centerRow) const
+{
+    int columns = 0;
+    for (int x = firstX; x <= lastX; x++)
+    {
+        for (int y = std::max(0, centerRow - 5); y <= std::min(image.height() - 1, centerRow + 5); y++)
+        {
+            const QColor pixel = image.pixelColor(x, y);
+            if (std::abs(pixel.red() - color.red()) < 40 && std::abs(pixel.green() - color.green()) < 40 && std::abs(pixel.blue() - color.blue()) < 40)
+            {
+                columns++;
+                break;
+            }
+        }
+    }
+    return columns;
+}
+
+/**
+ * A channel lagging behind the newest channel is plotted once its samples arrive, the columns queried before
+ * are not left empty.
+ */
+void TelemetryPlotTest::laggingChannelIsFilled()
+{
+    auto pLeading = m_pStore->GetOrAddChannel("lag/leading");
+    auto pLagging = m_pStore->GetOrAddChannel("lag/lagging");
+
+    TelemetryPlot plot(m_pWindow->contentItem());
+    plot.setSize(QSizeF(200.0, 100.0));
+    plot.setChannels({"lag/leading", "lag/lagging"});
+    plot.setTimeWindow(1.0);
+    plot.setYMin(-1.0);
+    plot.setYMax(1.0);
+
+    // 1 kHz from 1 s to 3 s, the lagging channel only up to 2.5 s
+    for (int64_t ms = 1000; ms < 3000; ms++)
+    {
+        pLeading->Append(ms * 1000000, -0.5);
+        if (ms < 2500)
+            pLagging->Append(ms * 1000000, 0.5);
+    }
+    render(plot);
+
+    // The rest of the lagging channel arrives with another value
+    for (int64_t ms = 2500; ms < 3000; ms++)
+        pLagging->Append(ms * 1000000, 0.0);
+    const QImage image = render(plot);
+
+    // The window ends at 2.995 s, 2.6 s .. 2.9 s are the pixel columns 121 .. 181
+    const QColor laggingColor("#d62728");
+    QVERIFY2(countColumns(image, laggingColor, 125, 175, 50) > 45, "Columns of the lagging channel were not queried again");
+    QVERIFY(countColumns(image, laggingColor, 125, 175, 25) < 5);
+}
+
+/**
+ * Values of a position channel 6e-7 deg apart are drawn apart, far below the float resolution at 47 deg.
+ */
+void TelemetryPlotTest::positionKeepsResolution()
+{
+    auto pLatitude = m_pStore->GetOrAddChannel("position/latitude");
+
+    TelemetryPlot plot(m_pWindow->contentItem());
+    plot.setSize(QSizeF(200.0, 100.0));
+    plot.setChannels({"position/latitude"});
+    plot.setTimeWindow(1.0);
+    plot.setYMin(47.0);
+    plot.setYMax(47.000001);
+
+    // Step at 2.5 s from 47.0000002 (row 80) to 47.0000008 (row 20)
+    for (int64_t ms = 1000; ms < 3000; ms++)
+        pLatitude->Append(ms * 1000000, ms < 2500 ? 47.0000002 : 47.0000008);
+    const QImage image = render(plot);
+
+    const QColor color("#1f77b4");
+    QVERIFY(countColumns(image, color, 20, 80, 80) > 55);
+    QVERIFY(countColumns(image, color, 120, 180, 20) > 55);
+}
+
+QTEST_MAIN(TelemetryPlotTest)
+
+#include "TelemetryPlotTest.moc"
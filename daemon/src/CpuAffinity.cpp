@@ -0,0 +1,117 @@
+#include "CpuAffinity.h"
+
+#include <Logger.h>
+
+#include <cstdlib>
+#include <sstream>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace aerolab::Daemon
+{
+    /**
+     * @brief Restricts a thread to a single CPU
+     * @details Keeps the cache of the CPU warm and the thread away from the cores of other hot threads.
+     *          Supported on Linux and Windows, other platforms log a warning and keep running unpinned.
+     * @param handle Native handle of the thread, see std::thread::native_handle()
+     * @param cpu Index of the logical CPU
+     * @return True if the thread has been pinned
+     */
+    bool PinThread(std::thread::native_handle_type handle, int cpu)
+    {
+        if (cpu < 0)
+            return false;
+
+#if defined(__linux__)
+        if (cpu >= CPU_SETSIZE)
+        {
+            LOG_ERROR("CPU index out of range: " + std::to_string(cpu));
+            return false;
+        }
+
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        const int result = pthread_setaffinity_np(handle, sizeof(cpus), &cpus);
+        if (result != 0)
+        {
+            LOG_ERROR("Could not pin thread to CPU " + std::to_string(cpu) + ", error " + std::to_string(result));
+            return false;
+        }
+        return true;
+#elif defined(_WIN32)
+        if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8))
+        {
+            LOG_ERROR("CPU index out of range: " + std::to_string(cpu));
+            return false;
+        }
+
+        if (SetThreadAffinityMask(static_cast<HANDLE>(handle), static_cast<DWORD_PTR>(1) << cpu) == 0)
+        {
+            LOG_ERROR("Could not pin thread to CPU " + std::to_string(cpu) + ", error " + std::to_string(GetLastError()));
+            return false;
+        }
+        return true;
+#else
+        (void)handle;
+        LOG_WARNING("CPU pinning is not supported on this platform");
+        return false;
+#endif
+    }
+
+    /**
+     * @brief Restricts the calling thread to a single CPU
+     * @param cpu Index of the logical CPU
+     * @return True if the thread has been pinned
+     */
+    bool PinCurrentThread(int cpu)
+    {
+#if defined(__linux__)
+        return PinThread(pthread_self(), cpu);
+#elif defined(_WIN32)
+        return PinThread(GetCurrentThread(), cpu);
+#else
+        return PinThread({}, cpu);
+#endif
+    }
+
+    /**
+     * @brief Parses a CPU list like "0,2-3"
+     * @param text Comma separated CPU indices and ranges
+     * @return The CPUs in the given order, empty if the list is invalid
+     */
+    std::vector<int> ParseCpuList(const std::string &text)
+    {
+        std::vector<int> cpus;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            if (item.empty())
+                continue;
+
+            char *pEnd = nullptr;
+            const long first = std::strtol(item.c_str(), &pEnd, 10);
+            long last = first;
+            if (*pEnd == '-')
+                last = std::strtol(pEnd + 1, &pEnd, 10);
+
+            if (*pEnd != '\0' || first < 0 || last < first)
+            {
+                LOG_ERROR("Invalid CPU list: " + text);
+                return {};
+            }
+
+            for (long cpu = first; cpu <= last; cpu++)
+                cpus.push_back(static_cast<int>(cpu));
+        }
+        return cpus;
+    }
+}
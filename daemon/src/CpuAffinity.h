@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aerolab::Daemon
+{
+    bool PinThread(std::thread::native_handle_type handle, int cpu);
+    bool PinCurrentThread(int cpu);
+    std::vector<int> ParseCpuList(const std::string &text);
+}
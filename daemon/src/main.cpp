@@ -0,0 +1,382 @@
+#include "CpuAffinity.h"
+
+#include <FlightRecorder.h>
+#include <InputManager.h>
+#include <JsonConfig.h>
+#include <Logger.h>
+#include <Metrics.h>
+#include <TelemetryArchive.h>
+#include <TelemetryIngest.h>
+#include <TelemetryStore.h>
+#include <VehicleDemux.h>
+#include <WorkStealingPool.h>
+
+#include <algorithm>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace aerolab::Core;
+using namespace aerolab::Daemon;
+
+namespace
+{
+    /// Entries per level of every channel, the daemon keeps the history in the recordings and not in memory
+    constexpr std::size_t DAEMON_STORE_CAPACITY = 1 << 10;
+
+    /// Command line settings, override the "daemon" section of the config
+    struct Options
+    {
+        /// Path of the config file
+        std::string configPath = "config/config.json";
+        /// Threads running the IO context, 0 to take the config value
+        int ioThreads = 0;
+        /// CPUs the threads are pinned to, empty to take the config value
+        std::vector<int> cpus;
+    };
+
+    void printUsage()
+    {
+        std::printf(
+            "Usage: telemetryd [options]\n"
+            "Headless ground station ingest, records the telemetry and exports the metrics without a GUI.\n\n"
+            "  --config <path>    config file (default config/config.json)\n"
+            "  --threads <n>      threads running the receive sockets (default daemon/ioThreads)\n"
+            "  --cpus <list>      CPUs the IO threads and then the pipeline workers are pinned to,\n"
+            "                     e.g. \"2,3\" or \"2-5\" (default daemon/cpus, unpinned if empty)\n");
+    }
+
+    std::optional<Options> parseOptions(int argc, char *argv[])
+    {
+        Options options;
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h" || i + 1 >= argc)
+                return std::nullopt;
+
+            const std::string value = argv[++i];
+            if (arg == "--config")
+                options.configPath = value;
+            else if (arg == "--threads")
+            {
+                options.ioThreads = std::atoi(value.c_str());
+                if (options.ioThreads <= 0)
+                    return std::nullopt;
+            }
+            else if (arg == "--cpus")
+            {
+                options.cpus = ParseCpuList(value);
+                if (options.cpus.empty())
+                    return std::nullopt;
+            }
+            else
+                return std::nullopt;
+        }
+        return options;
+    }
+
+    /// @brief Inserts "_<name>" in front of the extension of the path, e.g. "flight_v1.rec"
+    std::string vehicleRecordingPath(const std::string &path, const std::string &name)
+    {
+        const std::size_t extension = path.find_last_of('.');
+        std::string result = path;
+        result.insert(extension == std::string::npos ? result.size() : extension, "_" + name);
+        return result;
+    }
+
+    /// Period at which the derived channels of streams that went quiet are evaluated
+    constexpr std::chrono::milliseconds DERIVED_IDLE_INTERVAL{100};
+
+    /**
+     * @brief Evaluates the pending derived samples of idle streams every DERIVED_IDLE_INTERVAL
+     * @details Re-arms itself until the timer is cancelled or running is cleared, both on the timer's strand.
+     */
+    void flushDerivedPeriodically(boost::asio::steady_timer &timer, const bool &running, TelemetryIngest &ingest, const std::unique_ptr<VehicleDemux> &pDemux)
+    {
+        timer.expires_after(DERIVED_IDLE_INTERVAL);
+        timer.async_wait([&timer, &running, &ingest, &pDemux](const boost::system::error_code &ec)
+                         {
+                             if (ec || !running)
+                                 return;
+                             ingest.FlushIdle();
+                             if (pDemux)
+                                 pDemux->FlushIdle();
+                             flushDerivedPeriodically(timer, running, ingest, pDemux); });
+    }
+}
+
+/**
+ * @brief Headless telemetry daemon
+ * @details Runs the ingest pipeline of the ground station without Qt: InputManager -> (VehicleDemux) -> ingest,
+ *          optionally recorded by the FlightRecorder. The sockets are received on a multi-threaded IO context,
+ *          with per-vehicle pipelines every IO thread owns its own SO_REUSEPORT shard. The threads can be pinned
+ *          to dedicated CPUs so the hot path keeps its caches.
+ *          A GUI attaches through the local artifacts: the recordings are opened with the replay, the metrics file
+ *          is read by the stats panel or a Prometheus textfile collector.
+ *          Stops on SIGINT and SIGTERM.
+ */
+int main(int argc, char *argv[])
+{
+    const auto startTime = std::chrono::steady_clock::now();
+
+    auto parsed = parseOptions(argc, argv);
+    if (!parsed)
+    {
+        printUsage();
+        return 1;
+    }
+    Options &options = *parsed;
+
+    LOG_INIT("telemetryd.txt");
+    Logger::GetInstance()->SetConsoleOutput(false);
+    // The receive threads must not wait for the disk or the terminal
+    Logger::GetInstance()->SetAsync(true);
+
+    std::shared_ptr<JsonConfig> config = nullptr;
+    try
+    {
+        JsonConfig::Init(options.configPath);
+        config = JsonConfig::GetInstance();
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR(std::string("Could not load config, using defaults: ") + e.what());
+    }
+
+    std::string ip = "0.0.0.0";
+    int port = 5005;
+    try
+    {
+        if (config)
+        {
+            ip = config->GetParameter<std::string>("inputManager/ip");
+            port = config->GetParameter<int>("inputManager/port");
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Using default input endpoint: ") + e.what());
+    }
+
+    // Threads and CPUs of the daemon, the command line wins over the config
+    try
+    {
+        if (config && options.ioThreads <= 0)
+            options.ioThreads = config->GetParameter<int>("daemon/ioThreads");
+        if (config && options.cpus.empty())
+            options.cpus = config->GetParameter<std::vector<int>>("daemon/cpus");
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Using default daemon threads: ") + e.what());
+    }
+    const std::size_t ioThreadCount = static_cast<std::size_t>(std::max(options.ioThreads, 1));
+
+    auto pMetrics = MetricsRegistry::GetInstance();
+    try
+    {
+        if (config && config->GetParameter<bool>("metrics/enabled"))
+            pMetrics->StartExport(config->GetParameter<std::string>("metrics/path"),
+                                  std::chrono::milliseconds(config->GetParameter<int>("metrics/intervalMs")));
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Metrics export disabled: ") + e.what());
+    }
+
+    bool perVehicle = false;
+    std::size_t pipelineThreads = 0;
+    try
+    {
+        if (config)
+        {
+            perVehicle = config->GetParameter<bool>("pipelines/perVehicle");
+            pipelineThreads = static_cast<std::size_t>(std::max(config->GetParameter<int>("pipelines/threads"), 0));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Per-vehicle pipelines disabled: ") + e.what());
+    }
+
+    // Optional derived channels, compiled once and shared by all vehicles
+    std::shared_ptr<const DerivedProgram> pDerived;
+    try
+    {
+        if (config && config->GetParameter<bool>("derived/enabled"))
+        {
+            const auto channels = config->GetParameter<std::map<std::string, std::string>>("derived/channels");
+            pDerived = std::make_shared<DerivedProgram>(std::vector<std::pair<std::string, std::string>>(channels.begin(), channels.end()));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Derived channels disabled: ") + e.what());
+    }
+
+    std::unique_ptr<FlightRecorder> pRecorder;
+    std::string recorderPath;
+    try
+    {
+        if (config && config->GetParameter<bool>("recorder/enabled"))
+        {
+            recorderPath = config->GetParameter<std::string>("recorder/path");
+            if (!perVehicle)
+            {
+                pRecorder = std::make_unique<FlightRecorder>(recorderPath);
+                if (!pRecorder->Start())
+                    pRecorder.reset();
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Recorder disabled: ") + e.what());
+        recorderPath.clear();
+    }
+
+    boost::asio::io_context ioContext(static_cast<int>(ioThreadCount));
+    auto workGuard = boost::asio::make_work_guard(ioContext);
+    // Nothing plots the store, a short history keeps the channel allocation out of the startup time
+    auto pStore = std::make_shared<TelemetryStore>(DAEMON_STORE_CAPACITY);
+    TelemetryIngest ingest(pStore);
+    ingest.SetDerivedProgram(pDerived);
+    InputManager inputManager(ioContext.get_executor(), ip, port);
+    inputManager.SetBatchReceive(64);
+
+    // Optional compressed history of all channels, saved on shutdown. The short store rings hold about a second
+    // of the fastest channels, the update interval has to stay well below.
+    // It replaces the raw recorder only if that is disabled, the recorder does not compress.
+    std::unique_ptr<TelemetryArchive> pArchive;
+    std::string archivePath;
+    try
+    {
+        if (config && config->GetParameter<bool>("archive/enabled"))
+        {
+            archivePath = config->GetParameter<std::string>("archive/path");
+            if (!recorderPath.empty())
+                LOG_WARNING("Recorder and archive are both enabled, the raw recording is written uncompressed in addition to the archive");
+            pArchive = std::make_unique<TelemetryArchive>(pStore);
+            pArchive->Start(std::chrono::milliseconds(config->GetParameter<int>("archive/intervalMs")));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_WARNING(std::string("Archive disabled: ") + e.what());
+        pArchive.reset();
+    }
+    inputManager.SetReceiveBufferSize(8 << 20);
+
+    std::unique_ptr<WorkStealingPool> pPool;
+    std::unique_ptr<VehicleDemux> pDemux;
+    if (perVehicle)
+    {
+        // The demux takes datagrams from all shards at once, the vehicles are processed on the pool
+        inputManager.SetShardCount(ioThreadCount);
+        pPool = std::make_unique<WorkStealingPool>(pipelineThreads);
+        pDemux = std::make_unique<VehicleDemux>(*pPool, E_DemuxKey::SystemId, [pStore, recorderPath, pDerived](const std::string &name)
+                                                {
+                                                    VehicleParts parts{.pStore = pStore, .channelPrefix = name + "/", .pRecorder = nullptr, .pSnapshot = nullptr, .pDerived = pDerived};
+                                                    if (!recorderPath.empty())
+                                                    {
+                                                        parts.pRecorder = std::make_shared<FlightRecorder>(vehicleRecordingPath(recorderPath, name));
+                                                        if (!parts.pRecorder->Start())
+                                                            parts.pRecorder.reset();
+                                                    }
+                                                    return parts; });
+
+        inputManager.SetCallback([&pDemux](const Datagram &datagram)
+                                 { pDemux->Dispatch(datagram); });
+    }
+    else
+    {
+        // The ingest has a single writer, a single shard keeps it that way on any number of IO threads
+        inputManager.SetCallback([&ingest, &pRecorder](const Datagram &datagram)
+                                 {
+                                     if (pRecorder)
+                                         pRecorder->Record(datagram);
+                                     ingest.Process(datagram); });
+    }
+
+    // Samples held back for a stream that stopped are evaluated once it stays quiet
+    boost::asio::steady_timer idleTimer(boost::asio::make_strand(ioContext));
+    bool idleTimerRunning = pDerived != nullptr;
+    if (idleTimerRunning)
+        flushDerivedPeriodically(idleTimer, idleTimerRunning, ingest, pDemux);
+
+    boost::asio::signal_set signals(ioContext, SIGINT, SIGTERM);
+    signals.async_wait([&inputManager, &workGuard, &idleTimer, &idleTimerRunning](const boost::system::error_code &ec, int signal)
+                       {
+                           if (ec)
+                               return;
+                           LOG_INFO("Stopping on signal " + std::to_string(signal));
+                           inputManager.Stop();
+                           boost::asio::post(idleTimer.get_executor(), [&idleTimer, &idleTimerRunning]()
+                                             {
+                                                 idleTimerRunning = false;
+                                                 idleTimer.cancel(); });
+                           workGuard.reset(); });
+
+    inputManager.Start();
+
+    // The IO threads take the first CPUs of the list, the pipeline workers the following ones
+    std::vector<std::thread> ioThreads;
+    for (std::size_t i = 0; i < ioThreadCount; i++)
+    {
+        ioThreads.emplace_back([&ioContext]()
+                               { ioContext.run(); });
+        if (i < options.cpus.size())
+            PinThread(ioThreads.back().native_handle(), options.cpus[i]);
+    }
+    if (pPool)
+    {
+        for (std::size_t i = 0; i < pPool->ThreadCount() && ioThreadCount + i < options.cpus.size(); i++)
+            PinThread(pPool->NativeHandle(i), options.cpus[ioThreadCount + i]);
+    }
+
+    const auto startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    LOG_INFO_F("telemetryd listening on {}:{} with {} IO threads{}, started in {} ms", ip, port, ioThreadCount,
+               perVehicle ? " and per-vehicle pipelines" : "", startupMs);
+
+    for (auto &thread : ioThreads)
+        thread.join();
+
+    // Stops the pipelines before their recorders
+    if (pPool)
+        pPool->Stop();
+
+    uint64_t decoded = ingest.DecodedFrames();
+    uint64_t invalid = ingest.InvalidDatagrams();
+    if (pDemux)
+    {
+        for (const auto &pVehicle : pDemux->Vehicles())
+        {
+            decoded += pVehicle->DecodedFrames();
+            invalid += pVehicle->InvalidDatagrams();
+        }
+    }
+    LOG_INFO_F("telemetryd stopped, decoded {} frames, {} invalid datagrams", decoded, invalid);
+
+    pDemux.reset();
+
+    // The last update archives the samples received until the pipelines stopped
+    if (pArchive)
+    {
+        pArchive->Stop();
+        pArchive->Save(archivePath);
+    }
+
+    if (pRecorder)
+        pRecorder->Stop();
+
+    pMetrics->StopExport();
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "Bench.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new and delete of the benchmark executable to count the heap allocations
+
+namespace
+{
+    /// Number of allocations since startup
+    std::atomic<uint64_t> s_allocations{0};
+
+    void *allocate(std::size_t size)
+    {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+        if (void *p = std::malloc(size > 0 ? size : 1))
+            return p;
+        throw std::bad_alloc();
+    }
+
+    void *allocateAligned(std::size_t size, std::align_val_t alignment)
+    {
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+        const auto align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+        if (void *p = _aligned_malloc(size > 0 ? size : 1, align))
+            return p;
+#else
+        // aligned_alloc requires the size to be a multiple of the alignment
+        if (void *p = std::aligned_alloc(align, (size + align - 1) / align * align))
+            return p;
+#endif
+        throw std::bad_alloc();
+    }
+
+    void freeAligned(void *p)
+    {
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+}
+
+/**
+ * @brief Number of heap allocations of all threads since startup
+ */
+uint64_t aerolab::Bench::AllocationCount()
+{
+    return s_allocations.load(std::memory_order_relaxed);
+}
+
+void *operator new(std::size_t size) { return allocate(size); }
+void *operator new[](std::size_t size) { return allocate(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return allocateAligned(size, alignment); }
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return allocate(size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept { return operator new(size, tag); }
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { freeAligned(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { freeAligned(p); }
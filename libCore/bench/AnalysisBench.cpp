@@ -0,0 +1,218 @@
+#include "Bench.h"
+
+#include <SignalAnalysis.h>
+
+#include <cmath>
+#include <cstdio>
+#include <numbers>
+#include <random>
+
+using namespace aerolab::Bench;
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Length of the transforms
+    constexpr std::size_t FFT_SIZE = 1024;
+    /// Blocks summarized per run
+    constexpr int BLOCKS = 200000;
+    /// Spectra computed per run
+    constexpr int SPECTRA = 20000;
+    /// Sample rate of the analyzed channels in Hz
+    constexpr int SAMPLE_RATE = 1000;
+    /// Updates of the analyzer per second
+    constexpr int UPDATE_RATE = 10;
+    /// Seconds of telemetry analyzed per run
+    constexpr int SECONDS = 60;
+
+    /// @brief Vibration at 87 Hz and 190 Hz on top of gravity and noise, like the accelerometer of a multicopter
+    std::vector<TelemetrySample> vibration(std::size_t count, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::normal_distribution<float> noise(0.0f, 0.05f);
+        std::vector<TelemetrySample> samples(count);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const double t = static_cast<double>(i) / SAMPLE_RATE;
+            const double value = 9.81 + 0.8 * std::sin(2.0 * std::numbers::pi * 87.0 * t) + 0.3 * std::sin(2.0 * std::numbers::pi * 190.0 * t);
+            samples[i] = TelemetrySample{static_cast<int64_t>(i) * (1000000000 / SAMPLE_RATE), static_cast<float>(value) + noise(random)};
+        }
+        return samples;
+    }
+
+    /// @brief Formats small deviations, std::to_string() rounds them to zero
+    std::string scientific(double value)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.2e", value);
+        return buffer;
+    }
+
+    /// @brief The kernel sets of the build and the CPU, scalar first
+    std::vector<const SignalKernels *> kernelSets()
+    {
+        std::vector<const SignalKernels *> result;
+        for (E_SimdLevel level : {E_SimdLevel::Scalar, E_SimdLevel::Sse2, E_SimdLevel::Avx2})
+        {
+            if (const SignalKernels *pKernels = SignalKernelsFor(level))
+                result.push_back(pKernels);
+        }
+        return result;
+    }
+
+    /// @brief Summarizes blocks of RollingStats::BLOCK_SIZE samples, reports the deviation of the sum from the scalar set
+    BenchResult blockStats(const SignalKernels &kernels, const std::vector<float> &values, double referenceSum)
+    {
+        const std::size_t blockCount = values.size() / RollingStats::BLOCK_SIZE;
+        BlockStats stats;
+        double sum = 0.0;
+        BenchResult result;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BLOCKS; i++)
+        {
+            const float *pBlock = values.data() + (static_cast<std::size_t>(i) % blockCount) * RollingStats::BLOCK_SIZE;
+            kernels.blockStats(pBlock, RollingStats::BLOCK_SIZE, stats);
+            sum += stats.sum;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        result.benchmark = "AnalysisKernels";
+        result.variant = std::string("block stats, ") + kernels.name;
+        result.opsPerSecond = static_cast<double>(BLOCKS) * RollingStats::BLOCK_SIZE / seconds;
+        result.note = "relative deviation of the sums " + scientific(std::abs(sum - referenceSum) / std::abs(referenceSum));
+        return result;
+    }
+
+    /// @brief Computes spectra, reports the largest deviation of a bin from the scalar set relative to the peak
+    BenchResult spectrum(const SignalKernels &kernels, const std::vector<TelemetrySample> &samples, SpectrumResult &out,
+                         const SpectrumResult *pReference)
+    {
+        Spectrum spectrum(FFT_SIZE, kernels);
+        spectrum.Append(samples);
+        BenchResult result;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < SPECTRA; i++)
+        {
+            const auto computeStart = std::chrono::steady_clock::now();
+            spectrum.Compute(1.0f, out);
+            result.latency.Record(ElapsedNs(computeStart, std::chrono::steady_clock::now()));
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        float deviation = 0.0f;
+        if (pReference)
+        {
+            for (std::size_t i = 0; i < out.psd.size(); i++)
+                deviation = std::max(deviation, std::abs(out.psd[i] - pReference->psd[i]));
+            deviation /= pReference->peakDensity;
+        }
+
+        result.benchmark = "AnalysisKernels";
+        result.variant = std::to_string(FFT_SIZE) + " point PSD, " + kernels.name;
+        result.opsPerSecond = static_cast<double>(SPECTRA) / seconds;
+        result.note = "peak " + std::to_string(out.peakFrequency) + " Hz, largest bin deviation " + scientific(deviation) + " of the peak";
+        return result;
+    }
+
+    /**
+     * @brief Analyzes 1 kHz channels with UPDATE_RATE updates per second
+     * @details The samples are appended to the store between the updates like the ingest would, only the updates
+     *          are timed. The note gives the share of a core the analysis takes.
+     */
+    BenchResult analyzer(std::size_t channelCount)
+    {
+        auto pStore = std::make_shared<TelemetryStore>(FFT_SIZE * 4);
+        SignalAnalyzer analyzer(pStore);
+
+        std::vector<std::shared_ptr<TelemetryChannel>> channels;
+        std::vector<std::vector<TelemetrySample>> samples;
+        for (std::size_t i = 0; i < channelCount; i++)
+        {
+            const std::string name = "imu/channel" + std::to_string(i);
+            analyzer.AddChannel(name);
+            channels.push_back(pStore->GetChannel(name));
+            samples.push_back(vibration(SAMPLE_RATE * SECONDS, static_cast<uint32_t>(i)));
+        }
+
+        constexpr std::size_t SAMPLES_PER_UPDATE = SAMPLE_RATE / UPDATE_RATE;
+        constexpr int UPDATES = SECONDS * UPDATE_RATE;
+        BenchResult result;
+        uint64_t busyNs = 0;
+
+        for (int update = 0; update < UPDATES; update++)
+        {
+            for (std::size_t i = 0; i < channelCount; i++)
+            {
+                for (std::size_t j = 0; j < SAMPLES_PER_UPDATE; j++)
+                {
+                    const TelemetrySample &sample = samples[i][update * SAMPLES_PER_UPDATE + j];
+                    channels[i]->Append(sample.timestampNs, sample.value);
+                }
+            }
+
+            const auto start = std::chrono::steady_clock::now();
+            analyzer.Update();
+            const uint64_t elapsed = ElapsedNs(start, std::chrono::steady_clock::now());
+            result.latency.Record(elapsed);
+            busyNs += elapsed;
+        }
+
+        AnalysisResult analysis;
+        analyzer.GetResult("imu/channel0", analysis);
+
+        result.benchmark = "AnalysisUpdate";
+        result.variant = std::to_string(channelCount) + " channels at 1 kHz, " + std::to_string(UPDATE_RATE) + " Hz updates, " +
+                         analyzer.Kernels().name;
+        result.opsPerSecond = static_cast<double>(UPDATES) * 1e9 / static_cast<double>(busyNs);
+        result.note = std::to_string(static_cast<double>(busyNs) / 1e7 / SECONDS) + " % of a core, rms " +
+                      std::to_string(analysis.stats.rms) + ", peak " + std::to_string(analysis.spectrum.peakFrequency) + " Hz";
+        return result;
+    }
+}
+
+/**
+ * Kernel sets against the scalar reference: block statistics of the rolling windows and the power spectral density
+ * of a 1024 sample window (mean removal, Hann window, FFT, power). The deviations show the float rounding of the
+ * reordered operations.
+ */
+CORE_BENCH(AnalysisKernels)
+{
+    const std::vector<TelemetrySample> samples = vibration(FFT_SIZE * 16, 1);
+    std::vector<float> values;
+    for (const TelemetrySample &sample : samples)
+        values.push_back(sample.value);
+
+    const std::size_t blockCount = values.size() / RollingStats::BLOCK_SIZE;
+    double referenceSum = 0.0;
+    BlockStats stats;
+    for (int i = 0; i < BLOCKS; i++)
+    {
+        ScalarSignalKernels().blockStats(values.data() + (static_cast<std::size_t>(i) % blockCount) * RollingStats::BLOCK_SIZE,
+                                         RollingStats::BLOCK_SIZE, stats);
+        referenceSum += stats.sum;
+    }
+
+    SpectrumResult reference;
+    for (const SignalKernels *pKernels : kernelSets())
+    {
+        Report(blockStats(*pKernels, values, referenceSum));
+
+        SpectrumResult result;
+        Report(spectrum(*pKernels, samples, result, pKernels->level == E_SimdLevel::Scalar ? nullptr : &reference));
+        if (pKernels->level == E_SimdLevel::Scalar)
+            reference = std::move(result);
+    }
+}
+
+/**
+ * The analysis of live IMU channels: rolling statistics over 1024 samples and a 1024 point spectrum per channel
+ * and update, with the kernels selected for the CPU.
+ */
+CORE_BENCH(AnalysisUpdate)
+{
+    Report(analyzer(1));
+    Report(analyzer(6));
+    Report(analyzer(24));
+}
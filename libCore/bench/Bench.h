@@ -0,0 +1,81 @@
+#pragma once
+
+#include <LatencyHistogram.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace aerolab::Bench
+{
+    /// Result of a single benchmark variant
+    struct BenchResult
+    {
+        /// Name of the benchmark
+        std::string benchmark;
+        /// Name of the variant, e.g. the configuration
+        std::string variant;
+        /// Operations per second
+        double opsPerSecond = 0.0;
+        /// Latency of a single operation in nanoseconds
+        Core::LatencyHistogram latency;
+        /// Heap allocations per operation, negative if not measured
+        double allocationsPerOp = -1.0;
+        /// Additional remark, e.g. dropped messages
+        std::string note;
+        /// Failed self-check of the run, e.g. a broken round trip, empty if the run is valid
+        std::string failure;
+    };
+
+    /// A registered benchmark
+    struct Benchmark
+    {
+        std::string name;
+        std::function<void()> function;
+    };
+
+    std::vector<Benchmark> &Benchmarks();
+    void Report(const BenchResult &result);
+
+    uint64_t AllocationCount();
+
+    /**
+     * @brief Counts the heap allocations of all threads since construction
+     * @note Allocations inside the core library are only counted where the library shares the
+     *       operator new of the executable, i.e. not for the Windows DLL.
+     */
+    class AllocationScope
+    {
+    public:
+        AllocationScope() : m_start(AllocationCount()) {}
+
+        /// @brief Allocations since construction divided by the number of operations
+        double PerOp(uint64_t operations) const
+        {
+            return operations > 0 ? static_cast<double>(AllocationCount() - m_start) / static_cast<double>(operations) : 0.0;
+        }
+
+    private:
+        /// Allocation count on construction
+        uint64_t m_start;
+    };
+
+    /// Registers a benchmark function on startup
+    struct BenchRegistrar
+    {
+        BenchRegistrar(const std::string &name, std::function<void()> function) { Benchmarks().push_back({name, std::move(function)}); }
+    };
+
+    /// @brief Nanoseconds between two time points
+    inline uint64_t ElapsedNs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+}
+
+/// Defines and registers a benchmark, the name is used to select benchmarks on the command line
+#define CORE_BENCH(name)                                                                              \
+    static void name();                                                                               \
+    [[maybe_unused]] static const ::aerolab::Bench::BenchRegistrar s_##name##Registrar(#name, &name); \
+    static void name()
@@ -0,0 +1,132 @@
+#include "Bench.h"
+
+#include <Logger.h>
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+using namespace aerolab::Bench;
+
+namespace
+{
+    /// Results of the run, written as json at the end
+    std::vector<BenchResult> s_results;
+    /// Number of results whose self-check failed
+    int s_failures = 0;
+
+    /**
+     * @brief Writes the results as json
+     * @details One object per result, latencies in nanoseconds. Meant to be compared between releases.
+     * @param path Output file, "-" for stdout
+     * @return True on success
+     */
+    bool writeJson(const std::string &path)
+    {
+        nlohmann::json results = nlohmann::json::array();
+        for (const auto &result : s_results)
+        {
+            nlohmann::json entry = {
+                {"benchmark", result.benchmark},
+                {"variant", result.variant},
+                {"opsPerSecond", result.opsPerSecond},
+                {"latencyNs", {{"mean", result.latency.Mean()}, {"p50", result.latency.Percentile(50.0)}, {"p99", result.latency.Percentile(99.0)}, {"p99.9", result.latency.Percentile(99.9)}, {"max", result.latency.Max()}}},
+                {"note", result.note}};
+            if (result.allocationsPerOp >= 0.0)
+                entry["allocationsPerOp"] = result.allocationsPerOp;
+            if (!result.failure.empty())
+                entry["failure"] = result.failure;
+            results.push_back(std::move(entry));
+        }
+
+        const std::string content = nlohmann::json{{"results", std::move(results)}}.dump(4);
+        if (path == "-")
+        {
+            std::printf("%s\n", content.c_str());
+            return true;
+        }
+
+        std::ofstream file(path);
+        file << content << '\n';
+        return static_cast<bool>(file);
+    }
+}
+
+/**
+ * @brief All registered benchmarks
+ */
+std::vector<Benchmark> &aerolab::Bench::Benchmarks()
+{
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+/**
+ * @brief Prints a result line
+ * @details A failed self-check is printed on its own line and makes core_bench exit with 1.
+ * @param result The measured result
+ */
+void aerolab::Bench::Report(const BenchResult &result)
+{
+    char allocations[32] = "";
+    if (result.allocationsPerOp >= 0.0)
+        std::snprintf(allocations, sizeof(allocations), "%7.2f allocs/op", result.allocationsPerOp);
+
+    std::fprintf(stderr, "%-16s %-28s %14.0f ops/s  p50 %9.3f us  p99 %9.3f us  p99.9 %9.3f us  %s  %s\n",
+                 result.benchmark.c_str(), result.variant.c_str(), result.opsPerSecond,
+                 static_cast<double>(result.latency.Percentile(50.0)) / 1000.0,
+                 static_cast<double>(result.latency.Percentile(99.0)) / 1000.0,
+                 static_cast<double>(result.latency.Percentile(99.9)) / 1000.0,
+                 allocations, result.note.c_str());
+
+    if (!result.failure.empty())
+    {
+        std::fprintf(stderr, "%-16s %-28s FAILED: %s\n", result.benchmark.c_str(), result.variant.c_str(), result.failure.c_str());
+        s_failures++;
+    }
+
+    s_results.push_back(result);
+}
+
+/**
+ * @brief Runs all benchmarks whose name contains one of the filter arguments, all if there is none
+ * @details Usage: core_bench [--json <file>|-] [filter...]
+ *          The human readable results go to stderr, so "--json -" can be piped.
+ * @return 1 if a benchmark failed its self-check or the json could not be written, 0 otherwise
+ */
+int main(int argc, char *argv[])
+{
+    LOG_INIT("core_bench.txt");
+    aerolab::Core::Logger::GetInstance()->SetConsoleOutput(false);
+    // Production level, the debug output of the receive path would dominate the measured allocations
+    aerolab::Core::Logger::GetInstance()->SetLogLevel(aerolab::Core::E_LogLevel::Info);
+
+    std::string jsonPath;
+    std::vector<std::string> filters;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonPath = argv[++i];
+        else
+            filters.emplace_back(argv[i]);
+    }
+
+    for (const auto &benchmark : Benchmarks())
+    {
+        bool selected = filters.empty();
+        for (const auto &filter : filters)
+            selected |= benchmark.name.find(filter) != std::string::npos;
+
+        if (selected)
+            benchmark.function();
+    }
+
+    if (!jsonPath.empty() && !writeJson(jsonPath))
+    {
+        std::fprintf(stderr, "Could not write %s\n", jsonPath.c_str());
+        return 1;
+    }
+
+    return s_failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+#include "Bench.h"
+
+#include <RecordingFormat.h>
+#include <TelemetryCodec.h>
+#include <TelemetryFrames.h>
+
+#include <cmath>
+#include <random>
+
+using namespace aerolab::Bench;
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Seconds of telemetry per data set
+    constexpr int SECONDS = 600;
+    /// Bytes of a sample without padding, timestamp and value
+    constexpr double RAW_SAMPLE_BYTES = sizeof(int64_t) + sizeof(float);
+    /// Decoding runs per data set
+    constexpr int DECODE_RUNS = 5;
+
+    /// @brief Timestamps at a fixed rate, optionally with the jitter of the receive clock
+    std::vector<int64_t> timestamps(int rate, double jitterNs, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::normal_distribution<double> jitter(0.0, jitterNs);
+        const int64_t intervalNs = 1000000000 / rate;
+        std::vector<int64_t> result(static_cast<std::size_t>(rate) * SECONDS);
+        int64_t previous = 0;
+        for (std::size_t i = 0; i < result.size(); i++)
+        {
+            const int64_t timestamp = 1700000000000000000 + static_cast<int64_t>(i) * intervalNs + static_cast<int64_t>(jitterNs > 0.0 ? jitter(random) : 0.0);
+            previous = result[i] = std::max(timestamp, previous);
+        }
+        return result;
+    }
+
+    /// @brief Sensor value quantized like the integer fields of the frames, see FrameView::Get()
+    double quantize(double value, double scale)
+    {
+        return static_cast<double>(std::lround(value / scale)) * scale;
+    }
+
+    /// The channels of a frame
+    struct DataSet
+    {
+        std::string name;
+        std::vector<int64_t> timestamps;
+        std::vector<std::vector<double>> columns;
+        std::vector<double> scales;
+        /// Size of a datagram in the raw recording
+        std::size_t recordBytes;
+    };
+
+    /// @brief IMU frames with vibration and noise
+    template <typename Frame>
+    DataSet imu(const std::string &name, double jitterNs, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::normal_distribution<double> noise(0.0, 1.0);
+        DataSet dataSet{name, timestamps(1000, jitterNs, seed), std::vector<std::vector<double>>(7),
+                        {Frames::Imu::ACC_X.scale, Frames::Imu::ACC_Y.scale, Frames::Imu::ACC_Z.scale, Frames::Imu::GYRO_X.scale,
+                         Frames::Imu::GYRO_Y.scale, Frames::Imu::GYRO_Z.scale, Frames::Imu::TEMPERATURE.scale},
+                        RecordingRecordSize(FRAME_OVERHEAD + FramePayloadSize<Frame>())};
+        for (std::size_t i = 0; i < dataSet.timestamps.size(); i++)
+        {
+            const double t = static_cast<double>(i) * 0.001;
+            const double vibration = 0.2 * std::sin(t * 2.0 * 3.14159 * 87.0);
+            const double values[] = {0.1 * std::sin(t) + vibration + 0.03 * noise(random), 0.1 * std::cos(t) + vibration + 0.03 * noise(random),
+                                     9.81 + vibration + 0.03 * noise(random), 0.05 * std::sin(t * 0.7) + 0.01 * noise(random),
+                                     0.05 * std::cos(t * 0.5) + 0.01 * noise(random), 0.02 * std::sin(t * 0.3) + 0.01 * noise(random), 35.0 + t / 60.0};
+            for (std::size_t c = 0; c < dataSet.columns.size(); c++)
+                dataSet.columns[c].push_back(quantize(values[c], dataSet.scales[c]));
+        }
+        return dataSet;
+    }
+
+    /// @brief Frames of typical shapes, see the names
+    std::vector<DataSet> dataSets()
+    {
+        std::vector<DataSet> result;
+        result.push_back(imu<Frames::Imu>("imu 1 kHz, sender clock", 0.0, 1));
+        result.push_back(imu<Frames::Imu>("imu 1 kHz, receive clock", 20000.0, 2));
+
+        DataSet battery{"battery 50 Hz", timestamps(50, 20000.0, 3), std::vector<std::vector<double>>(3),
+                        {Frames::Battery::VOLTAGE.scale, Frames::Battery::CURRENT.scale, Frames::Battery::REMAINING.scale},
+                        RecordingRecordSize(FRAME_OVERHEAD + FramePayloadSize<Frames::Battery>())};
+        std::mt19937 random(4);
+        std::normal_distribution<double> noise(0.0, 1.0);
+        for (std::size_t i = 0; i < battery.timestamps.size(); i++)
+        {
+            const double progress = static_cast<double>(i) / static_cast<double>(battery.timestamps.size());
+            battery.columns[0].push_back(quantize(16.8 - 2.0 * progress + 0.005 * noise(random), battery.scales[0]));
+            battery.columns[1].push_back(quantize(12.0 + 0.5 * noise(random), battery.scales[1]));
+            battery.columns[2].push_back(quantize(100.0 - 80.0 * progress, battery.scales[2]));
+        }
+        result.push_back(std::move(battery));
+
+        DataSet attitude{"attitude 250 Hz, float", timestamps(250, 20000.0, 5), std::vector<std::vector<double>>(6),
+                         std::vector<double>(6, 0.0), RecordingRecordSize(FRAME_OVERHEAD + FramePayloadSize<Frames::Attitude>())};
+        for (std::size_t i = 0; i < attitude.timestamps.size(); i++)
+        {
+            const double t = static_cast<double>(i) * 0.004;
+            for (std::size_t c = 0; c < attitude.columns.size(); c++)
+                attitude.columns[c].push_back(static_cast<float>(0.4 * std::sin(t * (0.2 + 0.1 * static_cast<double>(c))) + 0.001 * noise(random)));
+        }
+        result.push_back(std::move(attitude));
+        return result;
+    }
+
+    /// @brief Compresses a data set and decodes it again, checks the round trip
+    BenchResult codec(const DataSet &dataSet)
+    {
+        BenchResult result;
+        result.benchmark = "TelemetryCodec";
+        result.variant = dataSet.name;
+
+        CompressedSeries series(dataSet.scales);
+        std::vector<std::span<const double>> columns(dataSet.columns.begin(), dataSet.columns.end());
+        const auto encodeStart = std::chrono::steady_clock::now();
+        series.Append(dataSet.timestamps, columns);
+        const double encodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - encodeStart).count();
+
+        bool identical = true;
+        std::vector<TelemetrySample> decoded;
+        decoded.reserve(dataSet.timestamps.size());
+        const auto decodeStart = std::chrono::steady_clock::now();
+        for (int run = 0; run < DECODE_RUNS; run++)
+        {
+            for (std::size_t c = 0; c < dataSet.columns.size(); c++)
+            {
+                const auto start = std::chrono::steady_clock::now();
+                series.ReadRaw(c, dataSet.timestamps.front(), dataSet.timestamps.back(), decoded);
+                result.latency.Record(ElapsedNs(start, std::chrono::steady_clock::now()));
+
+                identical = identical && decoded.size() == dataSet.timestamps.size();
+                for (std::size_t i = 0; identical && i < decoded.size(); i++)
+                    identical = decoded[i].timestampNs == dataSet.timestamps[i] &&
+                                std::bit_cast<uint64_t>(static_cast<double>(decoded[i].value)) == std::bit_cast<uint64_t>(dataSet.columns[c][i]);
+            }
+        }
+        const double decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - decodeStart).count() / DECODE_RUNS;
+
+        const double rows = static_cast<double>(dataSet.timestamps.size());
+        const double samples = rows * static_cast<double>(dataSet.columns.size());
+        const double bytes = static_cast<double>(series.CompressedBytes());
+        result.opsPerSecond = samples / decodeSeconds;
+        result.note = "ratio " + std::to_string(samples * RAW_SAMPLE_BYTES / bytes).substr(0, 5) + " (recording " +
+                      std::to_string(rows * static_cast<double>(dataSet.recordBytes) / bytes).substr(0, 5) + "), " +
+                      std::to_string(bytes * 8.0 / samples).substr(0, 5) + " bits/sample, " +
+                      std::to_string(static_cast<int>(bytes * 3600.0 / SECONDS / 1e6)) + " MB/h, encode " +
+                      std::to_string(static_cast<int>(samples / encodeSeconds / 1e6)) + " M/s, decode " +
+                      std::to_string(static_cast<int>(samples * RAW_SAMPLE_BYTES / decodeSeconds / 1e6)) + " MB/s raw";
+        if (!identical)
+            result.failure = "round trip is not bit exact";
+        return result;
+    }
+}
+
+/**
+ * Compression ratio and speed of the block codec on the channels of typical frames (the ops are decoded samples
+ * per second). The ratio is against timestamp and value per sample, and against the raw flight recording that
+ * keeps a record header and the padded frame per datagram.
+ */
+CORE_BENCH(TelemetryCodec)
+{
+    for (const DataSet &dataSet : dataSets())
+        Report(codec(dataSet));
+}
@@ -0,0 +1,97 @@
+#include "Bench.h"
+
+#include <JsonConfig.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+
+using namespace aerolab::Bench;
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Reads per measured block
+    constexpr int READS_PER_BLOCK = 1000;
+    /// Measured blocks per variant
+    constexpr int BLOCKS = 2000;
+
+    /// @brief Path of the given depth, e.g. "level0/level1/value" for depth 3
+    std::string pathOfDepth(int depth)
+    {
+        std::string path;
+        for (int i = 0; i < depth - 1; i++)
+            path += "level" + std::to_string(i) + "/";
+        return path + "value";
+    }
+
+    /// @brief Writes a config with a value at every benchmarked depth and initializes the JsonConfig
+    std::shared_ptr<JsonConfig> initConfig(const std::vector<int> &depths)
+    {
+        nlohmann::json root = nlohmann::json::object();
+        for (int depth : depths)
+        {
+            nlohmann::json *pNode = &root;
+            for (int i = 0; i < depth - 1; i++)
+            {
+                pNode = &(*pNode)["level" + std::to_string(i)];
+                // Siblings make every level a realistic object lookup
+                for (int sibling = 0; sibling < 8; sibling++)
+                    (*pNode)["sibling" + std::to_string(sibling)] = sibling;
+            }
+            (*pNode)["value"] = depth;
+        }
+
+        const auto path = std::filesystem::temp_directory_path() / "core_bench_config.json";
+        std::ofstream(path) << root.dump(4);
+
+        JsonConfig::Init(path.string());
+        return JsonConfig::GetInstance();
+    }
+
+    template <typename Read>
+    BenchResult measureReads(const std::string &variant, Read &&read)
+    {
+        BenchResult result;
+        result.benchmark = "ConfigLookup";
+        result.variant = variant;
+
+        std::atomic<int64_t> sink{0};
+        const AllocationScope allocations;
+        const auto start = std::chrono::steady_clock::now();
+        for (int block = 0; block < BLOCKS; block++)
+        {
+            const auto blockStart = std::chrono::steady_clock::now();
+            for (int i = 0; i < READS_PER_BLOCK; i++)
+                sink.fetch_add(read(), std::memory_order_relaxed);
+            result.latency.Record(ElapsedNs(blockStart, std::chrono::steady_clock::now()) / READS_PER_BLOCK);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        result.opsPerSecond = static_cast<double>(BLOCKS) * READS_PER_BLOCK / std::chrono::duration<double>(end - start).count();
+        result.allocationsPerOp = allocations.PerOp(static_cast<uint64_t>(BLOCKS) * READS_PER_BLOCK);
+        return result;
+    }
+}
+
+/**
+ * Reads of an int parameter at several path depths with GetParameter and with a ConfigParam handle.
+ */
+CORE_BENCH(ConfigLookup)
+{
+    const std::vector<int> depths{1, 3, 6, 10};
+    auto pConfig = initConfig(depths);
+
+    for (int depth : depths)
+    {
+        const std::string path = pathOfDepth(depth);
+        const std::string suffix = ", depth " + std::to_string(depth);
+
+        Report(measureReads("GetParameter" + suffix, [&]()
+                            { return pConfig->GetParameter<int>(path); }));
+
+        const ConfigParam<int> handle = pConfig->GetParameterHandle<int>(path);
+        Report(measureReads("ConfigParam" + suffix, [&]()
+                            { return handle.Get(); }));
+    }
+}
@@ -0,0 +1,253 @@
+#include "Bench.h"
+
+#include <InputManager.h>
+#include <TelemetryFrames.h>
+#include <VehicleDemux.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+using namespace aerolab::Bench;
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Loopback port of the benchmark
+    constexpr unsigned short BENCH_PORT = 47007;
+    /// Number of simulated vehicles, every vehicle sends from its own socket with its own system ID
+    constexpr int VEHICLES = 32;
+    /// Number of sending threads, the vehicles are spread over them
+    constexpr int SENDER_THREADS = 4;
+    /// Frames sent by every vehicle after the warm-up, below 65535 so the header sequence does not wrap
+    constexpr int FRAMES_PER_VEHICLE = 20000;
+    /// Frames per second of every vehicle in the paced runs
+    constexpr int PACED_RATE = 2000;
+    /// Busy time per processed datagram on top of the decoding, models heavier per-vehicle processing
+    constexpr auto EXTRA_WORK = std::chrono::nanoseconds(2000);
+    /// The run ends once no datagram has been processed for this long
+    constexpr auto IDLE_TIMEOUT = std::chrono::milliseconds(300);
+    /// Maximum time the pipelines of all vehicles may take to start
+    constexpr auto WARMUP_TIMEOUT = std::chrono::seconds(30);
+
+    /// Size of an attitude frame on the wire
+    constexpr std::size_t FRAME_SIZE = FRAME_OVERHEAD + FramePayloadSize<Frames::Attitude>();
+
+    /// @brief Nanoseconds of the steady clock, shared by sender and receiver
+    int64_t steadyNowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Encodes an attitude frame
+     * @details The header sequence counts the frames of a vehicle, the receiver checks that it only increases.
+     *          The header timestamp carries the send time.
+     */
+    std::array<uint8_t, FRAME_SIZE> encodeFrame(uint8_t systemId, uint16_t sequence)
+    {
+        std::array<uint8_t, FRAME_SIZE> frame{};
+        const FrameHeader header{FRAME_SYNC, systemId, Frames::Attitude::ID, 0, sequence,
+                                 static_cast<uint16_t>(FramePayloadSize<Frames::Attitude>()), static_cast<uint64_t>(steadyNowNs())};
+        std::memcpy(frame.data(), &header, sizeof(header));
+
+        const float roll = static_cast<float>(sequence) * 0.001f;
+        std::memcpy(frame.data() + sizeof(FrameHeader) + Frames::Attitude::ROLL.offset, &roll, sizeof(roll));
+
+        const uint16_t checksum = FrameChecksum(std::span<const uint8_t>(frame.data(), frame.size() - FRAME_CHECKSUM_SIZE));
+        std::memcpy(frame.data() + frame.size() - FRAME_CHECKSUM_SIZE, &checksum, sizeof(checksum));
+        return frame;
+    }
+
+    /// @brief Spins for the given time, sleeping would hide the cost from the workers
+    void busyWait(std::chrono::nanoseconds duration)
+    {
+        const auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end)
+        {
+        }
+    }
+
+    /// Receive state per vehicle, padded so the pipelines do not share cache lines
+    struct alignas(CACHE_LINE_SIZE) VehicleState
+    {
+        /// Sequence of the last processed frame, 0 before the first
+        uint16_t lastSequence = 0;
+        /// Send-to-processed latency of the frames
+        LatencyHistogram latency;
+    };
+
+    /**
+     * @brief Sends frames of many vehicles over loopback through InputManager and VehicleDemux
+     * @param workers Number of threads of the pool
+     * @param ratePerVehicle Frames per second of every vehicle, 0 to send as fast as possible
+     */
+    BenchResult demuxLoopback(std::size_t workers, int ratePerVehicle)
+    {
+        const uint64_t sent = static_cast<uint64_t>(VEHICLES) * FRAMES_PER_VEHICLE;
+
+        boost::asio::io_context ioContext;
+        auto workGuard = boost::asio::make_work_guard(ioContext);
+
+        InputManager inputManager(ioContext.get_executor(), "127.0.0.1", BENCH_PORT);
+        inputManager.SetBatchReceive(64);
+        inputManager.SetReceiveBufferSize(8 << 20);
+
+        WorkStealingPool pool(workers);
+        const uint64_t stealsBefore = pool.StealCount();
+        VehicleDemux demux(pool, E_DemuxKey::SystemId);
+        demux.SetInboxCapacity(16384);
+
+        // Every vehicle is processed by one worker at a time, so the entries need no synchronization
+        std::vector<VehicleState> vehicles(VEHICLES + 1);
+        std::atomic<uint64_t> processed{0};
+        std::atomic<uint64_t> violations{0};
+        demux.SetProcessedCallback([&](const VehiclePipeline &, const Datagram &datagram)
+                                   {
+            FrameHeader header;
+            std::memcpy(&header, datagram.Data(), sizeof(header));
+            busyWait(EXTRA_WORK);
+
+            VehicleState &state = vehicles[header.systemId];
+            if (header.sequence <= state.lastSequence)
+                violations.fetch_add(1, std::memory_order_relaxed);
+            state.lastSequence = header.sequence;
+            state.latency.Record(static_cast<uint64_t>(std::max<int64_t>(steadyNowNs() - static_cast<int64_t>(header.timestampNs), 0)));
+
+            processed.fetch_add(1, std::memory_order_relaxed); });
+
+        // Datagrams handed to the demux, and those it accepted into an inbox
+        std::atomic<uint64_t> received{0};
+        std::atomic<uint64_t> dispatched{0};
+        inputManager.SetCallback([&](const Datagram &datagram)
+                                 {
+            received.fetch_add(1, std::memory_order_relaxed);
+            if (demux.Dispatch(datagram))
+                dispatched.fetch_add(1, std::memory_order_relaxed); });
+        inputManager.Start();
+        std::thread ioThread([&ioContext]()
+                             { ioContext.run(); });
+
+        // One frame per vehicle creates the pipelines, their channels are allocated before the measurement
+        {
+            boost::asio::io_context warmupContext;
+            boost::asio::ip::udp::socket socket(warmupContext, boost::asio::ip::udp::v4());
+            const boost::asio::ip::udp::endpoint target(boost::asio::ip::make_address_v4("127.0.0.1"), BENCH_PORT);
+            for (int v = 1; v <= VEHICLES; v++)
+            {
+                const auto frame = encodeFrame(static_cast<uint8_t>(v), 1);
+                socket.send_to(boost::asio::buffer(frame), target);
+            }
+
+            const auto warmupStart = std::chrono::steady_clock::now();
+            while (processed.load() < static_cast<uint64_t>(VEHICLES) && std::chrono::steady_clock::now() - warmupStart < WARMUP_TIMEOUT)
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        const uint64_t warmupFrames = processed.exchange(0);
+        received.store(0);
+        dispatched.store(0);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> senders;
+        for (int s = 0; s < SENDER_THREADS; s++)
+        {
+            senders.emplace_back([s, ratePerVehicle]()
+                                 {
+                boost::asio::io_context senderContext;
+                const boost::asio::ip::udp::endpoint target(boost::asio::ip::make_address_v4("127.0.0.1"), BENCH_PORT);
+
+                std::vector<std::pair<uint8_t, std::unique_ptr<boost::asio::ip::udp::socket>>> vehicles;
+                for (int v = s; v < VEHICLES; v += SENDER_THREADS)
+                    vehicles.emplace_back(static_cast<uint8_t>(v + 1), std::make_unique<boost::asio::ip::udp::socket>(senderContext, boost::asio::ip::udp::v4()));
+
+                boost::system::error_code ec;
+                const int64_t startNs = steadyNowNs();
+                for (int sequence = 2; sequence <= FRAMES_PER_VEHICLE + 1; sequence++)
+                {
+                    if (ratePerVehicle > 0)
+                    {
+                        // Sleeping leaves the cores to the receiver and the workers
+                        const int64_t dueNs = startNs + static_cast<int64_t>(sequence - 1) * 1000000000 / ratePerVehicle;
+                        const int64_t waitNs = dueNs - steadyNowNs();
+                        if (waitNs > 0)
+                            std::this_thread::sleep_for(std::chrono::nanoseconds(waitNs));
+                    }
+
+                    for (auto &[systemId, pSocket] : vehicles)
+                    {
+                        const auto frame = encodeFrame(systemId, static_cast<uint16_t>(sequence));
+                        pSocket->send_to(boost::asio::buffer(frame), target, 0, ec);
+                    }
+                } });
+        }
+        for (auto &sender : senders)
+            sender.join();
+
+        // Wait until the pipelines ran dry
+        uint64_t lastProcessed = processed.load();
+        auto end = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - end < IDLE_TIMEOUT)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            const uint64_t current = processed.load();
+            if (current != lastProcessed)
+            {
+                lastProcessed = current;
+                end = std::chrono::steady_clock::now();
+            }
+        }
+
+        boost::asio::post(ioContext, [&inputManager]()
+                          { inputManager.Stop(); });
+        workGuard.reset();
+        ioThread.join();
+        pool.Stop();
+
+        uint64_t decoded = 0 - warmupFrames;
+        uint64_t inboxDrops = 0;
+        for (const auto &pVehicle : demux.Vehicles())
+        {
+            decoded += pVehicle->DecodedFrames();
+            inboxDrops += pVehicle->DroppedCount();
+        }
+
+        BenchResult result;
+        result.benchmark = "DemuxLoopback";
+        result.variant = std::to_string(workers) + (workers == 1 ? " worker, " : " workers, ") + std::to_string(VEHICLES) + " vehicles";
+        if (ratePerVehicle > 0)
+            result.variant += ", " + std::to_string(VEHICLES * ratePerVehicle / 1000) + "k/s";
+        for (const auto &state : vehicles)
+            result.latency.Merge(state.latency);
+        result.opsPerSecond = static_cast<double>(processed.load()) / std::chrono::duration<double>(end - start).count();
+        result.note = std::to_string(demux.Vehicles().size()) + " pipelines, decoded " + std::to_string(decoded) + " of " + std::to_string(sent) +
+                      ", inbox drops " + std::to_string(inboxDrops) + ", steals " + std::to_string(pool.StealCount() - stealsBefore) +
+                      ", order violations " + std::to_string(violations.load());
+
+        // Loopback may lose datagrams under load, but everything the demux accepted has to be decoded in order
+        if (violations.load() > 0)
+            result.failure = std::to_string(violations.load()) + " frames out of order";
+        else if (decoded != dispatched.load())
+            result.failure = "decoded " + std::to_string(decoded) + " of " + std::to_string(dispatched.load()) + " dispatched frames";
+        else if (dispatched.load() + inboxDrops != received.load())
+            result.failure = std::to_string(received.load() - dispatched.load() - inboxDrops) + " received frames were not routed";
+        return result;
+    }
+}
+
+/**
+ * Datagrams of many vehicles on one port, demultiplexed by system ID into per-vehicle pipelines on the
+ * work-stealing pool. Every datagram carries a counter per vehicle, the pipelines must see it strictly
+ * increasing (lost datagrams are allowed, reordered ones are not). With enough cores the throughput grows
+ * with the number of workers until the receive thread becomes the limit.
+ */
+CORE_BENCH(DemuxLoopback)
+{
+    for (std::size_t workers : {1, 2, 4})
+        Report(demuxLoopback(workers, 0));
+
+    for (std::size_t workers : {1, 4})
+        Report(demuxLoopback(workers, PACED_RATE));
+}
@@ -0,0 +1,86 @@
+#include "Bench.h"
+
+#include <DerivedChannels.h>
+
+#include <cmath>
+
+using namespace aerolab::Bench;
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Groups of three channels, the second channel of a group depends on the first
+    constexpr int GROUPS = 16;
+    /// Samples pushed per run
+    constexpr int SAMPLES = 200000;
+    /// Entries per level of the output channels
+    constexpr std::size_t STORE_CAPACITY = 1 << 12;
+
+    /// @brief Airspeed, total energy and NED yaw rate per group, like the channels of the default config
+    std::vector<std::pair<std::string, std::string>> definitions()
+    {
+        std::vector<std::pair<std::string, std::string>> result;
+        for (int group = 0; group < GROUPS; group++)
+        {
+            const std::string suffix = std::to_string(group);
+            const std::string offset = std::to_string(group) + ".5";
+            result.emplace_back("airspeed" + suffix, "sqrt(2 * max(airdata.diff_pressure + " + offset + ", 0) / 1.225)");
+            result.emplace_back("energy" + suffix, "gps.altitude + derived.airspeed" + suffix + "^2 / (2 * g)");
+            result.emplace_back("yaw_rate" + suffix, "(attitude.pitch_rate * sin(attitude.roll + " + offset +
+                                                         ") + attitude.yaw_rate * cos(attitude.roll)) / cos(attitude.pitch)");
+        }
+        return result;
+    }
+
+    /**
+     * @brief Pushes samples through a DerivedEvaluator
+     * @param intervalNs Time between two samples, defines how many samples fit into a batch
+     */
+    BenchResult derivedChannels(const std::shared_ptr<const DerivedProgram> &pProgram, int64_t intervalNs)
+    {
+        TelemetryStore store(STORE_CAPACITY);
+        DerivedEvaluator evaluator(pProgram, store);
+
+        std::array<double, SNAPSHOT_FIELD_COUNT> values{};
+        BenchResult result;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < SAMPLES; i++)
+        {
+            const float phase = static_cast<float>(i) * 0.001f;
+            values[SNAPSHOT_OFFSET<Frames::AirData>] = 100.0f + std::sin(phase) * 50.0f;
+            values[SNAPSHOT_OFFSET<Frames::Attitude>] = std::sin(phase) * 0.3f;
+            values[SNAPSHOT_OFFSET<Frames::Attitude> + 1] = std::cos(phase) * 0.2f;
+            values[SNAPSHOT_OFFSET<Frames::Attitude> + 4] = 0.1f;
+            values[SNAPSHOT_OFFSET<Frames::Attitude> + 5] = 0.05f;
+            values[SNAPSHOT_OFFSET<Frames::Gps> + 2] = 120.0f;
+
+            const auto pushStart = std::chrono::steady_clock::now();
+            evaluator.Push(values, static_cast<int64_t>(i) * intervalNs);
+            result.latency.Record(ElapsedNs(pushStart, std::chrono::steady_clock::now()));
+        }
+        evaluator.Flush();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const std::size_t channels = pProgram->ChannelNames().size();
+        result.benchmark = "DerivedChannels";
+        result.variant = std::to_string(channels) + " channels, " + std::to_string(1000000000 / intervalNs) + " Hz";
+        result.opsPerSecond = static_cast<double>(SAMPLES) / seconds;
+        result.note = std::to_string(pProgram->Instructions().size()) + " instructions, " +
+                      std::to_string(static_cast<int>(seconds * 1e9 / SAMPLES / static_cast<double>(channels))) +
+                      " ns per channel and sample, one core handles " + std::to_string(static_cast<int>(result.opsPerSecond / 1000.0)) + " kHz";
+        return result;
+    }
+}
+
+/**
+ * Derived channels evaluated from the latest telemetry values, one sample per datagram. At 1 kHz the batches are
+ * cut by their time span (about 10 samples), at 10 kHz they are full. The times include appending the results
+ * to the store.
+ */
+CORE_BENCH(DerivedChannels)
+{
+    const auto pProgram = std::make_shared<DerivedProgram>(definitions());
+    Report(derivedChannels(pProgram, 1000000));
+    Report(derivedChannels(pProgram, 100000));
+}
@@ -0,0 +1,192 @@
+#include "Bench.h"
+
+#include <InputManager.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+using namespace aerolab::Bench;
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Loopback port of the benchmark
+    constexpr unsigned short BENCH_PORT = 47005;
+    /// Number of sending threads, every sender uses its own socket and source port
+    constexpr int SENDERS = 4;
+    /// Datagrams sent by every unpaced sender
+    constexpr int DATAGRAMS_PER_SENDER = 200000;
+    /// Datagrams per second of every paced sender
+    constexpr int PACED_RATE = 25000;
+    /// Datagrams sent by every paced sender
+    constexpr int PACED_DATAGRAMS_PER_SENDER = 50000;
+    /// Size of a datagram, the first 8 bytes carry the send time
+    constexpr std::size_t DATAGRAM_SIZE = 64;
+    /// The run ends once no datagram arrived for this long
+    constexpr auto IDLE_TIMEOUT = std::chrono::milliseconds(200);
+
+    /// @brief Nanoseconds of the steady clock, shared by sender and receiver
+    int64_t steadyNowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Latency histograms of the receive threads
+     * @details Every thread records into its own histogram, they are merged after the run.
+     */
+    class ThreadLatencies
+    {
+    public:
+        /// @brief The histogram of the calling thread
+        LatencyHistogram &Local()
+        {
+            thread_local std::pair<const ThreadLatencies *, LatencyHistogram *> local{nullptr, nullptr};
+            if (local.first != this)
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                m_histograms.push_back(std::make_unique<LatencyHistogram>());
+                local = {this, m_histograms.back().get()};
+            }
+            return *local.second;
+        }
+
+        /// @brief All histograms merged, has to be called after the receive threads stopped
+        LatencyHistogram Merged()
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            LatencyHistogram merged;
+            for (const auto &pHistogram : m_histograms)
+                merged.Merge(*pHistogram);
+            return merged;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::vector<std::unique_ptr<LatencyHistogram>> m_histograms;
+    };
+
+    /**
+     * @brief Sends datagrams over loopback into an InputManager and measures throughput and latency
+     * @details The latency is the time from the send call to the zero-copy callback. Unpaced senders
+     *          saturate the receiver, the latency then mostly shows the time spent in the socket buffer.
+     * @param shardCount Number of ingest shards, one io thread per shard
+     * @param ratePerSender Datagrams per second of every sender, 0 to send as fast as possible
+     * @param datagramsPerSender Datagrams sent by every sender
+     */
+    BenchResult receiveLoopback(std::size_t shardCount, int ratePerSender, int datagramsPerSender)
+    {
+        const uint64_t sent = static_cast<uint64_t>(SENDERS) * static_cast<uint64_t>(datagramsPerSender);
+
+        boost::asio::io_context ioContext;
+        auto workGuard = boost::asio::make_work_guard(ioContext);
+
+        InputManager inputManager(ioContext.get_executor(), "127.0.0.1", BENCH_PORT);
+        inputManager.SetShardCount(shardCount);
+        inputManager.SetBatchReceive(64);
+        inputManager.SetReceiveBufferSize(8 << 20);
+
+        ThreadLatencies latencies;
+        std::atomic<uint64_t> received{0};
+        inputManager.SetCallback([&](const Datagram &datagram)
+                                 {
+            int64_t sentNs = 0;
+            if (datagram.Size() >= sizeof(sentNs))
+                std::memcpy(&sentNs, datagram.Data(), sizeof(sentNs));
+            latencies.Local().Record(static_cast<uint64_t>(std::max<int64_t>(steadyNowNs() - sentNs, 0)));
+            received.fetch_add(1, std::memory_order_relaxed); });
+
+        inputManager.Start();
+        std::vector<std::thread> ioThreads;
+        for (std::size_t i = 0; i < shardCount; i++)
+            ioThreads.emplace_back([&ioContext]()
+                                   { ioContext.run(); });
+
+        const AllocationScope allocations;
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> senders;
+        for (int s = 0; s < SENDERS; s++)
+        {
+            senders.emplace_back([ratePerSender, datagramsPerSender]()
+                                 {
+                boost::asio::io_context senderContext;
+                boost::asio::ip::udp::socket socket(senderContext, boost::asio::ip::udp::v4());
+                const boost::asio::ip::udp::endpoint target(boost::asio::ip::make_address_v4("127.0.0.1"), BENCH_PORT);
+
+                std::array<uint8_t, DATAGRAM_SIZE> payload{};
+                boost::system::error_code ec;
+                const int64_t startNs = steadyNowNs();
+                for (int i = 0; i < datagramsPerSender; i++)
+                {
+                    if (ratePerSender > 0)
+                    {
+                        const int64_t dueNs = startNs + static_cast<int64_t>(i) * 1000000000 / ratePerSender;
+                        while (steadyNowNs() < dueNs)
+                            std::this_thread::yield();
+                    }
+
+                    const int64_t nowNs = steadyNowNs();
+                    std::memcpy(payload.data(), &nowNs, sizeof(nowNs));
+                    socket.send_to(boost::asio::buffer(payload), target, 0, ec);
+                } });
+        }
+        for (auto &sender : senders)
+            sender.join();
+
+        // Wait for the datagrams still in flight
+        uint64_t lastReceived = received.load();
+        auto lastProgress = std::chrono::steady_clock::now();
+        auto end = lastProgress;
+        while (lastReceived < sent &&
+               std::chrono::steady_clock::now() - lastProgress < IDLE_TIMEOUT)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            const uint64_t current = received.load();
+            if (current != lastReceived)
+            {
+                lastReceived = current;
+                lastProgress = end = std::chrono::steady_clock::now();
+            }
+        }
+        if (lastReceived == sent)
+            end = std::chrono::steady_clock::now();
+
+        const uint64_t count = received.load();
+        const double allocationsPerOp = allocations.PerOp(count);
+
+        boost::asio::post(ioContext, [&inputManager]()
+                          { inputManager.Stop(); });
+        workGuard.reset();
+        for (auto &thread : ioThreads)
+            thread.join();
+
+        BenchResult result;
+        result.benchmark = "IngestLoopback";
+        result.variant = std::to_string(shardCount) + (shardCount == 1 ? " shard" : " shards");
+        if (ratePerSender > 0)
+            result.variant += ", " + std::to_string(SENDERS * ratePerSender / 1000) + "k/s";
+        result.opsPerSecond = static_cast<double>(count) / std::chrono::duration<double>(end - start).count();
+        result.latency = latencies.Merged();
+        result.allocationsPerOp = allocationsPerOp;
+        result.note = "lost " + std::to_string(sent - std::min(count, sent)) + " of " + std::to_string(sent);
+        return result;
+    }
+}
+
+/**
+ * Receive throughput of the InputManager with local senders over loopback, and the send-to-callback
+ * latency at a sustainable rate. Sharded receiving needs SO_REUSEPORT and therefore Linux.
+ */
+CORE_BENCH(IngestLoopback)
+{
+    for (std::size_t shards : {1, 2, 4})
+        Report(receiveLoopback(shards, 0, DATAGRAMS_PER_SENDER));
+
+    for (std::size_t shards : {1, 4})
+        Report(receiveLoopback(shards, PACED_RATE, PACED_DATAGRAMS_PER_SENDER));
+}
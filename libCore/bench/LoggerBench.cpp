@@ -0,0 +1,234 @@
+// Keep debug messages in release builds, the benchmark measures the runtime level check
+#define AEROLAB_LOG_MIN_LEVEL 3
+
+#include "Bench.h"
+
+#include <Logger.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace aerolab::Bench;
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Messages logged by every thread
+    constexpr int CALLS_PER_THREAD = 100000;
+
+    /**
+     * @brief Logs from several threads at once and measures every call
+     * @param variant Name of the variant
+     * @param threadCount Number of logging threads
+     */
+    BenchResult logFromThreads(const std::string &variant, int threadCount)
+    {
+        auto pLogger = Logger::GetInstance();
+        const uint64_t droppedBefore = pLogger->DroppedCount();
+
+        std::vector<LatencyHistogram> latencies(threadCount);
+        std::vector<std::thread> threads;
+        std::atomic<bool> go{false};
+
+        for (int t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&, t]()
+                                 {
+                while (!go.load())
+                    std::this_thread::yield();
+
+                for (int i = 0; i < CALLS_PER_THREAD; i++)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    LOG_INFO("Received " + std::to_string(i) + " bytes from 192.168.0.10:5005");
+                    latencies[t].Record(ElapsedNs(start, std::chrono::steady_clock::now()));
+                } });
+        }
+
+        const AllocationScope allocations;
+        const auto start = std::chrono::steady_clock::now();
+        go = true;
+        for (auto &thread : threads)
+            thread.join();
+        const auto end = std::chrono::steady_clock::now();
+        const double allocationsPerOp = allocations.PerOp(static_cast<uint64_t>(threadCount) * CALLS_PER_THREAD);
+
+        // Not part of the caller throughput, but the next variant must not compete with this one
+        pLogger->Flush();
+
+        BenchResult result;
+        result.benchmark = "LoggerThroughput";
+        result.variant = variant;
+        result.opsPerSecond = static_cast<double>(threadCount) * CALLS_PER_THREAD / std::chrono::duration<double>(end - start).count();
+        for (const auto &latency : latencies)
+            result.latency.Merge(latency);
+        result.allocationsPerOp = allocationsPerOp;
+        result.note = "dropped " + std::to_string(pLogger->DroppedCount() - droppedBefore);
+        return result;
+    }
+}
+
+/**
+ * Calls per second and caller latency of the synchronous and the asynchronous Logger,
+ * writing to the log file only.
+ */
+CORE_BENCH(LoggerThroughput)
+{
+    auto pLogger = Logger::GetInstance();
+    pLogger->SetLogLevel(E_LogLevel::Debug);
+
+    for (int threads : {1, 4})
+        Report(logFromThreads("sync, " + std::to_string(threads) + " threads", threads));
+
+    pLogger->SetAsync(true, 1 << 16);
+    for (int threads : {1, 4})
+        Report(logFromThreads("async, " + std::to_string(threads) + " threads", threads));
+    pLogger->SetAsync(false);
+    pLogger->SetLogLevel(E_LogLevel::Info);
+}
+
+namespace
+{
+    /// Calls per measured block
+    constexpr int CALLS_PER_BLOCK = 1000;
+    /// Measured blocks per variant
+    constexpr int BLOCKS = 10000;
+    /// Measured blocks per variant writing every message
+    constexpr int ENABLED_BLOCKS = 200;
+
+    /**
+     * @brief Measures the per-call cost of a loop body in blocks
+     * @param benchmark Name of the benchmark
+     * @param variant Name of the variant
+     * @param blocks Number of measured blocks
+     * @param body The measured code, called with the iteration
+     */
+    template <typename Body>
+    BenchResult measurePerCall(const std::string &benchmark, const std::string &variant, int blocks, Body &&body)
+    {
+        BenchResult result;
+        result.benchmark = benchmark;
+        result.variant = variant;
+
+        const AllocationScope allocations;
+        const auto start = std::chrono::steady_clock::now();
+        for (int block = 0; block < blocks; block++)
+        {
+            const auto blockStart = std::chrono::steady_clock::now();
+            for (int i = 0; i < CALLS_PER_BLOCK; i++)
+                body(block * CALLS_PER_BLOCK + i);
+            result.latency.Record(ElapsedNs(blockStart, std::chrono::steady_clock::now()) / CALLS_PER_BLOCK);
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        result.opsPerSecond = static_cast<double>(blocks) * CALLS_PER_BLOCK / std::chrono::duration<double>(end - start).count();
+        result.allocationsPerOp = allocations.PerOp(static_cast<uint64_t>(blocks) * CALLS_PER_BLOCK);
+        return result;
+    }
+}
+
+/**
+ * Per-packet cost of the debug messages of the receive path while debug logging is disabled at runtime.
+ * The empty loop is the baseline, a disabled LOG_DEBUG should be indistinguishable from it.
+ */
+CORE_BENCH(LoggerDisabled)
+{
+    auto pLogger = Logger::GetInstance();
+    pLogger->SetLogLevel(E_LogLevel::Info);
+
+    const std::string sender = "192.168.0.10";
+    std::atomic<uint64_t> sink{0};
+
+    Report(measurePerCall("LoggerDisabled", "empty loop", BLOCKS, [&](int i)
+                          { sink.fetch_add(static_cast<uint64_t>(i), std::memory_order_relaxed); }));
+
+    Report(measurePerCall("LoggerDisabled", "LOG_DEBUG concatenated", BLOCKS, [&](int i)
+                          {
+        sink.fetch_add(static_cast<uint64_t>(i), std::memory_order_relaxed);
+        LOG_DEBUG("Received " + std::to_string(i) + " bytes from " + sender); }));
+
+    Report(measurePerCall("LoggerDisabled", "LOG_DEBUG_F", BLOCKS, [&](int i)
+                          {
+        sink.fetch_add(static_cast<uint64_t>(i), std::memory_order_relaxed);
+        LOG_DEBUG_F("Received {} bytes from {}", i, sender); }));
+
+    Report(measurePerCall("LoggerDisabled", "LOG_DEBUG_LIMITED", BLOCKS, [&](int i)
+                          {
+        sink.fetch_add(static_cast<uint64_t>(i), std::memory_order_relaxed);
+        LOG_DEBUG_LIMITED(1000, "Received " + std::to_string(i) + " bytes from " + sender); }));
+
+    // Reference: what every packet paid before the level check moved in front of the message
+    Report(measurePerCall("LoggerDisabled", "message built eagerly", BLOCKS, [&](int i)
+                          {
+        const std::string message = "Received " + std::to_string(i) + " bytes from " + sender;
+        sink.fetch_add(message.size(), std::memory_order_relaxed); }));
+
+    pLogger->SetLogLevel(E_LogLevel::Debug);
+}
+
+namespace
+{
+    /// @brief Name of a log level for the variant names
+    const char *levelName(E_LogLevel level)
+    {
+        switch (level)
+        {
+        case E_LogLevel::Error:
+            return "error";
+        case E_LogLevel::Warning:
+            return "warning";
+        case E_LogLevel::Info:
+            return "info";
+        case E_LogLevel::Debug:
+        default:
+            return "debug";
+        }
+    }
+
+    /// @brief Logs a formatted message at the given level
+    void logAt(E_LogLevel level, int i, const std::string &sender)
+    {
+        switch (level)
+        {
+        case E_LogLevel::Error:
+            LOG_ERROR_F("Received {} bytes from {}", i, sender);
+            break;
+        case E_LogLevel::Warning:
+            LOG_WARNING_F("Received {} bytes from {}", i, sender);
+            break;
+        case E_LogLevel::Info:
+            LOG_INFO_F("Received {} bytes from {}", i, sender);
+            break;
+        case E_LogLevel::Debug:
+            LOG_DEBUG_F("Received {} bytes from {}", i, sender);
+            break;
+        }
+    }
+}
+
+/**
+ * Calls per second of the synchronous Logger at every level, enabled and disabled at runtime.
+ * Errors can not be disabled, the lowest runtime level still logs them.
+ */
+CORE_BENCH(LoggerLevels)
+{
+    auto pLogger = Logger::GetInstance();
+    const std::string sender = "192.168.0.10";
+
+    for (E_LogLevel level : {E_LogLevel::Error, E_LogLevel::Warning, E_LogLevel::Info, E_LogLevel::Debug})
+    {
+        pLogger->SetLogLevel(E_LogLevel::Debug);
+        Report(measurePerCall("LoggerLevels", std::string(levelName(level)) + ", enabled", ENABLED_BLOCKS, [&](int i)
+                              { logAt(level, i, sender); }));
+        pLogger->Flush();
+
+        if (level == E_LogLevel::Error)
+            continue;
+
+        pLogger->SetLogLevel(E_LogLevel::Error);
+        Report(measurePerCall("LoggerLevels", std::string(levelName(level)) + ", disabled", BLOCKS, [&](int i)
+                              { logAt(level, i, sender); }));
+    }
+
+    pLogger->SetLogLevel(E_LogLevel::Info);
+}
@@ -0,0 +1,79 @@
+#include "Bench.h"
+
+#include <Metrics.h>
+
+#include <thread>
+#include <vector>
+
+using namespace aerolab::Bench;
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Updates per measured block
+    constexpr int UPDATES_PER_BLOCK = 1000;
+    /// Measured blocks per thread
+    constexpr int BLOCKS = 2000;
+
+    /**
+     * @brief Updates a metric from several threads at once
+     * @details Every thread records its own per update latency, the results are merged afterwards.
+     */
+    template <typename Update>
+    BenchResult measureUpdates(const std::string &variant, int threadCount, Update &&update)
+    {
+        BenchResult result;
+        result.benchmark = "MetricsUpdate";
+        result.variant = variant + ", " + std::to_string(threadCount) + " threads";
+
+        std::vector<LatencyHistogram> latencies(static_cast<std::size_t>(threadCount));
+        std::vector<std::thread> threads;
+
+        const AllocationScope allocations;
+        const auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threadCount; t++)
+        {
+            threads.emplace_back([&, t]()
+                                 {
+                                     for (int block = 0; block < BLOCKS; block++)
+                                     {
+                                         const auto blockStart = std::chrono::steady_clock::now();
+                                         for (int i = 0; i < UPDATES_PER_BLOCK; i++)
+                                             update(static_cast<uint64_t>(i));
+                                         latencies[static_cast<std::size_t>(t)].Record(ElapsedNs(blockStart, std::chrono::steady_clock::now()) / UPDATES_PER_BLOCK);
+                                     } });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        const auto end = std::chrono::steady_clock::now();
+
+        const uint64_t updates = static_cast<uint64_t>(threadCount) * BLOCKS * UPDATES_PER_BLOCK;
+        for (const auto &latency : latencies)
+            result.latency.Merge(latency);
+        result.opsPerSecond = static_cast<double>(updates) / std::chrono::duration<double>(end - start).count();
+        result.allocationsPerOp = allocations.PerOp(updates);
+        return result;
+    }
+}
+
+/**
+ * Cost of recording into the metrics from one and from several threads. The plain shared atomic
+ * shows what the sharding saves once several threads update the same metric.
+ */
+CORE_BENCH(MetricsUpdate)
+{
+    auto pRegistry = MetricsRegistry::GetInstance();
+    auto &counter = pRegistry->GetCounter("bench_counter_total", "Benchmark counter");
+    auto &histogram = pRegistry->GetHistogram("bench_latency_seconds", "Benchmark histogram");
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> shared{0};
+
+    for (int threadCount : {1, 4})
+    {
+        Report(measureUpdates("shared atomic", threadCount, [&](uint64_t)
+                              { shared.fetch_add(1, std::memory_order_relaxed); }));
+        Report(measureUpdates("MetricCounter::Inc", threadCount, [&](uint64_t)
+                              { counter.Inc(); }));
+        Report(measureUpdates("MetricHistogram::Observe", threadCount, [&](uint64_t i)
+                              { histogram.Observe(i * 997); }));
+    }
+}
@@ -0,0 +1,193 @@
+#include "Bench.h"
+
+#include <CommandUplink.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+using namespace aerolab::Bench;
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Commands measured per variant, sent one after another
+    constexpr int COMMANDS = 2000;
+    /// Parameters of the upload running alongside the commands
+    constexpr int PARAMETERS = 50000;
+    /// Heartbeat interval of the uplink
+    constexpr auto HEARTBEAT_INTERVAL = std::chrono::milliseconds(10);
+
+    /**
+     * @brief Flight controller side of the loopback test
+     * @details Acknowledges every frame which requests it and tracks the gaps between the heartbeats.
+     *          Every lossEvery-th frame is dropped without acknowledgement.
+     */
+    class EchoPeer
+    {
+    public:
+        explicit EchoPeer(int lossEvery) : m_socket(m_ioContext, boost::asio::ip::udp::endpoint(boost::asio::ip::make_address_v4("127.0.0.1"), 0)),
+                                           m_lossEvery(lossEvery)
+        {
+            m_socket.set_option(boost::asio::socket_base::receive_buffer_size(4 * 1024 * 1024));
+            m_thread = std::thread(&EchoPeer::run, this);
+        }
+
+        ~EchoPeer()
+        {
+            m_running = false;
+            boost::system::error_code ec;
+            m_socket.shutdown(boost::asio::ip::udp::socket::shutdown_both, ec);
+            // Wake the blocking receive
+            m_socket.send_to(boost::asio::buffer("", 1), m_socket.local_endpoint(), 0, ec);
+            m_thread.join();
+        }
+
+        boost::asio::ip::udp::endpoint Endpoint() const { return m_socket.local_endpoint(); }
+
+        /// @brief Longest gap between two heartbeats in nanoseconds
+        uint64_t MaxHeartbeatGapNs() const { return m_maxGapNs.load(); }
+        /// @brief Number of received heartbeats
+        uint64_t Heartbeats() const { return m_heartbeats.load(); }
+
+    private:
+        void run()
+        {
+            std::array<uint8_t, MAX_DATAGRAM_SIZE> buffer;
+            boost::asio::ip::udp::endpoint sender;
+            uint64_t reliableFrames = 0;
+            std::chrono::steady_clock::time_point lastHeartbeat;
+
+            while (m_running)
+            {
+                boost::system::error_code ec;
+                const std::size_t bytes = m_socket.receive_from(boost::asio::buffer(buffer), sender, 0, ec);
+                if (ec || !m_running)
+                    continue;
+
+                FrameHeader header;
+                if (bytes < FRAME_OVERHEAD)
+                    continue;
+                std::memcpy(&header, buffer.data(), sizeof(header));
+
+                if (header.messageId == Frames::Heartbeat::ID)
+                {
+                    const auto now = std::chrono::steady_clock::now();
+                    if (m_heartbeats.fetch_add(1) > 0)
+                        m_maxGapNs = std::max(m_maxGapNs.load(), ElapsedNs(lastHeartbeat, now));
+                    lastHeartbeat = now;
+                }
+
+                if ((header.flags & Frames::FRAME_FLAG_ACK_REQUESTED) == 0)
+                    continue;
+                if (m_lossEvery > 0 && ++reliableFrames % static_cast<uint64_t>(m_lossEvery) == 0)
+                    continue;
+
+                std::array<uint8_t, FRAME_OVERHEAD + FramePayloadSize<Frames::Ack>()> ack{};
+                FrameHeader ackHeader{FRAME_SYNC, 1, Frames::Ack::ID, 0, 0, static_cast<uint16_t>(FramePayloadSize<Frames::Ack>()), 0};
+                std::memcpy(ack.data(), &ackHeader, sizeof(ackHeader));
+                std::memcpy(ack.data() + sizeof(FrameHeader) + Frames::Ack::SEQUENCE.offset, &header.sequence, sizeof(header.sequence));
+                ack[sizeof(FrameHeader) + Frames::Ack::MESSAGE_ID.offset] = header.messageId;
+                const uint16_t checksum = FrameChecksum(std::span<const uint8_t>(ack.data(), ack.size() - FRAME_CHECKSUM_SIZE));
+                std::memcpy(ack.data() + ack.size() - FRAME_CHECKSUM_SIZE, &checksum, sizeof(checksum));
+
+                m_socket.send_to(boost::asio::buffer(ack), sender, 0, ec);
+            }
+        }
+
+        boost::asio::io_context m_ioContext;
+        boost::asio::ip::udp::socket m_socket;
+        int m_lossEvery;
+        std::atomic<bool> m_running{true};
+        std::atomic<uint64_t> m_heartbeats{0};
+        std::atomic<uint64_t> m_maxGapNs{0};
+        std::thread m_thread;
+    };
+
+    /**
+     * @brief Sends commands one after another and records their round trip time
+     * @param parameters Parameters uploaded while the commands are measured
+     * @param lossEvery Every lossEvery-th frame is not acknowledged, 0 for no loss
+     */
+    BenchResult measureCommands(const std::string &variant, int parameters, int lossEvery)
+    {
+        BenchResult result;
+        result.benchmark = "UplinkEcho";
+        result.variant = variant;
+
+        EchoPeer peer(lossEvery);
+
+        boost::asio::io_context ioContext;
+        auto workGuard = boost::asio::make_work_guard(ioContext);
+
+        UplinkOptions options;
+        options.target = peer.Endpoint();
+        options.heartbeatInterval = HEARTBEAT_INTERVAL;
+        options.maxRetries = 10;
+        CommandUplink uplink(ioContext.get_executor(), options);
+        uplink.Start();
+        std::thread ioThread([&ioContext]()
+                             { ioContext.run(); });
+
+        std::atomic<int> parametersAcked{0};
+        std::atomic<int64_t> uploadEndNs{0};
+        const auto uploadStart = std::chrono::steady_clock::now();
+        for (int i = 0; i < parameters; i++)
+        {
+            uplink.SendParameter(static_cast<uint16_t>(i), static_cast<float>(i), [&, parameters](bool, std::chrono::nanoseconds)
+                                 {
+                                     if (parametersAcked.fetch_add(1) + 1 == parameters)
+                                         uploadEndNs = static_cast<int64_t>(ElapsedNs(uploadStart, std::chrono::steady_clock::now())); });
+        }
+
+        int failed = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < COMMANDS; i++)
+        {
+            std::atomic<int> state{0};
+            std::chrono::nanoseconds roundTrip{0};
+            uplink.SendCommand(Frames::E_UplinkCommand::Arm, 0.0f, 0.0f, [&](bool acked, std::chrono::nanoseconds elapsed)
+                               {
+                                   roundTrip = elapsed;
+                                   state = acked ? 1 : 2; });
+
+            while (state.load() == 0)
+                std::this_thread::yield();
+
+            if (state.load() == 1)
+                result.latency.Record(static_cast<uint64_t>(roundTrip.count()));
+            else
+                failed++;
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        while (parametersAcked.load() < parameters)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        uplink.Stop();
+        workGuard.reset();
+        ioThread.join();
+
+        result.opsPerSecond = COMMANDS / std::chrono::duration<double>(end - start).count();
+        result.note = "heartbeat gap max " + std::to_string(peer.MaxHeartbeatGapNs() / 1000000.0).substr(0, 5) + " ms, RTO " +
+                      std::to_string(uplink.Rto().count()) + " us";
+        if (parameters > 0)
+            result.note += ", " + std::to_string(parameters) + " parameters in " + std::to_string(uploadEndNs.load() / 1000000) + " ms";
+        if (failed > 0)
+            result.note += ", " + std::to_string(failed) + " failed";
+        return result;
+    }
+}
+
+/**
+ * Round trip time of commands through the uplink to a loopback peer which acknowledges every frame.
+ * The parameter upload variant shows that commands pre-empt the bulk traffic and the heartbeats keep their rate,
+ * the loss variant includes the retransmissions after the adaptive timeout.
+ */
+CORE_BENCH(UplinkEcho)
+{
+    Report(measureCommands("commands, idle link", 0, 0));
+    Report(measureCommands("commands, parameter upload", PARAMETERS, 0));
+    Report(measureCommands("commands, 1% loss", 0, 100));
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "DatagramPool.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "UplinkFrames.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+namespace aerolab::Core
+{
+    /// Enum for the priority of an uplink frame, lower values are sent first
+    enum class E_UplinkPriority
+    {
+        /// Commands, e.g. arming, pre-empt everything else
+        Command = 0,
+        /// Heartbeats, sent at their rate regardless of the bulk traffic
+        Heartbeat = 1,
+        /// Bulk traffic, e.g. parameter uploads, sent in batches
+        Bulk = 2
+    };
+
+    /// Settings of the uplink
+    struct UplinkOptions
+    {
+        /// Endpoint of the flight controller
+        boost::asio::ip::udp::endpoint target{boost::asio::ip::make_address_v4("127.0.0.1"), 5006};
+        /// Local endpoint the acknowledgements are received on, port 0 for an ephemeral port
+        boost::asio::ip::udp::endpoint local{boost::asio::ip::udp::v4(), 0};
+        /// ID of the ground station in the frame headers
+        uint8_t systemId = 255;
+        /// Interval of the heartbeats, 0 disables them
+        std::chrono::milliseconds heartbeatInterval{100};
+        /// Retransmit timeout before the first round trip has been measured
+        std::chrono::milliseconds initialRto{200};
+        /// Lower bound of the retransmit timeout
+        std::chrono::milliseconds minRto{10};
+        /// Upper bound of the retransmit timeout
+        std::chrono::milliseconds maxRto{2000};
+        /// Retransmissions before a frame is reported as failed
+        int maxRetries = 5;
+        /// Unacknowledged bulk frames on the link, limits the bulk traffic so commands find the link idle
+        std::size_t bulkWindow = 64;
+        /// Maximum number of bulk frames per send syscall
+        std::size_t bulkBatch = 16;
+    };
+
+    /**
+     * @brief The CommandUplink class
+     * @details Sends commands, parameters and heartbeats to the flight controller, the counterpart of the
+     *          receive-only InputManager. Frames use the telemetry frame format with the uplink layouts of
+     *          UplinkFrames.h and carry a sequence number per uplink.
+     *
+     *          Frames are queued per priority and sent on a strand of the given executor. Commands and
+     *          heartbeats are sent one by one as soon as they are queued, bulk frames in batches with sendmmsg
+     *          and only while fewer than bulkWindow of them are unacknowledged. The strand is released after
+     *          every bulk batch, so a large parameter upload never delays a heartbeat or a command by more
+     *          than one batch.
+     *
+     *          Commands and bulk frames request an acknowledgement and are retransmitted until it arrives.
+     *          The retransmit timeout adapts to the measured round trip time like TCP (RFC 6298): smoothed
+     *          round trip time plus four times its variation, doubled on every timeout and sampled only from
+     *          frames which have not been retransmitted (Karn's algorithm).
+     */
+    class CommandUplink
+    {
+    public:
+        /**
+         * @brief Called once per acknowledged frame, on the strand of the uplink
+         * @param acked True if the frame has been acknowledged, False if all retransmissions failed or the uplink stopped
+         * @param roundTrip Time from queuing the frame to its acknowledgement, including queuing and retransmissions
+         */
+        using AckCallback = std::function<void(bool acked, std::chrono::nanoseconds roundTrip)>;
+
+        CommandUplink(boost::asio::any_io_executor exec, UplinkOptions options);
+        ~CommandUplink();
+
+        /// Delete copy constructor, handlers reference the uplink
+        CommandUplink(const CommandUplink &) = delete;
+        /// Delete assign operator, handlers reference the uplink
+        CommandUplink &operator=(const CommandUplink &) = delete;
+
+        bool Start();
+        void Stop();
+
+        bool Send(uint8_t messageId, std::span<const uint8_t> payload, E_UplinkPriority priority, AckCallback onAck = {});
+        bool SendCommand(Frames::E_UplinkCommand command, float param1 = 0.0f, float param2 = 0.0f, AckCallback onAck = {});
+        bool SendParameter(uint16_t index, float value, AckCallback onAck = {});
+
+        /// @brief Local endpoint the uplink sends from and receives the acknowledgements on, valid after Start()
+        boost::asio::ip::udp::endpoint LocalEndpoint() const;
+
+        /// @brief Current retransmit timeout
+        std::chrono::microseconds Rto() const { return std::chrono::microseconds(m_rtoUs.load(std::memory_order_relaxed)); }
+        /// @brief Smoothed round trip time of the link, 0 before the first acknowledgement
+        std::chrono::microseconds SmoothedRtt() const { return std::chrono::microseconds(m_srttUs.load(std::memory_order_relaxed)); }
+
+    private:
+        /// A frame waiting in a priority queue
+        struct Outgoing
+        {
+            /// The encoded frame
+            std::vector<uint8_t> frame;
+            /// Sequence number of the frame
+            uint16_t sequence = 0;
+            /// Priority of the frame
+            E_UplinkPriority priority = E_UplinkPriority::Bulk;
+            /// The frame requests an acknowledgement
+            bool reliable = false;
+            /// The frame has been sent before and is queued again by the retransmit timer
+            bool retransmission = false;
+            /// Time the frame has been queued by Send()
+            std::chrono::steady_clock::time_point queued;
+            /// Called on the acknowledgement, moved into the in-flight entry on the first transmission
+            AckCallback onAck;
+        };
+
+        /// A sent frame waiting for its acknowledgement
+        struct InFlight
+        {
+            /// The encoded frame, copied for retransmissions
+            std::vector<uint8_t> frame;
+            /// Priority the frame is retransmitted with
+            E_UplinkPriority priority;
+            /// Time the frame has been queued by Send()
+            std::chrono::steady_clock::time_point queued;
+            /// Time of the last transmission
+            std::chrono::steady_clock::time_point lastSent;
+            /// Retransmission deadline, max while a retransmission is queued
+            std::chrono::steady_clock::time_point deadline;
+            /// Number of retransmissions
+            int retries = 0;
+            /// Called on the acknowledgement
+            AckCallback onAck;
+        };
+
+        static constexpr std::size_t PRIORITY_COUNT = 3;
+
+        void shutdown();
+        Outgoing encode(uint8_t messageId, std::span<const uint8_t> payload, E_UplinkPriority priority, bool reliable);
+        bool enqueue(uint8_t messageId, std::span<const uint8_t> payload, E_UplinkPriority priority, bool reliable, AckCallback onAck);
+        void schedulePump();
+        void pump();
+        bool popSendable(E_UplinkPriority priority, Outgoing &outgoing);
+        bool sendSingle(Outgoing &outgoing);
+        std::size_t sendBatch(std::vector<Outgoing> &batch);
+        void markSent(Outgoing &outgoing, std::chrono::steady_clock::time_point now);
+        void requeueFront(std::vector<Outgoing> &frames, std::size_t first);
+        void waitWritable();
+        void receiveAcks();
+        void handleAck(uint16_t sequence);
+        void updateRto(std::chrono::steady_clock::duration sample);
+        void armRetransmitTimer();
+        void onRetransmitTimer();
+        void scheduleHeartbeat();
+
+        /// Settings of the uplink
+        UplinkOptions m_options;
+        /// Strand serializing all socket and timer handlers
+        boost::asio::strand<boost::asio::any_io_executor> m_strand;
+        /// Socket the frames are sent from and the acknowledgements received on
+        boost::asio::ip::udp::socket m_socket;
+        /// Timer of the earliest retransmission
+        boost::asio::steady_timer m_retransmitTimer;
+        /// Timer of the next heartbeat
+        boost::asio::steady_timer m_heartbeatTimer;
+
+        /// Queued frames per priority, guarded by m_queueMutex
+        std::array<std::deque<Outgoing>, PRIORITY_COUNT> m_queues;
+        /// Mutex of the queues, senders on any thread only hold it while queuing
+        std::mutex m_queueMutex;
+        /// Sequence number of the next frame
+        std::atomic<uint16_t> m_nextSequence{0};
+        /// Sent frames waiting for their acknowledgement by sequence number, only accessed on the strand
+        std::unordered_map<uint16_t, InFlight> m_inFlight;
+        /// Bulk frames of the batch being sent, only accessed on the strand
+        std::vector<Outgoing> m_batch;
+        /// Sent bulk frames waiting for their acknowledgement, only accessed on the strand
+        std::size_t m_bulkInFlight = 0;
+        /// A pump is posted to the strand
+        std::atomic<bool> m_pumpScheduled{false};
+        /// The socket buffer is full, the pump continues once it is writable
+        bool m_waitingWritable = false;
+        /// Deadline the retransmit timer is armed for, max if it is idle
+        std::chrono::steady_clock::time_point m_timerDeadline = std::chrono::steady_clock::time_point::max();
+        /// Start() succeeded and Stop() has not been called
+        std::atomic<bool> m_running{false};
+
+        /// Smoothed round trip time in microseconds, 0 before the first sample
+        std::atomic<int64_t> m_srttUs{0};
+        /// Round trip time variation in microseconds
+        int64_t m_rttVarUs = 0;
+        /// Retransmit timeout in microseconds
+        std::atomic<int64_t> m_rtoUs;
+
+        /// Receive buffer of the acknowledgements
+        std::array<uint8_t, MAX_DATAGRAM_SIZE> m_receiveBuffer;
+        /// Sender of the last received datagram
+        boost::asio::ip::udp::endpoint m_receiveSender;
+
+        /// Registry of the metrics below, labeled with the target port
+        std::shared_ptr<MetricsRegistry> m_pMetrics;
+        /// Sent frames per priority, including retransmissions
+        std::array<MetricCounter *, PRIORITY_COUNT> m_sentCounters{};
+        /// Retransmitted frames
+        MetricCounter *m_pRetransmitCounter = nullptr;
+        /// Frames which have not been acknowledged after all retransmissions
+        MetricCounter *m_pFailedCounter = nullptr;
+        /// Failed send calls
+        MetricCounter *m_pErrorCounter = nullptr;
+        /// Frames waiting for their acknowledgement
+        MetricGauge *m_pInFlightGauge = nullptr;
+        /// Round trip time of the acknowledged frames
+        MetricHistogram *m_pRoundTripHistogram = nullptr;
+    };
+}
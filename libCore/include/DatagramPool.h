@@ -0,0 +1,175 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <boost/asio/ip/udp.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace aerolab::Core
+{
+    /// Maximum payload size of a single pooled datagram buffer
+    constexpr std::size_t MAX_DATAGRAM_SIZE = 4096;
+
+    class DatagramPool;
+
+    /**
+     * @brief A single preallocated datagram buffer
+     * @details Buffers are owned by a DatagramPool and handed out through Datagram handles.
+     *          The reference count is maintained by the handles, the buffer returns to its pool
+     *          once the last handle is released.
+     */
+    struct DatagramBuffer
+    {
+        /// Number of Datagram handles referencing this buffer
+        std::atomic<uint32_t> refCount{0};
+        /// Pool the buffer is returned to
+        DatagramPool *pPool = nullptr;
+        /// Number of valid bytes in data
+        std::size_t size = 0;
+        /// Endpoint the datagram was received from
+        boost::asio::ip::udp::endpoint sender;
+        /// Receive timestamp of the datagram
+        std::chrono::system_clock::time_point timestamp;
+        /// Payload storage
+        alignas(64) std::array<uint8_t, MAX_DATAGRAM_SIZE> data;
+    };
+
+    /**
+     * @brief Ref-counted handle to a pooled datagram buffer
+     * @details Copying a handle only increments the reference count, the payload is never copied.
+     *          Consumers may keep handles as long as they like, the buffer is returned to the pool
+     *          when the last handle goes out of scope.
+     * @note The mutable accessors must only be used while the handle is the sole owner of the buffer,
+     *       i.e. by the producer before the datagram is handed out.
+     * @note The owning DatagramPool must outlive all handles.
+     */
+    class Datagram
+    {
+    public:
+        Datagram() = default;
+        Datagram(const Datagram &other) noexcept : m_pBuffer(other.m_pBuffer) { retain(); }
+        Datagram(Datagram &&other) noexcept : m_pBuffer(other.m_pBuffer) { other.m_pBuffer = nullptr; }
+        ~Datagram() { reset(); }
+
+        Datagram &operator=(const Datagram &other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                m_pBuffer = other.m_pBuffer;
+                retain();
+            }
+            return *this;
+        }
+
+        Datagram &operator=(Datagram &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                m_pBuffer = other.m_pBuffer;
+                other.m_pBuffer = nullptr;
+            }
+            return *this;
+        }
+
+        /// @brief Checks if the handle references a buffer
+        explicit operator bool() const { return m_pBuffer != nullptr; }
+
+        /// @brief The received payload as read-only view
+        std::span<const uint8_t> Span() const { return {m_pBuffer->data.data(), m_pBuffer->size}; }
+        /// @brief Pointer to the received payload
+        const uint8_t *Data() const { return m_pBuffer->data.data(); }
+        /// @brief Number of received bytes
+        std::size_t Size() const { return m_pBuffer->size; }
+        /// @brief Endpoint the datagram was received from
+        const boost::asio::ip::udp::endpoint &Sender() const { return m_pBuffer->sender; }
+        /// @brief Receive timestamp of the datagram
+        std::chrono::system_clock::time_point Timestamp() const { return m_pBuffer->timestamp; }
+
+        /// @brief Writable view of the whole buffer, only valid while uniquely owned
+        std::span<uint8_t, MAX_DATAGRAM_SIZE> MutableBuffer() { return std::span<uint8_t, MAX_DATAGRAM_SIZE>(m_pBuffer->data); }
+        /// @brief Sets the number of valid bytes, only valid while uniquely owned
+        void SetSize(std::size_t size) { m_pBuffer->size = size; }
+        /// @brief Writable sender endpoint, only valid while uniquely owned
+        boost::asio::ip::udp::endpoint &MutableSender() { return m_pBuffer->sender; }
+        /// @brief Sets the receive timestamp, only valid while uniquely owned
+        void SetTimestamp(std::chrono::system_clock::time_point timestamp) { m_pBuffer->timestamp = timestamp; }
+
+    private:
+        friend class DatagramPool;
+
+        /// Adopts a buffer whose reference count has already been set by the pool
+        explicit Datagram(DatagramBuffer *pBuffer) noexcept : m_pBuffer(pBuffer) {}
+
+        void retain() noexcept
+        {
+            if (m_pBuffer)
+                m_pBuffer->refCount.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void reset() noexcept;
+
+        /// Referenced pool buffer
+        DatagramBuffer *m_pBuffer = nullptr;
+    };
+
+    /**
+     * @brief The DatagramPool class
+     * @details Preallocates a number of datagram buffers and hands them out as ref-counted Datagram handles.
+     *          In steady state no heap allocations are performed, the pool only grows if all buffers are in use.
+     *          Every heap allocation performed by the pool is counted so callers can verify a steady state.
+     */
+    class DatagramPool
+    {
+    public:
+        explicit DatagramPool(std::size_t initialCapacity = 256);
+        ~DatagramPool() = default;
+
+        /// Delete copy constructor, buffers reference their pool
+        DatagramPool(const DatagramPool &) = delete;
+        /// Delete assign operator, buffers reference their pool
+        DatagramPool &operator=(const DatagramPool &) = delete;
+
+        Datagram Acquire();
+
+        /// @brief Total number of buffers owned by the pool
+        std::size_t Capacity() const { return m_capacity.load(std::memory_order_relaxed); }
+        std::size_t Available() const;
+        /// @brief Number of heap allocations the pool has performed since construction
+        uint64_t AllocationCount() const { return m_allocationCount.load(std::memory_order_relaxed); }
+
+    private:
+        friend class Datagram;
+
+        void release(DatagramBuffer *pBuffer);
+        void grow(std::size_t count);
+
+        /// Mutex protecting the free list and the slabs
+        mutable std::mutex m_mutex;
+        /// Memory blocks containing the buffers
+        std::vector<std::unique_ptr<DatagramBuffer[]>> m_slabs;
+        /// Buffers currently not in use
+        std::vector<DatagramBuffer *> m_freeList;
+        /// Total number of buffers
+        std::atomic<std::size_t> m_capacity{0};
+        /// Number of heap allocations performed by the pool
+        std::atomic<uint64_t> m_allocationCount{0};
+    };
+
+    /**
+     * @brief Releases the referenced buffer
+     * @details Decrements the reference count and returns the buffer to its pool if this was the last reference
+     */
+    inline void Datagram::reset() noexcept
+    {
+        if (m_pBuffer && m_pBuffer->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            m_pBuffer->pPool->release(m_pBuffer);
+        m_pBuffer = nullptr;
+    }
+}
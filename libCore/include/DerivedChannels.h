@@ -0,0 +1,158 @@
+#pragma once
+
+#include "TelemetrySnapshot.h"
+#include "TelemetryStore.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace aerolab::Core
+{
+    /// Samples evaluated together, the length of the vectorized loops
+    constexpr std::size_t DERIVED_BATCH_SIZE = 64;
+
+    /// Enum for the operations of the derived channel bytecode
+    enum class E_DerivedOp : uint8_t
+    {
+        Add,
+        Sub,
+        Mul,
+        Div,
+        Pow,
+        Min,
+        Max,
+        Atan2,
+        Neg,
+        Abs,
+        Sqrt,
+        Sin,
+        Cos,
+        Tan,
+        Asin,
+        Acos,
+        Atan,
+        Exp,
+        Log
+    };
+
+    /// A single bytecode instruction, every operand is a register holding one value per batch sample
+    struct DerivedInstruction
+    {
+        /// The operation
+        E_DerivedOp op;
+        /// Register the result is written to
+        uint16_t dst;
+        /// First operand
+        uint16_t a;
+        /// Second operand, unused by unary operations
+        uint16_t b;
+    };
+
+    /**
+     * @brief The DerivedProgram class
+     * @details Compiles derived channels, defined as expressions over the telemetry fields and other derived
+     *          channels, into a single register bytecode. Every expression is parsed once, the channels are ordered
+     *          topologically so every channel is computed exactly once and before the channels using it.
+     *          The program is immutable and shared by the DerivedEvaluators of all vehicles.
+     *
+     *          Expression syntax: numbers, the operators + - * / ^ with the usual precedence, parentheses,
+     *          the constants pi and g and the functions abs, sqrt, sin, cos, tan, asin, acos, atan, exp, log,
+     *          pow, min, max and atan2. Telemetry fields are referenced with a dot instead of the slash of
+     *          the channel name, e.g. "airdata.diff_pressure", other derived channels as "derived.<name>".
+     *          Channels with an invalid expression, an unknown field or a dependency cycle are logged and left out.
+     */
+    class DerivedProgram
+    {
+    public:
+        explicit DerivedProgram(const std::vector<std::pair<std::string, std::string>> &definitions);
+
+        /// @brief Names of the compiled channels in evaluation order, without the "derived/" prefix
+        const std::vector<std::string> &ChannelNames() const { return m_channelNames; }
+        /// @brief Register holding the result of every compiled channel
+        const std::vector<uint16_t> &ChannelRegisters() const { return m_channelRegisters; }
+        /// @brief Snapshot fields read by the program, loaded into the registers 0..n-1
+        const std::vector<std::size_t> &InputFields() const { return m_inputFields; }
+        /// @brief Constants, loaded into the registers following the inputs
+        const std::vector<float> &Constants() const { return m_constants; }
+        /// @brief The instructions in execution order
+        const std::vector<DerivedInstruction> &Instructions() const { return m_instructions; }
+        /// @brief Number of registers the program uses
+        std::size_t RegisterCount() const { return m_registerCount; }
+
+    private:
+        /// Names of the compiled channels in evaluation order
+        std::vector<std::string> m_channelNames;
+        /// Result register of every compiled channel
+        std::vector<uint16_t> m_channelRegisters;
+        /// Snapshot fields loaded into the input registers
+        std::vector<std::size_t> m_inputFields;
+        /// Values of the constant registers
+        std::vector<float> m_constants;
+        /// The bytecode
+        std::vector<DerivedInstruction> m_instructions;
+        /// Number of registers
+        std::size_t m_registerCount = 0;
+    };
+
+    /**
+     * @brief The DerivedEvaluator class
+     * @details Runs a DerivedProgram over batches of telemetry samples and appends the results to the "derived/"
+     *          channels of a store. The ingest pushes the latest values once per datagram, the batch is evaluated
+     *          when it is full or spans more than MAX_BATCH_SPAN_NS. Every instruction is executed as one loop over
+     *          the batch, so the cost of the dispatch is shared by all samples and the loops vectorize.
+     *          A batch of a stream that stopped is evaluated by FlushIdle() or on destruction.
+     * @note Push() is called by the single writer, the owning TelemetryIngest. Flush() and FlushIdle() may be
+     *       called from any thread, e.g. a timer.
+     */
+    class DerivedEvaluator
+    {
+    public:
+        DerivedEvaluator(std::shared_ptr<const DerivedProgram> pProgram, TelemetryStore &store, const std::string &channelPrefix = "");
+        ~DerivedEvaluator();
+
+        /// Delete copy constructor, the batch is guarded by a mutex
+        DerivedEvaluator(const DerivedEvaluator &) = delete;
+        /// Delete assign operator, the batch is guarded by a mutex
+        DerivedEvaluator &operator=(const DerivedEvaluator &) = delete;
+
+        void Push(const std::array<double, SNAPSHOT_FIELD_COUNT> &values, int64_t timestampNs);
+        void Flush();
+        void FlushIdle();
+
+        /// @brief Number of samples waiting for the next evaluation
+        std::size_t Pending() const
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            return m_count;
+        }
+
+    private:
+        void evaluate();
+
+        /// Maximum time between the first and the last sample of a batch
+        static constexpr int64_t MAX_BATCH_SPAN_NS = 10'000'000;
+
+        /// One register, a value per batch sample
+        using Register = std::array<float, DERIVED_BATCH_SIZE>;
+
+        /// The program
+        std::shared_ptr<const DerivedProgram> m_pProgram;
+        /// Output channels in program order
+        std::vector<std::shared_ptr<TelemetryChannel>> m_channels;
+        /// Registers of the program, inputs first, then constants, then results
+        std::vector<Register> m_registers;
+        /// Timestamps of the batch samples
+        std::array<int64_t, DERIVED_BATCH_SIZE> m_timestamps{};
+        /// Samples in the batch
+        std::size_t m_count = 0;
+        /// A sample was pushed since the previous FlushIdle()
+        bool m_pushedSinceIdle = false;
+        /// Guards the batch, only contended by the idle flush
+        mutable std::mutex m_mutex;
+    };
+}
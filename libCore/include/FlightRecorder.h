@@ -0,0 +1,86 @@
+#pragma once
+
+#include "DatagramPool.h"
+#include "RecordingFormat.h"
+#include "RingBuffer.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace aerolab::Core
+{
+    /**
+     * @brief The FlightRecorder class
+     * @details Records received datagrams with their receive timestamp and source endpoint into a chunked
+     *          binary file (see RecordingFormat.h). Record() only pushes the datagram handle into a queue,
+     *          a writer thread copies the datagrams into the memory-mapped current chunk. The file is grown
+     *          by several chunks at once, so the receive thread never waits for the disk.
+     *          If the writer falls behind, the queue drops new datagrams and counts them.
+     */
+    class FlightRecorder
+    {
+    public:
+        FlightRecorder(std::string filePath, std::size_t chunkSize = 1 << 20, std::size_t queueCapacity = 4096);
+        ~FlightRecorder();
+
+        /// Delete copy constructor, the writer thread references the recorder
+        FlightRecorder(const FlightRecorder &) = delete;
+        /// Delete assign operator, the writer thread references the recorder
+        FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+        bool Start();
+        void Stop();
+
+        /**
+         * @brief Queues a datagram for recording
+         * @details Never blocks, can be called from any receive thread.
+         * @param datagram The received datagram
+         * @return True if queued, False if the queue is full or the recorder is not running
+         */
+        bool Record(const Datagram &datagram) { return m_running.load(std::memory_order_relaxed) && m_queue.Push(datagram); }
+
+        /// @brief Path of the recording file
+        const std::string &FilePath() const { return m_filePath; }
+        /// @brief Number of recorded datagrams
+        uint64_t RecordedCount() const { return m_recordedCount.load(std::memory_order_relaxed); }
+        /// @brief Number of datagrams dropped because the writer fell behind
+        uint64_t DroppedCount() const { return m_queue.DroppedCount(); }
+        /// @brief Number of bytes written into chunks
+        uint64_t BytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+
+    private:
+        /// Memory mapping of the current chunk
+        struct MappedChunk;
+
+        void run();
+        void writeRecord(const Datagram &datagram);
+        bool openChunk();
+        void closeChunk();
+        bool growFile(uint64_t minimumSize);
+
+        /// Path of the recording file
+        std::string m_filePath;
+        /// Size of every chunk
+        std::size_t m_chunkSize;
+        /// Datagrams waiting to be written
+        RingBuffer<Datagram> m_queue;
+        /// Writer thread
+        std::thread m_thread;
+        /// True while recording
+        std::atomic<bool> m_running{false};
+
+        /// Current chunk, only accessed by the writer thread
+        std::unique_ptr<MappedChunk> m_pChunk;
+        /// Sequence number of the current chunk
+        uint64_t m_chunkSequence = 0;
+        /// Current size of the (preallocated) file
+        uint64_t m_fileSize = 0;
+
+        /// Number of recorded datagrams
+        std::atomic<uint64_t> m_recordedCount{0};
+        /// Number of bytes written into chunks
+        std::atomic<uint64_t> m_bytesWritten{0};
+    };
+}
@@ -1,9 +1,14 @@
 #pragma once
 
+#include "DatagramPool.h"
 #include "Logger.h"
+#include "Metrics.h"
+#include "RingBuffer.h"
 
 #include <boost/asio.hpp>
 #include <functional>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 namespace aerolab::Core
@@ -11,26 +16,103 @@ namespace aerolab::Core
     class InputManager
     {
     public:
-        InputManager(boost::asio::any_io_executor exec, std::string, int port);
+        /// Callback receiving a pooled datagram handle, the handle may be kept without copying
+        using DatagramCallback = std::function<void(const Datagram &datagram)>;
+        /// Queue decoupling the receive threads from the consumers
+        using DatagramQueue = RingBuffer<Datagram>;
+
+        InputManager(boost::asio::io_context::executor_type exec, std::string, int port);
         ~InputManager();
 
         void Start();
         void Stop();
 
         /// @brief Sets the callback for received messages
+        /// @details The datagram is copied into a reused vector before the callback is called.
+        ///          With several shards the callback is called concurrently from the shards, see SetShardCount().
         /// @param callback The callback function to call on received messages
         void SetCallback(std::function<void(const std::vector<uint8_t> &datagram)> callback) { m_messageReceivedCallback = callback; }
 
+        /// @brief Sets the zero-copy callback for received messages
+        /// @details The callback receives a handle to the pooled receive buffer, see Datagram::Span().
+        ///          With several shards the callback is called concurrently from the shards, see SetShardCount().
+        /// @param callback The callback function to call on received messages
+        void SetCallback(DatagramCallback callback) { m_datagramCallback = callback; }
+
+        /// @brief Sets the queue received datagrams are pushed into
+        /// @details Consumers pop the datagrams in batches on their own threads, so a slow consumer
+        ///          never stalls the socket. What happens on a full queue is defined by its overflow policy.
+        ///          The queue is filled before the callbacks are called. Has to be set before Start().
+        /// @param pQueue The queue to push into, nullptr to disable
+        void SetQueue(std::shared_ptr<DatagramQueue> pQueue) { m_pQueue = std::move(pQueue); }
+
+        /// @brief Enables the batched receive mode
+        /// @details On Linux the socket is drained with recvmmsg, up to maxBatch datagrams per syscall,
+        ///          and every datagram carries its SO_TIMESTAMPNS kernel receive timestamp.
+        ///          Has to be set before Start(). Not supported on other platforms.
+        /// @param maxBatch Maximum number of datagrams per syscall, 0 or 1 disables batching
+        void SetBatchReceive(std::size_t maxBatch) { m_maxBatch = maxBatch; }
+
+        /// @brief Sets the kernel receive buffer size (SO_RCVBUF) applied on Start()
+        /// @param bytes Requested buffer size in bytes, 0 keeps the system default
+        void SetReceiveBufferSize(int bytes) { m_receiveBufferSize = bytes; }
+
+        /// @brief Sets the number of ingest shards
+        /// @details On Linux every shard opens its own socket bound with SO_REUSEPORT to the local endpoint
+        ///          and receives on its own strand, so the shards run in parallel on a multi-threaded executor.
+        ///          The kernel distributes datagrams by source address, so all datagrams of one source
+        ///          are received by the same shard and reach the callbacks in order.
+        ///          Has to be set before Start(). Other platforms always use a single socket.
+        /// @param shardCount Number of sockets to open
+        void SetShardCount(std::size_t shardCount) { m_shardCount = shardCount; }
+
+        /// @brief The pool the receive buffers are taken from
+        const std::shared_ptr<DatagramPool> &GetDatagramPool() const { return m_pDatagramPool; }
+
     private:
-        void receiveData();
+        /// Socket and receive state of a single ingest shard
+        struct Shard;
+
+        bool openShard(Shard &shard, bool reusePort);
+        void receiveData(Shard &shard);
+        void receiveBatch(Shard &shard);
+        void drainBatch(Shard &shard);
+        void handleDatagram(Shard &shard, const Datagram &datagram);
 
         /// Callback function for received messages
         std::function<void(const std::vector<uint8_t> &datagram)> m_messageReceivedCallback;
-        /// IO Executor for async operations
-        boost::asio::any_io_executor m_ioExecutor;
-        /// UDP input socket
-        boost::asio::ip::udp::socket m_socket;
+        /// Zero-copy callback function for received messages
+        DatagramCallback m_datagramCallback;
+        /// Queue the received datagrams are pushed into
+        std::shared_ptr<DatagramQueue> m_pQueue;
+        /// Pool of preallocated receive buffers
+        std::shared_ptr<DatagramPool> m_pDatagramPool;
+        /// IO Executor for async operations, not type-erased since a strand wrapped in any_io_executor allocates per handler
+        boost::asio::io_context::executor_type m_ioExecutor;
+        /// Ingest shards, each owning a UDP input socket, shared with their pending handlers
+        std::vector<std::shared_ptr<Shard>> m_shards;
         /// Local endpoint for binding the socket
         boost::asio::ip::udp::endpoint m_localEndpoint;
+        /// Maximum number of datagrams per batched receive
+        std::size_t m_maxBatch = 0;
+        /// Requested SO_RCVBUF size, 0 for system default
+        int m_receiveBufferSize = 0;
+        /// Number of ingest shards opened on Start()
+        std::size_t m_shardCount = 1;
+
+        /// Registry of the metrics below, labeled with the local port
+        std::shared_ptr<MetricsRegistry> m_pMetrics;
+        /// Received datagrams
+        MetricCounter *m_pDatagramCounter = nullptr;
+        /// Received payload bytes
+        MetricCounter *m_pByteCounter = nullptr;
+        /// Failed receive calls
+        MetricCounter *m_pErrorCounter = nullptr;
+        /// Datagrams the full queue refused
+        MetricCounter *m_pQueueDropCounter = nullptr;
+        /// Datagrams waiting in the queue after the last push
+        MetricGauge *m_pQueueDepthGauge = nullptr;
+        /// Time spent in the callbacks per datagram
+        MetricHistogram *m_pCallbackHistogram = nullptr;
     };
-}
\ No newline at end of file
+}
@@ -1,28 +1,54 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <Logger.h>
+#include <Metrics.h>
 #include <memory>
 #include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
-#include <sstream>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace aerolab::Core
 {
 
+template <typename T>
+class ConfigParam;
+
 /**
  * @brief The JsonConfig Class
  * @details This class provides functions to handle config parameters from a json config file.
  *          Parameters can be read and written as well as saved to the config file
+ *          The config is held as an immutable snapshot. Readers take the current snapshot without locking,
+ *          writers and reloads copy it, apply their change and publish the copy as the new snapshot.
+ *          Subscribers are notified about every changed path below the path they subscribed to.
  * @note This class uses the nlohmann json lib for handling json files.
  */
 class JsonConfig
 {
 public:
+    /// Immutable state of the config
+    using Snapshot = std::shared_ptr<const nlohmann::json>;
+    /// Callback receiving the changed path, formatted like the parameter paths ("node/.../parameter")
+    using ChangeCallback = std::function<void(const std::string &changedPath)>;
+
     static std::shared_ptr<JsonConfig> GetInstance();
     static void Init(const std::string &configFilePath = "");
 
+    /**
+     * @brief The current snapshot of the config
+     * @details The snapshot never changes, it stays valid as long as it is referenced.
+     * @return The current snapshot
+     */
+    Snapshot GetSnapshot() const { return m_snapshot.load(std::memory_order_acquire); }
+
     /**
      * @brief Get the parameter at the given path
      * @param parameterPath The path to the parameter
@@ -32,31 +58,50 @@ public:
     template <typename T>
     T GetParameter(const std::string &parameterPath) const
     {
-        using json = nlohmann::json;
+        const Snapshot pSnapshot = GetSnapshot();
+        const nlohmann::json *pNode = findNode(*pSnapshot, splitPath(parameterPath));
+        if (!pNode)
+            throw std::runtime_error("Could not find config parameter with path: " + parameterPath);
 
-        LOG_DEBUG("Retrieving Parameter: " + parameterPath);
-
-        // Split path to parameter
-        std::vector<std::string> parts = splitPath(parameterPath);
-
-        // Get json from member
-        const json *pNode = &m_json;
-
-        // Iterate through split parameter path
-        for (const auto &key : parts)
-        {
-            if (!pNode->contains(key))
-                throw std::runtime_error("Could not find config parameter with path: " + parameterPath);
+        return pNode->get<T>();
+    }
 
-            pNode = &((*pNode)[key]);
-        }
+    /**
+     * @brief Resolves the parameter at the given path into a typed handle
+     * @details The handle keeps the converted value and only converts it again after the config changed,
+     *          so reading it in a hot loop costs a single atomic load. See ConfigParam.
+     * @param parameterPath The path to the parameter
+     * @return The handle of the parameter
+     * @throws std::runtime_error if the parameter is not found.
+     */
+    template <typename T>
+    ConfigParam<T> GetParameterHandle(const std::string &parameterPath) const
+    {
+        return ConfigParam<T>(*this, parameterPath);
+    }
 
-        return pNode->get<T>();
+    /**
+     * @brief Resolves the optional parameter at the given path into a typed handle
+     * @param parameterPath The path to the parameter
+     * @param defaultValue Value used while the parameter is not in the config
+     * @return The handle of the parameter
+     */
+    template <typename T>
+    ConfigParam<T> GetParameterHandle(const std::string &parameterPath, T defaultValue) const
+    {
+        return ConfigParam<T>(*this, parameterPath, std::move(defaultValue));
     }
 
+    /**
+     * @brief Version of the config, incremented on every change
+     * @return The current version
+     */
+    uint64_t Version() const { return m_version.load(std::memory_order_acquire); }
+
     /**
      * @brief Set the given parameter at the given path
      * @details This function sets the given parameter in the member variable. To write the config to the file use SaveConfig.
+     *          Publishes a new snapshot and notifies the subscribers of the path, nothing happens if the value is unchanged.
      * @param parameterPath The path to the parameter to set
      * @param value The value of the parameter to set
      */
@@ -67,51 +112,264 @@ public:
 
         // Split path to parameter
         const auto parts = splitPath(parameterPath);
+        if (parts.empty())
+            return;
 
-        // Get json from member
-        json *pNode = &m_json;
-
-        // Navigate to the given path
-        for (size_t i = 0; i < parts.size(); i++)
         {
-            const auto &key = parts[i];
+            std::lock_guard<std::mutex> guard(m_writeMutex);
 
-            // If last element -> Set Value
-            if (i == parts.size() - 1)
-                (*pNode)[key] = value;
-            else // Node -> add object if it does not exist yet
+            // Copy of the current snapshot
+            auto pJson = std::make_shared<json>(*GetSnapshot());
+            json *pNode = pJson.get();
+
+            // Navigate to the given path
+            for (size_t i = 0; i < parts.size(); i++)
             {
-                if (!pNode->contains(key) || !(*pNode)[key].is_object())
-                    (*pNode)[key] = json::object();
+                const auto &key = parts[i];
+
+                // If last element -> Set Value
+                if (i == parts.size() - 1)
+                {
+                    json newValue = value;
+                    const auto it = pNode->find(key);
+                    if (it != pNode->end() && *it == newValue)
+                        return;
 
-                // Next node
-                pNode = &((*pNode)[key]);
+                    (*pNode)[key] = std::move(newValue);
+                }
+                else // Node -> add object if it does not exist yet
+                {
+                    if (!pNode->contains(key) || !(*pNode)[key].is_object())
+                        (*pNode)[key] = json::object();
+
+                    // Next node
+                    pNode = &((*pNode)[key]);
+                }
             }
+
+            publish(std::move(pJson));
         }
+
+        notifySubscribers({joinPath(parts)});
+
+        if (m_autoSave.load(std::memory_order_relaxed))
+            SaveJsonAsync();
     }
 
+    bool Reload();
+
+    uint64_t Subscribe(const std::string &parameterPath, ChangeCallback callback);
+    void Unsubscribe(uint64_t subscriptionId);
+
+    void StartWatching();
+    void StopWatching();
+
     bool SaveJson();
+    std::shared_future<bool> SaveJsonAsync(std::function<void(bool saved)> onSaved = {});
+
+    /**
+     * @brief Sets the time SaveJsonAsync() waits for further changes before writing
+     * @param delay The debounce delay
+     */
+    void SetSaveDelay(std::chrono::milliseconds delay) { m_saveDelayMs.store(delay.count(), std::memory_order_relaxed); }
 
-    /// Default destructor
-    ~JsonConfig() = default;
+    /**
+     * @brief Enables saving the config asynchronously after every WriteParameter()
+     * @param enabled True to save automatically
+     */
+    void SetAutoSave(bool enabled) { m_autoSave.store(enabled, std::memory_order_relaxed); }
+
+    ~JsonConfig();
     /// Delete copy constructor to ensure singleton pattern
     JsonConfig(const JsonConfig &) = delete;
     /// Delete assign operator to ensure singleton pattern
     JsonConfig &operator=(const JsonConfig &) = delete;
 
 private:
+    template <typename T>
+    friend class ConfigParam;
+
     JsonConfig(const std::string &configFilePath);
 
-    static std::vector<std::string> splitPath(const std::string &parameterPath);
+    /// A registered change callback
+    struct Subscription
+    {
+        uint64_t id;
+        std::vector<std::string> keys;
+        ChangeCallback callback;
+    };
+
+    static std::vector<std::string> splitPath(std::string_view parameterPath);
+    static std::string joinPath(const std::vector<std::string> &keys);
+    static const nlohmann::json *findNode(const nlohmann::json &root, const std::vector<std::string> &keys);
+
+    void publish(std::shared_ptr<const nlohmann::json> pJson);
+    void notifySubscribers(const std::vector<std::string> &changedPaths);
+    void watchFile();
+    bool watchInotify(const std::string &fileName, const std::string &directory);
+    void pollFile();
+    bool writeSnapshot(const Snapshot &pSnapshot);
+    void runSaver();
+    void stopSaver();
 
     /// Path to the config file
     std::string m_configFilePath;
-    /// Internal representation of the config file
-    nlohmann::json m_json;
+    /// Current snapshot of the config file
+    std::atomic<std::shared_ptr<const nlohmann::json>> m_snapshot;
+    /// Incremented after every published snapshot
+    std::atomic<uint64_t> m_version{0};
+    /// Serializes the writers, readers never lock
+    std::mutex m_writeMutex;
+
+    /// Registered change callbacks
+    std::vector<Subscription> m_subscriptions;
+    /// Id of the next subscription
+    uint64_t m_nextSubscriptionId = 1;
+    /// Mutex for the subscriptions
+    std::mutex m_subscriptionMutex;
+
+    /// Thread watching the config file for changes
+    std::thread m_watchThread;
+    /// Cleared to stop the watch thread
+    std::atomic<bool> m_watching{false};
+
+    /// Thread writing the asynchronous saves
+    std::thread m_saveThread;
+    /// Mutex for the asynchronous save state
+    std::mutex m_saveMutex;
+    /// Signaled on new save requests and on stop
+    std::condition_variable m_saveCondition;
+    /// A save has been requested and not been written yet
+    bool m_savePending = false;
+    /// Cleared to stop the save thread
+    bool m_saverRunning = false;
+    /// Earliest time of the pending save, moved back by every request
+    std::chrono::steady_clock::time_point m_saveDeadline;
+    /// Promise of the pending save, shared by all coalesced requests
+    std::promise<bool> m_savePromise;
+    /// Future of the pending save
+    std::shared_future<bool> m_saveFuture;
+    /// Completion callbacks of the pending save
+    std::vector<std::function<void(bool)>> m_saveCallbacks;
+    /// Debounce delay of the asynchronous saves
+    std::atomic<int64_t> m_saveDelayMs{200};
+    /// Save after every WriteParameter()
+    std::atomic<bool> m_autoSave{false};
+    /// Snapshot last written to the file, the next reload of this content is our own save. Cleared by the next reload
+    Snapshot m_pSavedSnapshot;
+    /// Serializes the file writes and guards m_pSavedSnapshot
+    std::mutex m_fileMutex;
+
+    /// Registry of the metrics below
+    std::shared_ptr<MetricsRegistry> m_pMetrics;
+    /// Reloads which changed the snapshot
+    MetricCounter *m_pReloadCounter = nullptr;
+    /// Reloads of files which could not be read or parsed
+    MetricCounter *m_pReloadErrorCounter = nullptr;
+    /// Written config files
+    MetricCounter *m_pSaveCounter = nullptr;
+    /// Failed writes of the config file
+    MetricCounter *m_pSaveErrorCounter = nullptr;
+    /// Duration of the successful writes including the sync to the disk
+    MetricHistogram *m_pSaveHistogram = nullptr;
     /// once flag for init function
     static std::once_flag s_once;
     /// singleton instance
     static std::shared_ptr<JsonConfig> s_instance;
 };
 
-}
\ No newline at end of file
+/**
+ * @brief The ConfigParam class
+ * @details Typed handle of a single config parameter. The path is split once on construction and the
+ *          converted value is cached. A read only compares the version of the config with the version
+ *          of the cached value, the json is only walked again after the config changed.
+ *          Reloads of the config file refresh the value as well.
+ * @note A handle must not be shared between threads, every thread creates its own handle.
+ *       The JsonConfig must outlive the handle.
+ */
+template <typename T>
+class ConfigParam
+{
+public:
+    /**
+     * @brief Constructor of a required parameter
+     * @param config The config the parameter is read from
+     * @param parameterPath The path to the parameter
+     * @throws std::runtime_error if the parameter is not found.
+     */
+    ConfigParam(const JsonConfig &config, const std::string &parameterPath)
+        : m_pConfig(&config),
+          m_path(parameterPath),
+          m_keys(JsonConfig::splitPath(parameterPath))
+    {
+        refresh(m_pConfig->Version());
+    }
+
+    /**
+     * @brief Constructor of an optional parameter
+     * @param config The config the parameter is read from
+     * @param parameterPath The path to the parameter
+     * @param defaultValue Value used while the parameter is not in the config
+     */
+    ConfigParam(const JsonConfig &config, const std::string &parameterPath, T defaultValue)
+        : m_pConfig(&config),
+          m_path(parameterPath),
+          m_keys(JsonConfig::splitPath(parameterPath)),
+          m_defaultValue(std::move(defaultValue)),
+          m_hasDefault(true)
+    {
+        refresh(m_pConfig->Version());
+    }
+
+    /**
+     * @brief Current value of the parameter
+     * @return The cached value, converted again if the config changed since the last read
+     * @throws std::runtime_error if a required parameter has been removed from the config.
+     */
+    const T &Get() const
+    {
+        const uint64_t version = m_pConfig->Version();
+        if (version != m_version)
+            refresh(version);
+        return m_value;
+    }
+
+    /// @brief Current value of the parameter, see Get()
+    const T &operator*() const { return Get(); }
+
+    /// @brief Path of the parameter
+    const std::string &Path() const { return m_path; }
+
+private:
+    /// @brief Converts the value from the config
+    void refresh(uint64_t version) const
+    {
+        const JsonConfig::Snapshot pSnapshot = m_pConfig->GetSnapshot();
+        const nlohmann::json *pNode = JsonConfig::findNode(*pSnapshot, m_keys);
+        if (pNode)
+            m_value = pNode->get<T>();
+        else if (m_hasDefault)
+            m_value = m_defaultValue;
+        else
+            throw std::runtime_error("Could not find config parameter with path: " + m_path);
+
+        m_version = version;
+    }
+
+    /// Config the parameter is read from
+    const JsonConfig *m_pConfig;
+    /// Path to the parameter
+    std::string m_path;
+    /// Keys of the path
+    std::vector<std::string> m_keys;
+    /// Value used while the parameter is not in the config
+    T m_defaultValue{};
+    /// True for optional parameters
+    bool m_hasDefault = false;
+    /// Cached value
+    mutable T m_value{};
+    /// Config version of the cached value
+    mutable uint64_t m_version = 0;
+};
+
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+namespace aerolab::Core
+{
+    /**
+     * @brief The LatencyHistogram class
+     * @details Log-linear histogram of unsigned values, e.g. latencies in nanoseconds.
+     *          Every power of two is split into 32 linear sub buckets, so every recorded value is
+     *          represented with a relative error below 3.2% over the full 64 bit range,
+     *          while recording is a few bit operations without any allocation.
+     * @note Not thread-safe, use one histogram per thread and Merge() them for reporting.
+     */
+    class LatencyHistogram
+    {
+    public:
+        /// Number of linear sub buckets per power of two
+        static constexpr uint32_t SUB_BUCKETS = 32;
+        /// Number of bits of SUB_BUCKETS
+        static constexpr uint32_t SUB_BUCKET_BITS = 5;
+        /// Total number of buckets covering the 64 bit range, the values below 2 * SUB_BUCKETS take two rows
+        static constexpr std::size_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+        /// @brief Records a single value
+        void Record(uint64_t value)
+        {
+            m_buckets[bucketIndex(value)]++;
+            m_count++;
+            m_sum += value;
+            m_min = std::min(m_min, value);
+            m_max = std::max(m_max, value);
+        }
+
+        /// @brief Adds all values recorded by another histogram
+        void Merge(const LatencyHistogram &other)
+        {
+            for (std::size_t i = 0; i < BUCKET_COUNT; i++)
+                m_buckets[i] += other.m_buckets[i];
+            m_count += other.m_count;
+            m_sum += other.m_sum;
+            m_min = std::min(m_min, other.m_min);
+            m_max = std::max(m_max, other.m_max);
+        }
+
+        /// @brief Removes all recorded values
+        void Reset() { *this = LatencyHistogram(); }
+
+        /// @brief Number of recorded values
+        uint64_t Count() const { return m_count; }
+        /// @brief Smallest recorded value, 0 if empty
+        uint64_t Min() const { return m_count > 0 ? m_min : 0; }
+        /// @brief Largest recorded value
+        uint64_t Max() const { return m_max; }
+        /// @brief Mean of the recorded values, 0 if empty
+        double Mean() const { return m_count > 0 ? static_cast<double>(m_sum) / static_cast<double>(m_count) : 0.0; }
+
+        /**
+         * @brief Value below which the given share of the recorded values lies
+         * @param percentile Percentile in the range 0..100, e.g. 99.9
+         * @return Upper bound of the bucket containing the percentile, clamped to the recorded range
+         */
+        uint64_t Percentile(double percentile) const
+        {
+            if (m_count == 0)
+                return 0;
+
+            const double clamped = std::clamp(percentile, 0.0, 100.0);
+            const auto target = std::max<uint64_t>(1, static_cast<uint64_t>(clamped / 100.0 * static_cast<double>(m_count) + 0.5));
+
+            uint64_t seen = 0;
+            for (std::size_t i = 0; i < BUCKET_COUNT; i++)
+            {
+                seen += m_buckets[i];
+                if (seen >= target)
+                    return std::clamp(bucketUpperBound(i), Min(), m_max);
+            }
+            return m_max;
+        }
+
+    private:
+        static std::size_t bucketIndex(uint64_t value)
+        {
+            static_assert(static_cast<std::size_t>(64 - SUB_BUCKET_BITS) * SUB_BUCKETS + SUB_BUCKETS - 1 < BUCKET_COUNT,
+                          "The largest value needs a bucket");
+            if (value < 2 * SUB_BUCKETS)
+                return static_cast<std::size_t>(value);
+
+            const uint32_t shift = static_cast<uint32_t>(std::bit_width(value)) - SUB_BUCKET_BITS - 1;
+            return static_cast<std::size_t>(shift + 1) * SUB_BUCKETS + static_cast<std::size_t>((value >> shift) - SUB_BUCKETS);
+        }
+
+        static uint64_t bucketUpperBound(std::size_t index)
+        {
+            if (index < 2 * SUB_BUCKETS)
+                return index;
+
+            const auto shift = static_cast<uint32_t>(index / SUB_BUCKETS - 1);
+            const uint64_t lower = static_cast<uint64_t>(index % SUB_BUCKETS + SUB_BUCKETS) << shift;
+            return lower + ((uint64_t{1} << shift) - 1);
+        }
+
+        /// Number of values per bucket
+        std::array<uint64_t, BUCKET_COUNT> m_buckets{};
+        /// Number of recorded values
+        uint64_t m_count = 0;
+        /// Sum of the recorded values
+        uint64_t m_sum = 0;
+        /// Smallest recorded value
+        uint64_t m_min = std::numeric_limits<uint64_t>::max();
+        /// Largest recorded value
+        uint64_t m_max = 0;
+    };
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace aerolab::Core
+{
+    namespace Detail
+    {
+        /// @brief Appends a single log argument to the message
+        template <typename T>
+        void AppendLogArgument(std::string &out, const T &value)
+        {
+            if constexpr (std::is_same_v<T, bool>)
+            {
+                out += value ? "true" : "false";
+            }
+            else if constexpr (std::is_same_v<T, char>)
+            {
+                out += value;
+            }
+            else if constexpr (std::is_arithmetic_v<T>)
+            {
+                char buffer[64];
+                const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                out.append(buffer, result.ptr);
+            }
+            else if constexpr (std::is_convertible_v<const T &, std::string_view>)
+            {
+                out += std::string_view(value);
+            }
+            else if constexpr (std::is_enum_v<T>)
+            {
+                AppendLogArgument(out, static_cast<std::underlying_type_t<T>>(value));
+            }
+            else
+            {
+                // Anything else which can be streamed, e.g. endpoints and addresses
+                std::ostringstream stream;
+                stream << value;
+                out += stream.str();
+            }
+        }
+
+        /// @brief Appends a null-terminated string, nullptr is written as "(null)"
+        inline void AppendLogArgument(std::string &out, const char *value)
+        {
+            out += value ? value : "(null)";
+        }
+    }
+
+    /**
+     * @brief Formats a log message
+     * @details Every "{}" in the format string is replaced by the next argument. Surplus arguments
+     *          are ignored, surplus placeholders are kept. Numbers are converted with std::to_chars,
+     *          other types are streamed.
+     * @param format The format string
+     * @param args The arguments
+     * @return The formatted message
+     */
+    template <typename... Args>
+    std::string FormatLog(std::string_view format, const Args &...args)
+    {
+        std::string out;
+        out.reserve(format.size() + 16 * sizeof...(Args));
+
+        std::size_t position = 0;
+        const auto appendNext = [&](const auto &arg)
+        {
+            const std::size_t placeholder = format.find("{}", position);
+            if (placeholder == std::string_view::npos)
+                return;
+
+            out.append(format.substr(position, placeholder - position));
+            Detail::AppendLogArgument(out, arg);
+            position = placeholder + 2;
+        };
+        (appendNext(args), ...);
+
+        out.append(format.substr(position));
+        return out;
+    }
+
+    /**
+     * @brief The LogRateLimiter class
+     * @details Limits a single log call site to one message per interval. The rate limited macros
+     *          (e.g. LOG_WARNING_LIMITED) keep one static limiter per call site.
+     */
+    class LogRateLimiter
+    {
+    public:
+        explicit LogRateLimiter(std::chrono::milliseconds interval) : m_intervalNs(std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count()) {}
+
+        /**
+         * @brief Checks if the call site may log now
+         * @param suppressed Receives the number of messages suppressed since the last allowed one
+         * @return True if the message should be logged
+         */
+        bool Allow(uint64_t &suppressed)
+        {
+            const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            int64_t next = m_nextAllowedNs.load(std::memory_order_relaxed);
+
+            if (now < next || !m_nextAllowedNs.compare_exchange_strong(next, now + m_intervalNs, std::memory_order_relaxed))
+            {
+                m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+
+        /// @brief Appends the number of suppressed messages to a message
+        static std::string Annotate(std::string message, uint64_t suppressed)
+        {
+            if (suppressed > 0)
+                message += " (" + std::to_string(suppressed) + " similar messages suppressed)";
+            return message;
+        }
+
+    private:
+        /// Minimum time between two messages
+        const int64_t m_intervalNs;
+        /// Earliest time of the next message
+        std::atomic<int64_t> m_nextAllowedNs{0};
+        /// Messages suppressed since the last allowed one
+        std::atomic<uint64_t> m_suppressed{0};
+    };
+}
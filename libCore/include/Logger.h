@@ -1,7 +1,18 @@
 #pragma once
 
+#include "LogFormat.h"
+#include "Metrics.h"
+#include "RingBuffer.h"
+#include "core_export.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
+#ifdef _WIN32
 #include <direct.h>
+#endif
 #include <fstream>
 #include <iostream>
 #include <filesystem>
@@ -9,15 +20,68 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 
 namespace aerolab::Core
 {
 
+/**
+ * Compile-time minimum log level, messages above it are removed by the compiler.
+ * 0 = Error, 1 = Warning, 2 = Info, 3 = Debug. Release builds (NDEBUG) drop debug messages by default.
+ */
+#ifndef AEROLAB_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define AEROLAB_LOG_MIN_LEVEL 2
+#else
+#define AEROLAB_LOG_MIN_LEVEL 3
+#endif
+#endif
+
+// The level is checked before the message is evaluated, so disabled messages cost a single atomic load
+#define AEROLAB_LOG(level, function, message)                                                                    \
+    do                                                                                                           \
+    {                                                                                                            \
+        if constexpr (static_cast<int>(level) <= AEROLAB_LOG_MIN_LEVEL)                                          \
+        {                                                                                                        \
+            if (::aerolab::Core::Logger::IsEnabled(level))                                                       \
+                ::aerolab::Core::Logger::GetInstance()->function(message, __FILE__, __LINE__, __func__);         \
+        }                                                                                                        \
+    } while (0)
+
+// Logs at most one message per interval for the call site, the number of suppressed messages is appended
+#define AEROLAB_LOG_LIMITED(level, function, intervalMs, message)                                                \
+    do                                                                                                           \
+    {                                                                                                            \
+        if constexpr (static_cast<int>(level) <= AEROLAB_LOG_MIN_LEVEL)                                          \
+        {                                                                                                        \
+            static ::aerolab::Core::LogRateLimiter s_logRateLimiter{std::chrono::milliseconds(intervalMs)};      \
+            uint64_t logSuppressed = 0;                                                                          \
+            if (::aerolab::Core::Logger::IsEnabled(level) && s_logRateLimiter.Allow(logSuppressed))              \
+                ::aerolab::Core::Logger::GetInstance()->function(                                                \
+                    ::aerolab::Core::LogRateLimiter::Annotate(message, logSuppressed), __FILE__, __LINE__, __func__); \
+        }                                                                                                        \
+    } while (0)
+
+// True if a level is enabled at compile time and at runtime, e.g. to skip preparing expensive messages
+#define LOG_ENABLED(level) (static_cast<int>(level) <= AEROLAB_LOG_MIN_LEVEL && ::aerolab::Core::Logger::IsEnabled(level))
+
 #define LOG_INIT(filename) ::aerolab::Core::Logger::Init(filename)
-#define LOG_ERROR(message) ::aerolab::Core::Logger::GetInstance()->logError(message, __FILE__, __LINE__, __func__)
-#define LOG_WARNING(message) ::aerolab::Core::Logger::GetInstance()->logWarning(message, __FILE__, __LINE__, __func__)
-#define LOG_INFO(message) ::aerolab::Core::Logger::GetInstance()->logInfo(message, __FILE__, __LINE__, __func__)
-#define LOG_DEBUG(message) ::aerolab::Core::Logger::GetInstance()->logDebug(message, __FILE__, __LINE__, __func__)
+#define LOG_ERROR(message) AEROLAB_LOG(::aerolab::Core::E_LogLevel::Error, logError, message)
+#define LOG_WARNING(message) AEROLAB_LOG(::aerolab::Core::E_LogLevel::Warning, logWarning, message)
+#define LOG_INFO(message) AEROLAB_LOG(::aerolab::Core::E_LogLevel::Info, logInfo, message)
+#define LOG_DEBUG(message) AEROLAB_LOG(::aerolab::Core::E_LogLevel::Debug, logDebug, message)
+
+// Formatting variants, every "{}" is replaced by the next argument (see FormatLog())
+#define LOG_ERROR_F(format, ...) LOG_ERROR(::aerolab::Core::FormatLog(format, __VA_ARGS__))
+#define LOG_WARNING_F(format, ...) LOG_WARNING(::aerolab::Core::FormatLog(format, __VA_ARGS__))
+#define LOG_INFO_F(format, ...) LOG_INFO(::aerolab::Core::FormatLog(format, __VA_ARGS__))
+#define LOG_DEBUG_F(format, ...) LOG_DEBUG(::aerolab::Core::FormatLog(format, __VA_ARGS__))
+
+// Rate limited variants for hot paths
+#define LOG_ERROR_LIMITED(intervalMs, message) AEROLAB_LOG_LIMITED(::aerolab::Core::E_LogLevel::Error, logError, intervalMs, message)
+#define LOG_WARNING_LIMITED(intervalMs, message) AEROLAB_LOG_LIMITED(::aerolab::Core::E_LogLevel::Warning, logWarning, intervalMs, message)
+#define LOG_INFO_LIMITED(intervalMs, message) AEROLAB_LOG_LIMITED(::aerolab::Core::E_LogLevel::Info, logInfo, intervalMs, message)
+#define LOG_DEBUG_LIMITED(intervalMs, message) AEROLAB_LOG_LIMITED(::aerolab::Core::E_LogLevel::Debug, logDebug, intervalMs, message)
 
     /// Enum for Log Le
     enum class E_LogLevel
@@ -32,10 +96,32 @@ namespace aerolab::Core
         Debug = 3
     };
 
+    /// A log message waiting for the writer thread of the asynchronous mode
+    struct LogRecord
+    {
+        /// Level of the message
+        E_LogLevel level = E_LogLevel::Info;
+        /// Time the message was logged
+        std::chrono::system_clock::time_point time;
+        /// Source file, points to a string literal
+        const char *file = "";
+        /// Source line
+        int line = 0;
+        /// Function name, points to a string literal
+        const char *func = "";
+        /// The message
+        std::string message;
+        /// Set by the writer once the record is flushed, shared with the waiting caller, nullptr if nobody waits for it
+        std::shared_ptr<std::atomic<bool>> pFlushed;
+    };
+
     /**
      * @brief The Logger class
      * @details This class provides logging functionalities
      * it is implemented as a singleton to encure a single instance throughout the application.
+     * By default every message is formatted and written by the calling thread. In the asynchronous
+     * mode (see SetAsync()) callers only queue a record and a writer thread formats and writes
+     * the records in batches.
      */
     class Logger
     {
@@ -43,6 +129,8 @@ namespace aerolab::Core
         static void Init(const std::string& fileName);
         static std::shared_ptr<Logger> GetInstance();
 
+        ~Logger();
+
         /// Delete copy constructor to ensure singleton instance management
         Logger(const Logger &) = delete;
         /// Delete assign operator to ensure singleton instance management
@@ -52,7 +140,38 @@ namespace aerolab::Core
          * @brief Sets the Log Level for the Logger class
          * @param loglevel Log level to be set
          */
-        void SetLogLevel(E_LogLevel logLevel) { m_logLevel = logLevel; }
+        void SetLogLevel(E_LogLevel logLevel) { s_logLevel.store(static_cast<int>(logLevel), std::memory_order_relaxed); }
+
+        /**
+         * @brief Checks if messages of a level are logged at runtime
+         * @details Used by the LOG_* macros before the message is evaluated.
+         *          Use LOG_ENABLED() to include the compile-time minimum level.
+         * @param level The level of the message
+         * @return True if the level is enabled
+         */
+        static bool IsEnabled(E_LogLevel level) { return static_cast<int>(level) <= s_logLevel.load(std::memory_order_relaxed); }
+
+        void SetAsync(bool enabled, std::size_t queueCapacity = 8192, E_OverflowPolicy overflowPolicy = E_OverflowPolicy::DropNewest);
+        /// @brief True if messages are written by the writer thread
+        bool IsAsync() const { return m_async.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Sets the interval the writer thread flushes the streams in the asynchronous mode
+         * @details Has to be set before SetAsync().
+         * @param interval The flush interval
+         */
+        void SetFlushInterval(std::chrono::milliseconds interval) { m_flushInterval = interval; }
+
+        /**
+         * @brief Enables or disables the colored terminal output, the log file is always written
+         * @param enabled True to write to the terminal
+         */
+        void SetConsoleOutput(bool enabled) { m_consoleOutput = enabled; }
+
+        void Flush();
+
+        /// @brief Number of messages dropped because the queue of the asynchronous mode was full
+        uint64_t DroppedCount() const { return m_pQueue ? m_pQueue->DroppedCount() : 0; }
 
         void log(const std::string &type, const std::string &msg, const char *file, int line, const char *func, std::ostream &stream);
 
@@ -64,12 +183,45 @@ namespace aerolab::Core
     private:
         Logger(const std::string &filePath);
 
+        void enqueue(E_LogLevel level, const std::string &msg, const char *file, int line, const char *func);
+        void stopWriter();
+        void runWriter();
+        void writeLate();
+        bool pushWaiting(LogRecord &record);
+
         /// Filestream of the Log file
         std::ofstream m_fileStream;
-        /// LogLevel of the Logger
-        E_LogLevel m_logLevel;
         /// Mutex for threadsafe logging
         std::mutex m_mutex;
+        /// Write to the terminal as well
+        std::atomic<bool> m_consoleOutput{true};
+
+        /// Records are queued for the writer thread
+        std::atomic<bool> m_async{false};
+        /// Queue of the asynchronous mode, kept once created so late producers never see a dangling queue
+        std::unique_ptr<RingBuffer<LogRecord>> m_pQueue;
+        /// Writer thread of the asynchronous mode
+        std::thread m_writerThread;
+        /// Cleared to stop the writer thread
+        std::atomic<bool> m_writerRunning{false};
+        /// Producers between the check of m_writerRunning and their push, stopWriter() waits for them
+        std::atomic<int> m_activeProducers{0};
+        /// Interval the writer thread flushes the streams
+        std::chrono::milliseconds m_flushInterval{1000};
+        /// Mutex of the flush condition
+        std::mutex m_flushMutex;
+        /// Signaled by the writer thread after flushing records somebody waits for
+        std::condition_variable m_flushCondition;
+
+        /// Registry of the counters, kept alive until the last message has been logged
+        std::shared_ptr<MetricsRegistry> m_pMetrics;
+        /// Logged messages per level, indexed by E_LogLevel
+        std::array<MetricCounter *, 4> m_messageCounters{};
+        /// Messages dropped by the overflow policy of the asynchronous mode
+        MetricCounter *m_pDroppedCounter = nullptr;
+
+        /// LogLevel of the Logger, static so the macros can check it without fetching the instance
+        static CORE_EXPORT std::atomic<int> s_logLevel;
         /// singleton instance of the Logger
         static std::shared_ptr<Logger> s_instance;
         /// once flag for singleton instance
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "RingBuffer.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aerolab::Core
+{
+    /// Number of shards of the counters and histograms, threads are spread over them round robin
+    constexpr std::size_t METRIC_SHARDS = 16;
+    /// Maximum number of buckets of a histogram, without the +Inf bucket
+    constexpr std::size_t METRIC_MAX_BUCKETS = 24;
+
+    /**
+     * @brief Shard of the calling thread
+     * @details Assigned on the first call of every thread, so threads only share a shard if there are more
+     *          threads than shards. The index only spreads the load, any thread may use any shard.
+     */
+    inline std::size_t MetricShardIndex()
+    {
+        static std::atomic<std::size_t> s_nextShard{0};
+        thread_local const std::size_t shard = s_nextShard.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+        return shard;
+    }
+
+    /// Enum for the type of a metric
+    enum class E_MetricType
+    {
+        /// Monotonic count, e.g. received packets
+        Counter = 0,
+        /// Current value, e.g. a queue depth
+        Gauge = 1,
+        /// Distribution of values in fixed buckets, e.g. latencies
+        Histogram = 2
+    };
+
+    /**
+     * @brief The MetricCounter class
+     * @details Monotonic counter. Every thread increments its own cache line, so concurrent increments
+     *          never contend. An increment is a single relaxed atomic add.
+     */
+    class MetricCounter
+    {
+    public:
+        /// @brief Adds to the counter
+        void Inc(uint64_t count = 1) { m_shards[MetricShardIndex()].value.fetch_add(count, std::memory_order_relaxed); }
+
+        /// @brief Sum of all shards
+        uint64_t Value() const
+        {
+            uint64_t sum = 0;
+            for (const auto &shard : m_shards)
+                sum += shard.value.load(std::memory_order_relaxed);
+            return sum;
+        }
+
+    private:
+        /// Counter of a shard on its own cache line
+        struct alignas(CACHE_LINE_SIZE) Shard
+        {
+            std::atomic<uint64_t> value{0};
+        };
+
+        /// Shards of the counter
+        std::array<Shard, METRIC_SHARDS> m_shards;
+    };
+
+    /**
+     * @brief The MetricGauge class
+     * @details Current value, set by a single owner, e.g. the thread owning a queue.
+     */
+    class MetricGauge
+    {
+    public:
+        /// @brief Sets the value
+        void Set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+        /// @brief Adds to the value, negative to subtract
+        void Add(int64_t delta) { m_value.fetch_add(delta, std::memory_order_relaxed); }
+        /// @brief The current value
+        int64_t Value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        /// Current value
+        alignas(CACHE_LINE_SIZE) std::atomic<int64_t> m_value{0};
+    };
+
+    /// Point in time copy of a histogram
+    struct HistogramSnapshot
+    {
+        /// Upper bounds of the buckets (inclusive) in exported units
+        std::vector<double> bounds;
+        /// Cumulative number of values per bucket, the last entry is the +Inf bucket
+        std::vector<uint64_t> cumulativeCounts;
+        /// Number of recorded values
+        uint64_t count = 0;
+        /// Sum of the recorded values in exported units
+        double sum = 0.0;
+
+        double Quantile(double q) const;
+    };
+
+    /**
+     * @brief The MetricHistogram class
+     * @details Fixed bucket histogram like the Prometheus histogram type. Values are recorded as integers,
+     *          e.g. nanoseconds, and scaled to the exported unit when read, e.g. seconds.
+     *          Every thread records into its own shard, recording is a short bucket search and two relaxed atomic adds.
+     */
+    class MetricHistogram
+    {
+    public:
+        MetricHistogram(std::vector<uint64_t> upperBounds, double scale);
+
+        /// Delete copy constructor, instruments keep references
+        MetricHistogram(const MetricHistogram &) = delete;
+        /// Delete assign operator, instruments keep references
+        MetricHistogram &operator=(const MetricHistogram &) = delete;
+
+        /// @brief Records a value
+        void Observe(uint64_t value)
+        {
+            std::size_t bucket = 0;
+            while (bucket < m_bucketCount && value > m_upperBounds[bucket])
+                bucket++;
+
+            Shard &shard = m_pShards[MetricShardIndex()];
+            shard.counts[bucket].fetch_add(1, std::memory_order_relaxed);
+            shard.sum.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        /// @brief Records a duration in nanoseconds
+        void ObserveSince(std::chrono::steady_clock::time_point start)
+        {
+            Observe(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+        }
+
+        HistogramSnapshot Snapshot() const;
+
+        static std::vector<uint64_t> LatencyBoundsNs();
+
+    private:
+        /// Bucket counts of a shard, aligned so shards never share a cache line
+        struct alignas(CACHE_LINE_SIZE) Shard
+        {
+            std::array<std::atomic<uint64_t>, METRIC_MAX_BUCKETS + 1> counts{};
+            std::atomic<uint64_t> sum{0};
+        };
+
+        /// Upper bounds of the buckets
+        std::array<uint64_t, METRIC_MAX_BUCKETS> m_upperBounds{};
+        /// Number of used bounds
+        std::size_t m_bucketCount = 0;
+        /// Factor converting the recorded values into the exported unit
+        double m_scale;
+        /// Shards of the histogram
+        std::unique_ptr<Shard[]> m_pShards;
+    };
+
+    /// Point in time copy of a metric
+    struct MetricSnapshot
+    {
+        /// Name of the metric
+        std::string name;
+        /// Labels in the Prometheus form, e.g. level="error", may be empty
+        std::string labels;
+        /// Description of the metric
+        std::string help;
+        /// Type of the metric
+        E_MetricType type = E_MetricType::Counter;
+        /// Value of counters and gauges
+        double value = 0.0;
+        /// Buckets of histograms
+        HistogramSnapshot histogram;
+    };
+
+    /**
+     * @brief The MetricsRegistry class
+     * @details Owns all metrics of the process. Instruments look their metrics up once, e.g. in their constructor,
+     *          and keep the returned reference, the registry never removes a metric. Looking up an existing
+     *          name with the same labels returns the existing metric.
+     *          The registry can periodically write all metrics in the Prometheus text format to a file,
+     *          e.g. for the textfile collector of the node exporter.
+     *          It is implemented as a singleton, so instruments in any library share it.
+     */
+    class MetricsRegistry
+    {
+    public:
+        static std::shared_ptr<MetricsRegistry> GetInstance();
+
+        ~MetricsRegistry();
+
+        /// Delete copy constructor to ensure singleton instance management
+        MetricsRegistry(const MetricsRegistry &) = delete;
+        /// Delete assign operator to ensure singleton instance management
+        MetricsRegistry &operator=(const MetricsRegistry &) = delete;
+
+        MetricCounter &GetCounter(const std::string &name, const std::string &help, const std::string &labels = "");
+        MetricGauge &GetGauge(const std::string &name, const std::string &help, const std::string &labels = "");
+        MetricHistogram &GetHistogram(const std::string &name, const std::string &help, const std::string &labels = "",
+                                      std::vector<uint64_t> upperBounds = MetricHistogram::LatencyBoundsNs(), double scale = 1e-9);
+
+        std::vector<MetricSnapshot> Snapshot() const;
+        std::string FormatPrometheus() const;
+        bool WritePrometheus(const std::string &filePath) const;
+
+        void StartExport(const std::string &filePath, std::chrono::milliseconds interval);
+        void StopExport();
+
+    private:
+        MetricsRegistry() = default;
+
+        /// A registered metric
+        struct Entry
+        {
+            std::string name;
+            std::string labels;
+            std::string help;
+            E_MetricType type;
+            std::unique_ptr<MetricCounter> pCounter;
+            std::unique_ptr<MetricGauge> pGauge;
+            std::unique_ptr<MetricHistogram> pHistogram;
+        };
+
+        Entry &getOrAdd(const std::string &name, const std::string &help, const std::string &labels, E_MetricType type);
+        void runExport(std::string filePath, std::chrono::milliseconds interval);
+
+        /// Registered metrics by name and labels
+        std::map<std::pair<std::string, std::string>, Entry> m_entries;
+        /// Mutex for registering and reading the list of metrics, never taken while recording
+        mutable std::mutex m_mutex;
+
+        /// Thread writing the export file
+        std::thread m_exportThread;
+        /// Cleared to stop the export thread
+        bool m_exporting = false;
+        /// Mutex of the export state
+        std::mutex m_exportMutex;
+        /// Wakes the export thread on stop
+        std::condition_variable m_exportCondition;
+
+        /// singleton instance
+        static std::shared_ptr<MetricsRegistry> s_instance;
+        /// once flag for singleton instance
+        static std::once_flag s_once;
+    };
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+namespace aerolab::Core
+{
+    /**
+     * File format of flight recordings (little endian)
+     *
+     *   FileHeader (64 bytes)
+     *   Chunk 0 .. n, each RecordingFileHeader::chunkSize bytes:
+     *     ChunkHeader (48 bytes)
+     *     RecordHeader + payload, payload padded to 8 bytes, repeated
+     *     ... free space ...
+     *     IndexEntry k-1 .. IndexEntry 0 (growing backwards from the end of the chunk)
+     *
+     * Every RECORDING_INDEX_INTERVAL records an IndexEntry is added to the footer of the chunk.
+     * Seeking to a timestamp is a binary search over the chunk headers, then over the chunk index,
+     * followed by a linear scan over at most RECORDING_INDEX_INTERVAL records.
+     */
+
+    /// Magic at the start of a recording file
+    constexpr char RECORDING_MAGIC[8] = {'A', 'I', 'R', 'R', 'E', 'C', '0', '1'};
+    /// Current format version
+    constexpr uint32_t RECORDING_VERSION = 1;
+    /// Magic at the start of every chunk
+    constexpr uint32_t RECORDING_CHUNK_MAGIC = 0x4B4E4843; // "CHNK"
+    /// Number of records between two index entries
+    constexpr uint32_t RECORDING_INDEX_INTERVAL = 64;
+
+    /// Header at the start of a recording file
+    struct RecordingFileHeader
+    {
+        /// RECORDING_MAGIC
+        char magic[8];
+        /// Format version
+        uint32_t version;
+        /// Size of every chunk in bytes
+        uint32_t chunkSize;
+        /// Creation time (system clock) in nanoseconds since epoch
+        int64_t createdNs;
+        /// Number of records between two index entries
+        uint32_t indexInterval;
+        /// Reserved, zero
+        uint8_t reserved[36];
+    };
+
+    /// Header at the start of every chunk
+    struct RecordingChunkHeader
+    {
+        /// RECORDING_CHUNK_MAGIC, zero for unused chunks
+        uint32_t magic;
+        /// Number of records in the chunk
+        uint32_t recordCount;
+        /// Sequence number of the chunk
+        uint64_t sequence;
+        /// Timestamp of the first record
+        int64_t firstTimestampNs;
+        /// Timestamp of the last record
+        int64_t lastTimestampNs;
+        /// Number of bytes used by records after the chunk header
+        uint32_t dataBytes;
+        /// Number of index entries at the end of the chunk
+        uint32_t indexCount;
+        /// Reserved, zero
+        uint8_t reserved[8];
+    };
+
+    /// Header of a single recorded datagram
+    struct RecordingRecordHeader
+    {
+        /// Receive timestamp in nanoseconds since epoch
+        int64_t timestampNs;
+        /// Payload size in bytes
+        uint16_t length;
+        /// Source port
+        uint16_t port;
+        /// 4 for IPv4, 6 for IPv6
+        uint8_t addressFamily;
+        /// Reserved, zero
+        uint8_t reserved[3];
+        /// Source address, IPv4 addresses use the first 4 bytes
+        uint8_t address[16];
+    };
+
+    /// Sparse index entry in the chunk footer
+    struct RecordingIndexEntry
+    {
+        /// Timestamp of the indexed record
+        int64_t timestampNs;
+        /// Offset of the indexed record from the chunk start
+        uint32_t offset;
+        /// Index of the record inside the chunk
+        uint32_t recordIndex;
+    };
+
+    static_assert(sizeof(RecordingFileHeader) == 64 && std::is_trivially_copyable_v<RecordingFileHeader>);
+    static_assert(sizeof(RecordingChunkHeader) == 48 && std::is_trivially_copyable_v<RecordingChunkHeader>);
+    static_assert(sizeof(RecordingRecordHeader) == 32 && std::is_trivially_copyable_v<RecordingRecordHeader>);
+    static_assert(sizeof(RecordingIndexEntry) == 16 && std::is_trivially_copyable_v<RecordingIndexEntry>);
+
+    /// @brief Size of a record including padding
+    constexpr std::size_t RecordingRecordSize(std::size_t payloadLength)
+    {
+        return sizeof(RecordingRecordHeader) + ((payloadLength + 7) & ~static_cast<std::size_t>(7));
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "RecordingFormat.h"
+
+#include <boost/asio/ip/udp.hpp>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace aerolab::Core
+{
+    /// A datagram read from a recording, the payload points into the mapped file
+    struct RecordedDatagram
+    {
+        /// Receive timestamp in nanoseconds since epoch
+        int64_t timestampNs = 0;
+        /// Endpoint the datagram was received from
+        boost::asio::ip::udp::endpoint sender;
+        /// Payload, valid as long as the reader exists
+        std::span<const uint8_t> payload;
+    };
+
+    /**
+     * @brief The RecordingReader class
+     * @details Maps a recording written by the FlightRecorder read-only and iterates over its datagrams
+     *          in file order. Seek() uses the chunk headers and the sparse index in the chunk footers,
+     *          so positioning is O(log n) in the number of records.
+     */
+    class RecordingReader
+    {
+    public:
+        explicit RecordingReader(const std::string &filePath);
+        ~RecordingReader();
+
+        bool Next(RecordedDatagram &datagram);
+        void Seek(int64_t timestampNs);
+        void Rewind();
+
+        /// @brief Number of chunks containing records
+        std::size_t ChunkCount() const { return m_chunkCount; }
+        /// @brief Number of records in the file
+        uint64_t RecordCount() const { return m_recordCount; }
+        /// @brief Timestamp of the first record, 0 for an empty recording
+        int64_t FirstTimestamp() const;
+        /// @brief Highest timestamp of all records, 0 for an empty recording
+        int64_t LastTimestamp() const;
+
+    private:
+        /// Read-only mapping of the whole file
+        struct Mapping;
+
+        bool stopInvalid();
+        uint32_t chunkRecords(std::size_t chunk) const;
+        const RecordingChunkHeader &chunkHeader(std::size_t chunk) const;
+        const RecordingIndexEntry &indexEntry(std::size_t chunk, uint32_t entry) const;
+
+        /// Mapping of the file
+        std::unique_ptr<Mapping> m_pMapping;
+        /// Start of the mapped file
+        const uint8_t *m_pBase = nullptr;
+        /// Size of every chunk
+        std::size_t m_chunkSize = 0;
+        /// Number of chunks containing records
+        std::size_t m_chunkCount = 0;
+        /// Number of records in the file
+        uint64_t m_recordCount = 0;
+        /// Number of valid records of the last chunk if it ends with an invalid record
+        uint32_t m_lastChunkRecords = UINT32_MAX;
+
+        /// Chunk of the next record
+        std::size_t m_chunk = 0;
+        /// Index of the next record inside the chunk
+        uint32_t m_record = 0;
+        /// Offset of the next record from the chunk start
+        std::size_t m_offset = sizeof(RecordingChunkHeader);
+    };
+}
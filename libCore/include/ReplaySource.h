@@ -0,0 +1,165 @@
+#pragma once
+
+#include "DatagramPool.h"
+#include "LatencyHistogram.h"
+#include "RecordingReader.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aerolab::Core
+{
+    /// Pacing of a replay
+    enum class E_ReplayMode
+    {
+        /// Datagrams are delivered with their recorded spacing
+        RealTime = 0,
+        /// Recorded spacing divided by the speed factor
+        Scaled = 1,
+        /// No pacing, the replay runs as fast as the stages allow
+        AsFastAsPossible = 2
+    };
+
+    /// Latency of a single replay stage
+    struct ReplayStageStats
+    {
+        /// Name of the stage
+        std::string name;
+        /// Time spent in the stage per datagram in nanoseconds
+        LatencyHistogram latency;
+    };
+
+    /// Result of a replay run
+    struct ReplayStats
+    {
+        /// Number of delivered datagrams
+        uint64_t datagrams = 0;
+        /// Number of delivered payload bytes
+        uint64_t bytes = 0;
+        /// Wall time of the run in seconds
+        double elapsedSeconds = 0.0;
+        /// Latency of reading a datagram from the recording into a pooled buffer
+        LatencyHistogram readLatency;
+        /// Latency of the stages in the order they are called
+        std::vector<ReplayStageStats> stages;
+        /// Delay of the deliveries behind their schedule, only recorded with pacing
+        LatencyHistogram lateness;
+
+        /// @brief Delivered datagrams per second
+        double PacketsPerSecond() const { return elapsedSeconds > 0.0 ? static_cast<double>(datagrams) / elapsedSeconds : 0.0; }
+
+        std::string Report() const;
+    };
+
+    /**
+     * @brief The ReplaySource class
+     * @details Reads a recording of the FlightRecorder and delivers the datagrams through the same
+     *          callback interface as the InputManager, so the decoder, the store and the GUI can be
+     *          driven by recorded data exactly as by live data. The datagrams keep their recorded receive
+     *          timestamps and source endpoints, so every replay of a recording produces the same samples.
+     *          Every callback is a named stage whose latency is measured, which turns the
+     *          AsFastAsPossible mode into an offline throughput benchmark of the pipeline.
+     * @note All callbacks are called from the thread running the replay, one datagram after another.
+     */
+    class ReplaySource
+    {
+    public:
+        /// Callback receiving a pooled datagram handle, the handle may be kept without copying
+        using DatagramCallback = std::function<void(const Datagram &datagram)>;
+
+        explicit ReplaySource(const std::string &filePath);
+        ~ReplaySource();
+
+        /// Delete copy constructor, the replay thread references the source
+        ReplaySource(const ReplaySource &) = delete;
+        /// Delete assign operator, the replay thread references the source
+        ReplaySource &operator=(const ReplaySource &) = delete;
+
+        /// @brief Sets the callback for replayed messages
+        /// @details The datagram is copied into a reused vector before the callback is called. Measured as stage "vector callback".
+        /// @param callback The callback function to call on replayed messages
+        void SetCallback(std::function<void(const std::vector<uint8_t> &datagram)> callback);
+
+        /// @brief Sets the zero-copy callback for replayed messages
+        /// @details Measured as stage "callback".
+        /// @param callback The callback function to call on replayed messages
+        void SetCallback(DatagramCallback callback) { AddStage("callback", std::move(callback)); }
+
+        void AddStage(const std::string &name, DatagramCallback stage);
+
+        /// @brief Sets the pacing of the replay, has to be set before Start() or Run()
+        /// @param mode The pacing mode
+        /// @param speed Speed factor of the Scaled mode, e.g. 10 for ten times real time
+        void SetMode(E_ReplayMode mode, double speed = 1.0)
+        {
+            m_mode = mode;
+            m_speed = speed > 0.0 ? speed : 1.0;
+        }
+
+        /// @brief Restricts the replay to records from the given receive timestamp on
+        /// @param timestampNs Timestamp in nanoseconds since epoch, 0 replays from the start
+        void SetStartTime(int64_t timestampNs) { m_startTimeNs = timestampNs; }
+
+        ReplayStats Run();
+        void Start();
+        void Stop();
+
+        /// @brief True while the replay delivers datagrams
+        bool IsRunning() const { return m_running.load(std::memory_order_relaxed); }
+        /// @brief Number of datagrams delivered so far
+        uint64_t DeliveredCount() const { return m_delivered.load(std::memory_order_relaxed); }
+        /// @brief Statistics of the last finished run, valid after Run() returned or Stop() joined
+        const ReplayStats &Stats() const { return m_stats; }
+        /// @brief The recording being replayed
+        const RecordingReader &Reader() const { return m_reader; }
+        /// @brief The pool the replayed buffers are taken from
+        const std::shared_ptr<DatagramPool> &GetDatagramPool() const { return m_pDatagramPool; }
+
+    private:
+        /// A named callback
+        struct Stage
+        {
+            std::string name;
+            DatagramCallback callback;
+        };
+
+        ReplayStats replay();
+        bool waitUntil(std::chrono::steady_clock::time_point deadline);
+
+        /// Recording to replay
+        RecordingReader m_reader;
+        /// Pool of the delivered buffers
+        std::shared_ptr<DatagramPool> m_pDatagramPool;
+        /// Stages called for every datagram
+        std::vector<Stage> m_stages;
+        /// Reused buffer of the vector callback
+        std::vector<uint8_t> m_receivedData;
+
+        /// Pacing mode
+        E_ReplayMode m_mode = E_ReplayMode::RealTime;
+        /// Speed factor of the Scaled mode
+        double m_speed = 1.0;
+        /// First replayed timestamp
+        int64_t m_startTimeNs = 0;
+
+        /// Replay thread of Start()
+        std::thread m_thread;
+        /// Cleared to stop the replay
+        std::atomic<bool> m_running{false};
+        /// Mutex of the stop condition
+        std::mutex m_mutex;
+        /// Wakes the replay thread from pacing on Stop()
+        std::condition_variable m_stopCondition;
+        /// Number of datagrams delivered so far
+        std::atomic<uint64_t> m_delivered{0};
+        /// Statistics of the last run
+        ReplayStats m_stats;
+    };
+}
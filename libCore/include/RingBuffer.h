@@ -0,0 +1,322 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+
+namespace aerolab::Core
+{
+    /// Assumed cache line size for padding shared indices
+    constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+    /// Enum for the behavior of a full RingBuffer
+    enum class E_OverflowPolicy
+    {
+        /// Discard the oldest queued element to make room for the new one
+        DropOldest = 0,
+        /// Discard the new element
+        DropNewest = 1,
+        /// Sleep until a consumer made room
+        Block = 2
+    };
+
+    /**
+     * @brief The RingBuffer class
+     * @details Bounded lock-free queue for handing elements from producer threads (e.g. the asio receive threads)
+     *          to consumer threads. Any number of producers and consumers is supported, every slot carries
+     *          a sequence number so pushes and pops only synchronize on the slot they use.
+     *          The enqueue and dequeue indices live on separate cache lines, so producers and consumers do
+     *          not invalidate each other's cache lines.
+     *          Consumers pop in batches with PopBatch() and may sleep in WaitForData() while the queue is empty.
+     * @tparam T Element type, has to be default constructible and movable
+     */
+    template <typename T>
+    class RingBuffer
+    {
+    public:
+        /**
+         * @brief Constructor of the RingBuffer
+         * @param capacity Maximum number of queued elements, rounded up to the next power of two
+         * @param policy Behavior when pushing into a full queue
+         */
+        explicit RingBuffer(std::size_t capacity, E_OverflowPolicy policy = E_OverflowPolicy::DropNewest)
+            : m_capacity(roundUpToPowerOfTwo(std::max<std::size_t>(capacity, 2))),
+              m_mask(m_capacity - 1),
+              m_policy(policy),
+              m_pCells(std::make_unique<Cell[]>(m_capacity))
+        {
+            for (std::size_t i = 0; i < m_capacity; i++)
+                m_pCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        /// Delete copy constructor, producers and consumers reference the queue
+        RingBuffer(const RingBuffer &) = delete;
+        /// Delete assign operator, producers and consumers reference the queue
+        RingBuffer &operator=(const RingBuffer &) = delete;
+
+        /**
+         * @brief Pushes an element according to the overflow policy
+         * @param value The element to push
+         * @return True if the element has been queued, False if it has been dropped
+         */
+        bool Push(T value)
+        {
+            if (tryPush(value))
+                return true;
+
+            switch (m_policy)
+            {
+            case E_OverflowPolicy::DropOldest:
+                while (!tryPush(value))
+                {
+                    T discarded;
+                    if (TryPop(discarded))
+                        m_dropped.fetch_add(1, std::memory_order_relaxed);
+                }
+                return true;
+
+            case E_OverflowPolicy::Block:
+                while (!tryPush(value))
+                    waitForSpace();
+                return true;
+
+            case E_OverflowPolicy::DropNewest:
+            default:
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        /**
+         * @brief Pushes an element if there is room, regardless of the overflow policy
+         * @details A failed attempt is not counted as dropped, the caller decides what to do with the element.
+         * @param value The element to push, only moved from on success
+         * @return True if the element has been queued, False if the queue is full
+         */
+        bool TryPush(T &value) { return tryPush(value); }
+
+        /**
+         * @brief Pops a single element
+         * @param value Receives the popped element
+         * @return True if an element has been popped, False if the queue was empty
+         */
+        bool TryPop(T &value)
+        {
+            std::size_t position = m_dequeuePosition.value.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                Cell &cell = m_pCells[position & m_mask];
+                const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+                if (difference == 0)
+                {
+                    if (m_dequeuePosition.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        value = std::move(cell.value);
+                        cell.value = T();
+                        cell.sequence.store(position + m_capacity, std::memory_order_release);
+                        onPopped();
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                    return false;
+                else
+                    position = m_dequeuePosition.value.load(std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Pops up to out.size() elements
+         * @param out Storage receiving the popped elements
+         * @return Number of popped elements
+         */
+        std::size_t PopBatch(std::span<T> out)
+        {
+            std::size_t count = 0;
+            while (count < out.size() && TryPop(out[count]))
+                count++;
+            return count;
+        }
+
+        /**
+         * @brief Waits until the queue contains data
+         * @param timeout Maximum time to wait
+         * @return True if data is available, False on timeout
+         */
+        bool WaitForData(std::chrono::milliseconds timeout)
+        {
+            if (Size() > 0)
+                return true;
+
+            std::unique_lock<std::mutex> lock(m_waitMutex);
+            m_waitingConsumers.fetch_add(1, std::memory_order_seq_cst);
+            const bool hasData = m_dataAvailable.wait_for(lock, timeout, [this]()
+                                                          { return Size() > 0; });
+            m_waitingConsumers.fetch_sub(1, std::memory_order_relaxed);
+            return hasData;
+        }
+
+        /// @brief Approximate number of queued elements
+        std::size_t Size() const
+        {
+            const std::size_t enqueue = m_enqueuePosition.value.load(std::memory_order_acquire);
+            const std::size_t dequeue = m_dequeuePosition.value.load(std::memory_order_acquire);
+            return enqueue > dequeue ? enqueue - dequeue : 0;
+        }
+
+        /// @brief Maximum number of queued elements
+        std::size_t Capacity() const { return m_capacity; }
+        /// @brief Overflow policy of the queue
+        E_OverflowPolicy Policy() const { return m_policy; }
+        /// @brief Number of elements queued since construction
+        uint64_t EnqueuedCount() const { return m_enqueued.load(std::memory_order_relaxed); }
+        /// @brief Number of elements dropped by the overflow policy since construction
+        uint64_t DroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+        /// @brief Highest observed queue depth
+        std::size_t HighWaterMark() const { return m_highWater.load(std::memory_order_relaxed); }
+
+    private:
+        /// Slot of the ring
+        struct Cell
+        {
+            /// Sequence number telling producers and consumers whose turn it is
+            std::atomic<std::size_t> sequence{0};
+            /// Stored element
+            T value{};
+        };
+
+        /// Index padded to a full cache line
+        struct alignas(CACHE_LINE_SIZE) PaddedIndex
+        {
+            std::atomic<std::size_t> value{0};
+        };
+
+        /**
+         * @brief Pushes an element if there is room
+         * @param value The element to push, only moved from on success
+         * @return True on success, False if the queue is full
+         */
+        bool tryPush(T &value)
+        {
+            std::size_t position = m_enqueuePosition.value.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                Cell &cell = m_pCells[position & m_mask];
+                const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+                if (difference == 0)
+                {
+                    if (m_enqueuePosition.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        cell.value = std::move(value);
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        onPushed();
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                    return false;
+                else
+                    position = m_enqueuePosition.value.load(std::memory_order_relaxed);
+            }
+        }
+
+        /// @brief Updates the statistics and wakes a waiting consumer
+        void onPushed()
+        {
+            m_enqueued.fetch_add(1, std::memory_order_relaxed);
+
+            const std::size_t depth = Size();
+            std::size_t highWater = m_highWater.load(std::memory_order_relaxed);
+            while (depth > highWater && !m_highWater.compare_exchange_weak(highWater, depth, std::memory_order_relaxed))
+            {
+            }
+
+            // Pairs with the increment in WaitForData so a sleeping consumer is never missed
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_waitingConsumers.load(std::memory_order_relaxed) > 0)
+            {
+                std::lock_guard<std::mutex> guard(m_waitMutex);
+                m_dataAvailable.notify_all();
+            }
+        }
+
+        /// @brief Wakes the producers blocked on a full queue, only needed for the Block policy
+        void onPopped()
+        {
+            if (m_policy != E_OverflowPolicy::Block)
+                return;
+
+            // Pairs with the increment in waitForSpace so a sleeping producer is never missed
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_waitingProducers.load(std::memory_order_relaxed) > 0)
+            {
+                std::lock_guard<std::mutex> guard(m_waitMutex);
+                m_spaceAvailable.notify_all();
+            }
+        }
+
+        /**
+         * @brief Sleeps until a consumer popped from the full queue
+         * @details The slot may still be released by the consumer when this returns, the caller retries the push.
+         */
+        void waitForSpace()
+        {
+            std::unique_lock<std::mutex> lock(m_waitMutex);
+            m_waitingProducers.fetch_add(1, std::memory_order_seq_cst);
+            m_spaceAvailable.wait(lock, [this]()
+                                  { return Size() < m_capacity; });
+            m_waitingProducers.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        static std::size_t roundUpToPowerOfTwo(std::size_t value)
+        {
+            std::size_t result = 1;
+            while (result < value)
+                result <<= 1;
+            return result;
+        }
+
+        /// Number of slots
+        const std::size_t m_capacity;
+        /// Mask mapping positions to slots
+        const std::size_t m_mask;
+        /// Behavior when pushing into a full queue
+        const E_OverflowPolicy m_policy;
+        /// Slots of the ring
+        std::unique_ptr<Cell[]> m_pCells;
+
+        /// Next position to push to, written by producers
+        PaddedIndex m_enqueuePosition;
+        /// Next position to pop from, written by consumers
+        PaddedIndex m_dequeuePosition;
+
+        /// Number of queued elements since construction
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> m_enqueued{0};
+        /// Number of dropped elements since construction
+        std::atomic<uint64_t> m_dropped{0};
+        /// Highest observed depth
+        std::atomic<std::size_t> m_highWater{0};
+
+        /// Number of consumers sleeping in WaitForData
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_waitingConsumers{0};
+        /// Number of producers sleeping in waitForSpace
+        std::atomic<std::size_t> m_waitingProducers{0};
+        /// Mutex for the wait conditions
+        std::mutex m_waitMutex;
+        /// Condition signalled when data is pushed with a waiting consumer
+        std::condition_variable m_dataAvailable;
+        /// Condition signalled when an element is popped with a blocked producer
+        std::condition_variable m_spaceAvailable;
+    };
+}
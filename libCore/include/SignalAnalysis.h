@@ -0,0 +1,246 @@
+#pragma once
+
+#include "SignalKernels.h"
+#include "TelemetryStore.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aerolab::Core
+{
+    /**
+     * @brief The Fft class
+     * @details In-place radix-2 FFT on split complex data. The bit reversal table and the twiddle factors of every
+     *          stage are computed on construction, the twiddles of a stage are contiguous so the butterflies run
+     *          as vector loops of the SignalKernels.
+     */
+    class Fft
+    {
+    public:
+        Fft(std::size_t size, const SignalKernels &kernels);
+
+        void Transform(std::span<float> re, std::span<float> im) const;
+
+        /// @brief Length of the transform
+        std::size_t Size() const { return m_size; }
+
+    private:
+        /// Length of the transform, a power of two
+        std::size_t m_size;
+        /// Kernels running the stages
+        const SignalKernels &m_kernels;
+        /// Pairs of indices swapped by the bit reversal
+        std::vector<std::pair<uint32_t, uint32_t>> m_swaps;
+        /// Real parts of the twiddle factors, the stages one after the other
+        std::vector<float> m_twiddleRe;
+        /// Imaginary parts of the twiddle factors, the stages one after the other
+        std::vector<float> m_twiddleIm;
+    };
+
+    /// Statistics of a window of samples
+    struct RollingStatsResult
+    {
+        /// Number of samples in the window
+        std::size_t count = 0;
+        float mean = 0.0f;
+        float rms = 0.0f;
+        float variance = 0.0f;
+        float min = 0.0f;
+        float max = 0.0f;
+    };
+
+    /**
+     * @brief The RollingStats class
+     * @details Mean, RMS, variance and range over the latest samples, updated incrementally. The samples are
+     *          summarized in blocks of BLOCK_SIZE by the SignalKernels as soon as a block is complete, the window
+     *          consists of the latest window / BLOCK_SIZE complete blocks and the current partial block. So the
+     *          window slides in steps of BLOCK_SIZE, no sample is summed twice and no sums are subtracted, so there
+     *          is no drift.
+     */
+    class RollingStats
+    {
+    public:
+        /// Samples per block
+        static constexpr std::size_t BLOCK_SIZE = 64;
+
+        RollingStats(std::size_t window, const SignalKernels &kernels);
+
+        void Append(std::span<const float> values);
+        RollingStatsResult Result() const;
+
+    private:
+        /// Kernels summarizing the blocks
+        const SignalKernels &m_kernels;
+        /// Summaries of the latest complete blocks, used as ring
+        std::vector<BlockStats> m_blocks;
+        /// Slot of the next complete block
+        std::size_t m_nextBlock = 0;
+        /// Number of valid blocks
+        std::size_t m_blockCount = 0;
+        /// Samples of the current partial block
+        std::vector<float> m_partial;
+    };
+
+    /// Power spectral density of a window of samples
+    struct SpectrumResult
+    {
+        /// Density per bin from 0 Hz to the Nyquist frequency, in unit^2/Hz
+        std::vector<float> psd;
+        /// Width of a bin in Hz
+        float binWidth = 0.0f;
+        /// Frequency of the strongest bin above 0 Hz
+        float peakFrequency = 0.0f;
+        /// Density of the strongest bin above 0 Hz
+        float peakDensity = 0.0f;
+    };
+
+    /**
+     * @brief The Spectrum class
+     * @details One-sided power spectral density over the latest samples: the mean is removed, a Hann window applied
+     *          and the periodogram scaled to unit^2/Hz. Successive spectra are averaged exponentially, which smooths
+     *          the noise floor so vibration peaks stand out. The samples are kept in a ring of the transform length,
+     *          appending costs a copy per sample, the transform only runs in Compute().
+     */
+    class Spectrum
+    {
+    public:
+        Spectrum(std::size_t size, const SignalKernels &kernels);
+
+        void Append(std::span<const TelemetrySample> samples);
+        bool Compute(float averaging, SpectrumResult &result);
+
+        /// @brief True once the ring holds a full transform length
+        bool Ready() const { return m_count >= m_fft.Size(); }
+
+    private:
+        /// Kernels of the window and the power
+        const SignalKernels &m_kernels;
+        /// The transform
+        Fft m_fft;
+        /// Hann window
+        std::vector<float> m_window;
+        /// Sum of the squared window coefficients, normalizes the density
+        float m_windowPower = 0.0f;
+        /// Latest samples, used as ring
+        std::vector<float> m_values;
+        /// Timestamps of the latest samples, used as ring
+        std::vector<int64_t> m_timestamps;
+        /// Slot of the next sample
+        std::size_t m_next = 0;
+        /// Number of appended samples, saturating at the transform length
+        std::size_t m_count = 0;
+        /// Scratch buffers of the transform
+        std::vector<float> m_re;
+        std::vector<float> m_im;
+        std::vector<float> m_power;
+        /// Averaged density of the previous spectra
+        std::vector<float> m_average;
+    };
+
+    /// Settings of the SignalAnalyzer
+    struct AnalysisOptions
+    {
+        /// Samples of the rolling statistics
+        std::size_t window = 1024;
+        /// Length of the FFT, a power of two
+        std::size_t fftSize = 1024;
+        /// Time between two updates
+        std::chrono::milliseconds interval{100};
+        /// Weight of the newest spectrum in the average, 1 disables averaging
+        float averaging = 0.5f;
+    };
+
+    /// Analysis of a channel, as polled by the GUI
+    struct AnalysisResult
+    {
+        /// Name of the channel
+        std::string channel;
+        /// Statistics of the latest samples
+        RollingStatsResult stats;
+        /// Spectrum of the latest samples, empty until fftSize samples have been received
+        SpectrumResult spectrum;
+        /// Sample rate estimated from the timestamps in Hz
+        float sampleRate = 0.0f;
+        /// Number of updates with new samples
+        uint64_t updates = 0;
+    };
+
+    /**
+     * @brief The SignalAnalyzer class
+     * @details Computes rolling statistics and spectra of telemetry channels on its own thread, for tuning the
+     *          flight controller on live data. Every update reads only the samples appended to the channels since
+     *          the previous update, readers never block the ingest writing the channels.
+     *          The results are copied under a mutex per update, the GUI polls them with GetResult().
+     */
+    class SignalAnalyzer
+    {
+    public:
+        SignalAnalyzer(std::shared_ptr<TelemetryStore> pStore, AnalysisOptions options = {});
+        ~SignalAnalyzer();
+
+        void AddChannel(const std::string &name);
+        void Start();
+        void Stop();
+        void Update();
+
+        bool GetResult(const std::string &name, AnalysisResult &result) const;
+        std::vector<std::string> Channels() const;
+
+        /// @brief The kernels selected for the CPU
+        const SignalKernels &Kernels() const { return m_kernels; }
+
+    private:
+        /// State of an analyzed channel, only accessed by the updating thread
+        struct ChannelState
+        {
+            ChannelState(std::shared_ptr<TelemetryChannel> pChannel, const AnalysisOptions &options, const SignalKernels &kernels)
+                : pChannel(std::move(pChannel)), stats(options.window, kernels), spectrum(options.fftSize, kernels) {}
+
+            std::shared_ptr<TelemetryChannel> pChannel;
+            /// Position of the next unread sample
+            uint64_t position = 0;
+            RollingStats stats;
+            Spectrum spectrum;
+            /// Latest result, copied into the published result
+            AnalysisResult result;
+        };
+
+        void run();
+
+        /// Store of the analyzed channels
+        std::shared_ptr<TelemetryStore> m_pStore;
+        /// Settings
+        AnalysisOptions m_options;
+        /// Kernels selected for the CPU
+        const SignalKernels &m_kernels;
+
+        /// Guards m_channels against AddChannel() during an update
+        mutable std::mutex m_channelMutex;
+        /// Analyzed channels
+        std::vector<std::unique_ptr<ChannelState>> m_channels;
+        /// Guards m_results
+        mutable std::mutex m_resultMutex;
+        /// Published results in channel order
+        std::vector<AnalysisResult> m_results;
+        /// Scratch buffer of the samples read per update
+        std::vector<TelemetrySample> m_samples;
+        /// Scratch buffer of the sample values
+        std::vector<float> m_values;
+
+        /// Thread calling Update() periodically
+        std::thread m_thread;
+        /// Cleared to stop the thread
+        bool m_running = false;
+        /// Guards m_running
+        std::mutex m_runMutex;
+        /// Wakes the thread on Stop()
+        std::condition_variable m_runCondition;
+    };
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+namespace aerolab::Core
+{
+    /// Enum for the instruction sets of the signal kernels
+    enum class E_SimdLevel
+    {
+        /// Portable C++, the reference implementation
+        Scalar = 0,
+        /// 4 floats per instruction, the baseline of x86-64
+        Sse2 = 1,
+        /// 8 floats per instruction with fused multiply-add
+        Avx2 = 2
+    };
+
+    /// Sum, sum of squares and range of a block of samples
+    struct BlockStats
+    {
+        /// Number of samples
+        std::size_t count = 0;
+        /// Sum of the samples
+        double sum = 0.0;
+        /// Sum of the squared samples
+        double sumSquares = 0.0;
+        /// Smallest sample
+        float min = std::numeric_limits<float>::infinity();
+        /// Largest sample
+        float max = -std::numeric_limits<float>::infinity();
+
+        /// @brief Adds the samples of another block
+        void Merge(const BlockStats &other)
+        {
+            count += other.count;
+            sum += other.sum;
+            sumSquares += other.sumSquares;
+            min = other.min < min ? other.min : min;
+            max = other.max > max ? other.max : max;
+        }
+    };
+
+    /**
+     * @brief Inner loops of the signal analysis, implemented once per instruction set
+     * @details The sets are selected at runtime by BestSignalKernels(), so a single build runs the widest
+     *          kernels the CPU supports. All kernels produce the same results as the scalar set up to the
+     *          rounding of the reordered float operations.
+     */
+    struct SignalKernels
+    {
+        /// Instruction set of the kernels
+        E_SimdLevel level;
+        /// Name of the instruction set for logs and benchmarks
+        const char *name;
+
+        /**
+         * @brief Computes the statistics of a block
+         * @details Accumulates in float lanes, meant for blocks of up to a few hundred samples.
+         */
+        void (*blockStats)(const float *pData, std::size_t count, BlockStats &out);
+
+        /// @brief Computes pOut[i] = (pIn[i] - offset) * pWindow[i]
+        void (*applyWindow)(const float *pIn, const float *pWindow, float offset, float *pOut, std::size_t count);
+
+        /**
+         * @brief Runs one radix-2 stage of an in-place FFT on split complex data
+         * @param pRe Real parts, count values
+         * @param pIm Imaginary parts, count values
+         * @param pTwiddleRe Real parts of the half twiddle factors of the stage
+         * @param pTwiddleIm Imaginary parts of the half twiddle factors of the stage
+         * @param count Length of the transform
+         * @param half Distance of the butterfly inputs, half the length of the stage
+         */
+        void (*butterflies)(float *pRe, float *pIm, const float *pTwiddleRe, const float *pTwiddleIm, std::size_t count, std::size_t half);
+
+        /// @brief Computes pOut[i] = (pRe[i]^2 + pIm[i]^2) * scale
+        void (*power)(const float *pRe, const float *pIm, float *pOut, std::size_t count, float scale);
+    };
+
+    const SignalKernels &ScalarSignalKernels();
+    const SignalKernels *SignalKernelsFor(E_SimdLevel level);
+    const SignalKernels &BestSignalKernels();
+}
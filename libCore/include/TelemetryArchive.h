@@ -0,0 +1,112 @@
+#pragma once
+
+#include "Metrics.h"
+#include "TelemetryCodec.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aerolab::Core
+{
+    /**
+     * @brief The TelemetryArchive class
+     * @details Keeps the complete raw history of all channels of a TelemetryStore in memory, compressed with
+     *          the CompressedSeries. The store rings only hold the latest samples, the archive copies the samples
+     *          appended since the previous update on its own thread, so the ingest never waits for the encoder.
+     *          The channels of a frame (see TelemetryIngest) are appended together with the same timestamps and
+     *          share a series, any other channel gets a series of its own.
+     *          The archive can be saved as compact recording of the decoded channels and loaded again
+     *          (see TelemetryCodec.h).
+     * @note The archive does not compress the raw recording of the FlightRecorder, which is written uncompressed.
+     *       It only saves disk space if the recorder is disabled. It holds decoded channels, not datagrams, so it
+     *       can not be replayed. Float channels like the attitude compress only about 3.8 times over the raw recording.
+     */
+    class TelemetryArchive
+    {
+    public:
+        explicit TelemetryArchive(std::shared_ptr<TelemetryStore> pStore = nullptr);
+        ~TelemetryArchive();
+
+        /// Delete copy constructor, the update thread references the archive
+        TelemetryArchive(const TelemetryArchive &) = delete;
+        /// Delete assign operator, the update thread references the archive
+        TelemetryArchive &operator=(const TelemetryArchive &) = delete;
+
+        void Start(std::chrono::milliseconds interval);
+        void Stop();
+        void Update();
+
+        std::size_t ReadRaw(const std::string &channel, int64_t startNs, int64_t endNs, std::vector<TelemetrySample> &out) const;
+        std::vector<std::string> ChannelNames() const;
+        uint64_t SampleCount() const;
+        std::size_t CompressedBytes() const;
+
+        bool Save(const std::string &filePath) const;
+        bool Load(const std::string &filePath);
+
+    private:
+        /// Channels archived in a series
+        struct ArchivedSeries
+        {
+            /// Channel of every column in the store, empty for loaded series
+            std::vector<std::shared_ptr<TelemetryChannel>> channels;
+            /// Names of the channels
+            std::vector<std::string> names;
+            /// Position of the next unread sample, the same in all channels
+            uint64_t position = 0;
+            /// Compressed rows
+            CompressedSeries series;
+        };
+
+        /// Column of a channel
+        struct ChannelLocation
+        {
+            /// Index in m_series
+            std::size_t series;
+            /// Column in the series
+            std::size_t column;
+        };
+
+        void addSeries(const std::vector<std::string> &names);
+        void updateSeries(ArchivedSeries &archived);
+        void run(std::chrono::milliseconds interval);
+        void updateMetrics();
+
+        /// Store of the archived channels, nullptr for a loaded archive
+        std::shared_ptr<TelemetryStore> m_pStore;
+        /// Guards the series, the locations and the scratch buffers
+        mutable std::mutex m_mutex;
+        /// Archived series
+        std::vector<ArchivedSeries> m_series;
+        /// Column of every archived channel by name
+        std::map<std::string, ChannelLocation> m_locations;
+        /// Scratch buffers of the samples read per channel
+        std::vector<std::vector<TelemetrySample>> m_samples;
+        /// Scratch buffer of the timestamps appended to a series
+        std::vector<int64_t> m_timestamps;
+        /// Scratch buffers of the values appended to a series per column
+        std::vector<std::vector<double>> m_values;
+
+        /// Thread calling Update() periodically
+        std::thread m_thread;
+        /// Cleared to stop the thread
+        bool m_running = false;
+        /// Guards m_running
+        std::mutex m_runMutex;
+        /// Wakes the thread on Stop()
+        std::condition_variable m_runCondition;
+
+        /// Registry of the metrics
+        std::shared_ptr<MetricsRegistry> m_pMetrics;
+        /// Compressed size of the archive
+        MetricGauge *m_pBytesGauge = nullptr;
+        /// Number of archived samples
+        MetricGauge *m_pSamplesGauge = nullptr;
+    };
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "TelemetryStore.h"
+
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace aerolab::Core
+{
+    /**
+     * Format of a compressed block of columns sharing their timestamps, e.g. the fields of a frame (little endian)
+     *
+     *   CompressedBlockHeader (40 bytes)
+     *   Timestamp groups (timestampBytes): delta-of-deltas of the rows 2 .. rowCount-1, zigzag encoded
+     *     per group of TELEMETRY_GROUP_SAMPLES: width (1 byte), values bit-packed with width bits
+     *   Column 0 .. columnCount-1:
+     *     CompressedColumnHeader (24 bytes)
+     *     Value groups (bytes) of the rows 1 .. rowCount-1, per group of TELEMETRY_GROUP_SAMPLES a mode (1 byte):
+     *       VALUE_GROUP_UNCHANGED: all values equal the previous value
+     *       VALUE_GROUP_XOR: width, shift (1 byte each), bitmap of the changed values,
+     *                        XORs of the float bits with the previous value >> shift, changed values only,
+     *                        the values are rounded to float
+     *       VALUE_GROUP_SCALED: width (1 byte), zigzag encoded deltas of the raw values value / scale
+     *   8 bytes zero padding
+     *
+     * Every bit-packed group starts at a byte boundary. Fixed widths per group instead of variable length codes
+     * per sample decouple the samples, the unpacking has no dependency between lanes and vectorizes. Rows at
+     * a fixed rate cost no timestamp bits, repeated values one bit. Values of integer frame fields are raw * scale
+     * in double (see FrameView::Get()), the scaled groups store the small differences of the raw integers instead of
+     * the scattered mantissa bits and restore every value bit exactly, e.g. GPS positions in 1e-7 deg. The XOR groups
+     * keep float precision, the encoder only uses them instead of scaled groups if they restore the values exactly
+     * as well and are smaller. Values are only rounded to float if they are no scaled integers.
+     * The padding allows 64 bit loads at the end of the packed data.
+     */
+
+    /// Maximum number of rows per block
+    constexpr std::size_t TELEMETRY_BLOCK_SAMPLES = 1024;
+    /// Number of rows sharing a bit width
+    constexpr std::size_t TELEMETRY_GROUP_SAMPLES = 128;
+    /// Zero bytes at the end of every block
+    constexpr std::size_t TELEMETRY_BLOCK_PADDING = 8;
+
+    /// Modes of the value groups
+    enum E_ValueGroup : uint8_t
+    {
+        VALUE_GROUP_UNCHANGED = 0,
+        VALUE_GROUP_XOR = 1,
+        VALUE_GROUP_SCALED = 2
+    };
+
+    /// Header at the start of every compressed block
+    struct CompressedBlockHeader
+    {
+        /// Timestamp of the first row
+        int64_t firstTimestampNs;
+        /// Timestamp of the last row
+        int64_t lastTimestampNs;
+        /// Timestamp of the second row minus the first, zero for a single row
+        int64_t firstDeltaNs;
+        /// Number of rows
+        uint32_t rowCount;
+        /// Number of bytes after the header, including the padding
+        uint32_t payloadBytes;
+        /// Number of bytes of the timestamp groups
+        uint32_t timestampBytes;
+        /// Number of columns
+        uint16_t columnCount;
+        /// Reserved, zero
+        uint16_t reserved;
+    };
+
+    /// Header of a column inside a compressed block
+    struct CompressedColumnHeader
+    {
+        /// Number of bytes of the value groups after the header
+        uint32_t bytes;
+        /// Reserved, zero
+        uint32_t reserved;
+        /// Value of the first row
+        double firstValue;
+        /// Factor of the scaled groups, zero without scaled groups
+        double scale;
+    };
+
+    /// A column passed to EncodeTelemetryBlock()
+    struct TelemetryColumn
+    {
+        /// Value per row
+        std::span<const double> values;
+        /// Factor converting the raw integer into the value, zero if the values are not scaled integers
+        double scale = 0.0;
+    };
+
+    static_assert(sizeof(CompressedBlockHeader) == 40 && std::is_trivially_copyable_v<CompressedBlockHeader>);
+    static_assert(sizeof(CompressedColumnHeader) == 24 && std::is_trivially_copyable_v<CompressedColumnHeader>);
+
+    /**
+     * File format of telemetry archives (little endian)
+     *
+     *   ArchiveFileHeader (64 bytes)
+     *   Series 0 .. seriesCount-1:
+     *     ArchiveSeriesHeader (16 bytes)
+     *     Column 0 .. columnCount-1: name length (4 bytes), channel name (no terminator)
+     *     compressed block 0 .. blockCount-1, each CompressedBlockHeader + payload
+     */
+
+    /// Magic at the start of an archive file
+    constexpr char ARCHIVE_MAGIC[8] = {'A', 'I', 'R', 'A', 'R', 'C', '0', '1'};
+    /// Current archive format version, 2 keeps the values of the columns in double
+    constexpr uint32_t ARCHIVE_VERSION = 2;
+
+    /// Header at the start of an archive file
+    struct ArchiveFileHeader
+    {
+        /// ARCHIVE_MAGIC
+        char magic[8];
+        /// Format version
+        uint32_t version;
+        /// Number of series
+        uint32_t seriesCount;
+        /// Creation time (system clock) in nanoseconds since epoch
+        int64_t createdNs;
+        /// Reserved, zero
+        uint8_t reserved[40];
+    };
+
+    /// Header of a series of channels in an archive file
+    struct ArchiveSeriesHeader
+    {
+        /// Number of columns, one channel each
+        uint32_t columnCount;
+        /// Number of compressed blocks
+        uint32_t blockCount;
+        /// Number of rows in all blocks
+        uint64_t rowCount;
+    };
+
+    static_assert(sizeof(ArchiveFileHeader) == 64 && std::is_trivially_copyable_v<ArchiveFileHeader>);
+    static_assert(sizeof(ArchiveSeriesHeader) == 16 && std::is_trivially_copyable_v<ArchiveSeriesHeader>);
+
+    std::size_t EncodeTelemetryBlock(std::span<const int64_t> timestamps, std::span<const TelemetryColumn> columns, std::vector<uint8_t> &out);
+    bool DecodeTelemetryBlock(std::span<const uint8_t> block, std::size_t column, std::vector<TelemetrySample> &out);
+    bool ReadBlockHeader(std::span<const uint8_t> data, CompressedBlockHeader &header);
+
+    /**
+     * @brief The CompressedSeries class
+     * @details Time series of channels sharing their timestamps, e.g. the fields of a frame, compressed block by
+     *          block. Appended rows are collected until a block of TELEMETRY_BLOCK_SAMPLES is complete, then the
+     *          block is encoded and kept with its time range, so reads only decode the blocks overlapping the
+     *          requested window. Not thread-safe, see TelemetryArchive.
+     */
+    class CompressedSeries
+    {
+    public:
+        explicit CompressedSeries(std::vector<double> scales);
+
+        void Append(std::span<const int64_t> timestamps, std::span<const std::span<const double>> columns);
+        bool AppendBlock(std::vector<uint8_t> block);
+        std::size_t ReadRaw(std::size_t column, int64_t startNs, int64_t endNs, std::vector<TelemetrySample> &out) const;
+        std::size_t EncodePending(std::vector<uint8_t> &out) const;
+
+        /// @brief Number of columns
+        std::size_t ColumnCount() const { return m_scales.size(); }
+        /// @brief Number of rows in the blocks and the pending rows
+        uint64_t RowCount() const { return m_rowCount; }
+        /// @brief Number of bytes of the blocks, pending rows count with their raw size
+        std::size_t CompressedBytes() const { return m_blockBytes + m_pendingTimestamps.size() * (sizeof(int64_t) + sizeof(double) * ColumnCount()); }
+        /// @brief Factor of the scaled groups of a column, zero for values that are no scaled integers
+        double Scale(std::size_t column) const { return m_scales[column]; }
+        /// @brief Number of encoded blocks
+        std::size_t BlockCount() const { return m_blocks.size(); }
+        /// @brief Encoded block, see EncodeTelemetryBlock()
+        std::span<const uint8_t> Block(std::size_t index) const { return m_blocks[index].data; }
+
+    private:
+        /// An encoded block
+        struct EncodedBlock
+        {
+            /// Timestamp of the first row
+            int64_t firstTimestampNs;
+            /// Timestamp of the last row
+            int64_t lastTimestampNs;
+            /// Encoded rows
+            std::vector<uint8_t> data;
+        };
+
+        void encodePending();
+
+        /// Factor of the scaled groups per column, zero for values that are no scaled integers
+        std::vector<double> m_scales;
+        /// Encoded blocks in time order
+        std::vector<EncodedBlock> m_blocks;
+        /// Timestamps of the next block
+        std::vector<int64_t> m_pendingTimestamps;
+        /// Values of the next block per column
+        std::vector<std::vector<double>> m_pendingValues;
+        /// Scratch buffer of the encoder
+        std::vector<uint8_t> m_scratch;
+        /// Number of rows in the blocks and the pending rows
+        uint64_t m_rowCount = 0;
+        /// Number of bytes of all blocks
+        std::size_t m_blockBytes = 0;
+    };
+}
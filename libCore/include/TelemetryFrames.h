@@ -0,0 +1,106 @@
+#pragma once
+
+#include "TelemetrySchema.h"
+
+namespace aerolab::Core::Frames
+{
+    /// Gravity constant for scaling accelerometer values
+    constexpr float GRAVITY = 9.80665f;
+    /// Degrees to radians
+    constexpr float DEG_TO_RAD = 0.017453292f;
+
+    /**
+     * @brief Raw IMU sample, sent at the IMU rate (1 kHz)
+     * @details Accelerometer in m/s^2 (±16 g range), gyroscope in rad/s (±2000 deg/s range), temperature in °C
+     */
+    struct Imu
+    {
+        static constexpr uint8_t ID = 0x01;
+        static constexpr const char *NAME = "imu";
+
+        static constexpr FieldDesc<int16_t> ACC_X{"acc_x", 0, GRAVITY / 2048.0f};
+        static constexpr FieldDesc<int16_t> ACC_Y{"acc_y", 2, GRAVITY / 2048.0f};
+        static constexpr FieldDesc<int16_t> ACC_Z{"acc_z", 4, GRAVITY / 2048.0f};
+        static constexpr FieldDesc<int16_t> GYRO_X{"gyro_x", 6, DEG_TO_RAD / 16.4f};
+        static constexpr FieldDesc<int16_t> GYRO_Y{"gyro_y", 8, DEG_TO_RAD / 16.4f};
+        static constexpr FieldDesc<int16_t> GYRO_Z{"gyro_z", 10, DEG_TO_RAD / 16.4f};
+        static constexpr FieldDesc<int16_t> TEMPERATURE{"temperature", 12, 0.01f};
+
+        static constexpr auto FIELDS = std::make_tuple(ACC_X, ACC_Y, ACC_Z, GYRO_X, GYRO_Y, GYRO_Z, TEMPERATURE);
+    };
+
+    /**
+     * @brief Estimated attitude, sent at the control loop rate
+     * @details Angles in rad, rates in rad/s
+     */
+    struct Attitude
+    {
+        static constexpr uint8_t ID = 0x02;
+        static constexpr const char *NAME = "attitude";
+
+        static constexpr FieldDesc<float> ROLL{"roll", 0};
+        static constexpr FieldDesc<float> PITCH{"pitch", 4};
+        static constexpr FieldDesc<float> YAW{"yaw", 8};
+        static constexpr FieldDesc<float> ROLL_RATE{"roll_rate", 12};
+        static constexpr FieldDesc<float> PITCH_RATE{"pitch_rate", 16};
+        static constexpr FieldDesc<float> YAW_RATE{"yaw_rate", 20};
+
+        static constexpr auto FIELDS = std::make_tuple(ROLL, PITCH, YAW, ROLL_RATE, PITCH_RATE, YAW_RATE);
+    };
+
+    /**
+     * @brief Battery state
+     * @details Voltage in V, current in A, remaining capacity in %
+     */
+    struct Battery
+    {
+        static constexpr uint8_t ID = 0x03;
+        static constexpr const char *NAME = "battery";
+
+        static constexpr FieldDesc<uint16_t> VOLTAGE{"voltage", 0, 0.001f};
+        static constexpr FieldDesc<int16_t> CURRENT{"current", 2, 0.01f};
+        static constexpr FieldDesc<uint8_t> REMAINING{"remaining", 4};
+
+        static constexpr auto FIELDS = std::make_tuple(VOLTAGE, CURRENT, REMAINING);
+    };
+
+    /**
+     * @brief GNSS position fix
+     * @details Latitude and longitude in deg, altitude in m (MSL), ground speed in m/s, course in rad.
+     *          Latitude and longitude are scaled in double, in float 1e-7 deg would only resolve about 0.4 m.
+     */
+    struct Gps
+    {
+        static constexpr uint8_t ID = 0x04;
+        static constexpr const char *NAME = "gps";
+
+        static constexpr FieldDesc<int32_t> LATITUDE{"latitude", 0, 1e-7};
+        static constexpr FieldDesc<int32_t> LONGITUDE{"longitude", 4, 1e-7};
+        static constexpr FieldDesc<int32_t> ALTITUDE{"altitude", 8, 0.001f};
+        static constexpr FieldDesc<uint16_t> GROUND_SPEED{"ground_speed", 12, 0.01f};
+        static constexpr FieldDesc<uint16_t> COURSE{"course", 14, DEG_TO_RAD * 0.01f};
+        static constexpr FieldDesc<uint8_t> SATELLITES{"satellites", 16};
+        static constexpr FieldDesc<uint8_t> FIX_TYPE{"fix_type", 17};
+
+        static constexpr auto FIELDS = std::make_tuple(LATITUDE, LONGITUDE, ALTITUDE, GROUND_SPEED, COURSE, SATELLITES, FIX_TYPE);
+    };
+
+    /**
+     * @brief Air data
+     * @details Pressures in Pa, temperature in °C
+     */
+    struct AirData
+    {
+        static constexpr uint8_t ID = 0x05;
+        static constexpr const char *NAME = "airdata";
+
+        static constexpr FieldDesc<float> DIFF_PRESSURE{"diff_pressure", 0};
+        static constexpr FieldDesc<float> STATIC_PRESSURE{"static_pressure", 4};
+        static constexpr FieldDesc<int16_t> TEMPERATURE{"temperature", 8, 0.01f};
+
+        static constexpr auto FIELDS = std::make_tuple(DIFF_PRESSURE, STATIC_PRESSURE, TEMPERATURE);
+    };
+
+    /// Decoder for all frames sent by the flight controller
+    using TelemetryDecoder = FrameDecoder<Imu, Attitude, Battery, Gps, AirData>;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "DatagramPool.h"
+#include "DerivedChannels.h"
+#include "TelemetryFrames.h"
+#include "TelemetrySnapshot.h"
+#include "TelemetryStore.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <tuple>
+
+namespace aerolab::Core
+{
+    /**
+     * @brief The TelemetryIngest class
+     * @details Decodes received datagrams and appends the fields of all flight controller frames
+     *          to the channels of a TelemetryStore. The channels are resolved once on construction.
+     *          Samples are stamped with the receive timestamp of the datagram.
+     * @note Process() must not be called concurrently, it is the writer of the channels. Calls from different
+     *       threads have to be ordered, e.g. by the VehiclePipeline task.
+     */
+    class TelemetryIngest
+    {
+    public:
+        TelemetryIngest(std::shared_ptr<TelemetryStore> pStore, const std::string &channelPrefix = "");
+
+        void Process(const Datagram &datagram);
+
+        /// @brief Number of decoded frames
+        uint64_t DecodedFrames() const { return m_decodedFrames.load(std::memory_order_relaxed); }
+        /// @brief Number of datagrams without a valid frame
+        uint64_t InvalidDatagrams() const { return m_invalidDatagrams.load(std::memory_order_relaxed); }
+
+        /// @brief Sets the buffer the latest values are published to, once per decoded datagram
+        /// @details The ingest is the only writer of the buffer. Has to be set before the first Process().
+        /// @param pSnapshot The buffer, nullptr to disable
+        void SetSnapshotBuffer(std::shared_ptr<TelemetrySnapshotBuffer> pSnapshot) { m_pSnapshot = std::move(pSnapshot); }
+
+        void SetDerivedProgram(std::shared_ptr<const DerivedProgram> pProgram);
+        void FlushIdle();
+
+    private:
+        /// Store the samples are appended to
+        std::shared_ptr<TelemetryStore> m_pStore;
+        /// Prefix of all channel names
+        std::string m_channelPrefix;
+        /// Channels of all frame layouts
+        std::tuple<FrameChannels<Frames::Imu>,
+                   FrameChannels<Frames::Attitude>,
+                   FrameChannels<Frames::Battery>,
+                   FrameChannels<Frames::Gps>,
+                   FrameChannels<Frames::AirData>>
+            m_channels;
+        /// Number of decoded frames
+        std::atomic<uint64_t> m_decodedFrames{0};
+        /// Number of datagrams without a valid frame
+        std::atomic<uint64_t> m_invalidDatagrams{0};
+        /// Buffer the latest values are published to
+        std::shared_ptr<TelemetrySnapshotBuffer> m_pSnapshot;
+        /// Latest values, copied into the buffer on publishing
+        TelemetrySnapshot m_latest;
+        /// Evaluates the derived channels over the latest values, nullptr without derived channels
+        std::unique_ptr<DerivedEvaluator> m_pDerived;
+    };
+}
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <tuple>
+#include <type_traits>
+
+namespace aerolab::Core
+{
+    static_assert(std::endian::native == std::endian::little, "Telemetry frames are little endian, big endian hosts are not supported");
+
+    /// Sync byte starting every telemetry frame
+    constexpr uint8_t FRAME_SYNC = 0xA5;
+
+    /**
+     * @brief Header preceding the payload of every telemetry frame
+     * @details Frame layout (little endian): header | payload[payloadLength] | checksum (uint16)
+     */
+    struct FrameHeader
+    {
+        /// Always FRAME_SYNC
+        uint8_t sync;
+        /// ID of the sending vehicle
+        uint8_t systemId;
+        /// ID of the frame layout, see the frame descriptors
+        uint8_t messageId;
+        /// Reserved for flags
+        uint8_t flags;
+        /// Sequence number per vehicle
+        uint16_t sequence;
+        /// Number of payload bytes following the header
+        uint16_t payloadLength;
+        /// Monotonic send timestamp of the sender in nanoseconds
+        uint64_t timestampNs;
+    };
+    static_assert(sizeof(FrameHeader) == 16 && std::is_trivially_copyable_v<FrameHeader>, "FrameHeader must match the wire layout");
+
+    /// Size of the frame checksum
+    constexpr std::size_t FRAME_CHECKSUM_SIZE = sizeof(uint16_t);
+    /// Size of a frame without payload
+    constexpr std::size_t FRAME_OVERHEAD = sizeof(FrameHeader) + FRAME_CHECKSUM_SIZE;
+
+    /**
+     * @brief Calculates the frame checksum
+     * @details XOR over the data in 64 bit words folded to 16 bit. Four independent accumulators
+     *          let the compiler vectorise the loop, the checksum costs a few cycles per 32 bytes.
+     * @param data The header and payload of a frame
+     * @return The checksum
+     */
+    inline uint16_t FrameChecksum(std::span<const uint8_t> data)
+    {
+        uint64_t acc[4] = {0, 0, 0, 0};
+        std::size_t i = 0;
+
+        for (; i + 32 <= data.size(); i += 32)
+        {
+            uint64_t words[4];
+            std::memcpy(words, data.data() + i, sizeof(words));
+            acc[0] ^= words[0];
+            acc[1] ^= words[1];
+            acc[2] ^= words[2];
+            acc[3] ^= words[3];
+        }
+
+        uint64_t result = acc[0] ^ acc[1] ^ acc[2] ^ acc[3];
+
+        // Remaining bytes, placed at the same position they would have in a full word
+        for (; i < data.size(); i++)
+            result ^= static_cast<uint64_t>(data[i]) << ((i % 8) * 8);
+
+        result ^= result >> 32;
+        result ^= result >> 16;
+        return static_cast<uint16_t>(result);
+    }
+
+    /**
+     * @brief Compile-time descriptor of a single frame field
+     * @tparam Raw The wire type of the field
+     */
+    template <typename Raw>
+    struct FieldDesc
+    {
+        static_assert(std::is_arithmetic_v<Raw>, "Fields must be arithmetic types");
+        using RawType = Raw;
+
+        /// Name of the field, used as channel name
+        const char *name;
+        /// Byte offset inside the payload
+        std::size_t offset;
+        /// Factor converting the raw value into the physical value
+        double scale = 1.0;
+
+        /// @brief End of the field inside the payload
+        constexpr std::size_t End() const { return offset + sizeof(Raw); }
+    };
+
+    /**
+     * @brief Number of payload bytes a frame layout occupies
+     * @tparam Frame The frame descriptor
+     */
+    template <typename Frame>
+    constexpr std::size_t FramePayloadSize()
+    {
+        return std::apply([](const auto &...fields)
+                          {
+                              std::size_t size = 0;
+                              ((size = fields.End() > size ? fields.End() : size), ...);
+                              return size; },
+                          Frame::FIELDS);
+    }
+
+    /// Number of fields of a frame layout
+    template <typename Frame>
+    constexpr std::size_t FrameFieldCount = std::tuple_size_v<std::remove_cv_t<decltype(Frame::FIELDS)>>;
+
+    /**
+     * @brief Zero-copy view of a received frame
+     * @details Fields are read directly from the received bytes when accessed.
+     *          The view is only valid as long as the received buffer.
+     * @tparam Frame The frame descriptor
+     */
+    template <typename Frame>
+    class FrameView
+    {
+    public:
+        /// The frame descriptor of the view
+        using FrameType = Frame;
+
+        FrameView(const FrameHeader &header, const uint8_t *pPayload) : m_header(header), m_pPayload(pPayload) {}
+
+        /// @brief The header of the frame
+        const FrameHeader &Header() const { return m_header; }
+
+        /// @brief Reads the raw wire value of a field
+        template <typename Raw>
+        Raw GetRaw(const FieldDesc<Raw> &field) const
+        {
+            Raw value;
+            std::memcpy(&value, m_pPayload + field.offset, sizeof(Raw));
+            return value;
+        }
+
+        /// @brief Reads the scaled physical value of a field, in double so 32 bit raw values keep their resolution
+        template <typename Raw>
+        double Get(const FieldDesc<Raw> &field) const
+        {
+            return static_cast<double>(GetRaw(field)) * field.scale;
+        }
+
+        /**
+         * @brief Calls the given function for every field of the frame
+         * @param func Called as func(index, name, value) with the scaled value
+         */
+        template <typename Func>
+        void ForEachField(Func &&func) const
+        {
+            forEachField(func, std::make_index_sequence<FrameFieldCount<Frame>>{});
+        }
+
+    private:
+        template <typename Func, std::size_t... I>
+        void forEachField(Func &func, std::index_sequence<I...>) const
+        {
+            (func(I, std::get<I>(Frame::FIELDS).name, Get(std::get<I>(Frame::FIELDS))), ...);
+        }
+
+        /// Copy of the frame header
+        FrameHeader m_header;
+        /// Start of the payload inside the received buffer
+        const uint8_t *m_pPayload;
+    };
+
+    /// Enum for the result of decoding a frame
+    enum class E_DecodeResult
+    {
+        /// The frame has been decoded
+        Ok = 0,
+        /// Not enough bytes for the header or the announced payload
+        TooShort = 1,
+        /// The frame does not start with FRAME_SYNC
+        BadSync = 2,
+        /// The payload is shorter than the frame layout
+        BadLength = 3,
+        /// The checksum does not match
+        BadChecksum = 4,
+        /// No frame layout is registered for the message ID
+        UnknownMessage = 5
+    };
+
+    /**
+     * @brief The FrameDecoder class
+     * @details Decodes telemetry frames of the given layouts without copying the payload.
+     *          The message ID is dispatched through a jump table generated at compile time,
+     *          the handler receives a FrameView of the matching layout. Handlers only need to
+     *          accept the layouts they are interested in, other frames are validated and skipped.
+     * @tparam Frames The frame descriptors, every descriptor provides ID, NAME and FIELDS
+     */
+    template <typename... Frames>
+    class FrameDecoder
+    {
+    public:
+        /**
+         * @brief Decodes the first frame of the given data
+         * @param data The received bytes
+         * @param handler Called with a FrameView of the decoded frame
+         * @param consumed Receives the number of bytes belonging to the frame
+         * @return The result of the decoding
+         */
+        template <typename Handler>
+        static E_DecodeResult DecodeFrame(std::span<const uint8_t> data, Handler &&handler, std::size_t &consumed)
+        {
+            consumed = data.size();
+
+            if (data.size() < FRAME_OVERHEAD)
+                return E_DecodeResult::TooShort;
+
+            FrameHeader header;
+            std::memcpy(&header, data.data(), sizeof(header));
+
+            if (header.sync != FRAME_SYNC)
+                return E_DecodeResult::BadSync;
+
+            const std::size_t frameSize = FRAME_OVERHEAD + header.payloadLength;
+            if (data.size() < frameSize)
+                return E_DecodeResult::TooShort;
+
+            consumed = frameSize;
+
+            uint16_t checksum;
+            std::memcpy(&checksum, data.data() + frameSize - FRAME_CHECKSUM_SIZE, sizeof(checksum));
+            if (checksum != FrameChecksum(data.first(frameSize - FRAME_CHECKSUM_SIZE)))
+                return E_DecodeResult::BadChecksum;
+
+            using HandlerType = std::remove_reference_t<Handler>;
+            constexpr auto table = makeDispatchTable<HandlerType>();
+
+            const auto dispatch = table[header.messageId];
+            if (dispatch == nullptr)
+                return E_DecodeResult::UnknownMessage;
+
+            return dispatch(header, data.data() + sizeof(FrameHeader), handler);
+        }
+
+        /**
+         * @brief Decodes all frames contained in the given data
+         * @param data The received bytes, containing one or more frames back to back
+         * @param handler Called with a FrameView for every decoded frame
+         * @return Number of decoded frames
+         */
+        template <typename Handler>
+        static std::size_t Decode(std::span<const uint8_t> data, Handler &&handler)
+        {
+            std::size_t decoded = 0;
+
+            while (!data.empty())
+            {
+                std::size_t consumed = 0;
+                const E_DecodeResult result = DecodeFrame(data, handler, consumed);
+
+                if (result == E_DecodeResult::Ok)
+                    decoded++;
+                else if (result != E_DecodeResult::UnknownMessage && result != E_DecodeResult::BadLength)
+                    break; // Framing is lost, skip the rest of the datagram
+
+                data = data.subspan(consumed);
+            }
+
+            return decoded;
+        }
+
+    private:
+        template <typename Handler>
+        using Dispatch = E_DecodeResult (*)(const FrameHeader &, const uint8_t *, Handler &);
+
+        /// @brief Validates the length and calls the handler for a single frame layout
+        template <typename Frame, typename Handler>
+        static E_DecodeResult dispatchFrame(const FrameHeader &header, const uint8_t *pPayload, Handler &handler)
+        {
+            // Longer payloads are accepted so the sender may append fields
+            if (header.payloadLength < FramePayloadSize<Frame>())
+                return E_DecodeResult::BadLength;
+
+            if constexpr (std::is_invocable_v<Handler &, const FrameView<Frame> &>)
+            {
+                const FrameView<Frame> view(header, pPayload);
+                handler(view);
+            }
+
+            return E_DecodeResult::Ok;
+        }
+
+        /// @brief Builds the message ID jump table
+        template <typename Handler>
+        static constexpr std::array<Dispatch<Handler>, 256> makeDispatchTable()
+        {
+            std::array<Dispatch<Handler>, 256> table{};
+            ((table[Frames::ID] = &dispatchFrame<Frames, Handler>), ...);
+            return table;
+        }
+
+        /// @brief Checks that no message ID is registered twice
+        static constexpr bool uniqueIds()
+        {
+            constexpr std::array<uint8_t, sizeof...(Frames)> ids{Frames::ID...};
+            for (std::size_t i = 0; i < ids.size(); i++)
+                for (std::size_t j = i + 1; j < ids.size(); j++)
+                    if (ids[i] == ids[j])
+                        return false;
+            return true;
+        }
+
+        static_assert(sizeof...(Frames) > 0, "FrameDecoder needs at least one frame layout");
+        static_assert(uniqueIds(), "Frame layouts must have unique message IDs");
+    };
+}
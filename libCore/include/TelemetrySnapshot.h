@@ -0,0 +1,75 @@
+#pragma once
+
+#include "TelemetryFrames.h"
+#include "TripleBuffer.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace aerolab::Core
+{
+    namespace Detail
+    {
+        /// @brief Number of fields of the frames in front of Frame in the list
+        template <typename Frame, typename First, typename... Rest>
+        constexpr std::size_t snapshotOffset()
+        {
+            if constexpr (std::is_same_v<Frame, First>)
+                return 0;
+            else
+                return FrameFieldCount<First> + snapshotOffset<Frame, Rest...>();
+        }
+    }
+
+    /// Index of the first field of a frame layout in the snapshot, the fields follow in frame order
+    template <typename Frame>
+    constexpr std::size_t SNAPSHOT_OFFSET = Detail::snapshotOffset<Frame, Frames::Imu, Frames::Attitude, Frames::Battery, Frames::Gps, Frames::AirData>();
+
+    /// Number of fields in the snapshot
+    constexpr std::size_t SNAPSHOT_FIELD_COUNT = SNAPSHOT_OFFSET<Frames::AirData> + FrameFieldCount<Frames::AirData>;
+
+    /**
+     * @brief Latest values of all fields of the flight controller frames
+     * @details Written by the ingest once per datagram and handed to the GUI through a TelemetrySnapshotBuffer.
+     *          Fields which have not been received yet are 0.
+     */
+    struct TelemetrySnapshot
+    {
+        /// Scaled values in snapshot order, see SNAPSHOT_OFFSET, in double like FrameView::Get()
+        std::array<double, SNAPSHOT_FIELD_COUNT> values{};
+        /// Receive timestamp of the latest datagram in nanoseconds
+        int64_t timestampNs = 0;
+        /// Number of datagrams the snapshot contains, 0 before the first
+        uint64_t sequence = 0;
+    };
+
+    /// Buffer handing the snapshots from the ingest to the GUI
+    using TelemetrySnapshotBuffer = TripleBuffer<TelemetrySnapshot>;
+
+    /**
+     * @brief Names of the snapshot fields
+     * @details Same names as the channels of the TelemetryIngest, e.g. "imu/acc_x".
+     * @return The names in snapshot order
+     */
+    inline std::vector<std::string> SnapshotFieldNames()
+    {
+        std::vector<std::string> names;
+        names.reserve(SNAPSHOT_FIELD_COUNT);
+
+        const auto addFrame = [&names](const char *frameName, const auto &fields)
+        {
+            std::apply([&](const auto &...field)
+                       { (names.push_back(std::string(frameName) + "/" + field.name), ...); },
+                       fields);
+        };
+        addFrame(Frames::Imu::NAME, Frames::Imu::FIELDS);
+        addFrame(Frames::Attitude::NAME, Frames::Attitude::FIELDS);
+        addFrame(Frames::Battery::NAME, Frames::Battery::FIELDS);
+        addFrame(Frames::Gps::NAME, Frames::Gps::FIELDS);
+        addFrame(Frames::AirData::NAME, Frames::AirData::FIELDS);
+        return names;
+    }
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include "TelemetrySchema.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace aerolab::Core
+{
+    /// Single raw sample of a channel
+    struct TelemetrySample
+    {
+        /// Timestamp in nanoseconds
+        int64_t timestampNs;
+        /// Sample value
+        double value;
+    };
+
+    /// Aggregate of consecutive samples of a channel
+    struct TelemetryBucket
+    {
+        /// Timestamp of the first aggregated sample in nanoseconds
+        int64_t timestampNs;
+        /// Minimum of the aggregated samples
+        double min;
+        /// Maximum of the aggregated samples
+        double max;
+        /// Mean of the aggregated samples
+        double mean;
+    };
+
+    /**
+     * @brief The TelemetryChannel class
+     * @details Time series of a single telemetry channel. Samples are kept as structure-of-arrays ring buffer
+     *          of timestamps and values. Additionally min/max/mean decimation levels are maintained incrementally
+     *          while samples arrive (see LEVEL_FACTORS), each level keeps the same number of entries as the raw ring,
+     *          so coarser levels reach further into the past.
+     *          A channel has a single writer, any number of readers. Readers never block the writer: they copy
+     *          the entries they need and discard the ones the writer overwrote meanwhile (seqlock style).
+     *          Values are stored as float offsets from the first sample of the channel, so channels with a large
+     *          constant part keep their resolution: a position 1 deg away from the first fix still resolves about 1 cm.
+     * @note Timestamps have to be monotonic, older timestamps are clamped to the latest one.
+     */
+    class TelemetryChannel
+    {
+    public:
+        /// Number of raw samples aggregated per entry of each decimation level
+        static constexpr std::array<std::size_t, 3> LEVEL_FACTORS{1, 16, 256};
+
+        TelemetryChannel(std::string name, std::size_t capacity);
+
+        /// Delete copy constructor, readers reference the channel
+        TelemetryChannel(const TelemetryChannel &) = delete;
+        /// Delete assign operator, readers reference the channel
+        TelemetryChannel &operator=(const TelemetryChannel &) = delete;
+
+        /// @brief Name of the channel
+        const std::string &Name() const { return m_name; }
+        /// @brief Number of entries kept per level
+        std::size_t Capacity() const { return m_capacity; }
+        /// @brief Total number of samples appended since construction
+        uint64_t SampleCount() const { return m_raw.written.load(std::memory_order_acquire); }
+
+        void Append(int64_t timestampNs, double value);
+
+        bool Latest(TelemetrySample &sample) const;
+        std::size_t ReadFrom(uint64_t &position, std::span<TelemetrySample> out) const;
+        std::size_t ReadRaw(int64_t startNs, int64_t endNs, std::vector<TelemetrySample> &out) const;
+        std::size_t Query(int64_t startNs, int64_t endNs, std::size_t maxPoints, std::vector<TelemetryBucket> &out) const;
+
+    private:
+        /// Ring of a single level, raw samples use min as value
+        struct Level
+        {
+            /// Timestamps of the entries
+            std::unique_ptr<std::atomic<int64_t>[]> timestamps;
+            /// Minimum (or value for the raw level), offset from m_origin
+            std::unique_ptr<std::atomic<float>[]> mins;
+            /// Maximum, not used for the raw level, offset from m_origin
+            std::unique_ptr<std::atomic<float>[]> maxs;
+            /// Mean, not used for the raw level, offset from m_origin
+            std::unique_ptr<std::atomic<float>[]> means;
+            /// Number of entries the writer started to write
+            std::atomic<uint64_t> reserved{0};
+            /// Number of completely written entries
+            std::atomic<uint64_t> written{0};
+
+            /// Entry under construction, only accessed by the writer
+            TelemetryBucket pending{};
+            /// Number of entries of the finer level in the pending entry
+            std::size_t pendingCount = 0;
+        };
+
+        void accumulate(std::size_t levelIndex, const TelemetryBucket &entry);
+        void publish(Level &level, const TelemetryBucket &entry, bool aggregated);
+        TelemetryBucket readEntry(const Level &level, uint64_t index, bool aggregated) const;
+        bool isValid(const Level &level, uint64_t index) const;
+        uint64_t lowerBound(const Level &level, int64_t timestampNs) const;
+        void gather(std::size_t levelIndex, int64_t startNs, int64_t endNs, std::vector<TelemetryBucket> &out) const;
+
+        /// Name of the channel
+        const std::string m_name;
+        /// Entries per level, power of two
+        const std::size_t m_capacity;
+        /// Mask mapping indices to ring slots
+        const std::size_t m_mask;
+        /// Raw samples
+        Level m_raw;
+        /// Decimation levels, m_levels[i] belongs to LEVEL_FACTORS[i + 1]
+        std::array<Level, LEVEL_FACTORS.size() - 1> m_levels;
+        /// Latest appended timestamp, only accessed by the writer
+        int64_t m_lastTimestamp = std::numeric_limits<int64_t>::min();
+        /// Value the stored offsets are relative to, set before the first sample is published and constant afterwards
+        double m_origin = 0.0;
+    };
+
+    /**
+     * @brief The TelemetryStore class
+     * @details Holds the time series of all telemetry channels. Channels are created on first use and
+     *          live as long as the store. Writers and readers should keep the channel pointer instead of
+     *          looking the channel up per sample.
+     */
+    class TelemetryStore
+    {
+    public:
+        explicit TelemetryStore(std::size_t capacity = 1 << 16);
+
+        std::shared_ptr<TelemetryChannel> GetOrAddChannel(const std::string &name);
+        std::shared_ptr<TelemetryChannel> GetChannel(const std::string &name) const;
+        std::vector<std::string> ChannelNames() const;
+
+    private:
+        /// Entries per level of new channels
+        std::size_t m_capacity;
+        /// Mutex protecting the channel map, never taken per sample
+        mutable std::shared_mutex m_mutex;
+        /// Channels by name
+        std::map<std::string, std::shared_ptr<TelemetryChannel>> m_channels;
+    };
+
+    /**
+     * @brief Maps the fields of a frame layout to store channels
+     * @details Channels are resolved once on construction and named "<prefix><frame name>/<field name>".
+     * @tparam Frame The frame descriptor
+     */
+    template <typename Frame>
+    class FrameChannels
+    {
+    public:
+        FrameChannels(TelemetryStore &store, const std::string &prefix = "")
+        {
+            std::size_t index = 0;
+            std::apply([&](const auto &...fields)
+                       { ((m_channels[index++] = store.GetOrAddChannel(prefix + Frame::NAME + "/" + fields.name)), ...); },
+                       Frame::FIELDS);
+        }
+
+        /**
+         * @brief Appends all fields of a frame to their channels
+         * @param view The decoded frame
+         * @param timestampNs Timestamp of the samples
+         */
+        void Append(const FrameView<Frame> &view, int64_t timestampNs)
+        {
+            view.ForEachField([&](std::size_t index, const char *, double value)
+                              { m_channels[index]->Append(timestampNs, value); });
+        }
+
+    private:
+        /// Channels in field order
+        std::array<std::shared_ptr<TelemetryChannel>, FrameFieldCount<Frame>> m_channels;
+    };
+}
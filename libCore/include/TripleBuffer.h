@@ -0,0 +1,98 @@
+#pragma once
+
+#include "RingBuffer.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace aerolab::Core
+{
+    /**
+     * @brief The TripleBuffer class
+     * @details Hands the latest value of a single writer to a single reader without locks and without queueing.
+     *          The writer fills its own slot and swaps it with the middle slot on Publish(), the reader swaps
+     *          its own slot with the middle slot on Update() if something has been published since. Neither side
+     *          ever waits for the other, and the reader always gets the most recently published value:
+     *          intermediate values the reader did not pick up in time are overwritten, not queued.
+     *          Every slot is on its own cache line, so writing a slot never invalidates the slot being read.
+     * @note Write() and Publish() must only be called from one thread at a time, the same applies to Update() and Read().
+     * @tparam T Value type, has to be default constructible and copy assignable
+     */
+    template <typename T>
+    class TripleBuffer
+    {
+    public:
+        TripleBuffer() = default;
+
+        /// @brief Initializes all slots with the given value
+        explicit TripleBuffer(const T &initial)
+        {
+            for (Slot &slot : m_slots)
+                slot.value = initial;
+        }
+
+        TripleBuffer(const TripleBuffer &) = delete;
+        TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+        /**
+         * @brief The slot of the writer
+         * @details Holds an older value after Publish(), the writer has to fill it completely before publishing it.
+         * @return The slot to fill
+         */
+        T &WriteBuffer() { return m_slots[m_writeIndex].value; }
+
+        /// @brief Makes the write slot the latest value, replacing an unread value
+        void Publish()
+        {
+            const uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_writeIndex | FRESH_FLAG), std::memory_order_acq_rel);
+            m_writeIndex = previous & INDEX_MASK;
+        }
+
+        /// @brief Copies the value into the write slot and publishes it
+        void Write(const T &value)
+        {
+            WriteBuffer() = value;
+            Publish();
+        }
+
+        /**
+         * @brief Takes the latest published value
+         * @details Costs a single relaxed load if nothing has been published since the last call.
+         * @return True if Read() returns a new value
+         */
+        bool Update()
+        {
+            if ((m_middle.load(std::memory_order_relaxed) & FRESH_FLAG) == 0)
+                return false;
+
+            const uint8_t previous = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+            m_readIndex = previous & INDEX_MASK;
+            return true;
+        }
+
+        /// @brief The value taken by the last Update()
+        const T &Read() const { return m_slots[m_readIndex].value; }
+
+    private:
+        /// Bits of the middle state holding the slot index
+        static constexpr uint8_t INDEX_MASK = 0x03;
+        /// Bit of the middle state set while the middle slot has not been read
+        static constexpr uint8_t FRESH_FLAG = 0x04;
+
+        /// A value padded to its own cache lines
+        struct alignas(CACHE_LINE_SIZE) Slot
+        {
+            T value{};
+        };
+
+        /// The three slots, owned by the writer, the reader and the middle at any time
+        std::array<Slot, 3> m_slots;
+        /// Slot of the writer, only accessed by the writer
+        alignas(CACHE_LINE_SIZE) uint8_t m_writeIndex = 0;
+        /// Slot in the middle and FRESH_FLAG, exchanged by both sides
+        alignas(CACHE_LINE_SIZE) std::atomic<uint8_t> m_middle{1};
+        /// Slot of the reader, only accessed by the reader
+        alignas(CACHE_LINE_SIZE) uint8_t m_readIndex = 2;
+    };
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "TelemetrySchema.h"
+
+namespace aerolab::Core::Frames
+{
+    /// Header flag of uplink frames the receiver has to acknowledge with an Ack frame
+    constexpr uint8_t FRAME_FLAG_ACK_REQUESTED = 0x01;
+
+    /// Commands understood by the flight controller
+    enum class E_UplinkCommand : uint16_t
+    {
+        /// Arm the motors
+        Arm = 1,
+        /// Disarm the motors
+        Disarm = 2,
+        /// Return to the launch position
+        ReturnToLaunch = 3,
+        /// Land at the current position
+        Land = 4
+    };
+
+    /**
+     * @brief Heartbeat of the ground station, sent at a fixed rate
+     * @details The flight controller starts its link loss failsafe if the heartbeats stop.
+     */
+    struct Heartbeat
+    {
+        static constexpr uint8_t ID = 0x40;
+        static constexpr const char *NAME = "heartbeat";
+
+        static constexpr FieldDesc<uint8_t> STATE{"state", 0};
+
+        static constexpr auto FIELDS = std::make_tuple(STATE);
+    };
+
+    /**
+     * @brief Command to the flight controller, always acknowledged
+     * @details The meaning of the parameters depends on the command, see E_UplinkCommand
+     */
+    struct Command
+    {
+        static constexpr uint8_t ID = 0x41;
+        static constexpr const char *NAME = "command";
+
+        static constexpr FieldDesc<uint16_t> COMMAND{"command", 0};
+        static constexpr FieldDesc<float> PARAM1{"param1", 2};
+        static constexpr FieldDesc<float> PARAM2{"param2", 6};
+
+        static constexpr auto FIELDS = std::make_tuple(COMMAND, PARAM1, PARAM2);
+    };
+
+    /**
+     * @brief Sets a parameter of the flight controller, always acknowledged
+     * @details Parameter uploads send one frame per parameter
+     */
+    struct ParameterSet
+    {
+        static constexpr uint8_t ID = 0x42;
+        static constexpr const char *NAME = "parameter_set";
+
+        static constexpr FieldDesc<uint16_t> INDEX{"index", 0};
+        static constexpr FieldDesc<float> VALUE{"value", 2};
+
+        static constexpr auto FIELDS = std::make_tuple(INDEX, VALUE);
+    };
+
+    /**
+     * @brief Acknowledgement of an uplink frame, sent by the flight controller
+     * @details Carries the sequence number and the message ID of the acknowledged frame
+     */
+    struct Ack
+    {
+        static constexpr uint8_t ID = 0x43;
+        static constexpr const char *NAME = "ack";
+
+        static constexpr FieldDesc<uint16_t> SEQUENCE{"sequence", 0};
+        static constexpr FieldDesc<uint8_t> MESSAGE_ID{"message_id", 2};
+        static constexpr FieldDesc<uint8_t> RESULT{"result", 3};
+
+        static constexpr auto FIELDS = std::make_tuple(SEQUENCE, MESSAGE_ID, RESULT);
+    };
+
+    /// Decoder for the frames sent by the ground station, used by the flight controller side
+    using UplinkDecoder = FrameDecoder<Heartbeat, Command, ParameterSet>;
+    /// Decoder for the acknowledgements received by the ground station
+    using AckDecoder = FrameDecoder<Ack>;
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "DatagramPool.h"
+#include "FlightRecorder.h"
+#include "Metrics.h"
+#include "RingBuffer.h"
+#include "TelemetryIngest.h"
+#include "TelemetryStore.h"
+#include "WorkStealingPool.h"
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace aerolab::Core
+{
+    /// Enum for the key the datagrams are assigned to a vehicle by
+    enum class E_DemuxKey
+    {
+        /// System ID in the header of the first frame, vehicles may change their address
+        SystemId = 0,
+        /// Address and port the datagram was received from, for senders without unique system IDs
+        SourceEndpoint = 1
+    };
+
+    /// Decoder outputs of a vehicle, created by the pipeline factory of the VehicleDemux
+    struct VehicleParts
+    {
+        /// Store the decoded samples are appended to
+        std::shared_ptr<TelemetryStore> pStore;
+        /// Prefix of the channel names, separates the vehicles in a shared store
+        std::string channelPrefix;
+        /// Optional recorder of the raw datagrams, has to be started by the factory
+        std::shared_ptr<FlightRecorder> pRecorder;
+        /// Optional buffer the latest values are published to, the vehicle has to be its only writer
+        std::shared_ptr<TelemetrySnapshotBuffer> pSnapshot;
+        /// Optional derived channels, computed per vehicle with the channel prefix
+        std::shared_ptr<const DerivedProgram> pDerived;
+    };
+
+    class VehiclePipeline;
+
+    /**
+     * @brief Called on a worker for every processed datagram, after it has been decoded and recorded
+     * @details Called in receive order per vehicle, but concurrently for different vehicles.
+     */
+    using VehicleProcessedCallback = std::function<void(const VehiclePipeline &vehicle, const Datagram &datagram)>;
+
+    /**
+     * @brief The VehiclePipeline class
+     * @details Decoder, store and recorder of a single vehicle. Datagrams are posted into the inbox of the
+     *          pipeline and processed by a task on the worker pool. At most one task per pipeline is queued
+     *          or running, so the datagrams of a vehicle are processed one after another in posting order,
+     *          while the pipelines of different vehicles run in parallel on all workers.
+     *          A task processes at most DRAIN_BUDGET datagrams and then requeues itself behind the other
+     *          pipelines, so a busy vehicle never starves the others.
+     *          The decoder resolves its channels in the first task, allocating the channels of a new vehicle
+     *          takes long enough to stall the receive thread.
+     */
+    class VehiclePipeline : public std::enable_shared_from_this<VehiclePipeline>
+    {
+    public:
+        /// Datagrams processed per task before the pipeline yields the worker
+        static constexpr std::size_t DRAIN_BUDGET = 64;
+
+        VehiclePipeline(WorkStealingPool &pool, std::string name, VehicleParts parts, std::size_t inboxCapacity,
+                        VehicleProcessedCallback onProcessed);
+
+        /// Delete copy constructor, queued tasks reference the pipeline
+        VehiclePipeline(const VehiclePipeline &) = delete;
+        /// Delete assign operator, queued tasks reference the pipeline
+        VehiclePipeline &operator=(const VehiclePipeline &) = delete;
+
+        bool Post(const Datagram &datagram);
+
+        /// @brief Name of the vehicle, e.g. "v1" or "192.168.4.2:5005"
+        const std::string &Name() const { return m_name; }
+        /// @brief Store the samples of the vehicle are appended to
+        const std::shared_ptr<TelemetryStore> &Store() const { return m_parts.pStore; }
+        /// @brief Prefix of the channel names of the vehicle
+        const std::string &ChannelPrefix() const { return m_parts.channelPrefix; }
+        /// @brief Recorder of the vehicle, may be nullptr
+        const std::shared_ptr<FlightRecorder> &Recorder() const { return m_parts.pRecorder; }
+        uint64_t DecodedFrames() const;
+        uint64_t InvalidDatagrams() const;
+        void FlushIdle();
+        /// @brief Number of datagrams dropped because the inbox was full
+        uint64_t DroppedCount() const { return m_inbox.DroppedCount(); }
+
+    private:
+        void schedule();
+        void drain();
+
+        /// Pool the tasks of the pipeline run on
+        WorkStealingPool &m_pool;
+        /// Name of the vehicle
+        std::string m_name;
+        /// Store, channel prefix and recorder of the vehicle
+        VehicleParts m_parts;
+        /// Decoder of the vehicle, created and used by the task of the pipeline
+        std::unique_ptr<TelemetryIngest> m_pIngest;
+        /// The decoder has been created
+        std::atomic<bool> m_ingestReady{false};
+        /// Datagrams waiting for the task
+        RingBuffer<Datagram> m_inbox;
+        /// Called for every processed datagram
+        VehicleProcessedCallback m_onProcessed;
+        /// A task of the pipeline is queued or running
+        alignas(CACHE_LINE_SIZE) std::atomic<bool> m_scheduled{false};
+
+        /// Registry of the metrics below, labeled with the vehicle name
+        std::shared_ptr<MetricsRegistry> m_pMetrics;
+        /// Processed datagrams
+        MetricCounter *m_pProcessedCounter = nullptr;
+        /// Datagrams the full inbox refused
+        MetricCounter *m_pDropCounter = nullptr;
+    };
+
+    /**
+     * @brief The VehicleDemux class
+     * @details Assigns received datagrams to per-vehicle pipelines by system ID or source endpoint, so several
+     *          aircraft can send to the same port. A pipeline is created with the first datagram of a vehicle,
+     *          its store, channel prefix and recorder are provided by the factory. Without a factory every
+     *          vehicle gets its own store.
+     *
+     *          Dispatch() is meant to be called from the InputManager callback. It never blocks and only
+     *          posts the datagram handle into the inbox of the pipeline, decoding and recording run on the
+     *          shared WorkStealingPool. Datagrams of a vehicle are processed in the order of the Dispatch()
+     *          calls, i.e. in receive order as long as a source is received by a single shard.
+     * @note The pool has to outlive the demux.
+     */
+    class VehicleDemux
+    {
+    public:
+        /// Creates store, channel prefix and recorder of a new vehicle
+        using PipelineFactory = std::function<VehicleParts(const std::string &name)>;
+
+        VehicleDemux(WorkStealingPool &pool, E_DemuxKey key = E_DemuxKey::SystemId, PipelineFactory factory = {});
+
+        /// Delete copy constructor, the pipelines reference the pool
+        VehicleDemux(const VehicleDemux &) = delete;
+        /// Delete assign operator, the pipelines reference the pool
+        VehicleDemux &operator=(const VehicleDemux &) = delete;
+
+        bool Dispatch(const Datagram &datagram);
+
+        /// @brief Sets the maximum number of vehicles, datagrams of further vehicles are dropped. Has to be set before the first Dispatch().
+        void SetMaxVehicles(std::size_t maxVehicles) { m_maxVehicles = maxVehicles; }
+        /// @brief Sets the inbox capacity of new pipelines. Has to be set before the first Dispatch().
+        void SetInboxCapacity(std::size_t capacity) { m_inboxCapacity = capacity; }
+        /// @brief Sets the callback for processed datagrams. Has to be set before the first Dispatch().
+        void SetProcessedCallback(VehicleProcessedCallback callback) { m_onProcessed = std::move(callback); }
+
+        std::vector<std::shared_ptr<VehiclePipeline>> Vehicles() const;
+        void FlushIdle();
+
+    private:
+        /// Hash of the source endpoints
+        struct EndpointHash
+        {
+            std::size_t operator()(const boost::asio::ip::udp::endpoint &endpoint) const;
+        };
+
+        VehiclePipeline *findBySystemId(uint8_t systemId);
+        VehiclePipeline *findByEndpoint(const boost::asio::ip::udp::endpoint &endpoint);
+        std::shared_ptr<VehiclePipeline> createPipeline(const std::string &name);
+
+        /// Pool the pipelines run on
+        WorkStealingPool &m_pool;
+        /// Key the datagrams are assigned by
+        E_DemuxKey m_key;
+        /// Creates the parts of new vehicles
+        PipelineFactory m_factory;
+        /// Maximum number of vehicles
+        std::size_t m_maxVehicles = 64;
+        /// Inbox capacity of new pipelines
+        std::size_t m_inboxCapacity = 4096;
+        /// Called for every processed datagram
+        VehicleProcessedCallback m_onProcessed;
+
+        /// Pipelines by system ID, read without locking
+        std::array<std::atomic<VehiclePipeline *>, 256> m_bySystemId{};
+        /// Pipelines by source endpoint, guarded by m_endpointMutex
+        std::unordered_map<boost::asio::ip::udp::endpoint, VehiclePipeline *, EndpointHash> m_byEndpoint;
+        /// Mutex of the endpoint map, only taken exclusively when a vehicle is added
+        mutable std::shared_mutex m_endpointMutex;
+        /// All pipelines, owns them, guarded by m_vehicleMutex
+        std::vector<std::shared_ptr<VehiclePipeline>> m_vehicles;
+        /// Mutex of the pipeline list, serializes the creation of pipelines
+        mutable std::mutex m_vehicleMutex;
+        /// The vehicle limit has been reported, guarded by m_vehicleMutex
+        bool m_limitReported = false;
+
+        /// Registry of the metrics below
+        std::shared_ptr<MetricsRegistry> m_pMetrics;
+        /// Datagrams without a valid header or of vehicles beyond the limit
+        MetricCounter *m_pUnroutedCounter = nullptr;
+        /// Number of vehicles
+        MetricGauge *m_pVehicleGauge = nullptr;
+    };
+}
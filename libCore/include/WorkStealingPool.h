@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Metrics.h"
+#include "RingBuffer.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace aerolab::Core
+{
+    /**
+     * @brief The WorkStealingPool class
+     * @details Fixed set of worker threads, every worker owns a task queue. Tasks submitted by a worker go to
+     *          its own queue, tasks submitted by other threads (e.g. the receive threads) are spread round robin.
+     *          A worker runs its own tasks in submission order and steals from the other queues once its own
+     *          queue is empty, so a burst of work for one worker is picked up by all idle workers.
+     *          Idle workers sleep until a task is submitted.
+     *          Tasks should be short, long running work should be split into tasks which resubmit themselves.
+     */
+    class WorkStealingPool
+    {
+    public:
+        /// A unit of work, small captures like a single shared_ptr are stored without allocation
+        using Task = std::function<void()>;
+
+        explicit WorkStealingPool(std::size_t threadCount = 0);
+        ~WorkStealingPool();
+
+        /// Delete copy constructor, the workers reference the pool
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        /// Delete assign operator, the workers reference the pool
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        void Submit(Task task);
+        void Stop();
+
+        /// @brief Number of worker threads
+        std::size_t ThreadCount() const { return m_workers.size(); }
+        /// @brief Native handle of a worker thread, e.g. for CPU pinning
+        std::thread::native_handle_type NativeHandle(std::size_t index) { return m_workers[index]->thread.native_handle(); }
+        /// @brief Number of tasks taken from the queue of another worker
+        uint64_t StealCount() const { return m_pStealCounter->Value(); }
+
+    private:
+        /// Queue and thread of a single worker, on its own cache lines
+        struct alignas(CACHE_LINE_SIZE) Worker
+        {
+            /// Mutex of the queue, only contended while another worker steals
+            std::mutex mutex;
+            /// Queued tasks, the owner pops the front, thieves the back
+            std::deque<Task> tasks;
+            /// The worker thread
+            std::thread thread;
+        };
+
+        void run(std::size_t index);
+        bool popLocal(std::size_t index, Task &task);
+        bool steal(std::size_t index, Task &task);
+
+        /// The workers
+        std::vector<std::unique_ptr<Worker>> m_workers;
+        /// Round robin index for tasks submitted from other threads
+        std::atomic<std::size_t> m_nextWorker{0};
+        /// Number of queued tasks of all workers
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> m_pending{0};
+        /// Number of sleeping workers
+        std::atomic<std::size_t> m_sleeping{0};
+        /// Cleared to stop the workers
+        std::atomic<bool> m_running{true};
+        /// Mutex of the wake condition
+        std::mutex m_wakeMutex;
+        /// Wakes sleeping workers on new tasks and on stop
+        std::condition_variable m_wakeCondition;
+
+        /// Registry of the metrics below
+        std::shared_ptr<MetricsRegistry> m_pMetrics;
+        /// Executed tasks
+        MetricCounter *m_pTaskCounter = nullptr;
+        /// Tasks taken from the queue of another worker
+        MetricCounter *m_pStealCounter = nullptr;
+    };
+}
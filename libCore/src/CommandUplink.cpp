@@ -0,0 +1,776 @@
+#include "CommandUplink.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/socket.h>
+#endif
+
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Upper limit of the bulk frames per send syscall, sizes the message arrays on the stack
+    constexpr std::size_t MAX_BULK_BATCH = 64;
+    /// Clock granularity G of RFC 6298 in microseconds, the lower bound of the variation term
+    constexpr int64_t CLOCK_GRANULARITY_US = 1000;
+
+    constexpr const char *PRIORITY_LABELS[] = {"priority=\"command\"", "priority=\"heartbeat\"", "priority=\"bulk\""};
+
+    /// @brief Writes a field into a payload in wire format
+    template <typename Raw>
+    void writeField(std::span<uint8_t> payload, const FieldDesc<Raw> &field, Raw value)
+    {
+        std::memcpy(payload.data() + field.offset, &value, sizeof(Raw));
+    }
+
+    int64_t toMicroseconds(std::chrono::steady_clock::duration duration)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    }
+}
+
+/**
+ * @brief Constructor of the CommandUplink
+ * @param exec The IO Executor for asynchronous operations, may be multi-threaded
+ * @param options Settings of the uplink
+ */
+CommandUplink::CommandUplink(boost::asio::any_io_executor exec, UplinkOptions options) : m_options(std::move(options)),
+                                                                                         m_strand(boost::asio::make_strand(exec)),
+                                                                                         m_socket(m_strand),
+                                                                                         m_retransmitTimer(m_strand),
+                                                                                         m_heartbeatTimer(m_strand),
+                                                                                         m_rtoUs(toMicroseconds(m_options.initialRto)),
+                                                                                         m_pMetrics(MetricsRegistry::GetInstance())
+{
+    m_options.bulkBatch = std::clamp<std::size_t>(m_options.bulkBatch, 1, MAX_BULK_BATCH);
+    m_options.bulkWindow = std::max<std::size_t>(m_options.bulkWindow, 1);
+    m_batch.reserve(m_options.bulkBatch);
+    m_inFlight.reserve(m_options.bulkWindow * 2);
+
+    const std::string target = "target=\"" + m_options.target.address().to_string() + ":" + std::to_string(m_options.target.port()) + "\"";
+    for (std::size_t i = 0; i < PRIORITY_COUNT; i++)
+        m_sentCounters[i] = &m_pMetrics->GetCounter("aerolab_uplink_frames_total", "Sent uplink frames including retransmissions",
+                                                    target + "," + PRIORITY_LABELS[i]);
+    m_pRetransmitCounter = &m_pMetrics->GetCounter("aerolab_uplink_retransmits_total", "Retransmitted uplink frames", target);
+    m_pFailedCounter = &m_pMetrics->GetCounter("aerolab_uplink_failed_total", "Uplink frames not acknowledged after all retransmissions", target);
+    m_pErrorCounter = &m_pMetrics->GetCounter("aerolab_uplink_send_errors_total", "Failed uplink send calls", target);
+    m_pInFlightGauge = &m_pMetrics->GetGauge("aerolab_uplink_in_flight", "Uplink frames waiting for their acknowledgement", target);
+    m_pRoundTripHistogram = &m_pMetrics->GetHistogram("aerolab_uplink_round_trip_seconds", "Time from queuing an uplink frame to its acknowledgement", target);
+
+    LOG_INFO("Created CommandUplink");
+}
+
+/**
+ * @brief Destructor of the CommandUplink
+ * @details Stops the uplink, see Stop() for the threads it may be destroyed on.
+ */
+CommandUplink::~CommandUplink()
+{
+    Stop();
+}
+
+// ============================================================================
+// Livecycle Management
+// ============================================================================
+
+/**
+ * @brief Opens the socket and starts the heartbeats and the acknowledgement reception
+ * @details Has to be called before the executor runs or on the executor.
+ * @return True on success, False otherwise
+ */
+bool CommandUplink::Start()
+{
+    LOG_INFO("*** Starting CommandUplink ***");
+
+    boost::system::error_code ec;
+    m_socket.open(boost::asio::ip::udp::v4(), ec);
+    if (ec)
+    {
+        LOG_ERROR("open failed: " + ec.message());
+        return false;
+    }
+
+    m_socket.bind(m_options.local, ec);
+    if (ec)
+    {
+        LOG_ERROR("bind failed: " + ec.message());
+        m_socket.close(ec);
+        return false;
+    }
+
+    // Sends never block the strand, a full socket buffer is waited for asynchronously
+    m_socket.non_blocking(true, ec);
+
+    m_running = true;
+    receiveAcks();
+
+    if (m_options.heartbeatInterval.count() > 0)
+    {
+        m_heartbeatTimer.expires_at(std::chrono::steady_clock::now());
+        scheduleHeartbeat();
+    }
+
+    LOG_INFO("Uplink to " + m_options.target.address().to_string() + ":" + std::to_string(m_options.target.port()) +
+             " from port " + std::to_string(LocalEndpoint().port()));
+    LOG_INFO("*** CommandUplink started ***\n");
+    return true;
+}
+
+/**
+ * @brief Stops the uplink
+ * @details Runs the shutdown on the strand and waits for it, so it never races a handler of the uplink.
+ *          Frames waiting for their acknowledgement or in the queues are reported as failed.
+ *          Has to be called on the strand, e.g. from an AckCallback, or from a thread which does not run
+ *          the executor while the executor is running.
+ */
+void CommandUplink::Stop()
+{
+    if (!m_running.exchange(false))
+        return;
+
+    if (m_strand.running_in_this_thread())
+    {
+        shutdown();
+        return;
+    }
+
+    std::promise<void> done;
+    boost::asio::dispatch(m_strand, [this, &done]()
+                          {
+                              shutdown();
+                              done.set_value(); });
+    done.get_future().wait();
+}
+
+/**
+ * @brief Closes the socket, cancels the timers and fails the pending frames, runs on the strand
+ * @details Handlers which completed before are still queued on the strand, they return on the closed socket.
+ */
+void CommandUplink::shutdown()
+{
+    LOG_INFO("*** Stopping CommandUplink ***");
+
+    m_heartbeatTimer.cancel();
+    m_retransmitTimer.cancel();
+
+    boost::system::error_code ec;
+    m_socket.cancel(ec);
+    m_socket.close(ec);
+
+    std::vector<AckCallback> failed;
+    {
+        std::lock_guard<std::mutex> guard(m_queueMutex);
+        for (auto &queue : m_queues)
+        {
+            for (auto &outgoing : queue)
+                if (outgoing.onAck)
+                    failed.push_back(std::move(outgoing.onAck));
+            queue.clear();
+        }
+    }
+    for (auto &[sequence, entry] : m_inFlight)
+        if (entry.onAck)
+            failed.push_back(std::move(entry.onAck));
+    m_inFlight.clear();
+    m_bulkInFlight = 0;
+    m_waitingWritable = false;
+    m_timerDeadline = std::chrono::steady_clock::time_point::max();
+    m_pInFlightGauge->Set(0);
+
+    for (auto &callback : failed)
+        callback(false, std::chrono::nanoseconds(0));
+
+    LOG_INFO("*** CommandUplink stopped ***\n");
+}
+
+boost::asio::ip::udp::endpoint CommandUplink::LocalEndpoint() const
+{
+    boost::system::error_code ec;
+    return m_socket.local_endpoint(ec);
+}
+
+// ============================================================================
+// Queuing
+// ============================================================================
+
+/**
+ * @brief Queues a frame
+ * @details Thread-safe. Frames with the priority Heartbeat are sent once without acknowledgement,
+ *          all others are retransmitted until they are acknowledged.
+ * @param messageId ID of the frame layout, see UplinkFrames.h
+ * @param payload The payload of the frame
+ * @param priority The priority of the frame
+ * @param onAck Called once the frame has been acknowledged or has failed, not called for heartbeats
+ * @return True if the frame has been queued
+ */
+bool CommandUplink::Send(uint8_t messageId, std::span<const uint8_t> payload, E_UplinkPriority priority, AckCallback onAck)
+{
+    return enqueue(messageId, payload, priority, priority != E_UplinkPriority::Heartbeat, std::move(onAck));
+}
+
+/**
+ * @brief Queues a command with the highest priority
+ * @param command The command
+ * @param param1 First parameter of the command
+ * @param param2 Second parameter of the command
+ * @param onAck Called once the command has been acknowledged or has failed
+ * @return True if the command has been queued
+ */
+bool CommandUplink::SendCommand(Frames::E_UplinkCommand command, float param1, float param2, AckCallback onAck)
+{
+    std::array<uint8_t, FramePayloadSize<Frames::Command>()> payload{};
+    writeField(payload, Frames::Command::COMMAND, static_cast<uint16_t>(command));
+    writeField(payload, Frames::Command::PARAM1, param1);
+    writeField(payload, Frames::Command::PARAM2, param2);
+    return enqueue(Frames::Command::ID, payload, E_UplinkPriority::Command, true, std::move(onAck));
+}
+
+/**
+ * @brief Queues a parameter update as bulk traffic
+ * @param index Index of the parameter
+ * @param value New value of the parameter
+ * @param onAck Called once the update has been acknowledged or has failed
+ * @return True if the update has been queued
+ */
+bool CommandUplink::SendParameter(uint16_t index, float value, AckCallback onAck)
+{
+    std::array<uint8_t, FramePayloadSize<Frames::ParameterSet>()> payload{};
+    writeField(payload, Frames::ParameterSet::INDEX, index);
+    writeField(payload, Frames::ParameterSet::VALUE, value);
+    return enqueue(Frames::ParameterSet::ID, payload, E_UplinkPriority::Bulk, true, std::move(onAck));
+}
+
+/**
+ * @brief Encodes a frame with the next sequence number
+ * @details Thread-safe. Frames of concurrent senders may leave in a different order than their
+ *          sequence numbers, the acknowledgements are selective.
+ */
+CommandUplink::Outgoing CommandUplink::encode(uint8_t messageId, std::span<const uint8_t> payload, E_UplinkPriority priority, bool reliable)
+{
+    Outgoing outgoing;
+    outgoing.sequence = m_nextSequence.fetch_add(1, std::memory_order_relaxed);
+    outgoing.priority = priority;
+    outgoing.reliable = reliable;
+    outgoing.queued = std::chrono::steady_clock::now();
+
+    FrameHeader header{};
+    header.sync = FRAME_SYNC;
+    header.systemId = m_options.systemId;
+    header.messageId = messageId;
+    header.flags = reliable ? Frames::FRAME_FLAG_ACK_REQUESTED : 0;
+    header.sequence = outgoing.sequence;
+    header.payloadLength = static_cast<uint16_t>(payload.size());
+    header.timestampNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(outgoing.queued.time_since_epoch()).count());
+
+    // Uplink frames are small, a compact buffer per frame keeps large uploads cheap in memory
+    auto &frame = outgoing.frame;
+    frame.resize(FRAME_OVERHEAD + payload.size());
+    std::memcpy(frame.data(), &header, sizeof(header));
+    std::memcpy(frame.data() + sizeof(FrameHeader), payload.data(), payload.size());
+
+    const uint16_t checksum = FrameChecksum(std::span<const uint8_t>(frame.data(), frame.size() - FRAME_CHECKSUM_SIZE));
+    std::memcpy(frame.data() + frame.size() - FRAME_CHECKSUM_SIZE, &checksum, sizeof(checksum));
+    return outgoing;
+}
+
+/**
+ * @brief Encodes a frame and appends it to the queue of its priority
+ */
+bool CommandUplink::enqueue(uint8_t messageId, std::span<const uint8_t> payload, E_UplinkPriority priority, bool reliable, AckCallback onAck)
+{
+    if (!m_running.load(std::memory_order_acquire))
+    {
+        LOG_WARNING("Uplink is not running, frame discarded");
+        return false;
+    }
+
+    if (FRAME_OVERHEAD + payload.size() > MAX_DATAGRAM_SIZE)
+    {
+        LOG_ERROR("Uplink payload of " + std::to_string(payload.size()) + " bytes is too large");
+        return false;
+    }
+
+    Outgoing outgoing = encode(messageId, payload, priority, reliable);
+    outgoing.onAck = std::move(onAck);
+
+    {
+        std::lock_guard<std::mutex> guard(m_queueMutex);
+        m_queues[static_cast<std::size_t>(priority)].push_back(std::move(outgoing));
+    }
+
+    schedulePump();
+    return true;
+}
+
+/**
+ * @brief Posts a pump to the strand unless one is pending already
+ */
+void CommandUplink::schedulePump()
+{
+    if (m_pumpScheduled.exchange(true, std::memory_order_acq_rel))
+        return;
+
+    boost::asio::post(m_strand, [this]()
+                      {
+                          m_pumpScheduled.store(false, std::memory_order_release);
+                          pump(); });
+}
+
+// ============================================================================
+// Sending
+// ============================================================================
+
+/**
+ * @brief Sends the queued frames, runs on the strand
+ * @details Sends all commands and heartbeats, then a single batch of bulk frames. If more bulk frames
+ *          are waiting, the next pump is posted instead of looping, so timers and new commands get
+ *          the strand between two batches.
+ */
+void CommandUplink::pump()
+{
+    if (!m_socket.is_open() || m_waitingWritable)
+        return;
+
+    for (const auto priority : {E_UplinkPriority::Command, E_UplinkPriority::Heartbeat})
+    {
+        Outgoing outgoing;
+        while (popSendable(priority, outgoing))
+        {
+            if (!sendSingle(outgoing))
+            {
+                std::vector<Outgoing> pending;
+                pending.push_back(std::move(outgoing));
+                requeueFront(pending, 0);
+                waitWritable();
+                return;
+            }
+        }
+    }
+
+    if (m_bulkInFlight < m_options.bulkWindow)
+    {
+        const std::size_t maxCount = std::min(m_options.bulkBatch, m_options.bulkWindow - m_bulkInFlight);
+
+        m_batch.clear();
+        Outgoing outgoing;
+        while (m_batch.size() < maxCount && popSendable(E_UplinkPriority::Bulk, outgoing))
+            m_batch.push_back(std::move(outgoing));
+
+        const std::size_t sent = sendBatch(m_batch);
+        if (sent < m_batch.size())
+        {
+            requeueFront(m_batch, sent);
+            waitWritable();
+            return;
+        }
+
+        bool bulkWaiting = false;
+        {
+            std::lock_guard<std::mutex> guard(m_queueMutex);
+            bulkWaiting = !m_queues[static_cast<std::size_t>(E_UplinkPriority::Bulk)].empty();
+        }
+        if (bulkWaiting && m_bulkInFlight < m_options.bulkWindow)
+            schedulePump();
+    }
+
+    armRetransmitTimer();
+}
+
+/**
+ * @brief Takes the next frame of a priority
+ * @details Queued retransmissions of frames acknowledged meanwhile are skipped.
+ * @return True if a frame has been taken
+ */
+bool CommandUplink::popSendable(E_UplinkPriority priority, Outgoing &outgoing)
+{
+    std::lock_guard<std::mutex> guard(m_queueMutex);
+
+    auto &queue = m_queues[static_cast<std::size_t>(priority)];
+    while (!queue.empty())
+    {
+        outgoing = std::move(queue.front());
+        queue.pop_front();
+
+        if (!outgoing.retransmission || m_inFlight.contains(outgoing.sequence))
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Puts frames which could not be sent back to the front of their queues
+ * @param frames The frames in send order
+ * @param first Index of the first frame to put back
+ */
+void CommandUplink::requeueFront(std::vector<Outgoing> &frames, std::size_t first)
+{
+    std::lock_guard<std::mutex> guard(m_queueMutex);
+
+    for (std::size_t i = frames.size(); i > first; i--)
+    {
+        Outgoing &outgoing = frames[i - 1];
+        m_queues[static_cast<std::size_t>(outgoing.priority)].push_front(std::move(outgoing));
+    }
+}
+
+/**
+ * @brief Sends a single frame without blocking
+ * @return False if the socket buffer is full and the frame has to be sent again later
+ */
+bool CommandUplink::sendSingle(Outgoing &outgoing)
+{
+    boost::system::error_code ec;
+    m_socket.send_to(boost::asio::buffer(outgoing.frame), m_options.target, 0, ec);
+
+    if (ec == boost::asio::error::would_block || ec == boost::asio::error::try_again)
+        return false;
+
+    if (ec)
+    {
+        // Reliable frames are retransmitted by the timer, unreliable ones are lost like on the radio link
+        m_pErrorCounter->Inc();
+        LOG_ERROR("Error sending uplink frame: " + ec.message());
+    }
+
+    markSent(outgoing, std::chrono::steady_clock::now());
+    return true;
+}
+
+/**
+ * @brief Sends a batch of bulk frames without blocking
+ * @details On Linux the whole batch is sent with a single sendmmsg call.
+ * @return Number of frames handed to the socket, the rest has to be sent again later
+ */
+std::size_t CommandUplink::sendBatch(std::vector<Outgoing> &batch)
+{
+    if (batch.empty())
+        return 0;
+
+#ifdef __linux__
+    std::array<mmsghdr, MAX_BULK_BATCH> messages{};
+    std::array<iovec, MAX_BULK_BATCH> iovecs{};
+
+    for (std::size_t i = 0; i < batch.size(); i++)
+    {
+        iovecs[i].iov_base = batch[i].frame.data();
+        iovecs[i].iov_len = batch[i].frame.size();
+
+        msghdr &header = messages[i].msg_hdr;
+        header.msg_name = m_options.target.data();
+        header.msg_namelen = static_cast<socklen_t>(m_options.target.size());
+        header.msg_iov = &iovecs[i];
+        header.msg_iovlen = 1;
+    }
+
+    const int count = sendmmsg(m_socket.native_handle(), messages.data(), static_cast<unsigned int>(batch.size()), MSG_DONTWAIT);
+    const auto now = std::chrono::steady_clock::now();
+
+    if (count < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+
+        m_pErrorCounter->Inc();
+        LOG_ERROR("Error sending uplink frames: " + std::string(std::strerror(errno)));
+
+        // Retransmitted by the timer
+        for (auto &outgoing : batch)
+            markSent(outgoing, now);
+        return batch.size();
+    }
+
+    for (int i = 0; i < count; i++)
+        markSent(batch[static_cast<std::size_t>(i)], now);
+    return static_cast<std::size_t>(count);
+#else
+    for (std::size_t i = 0; i < batch.size(); i++)
+        if (!sendSingle(batch[i]))
+            return i;
+    return batch.size();
+#endif
+}
+
+/**
+ * @brief Registers a sent frame for its acknowledgement
+ * @param outgoing The sent frame, its callback is moved into the in-flight entry
+ * @param now Time of the transmission
+ */
+void CommandUplink::markSent(Outgoing &outgoing, std::chrono::steady_clock::time_point now)
+{
+    m_sentCounters[static_cast<std::size_t>(outgoing.priority)]->Inc();
+
+    if (!outgoing.reliable)
+        return;
+
+    const auto deadline = now + std::chrono::microseconds(m_rtoUs.load(std::memory_order_relaxed));
+
+    auto it = m_inFlight.find(outgoing.sequence);
+    if (it != m_inFlight.end())
+    {
+        it->second.lastSent = now;
+        it->second.deadline = deadline;
+        return;
+    }
+
+    InFlight entry;
+    entry.frame = std::move(outgoing.frame);
+    entry.priority = outgoing.priority;
+    entry.queued = outgoing.queued;
+    entry.lastSent = now;
+    entry.deadline = deadline;
+    entry.onAck = std::move(outgoing.onAck);
+    m_inFlight.emplace(outgoing.sequence, std::move(entry));
+
+    if (outgoing.priority == E_UplinkPriority::Bulk)
+        m_bulkInFlight++;
+    m_pInFlightGauge->Set(static_cast<int64_t>(m_inFlight.size()));
+}
+
+/**
+ * @brief Continues the pump once the socket buffer has room again
+ */
+void CommandUplink::waitWritable()
+{
+    m_waitingWritable = true;
+    m_socket.async_wait(boost::asio::ip::udp::socket::wait_write,
+                        [this](boost::system::error_code ec)
+                        {
+                            if (ec == boost::asio::error::operation_aborted)
+                                return;
+                            m_waitingWritable = false;
+                            if (!ec)
+                                pump();
+                        });
+}
+
+// ============================================================================
+// Acknowledgements
+// ============================================================================
+
+/**
+ * @brief Receives the acknowledgements of the flight controller
+ * @details Datagrams from other senders than the target are dropped. It then recursively calls itself to
+ *          continue listening for incoming data.
+ */
+void CommandUplink::receiveAcks()
+{
+    m_socket.async_receive_from(
+        boost::asio::buffer(m_receiveBuffer), m_receiveSender,
+        [this](boost::system::error_code ec, std::size_t bytesReceived)
+        {
+            if (ec == boost::asio::error::operation_aborted || !m_socket.is_open())
+                return;
+
+            // Acknowledgements arrive in bursts while bulk frames are in flight, drain the socket
+            // without blocking so a burst costs a single handler
+            while (!ec)
+            {
+                // Only the flight controller acknowledges, anybody else reaching the port could suppress retransmits
+                if (m_receiveSender == m_options.target)
+                    Frames::AckDecoder::Decode(std::span<const uint8_t>(m_receiveBuffer.data(), bytesReceived),
+                                               [this](const FrameView<Frames::Ack> &ack)
+                                               { handleAck(ack.GetRaw(Frames::Ack::SEQUENCE)); });
+                else
+                    LOG_WARNING_LIMITED(10000, "Dropped uplink acknowledgement from " + m_receiveSender.address().to_string() + ":" +
+                                                   std::to_string(m_receiveSender.port()) + ", not the uplink target");
+
+                bytesReceived = m_socket.receive_from(boost::asio::buffer(m_receiveBuffer), m_receiveSender, 0, ec);
+            }
+
+            // An acknowledgement callback may have stopped the uplink
+            if (!m_socket.is_open())
+                return;
+
+            // Windows reports ICMP port unreachable of earlier sends as connection_refused, the retransmits handle it
+            if (ec != boost::asio::error::would_block && ec != boost::asio::error::try_again && ec != boost::asio::error::connection_refused)
+                LOG_WARNING("Error receiving uplink acknowledgement: " + ec.message());
+
+            receiveAcks();
+        });
+}
+
+/**
+ * @brief Completes an acknowledged frame
+ * @param sequence Sequence number of the acknowledged frame, duplicates are ignored
+ */
+void CommandUplink::handleAck(uint16_t sequence)
+{
+    auto it = m_inFlight.find(sequence);
+    if (it == m_inFlight.end())
+        return;
+
+    const auto now = std::chrono::steady_clock::now();
+    InFlight entry = std::move(it->second);
+    m_inFlight.erase(it);
+    m_pInFlightGauge->Set(static_cast<int64_t>(m_inFlight.size()));
+
+    // Karn: an acknowledgement of a retransmitted frame can not be matched to a transmission
+    if (entry.retries == 0)
+        updateRto(now - entry.lastSent);
+
+    const auto roundTrip = std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry.queued);
+    m_pRoundTripHistogram->Observe(static_cast<uint64_t>(roundTrip.count()));
+
+    if (entry.priority == E_UplinkPriority::Bulk)
+    {
+        m_bulkInFlight--;
+        schedulePump();
+    }
+
+    if (entry.onAck)
+        entry.onAck(true, roundTrip);
+}
+
+/**
+ * @brief Updates the retransmit timeout with a round trip sample as specified by RFC 6298
+ * @param sample Time from the transmission to the acknowledgement
+ */
+void CommandUplink::updateRto(std::chrono::steady_clock::duration sample)
+{
+    const int64_t rttUs = std::max<int64_t>(toMicroseconds(sample), 1);
+    int64_t srttUs = m_srttUs.load(std::memory_order_relaxed);
+
+    if (srttUs == 0)
+    {
+        srttUs = rttUs;
+        m_rttVarUs = rttUs / 2;
+    }
+    else
+    {
+        // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R
+        m_rttVarUs = (3 * m_rttVarUs + std::abs(srttUs - rttUs)) / 4;
+        srttUs = (7 * srttUs + rttUs) / 8;
+    }
+
+    const int64_t rtoUs = srttUs + std::max(CLOCK_GRANULARITY_US, 4 * m_rttVarUs);
+    m_srttUs.store(srttUs, std::memory_order_relaxed);
+    m_rtoUs.store(std::clamp(rtoUs, toMicroseconds(m_options.minRto), toMicroseconds(m_options.maxRto)), std::memory_order_relaxed);
+}
+
+// ============================================================================
+// Timers
+// ============================================================================
+
+/**
+ * @brief Arms the retransmit timer for the earliest deadline of the frames in flight
+ */
+void CommandUplink::armRetransmitTimer()
+{
+    auto earliest = std::chrono::steady_clock::time_point::max();
+    for (const auto &[sequence, entry] : m_inFlight)
+        earliest = std::min(earliest, entry.deadline);
+
+    if (earliest == m_timerDeadline || earliest == std::chrono::steady_clock::time_point::max())
+        return;
+
+    m_timerDeadline = earliest;
+    m_retransmitTimer.expires_at(earliest);
+    m_retransmitTimer.async_wait([this](boost::system::error_code ec)
+                                 {
+                                     if (ec || !m_socket.is_open())
+                                         return;
+                                     m_timerDeadline = std::chrono::steady_clock::time_point::max();
+                                     onRetransmitTimer(); });
+}
+
+/**
+ * @brief Queues the retransmissions of all frames past their deadline
+ * @details The retransmissions are queued in front of their priority. Frames without retries left are
+ *          reported as failed. Every expiry doubles the retransmit timeout until the next valid sample.
+ */
+void CommandUplink::onRetransmitTimer()
+{
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<Outgoing> retransmits;
+    std::vector<std::pair<AckCallback, std::chrono::nanoseconds>> failed;
+
+    for (auto it = m_inFlight.begin(); it != m_inFlight.end();)
+    {
+        InFlight &entry = it->second;
+        if (entry.deadline > now)
+        {
+            ++it;
+            continue;
+        }
+
+        if (entry.retries >= m_options.maxRetries)
+        {
+            m_pFailedCounter->Inc();
+            LOG_WARNING("Uplink frame " + std::to_string(it->first) + " has not been acknowledged after " + std::to_string(entry.retries) + " retransmissions");
+
+            if (entry.priority == E_UplinkPriority::Bulk)
+                m_bulkInFlight--;
+            failed.emplace_back(std::move(entry.onAck), std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry.queued));
+            it = m_inFlight.erase(it);
+            continue;
+        }
+
+        entry.retries++;
+        entry.deadline = std::chrono::steady_clock::time_point::max();
+        m_pRetransmitCounter->Inc();
+
+        Outgoing outgoing;
+        outgoing.frame = entry.frame;
+        outgoing.sequence = it->first;
+        outgoing.priority = entry.priority;
+        outgoing.reliable = true;
+        outgoing.retransmission = true;
+        outgoing.queued = entry.queued;
+        retransmits.push_back(std::move(outgoing));
+        ++it;
+    }
+
+    if (!retransmits.empty() || !failed.empty())
+    {
+        const int64_t rtoUs = m_rtoUs.load(std::memory_order_relaxed);
+        m_rtoUs.store(std::min(rtoUs * 2, toMicroseconds(m_options.maxRto)), std::memory_order_relaxed);
+    }
+
+    // Oldest sequence first, so the receiver sees the retransmissions in order
+    std::sort(retransmits.begin(), retransmits.end(), [](const Outgoing &a, const Outgoing &b)
+              { return static_cast<int16_t>(a.sequence - b.sequence) < 0; });
+    requeueFront(retransmits, 0);
+    m_pInFlightGauge->Set(static_cast<int64_t>(m_inFlight.size()));
+
+    for (auto &[callback, elapsed] : failed)
+        if (callback)
+            callback(false, elapsed);
+
+    pump();
+}
+
+/**
+ * @brief Queues a heartbeat every heartbeat interval
+ * @details The timer advances by whole intervals, so the rate does not drift. After a stall the
+ *          missed heartbeats are skipped instead of being sent in a burst.
+ */
+void CommandUplink::scheduleHeartbeat()
+{
+    auto next = m_heartbeatTimer.expiry() + m_options.heartbeatInterval;
+    const auto now = std::chrono::steady_clock::now();
+    if (next < now)
+        next = now;
+
+    m_heartbeatTimer.expires_at(next);
+    m_heartbeatTimer.async_wait([this](boost::system::error_code ec)
+                                {
+                                    if (ec || !m_socket.is_open())
+                                        return;
+
+                                    // Sent right away on the strand, a heartbeat never waits behind queued frames
+                                    const std::array<uint8_t, FramePayloadSize<Frames::Heartbeat>()> payload{};
+                                    Outgoing heartbeat = encode(Frames::Heartbeat::ID, payload, E_UplinkPriority::Heartbeat, false);
+                                    if (m_waitingWritable || !sendSingle(heartbeat))
+                                    {
+                                        std::lock_guard<std::mutex> guard(m_queueMutex);
+                                        m_queues[static_cast<std::size_t>(E_UplinkPriority::Heartbeat)].push_back(std::move(heartbeat));
+                                    }
+
+                                    scheduleHeartbeat(); });
+}
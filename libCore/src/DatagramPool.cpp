@@ -0,0 +1,93 @@
+#include "DatagramPool.h"
+
+using namespace aerolab::Core;
+
+/**
+ * @brief Constructor of the DatagramPool
+ * @details Preallocates the given number of buffers
+ * @param initialCapacity Number of buffers to preallocate
+ */
+DatagramPool::DatagramPool(std::size_t initialCapacity)
+{
+    // Reserve room for the slabs up front, growing doubles the capacity so this is plenty
+    m_slabs.reserve(32);
+    grow(initialCapacity > 0 ? initialCapacity : 1);
+}
+
+// ============================================================================
+// Buffer management
+// ============================================================================
+
+/**
+ * @brief Acquires a buffer from the pool
+ * @details The returned handle is the sole owner of the buffer. If no buffer is available,
+ *          the pool doubles its capacity.
+ * @return Handle to an empty buffer
+ */
+Datagram DatagramPool::Acquire()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    if (m_freeList.empty())
+        grow(m_capacity.load(std::memory_order_relaxed));
+
+    DatagramBuffer *pBuffer = m_freeList.back();
+    m_freeList.pop_back();
+
+    pBuffer->size = 0;
+    pBuffer->refCount.store(1, std::memory_order_relaxed);
+
+    return Datagram(pBuffer);
+}
+
+/**
+ * @brief Number of buffers currently not in use
+ */
+std::size_t DatagramPool::Available() const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    return m_freeList.size();
+}
+
+/**
+ * @brief Returns a buffer to the pool
+ * @param pBuffer The buffer whose last reference has been released
+ */
+void DatagramPool::release(DatagramBuffer *pBuffer)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    // The free list always has room for every buffer, so this never allocates
+    m_freeList.push_back(pBuffer);
+}
+
+/**
+ * @brief Allocates a new slab of buffers
+ * @note Must be called with m_mutex held (or from the constructor)
+ * @param count Number of buffers to add
+ */
+void DatagramPool::grow(std::size_t count)
+{
+    auto slab = std::make_unique<DatagramBuffer[]>(count);
+    m_allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    const std::size_t newCapacity = m_capacity.load(std::memory_order_relaxed) + count;
+
+    if (m_freeList.capacity() < newCapacity)
+    {
+        m_freeList.reserve(newCapacity);
+        m_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (m_slabs.size() == m_slabs.capacity())
+        m_allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        slab[i].pPool = this;
+        m_freeList.push_back(&slab[i]);
+    }
+
+    m_slabs.push_back(std::move(slab));
+    m_capacity.store(newCapacity, std::memory_order_relaxed);
+}
@@ -0,0 +1,630 @@
+#include "DerivedChannels.h"
+
+#include "Logger.h"
+
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Prefix of the derived channels, also used to reference them in expressions
+    const std::string DERIVED_PREFIX = "derived/";
+
+    /// Node of a parsed expression
+    struct Node
+    {
+        /// Enum for the kinds of nodes
+        enum class E_Kind
+        {
+            Number,
+            Variable,
+            Unary,
+            Binary
+        };
+
+        E_Kind kind = E_Kind::Number;
+        /// Operation of unary and binary nodes
+        E_DerivedOp op = E_DerivedOp::Add;
+        /// Value of number nodes
+        float value = 0.0f;
+        /// Channel name of variable nodes, e.g. "airdata/diff_pressure"
+        std::string name;
+        /// Operands
+        std::unique_ptr<Node> pA;
+        std::unique_ptr<Node> pB;
+    };
+
+    /// A function callable in expressions
+    struct Function
+    {
+        const char *name;
+        E_DerivedOp op;
+        /// Number of arguments, 1 or 2
+        int arity;
+    };
+
+    constexpr Function FUNCTIONS[] = {
+        {"abs", E_DerivedOp::Abs, 1},
+        {"sqrt", E_DerivedOp::Sqrt, 1},
+        {"sin", E_DerivedOp::Sin, 1},
+        {"cos", E_DerivedOp::Cos, 1},
+        {"tan", E_DerivedOp::Tan, 1},
+        {"asin", E_DerivedOp::Asin, 1},
+        {"acos", E_DerivedOp::Acos, 1},
+        {"atan", E_DerivedOp::Atan, 1},
+        {"exp", E_DerivedOp::Exp, 1},
+        {"log", E_DerivedOp::Log, 1},
+        {"pow", E_DerivedOp::Pow, 2},
+        {"min", E_DerivedOp::Min, 2},
+        {"max", E_DerivedOp::Max, 2},
+        {"atan2", E_DerivedOp::Atan2, 2}};
+
+    /**
+     * @brief Recursive descent parser of a single expression
+     * @details Grammar:
+     *          expression := term (('+' | '-') term)*
+     *          term       := unary (('*' | '/') unary)*
+     *          unary      := '-' unary | power
+     *          power      := primary ('^' unary)?
+     *          primary    := number | constant | variable | function '(' expression (',' expression)? ')' | '(' expression ')'
+     */
+    class Parser
+    {
+    public:
+        explicit Parser(const std::string &text) : m_text(text) {}
+
+        /// @throws std::runtime_error on a syntax error
+        std::unique_ptr<Node> Parse()
+        {
+            auto pNode = parseExpression();
+            skipSpaces();
+            if (m_pos != m_text.size())
+                fail("unexpected character");
+            return pNode;
+        }
+
+    private:
+        [[noreturn]] void fail(const std::string &message) const
+        {
+            throw std::runtime_error(message + " at position " + std::to_string(m_pos));
+        }
+
+        void skipSpaces()
+        {
+            while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos])))
+                m_pos++;
+        }
+
+        bool accept(char c)
+        {
+            skipSpaces();
+            if (m_pos < m_text.size() && m_text[m_pos] == c)
+            {
+                m_pos++;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char c)
+        {
+            if (!accept(c))
+                fail(std::string("expected '") + c + "'");
+        }
+
+        static std::unique_ptr<Node> makeBinary(E_DerivedOp op, std::unique_ptr<Node> pA, std::unique_ptr<Node> pB)
+        {
+            auto pNode = std::make_unique<Node>();
+            pNode->kind = Node::E_Kind::Binary;
+            pNode->op = op;
+            pNode->pA = std::move(pA);
+            pNode->pB = std::move(pB);
+            return pNode;
+        }
+
+        static std::unique_ptr<Node> makeUnary(E_DerivedOp op, std::unique_ptr<Node> pA)
+        {
+            auto pNode = std::make_unique<Node>();
+            pNode->kind = Node::E_Kind::Unary;
+            pNode->op = op;
+            pNode->pA = std::move(pA);
+            return pNode;
+        }
+
+        static std::unique_ptr<Node> makeNumber(float value)
+        {
+            auto pNode = std::make_unique<Node>();
+            pNode->value = value;
+            return pNode;
+        }
+
+        std::unique_ptr<Node> parseExpression()
+        {
+            auto pNode = parseTerm();
+            while (true)
+            {
+                if (accept('+'))
+                    pNode = makeBinary(E_DerivedOp::Add, std::move(pNode), parseTerm());
+                else if (accept('-'))
+                    pNode = makeBinary(E_DerivedOp::Sub, std::move(pNode), parseTerm());
+                else
+                    return pNode;
+            }
+        }
+
+        std::unique_ptr<Node> parseTerm()
+        {
+            auto pNode = parseUnary();
+            while (true)
+            {
+                if (accept('*'))
+                    pNode = makeBinary(E_DerivedOp::Mul, std::move(pNode), parseUnary());
+                else if (accept('/'))
+                    pNode = makeBinary(E_DerivedOp::Div, std::move(pNode), parseUnary());
+                else
+                    return pNode;
+            }
+        }
+
+        std::unique_ptr<Node> parseUnary()
+        {
+            if (accept('-'))
+                return makeUnary(E_DerivedOp::Neg, parseUnary());
+            return parsePower();
+        }
+
+        std::unique_ptr<Node> parsePower()
+        {
+            auto pNode = parsePrimary();
+            // Right associative and binding stronger than the sign, -2^2 is -4
+            if (accept('^'))
+                pNode = makeBinary(E_DerivedOp::Pow, std::move(pNode), parseUnary());
+            return pNode;
+        }
+
+        std::unique_ptr<Node> parsePrimary()
+        {
+            skipSpaces();
+            if (m_pos >= m_text.size())
+                fail("unexpected end");
+
+            if (accept('('))
+            {
+                auto pNode = parseExpression();
+                expect(')');
+                return pNode;
+            }
+
+            const char c = m_text[m_pos];
+            if (std::isdigit(static_cast<unsigned char>(c)) || c == '.')
+            {
+                // from_chars ignores the locale, the GUI may run with a decimal comma
+                const char *pBegin = m_text.data() + m_pos;
+                float value = 0.0f;
+                const auto [pEnd, ec] = std::from_chars(pBegin, m_text.data() + m_text.size(), value);
+                if (ec != std::errc())
+                    fail("invalid number");
+                m_pos += static_cast<std::size_t>(pEnd - pBegin);
+                return makeNumber(value);
+            }
+
+            if (!std::isalpha(static_cast<unsigned char>(c)) && c != '_')
+                fail("unexpected character");
+
+            const std::size_t begin = m_pos;
+            while (m_pos < m_text.size() && (std::isalnum(static_cast<unsigned char>(m_text[m_pos])) || m_text[m_pos] == '_' || m_text[m_pos] == '.'))
+                m_pos++;
+            std::string identifier = m_text.substr(begin, m_pos - begin);
+
+            if (accept('('))
+            {
+                for (const Function &function : FUNCTIONS)
+                {
+                    if (identifier != function.name)
+                        continue;
+
+                    auto pA = parseExpression();
+                    if (function.arity == 1)
+                    {
+                        expect(')');
+                        return makeUnary(function.op, std::move(pA));
+                    }
+                    expect(',');
+                    auto pB = parseExpression();
+                    expect(')');
+                    return makeBinary(function.op, std::move(pA), std::move(pB));
+                }
+                fail("unknown function " + identifier);
+            }
+
+            if (identifier == "pi")
+                return makeNumber(3.14159265f);
+            if (identifier == "g")
+                return makeNumber(Frames::GRAVITY);
+
+            // Channel names use a slash, which would be a division in the expression
+            for (char &ch : identifier)
+            {
+                if (ch == '.')
+                    ch = '/';
+            }
+            auto pNode = std::make_unique<Node>();
+            pNode->kind = Node::E_Kind::Variable;
+            pNode->name = std::move(identifier);
+            return pNode;
+        }
+
+        /// The expression
+        const std::string &m_text;
+        /// Position of the next character
+        std::size_t m_pos = 0;
+    };
+
+    /// @brief Collects the channel names referenced by an expression
+    void collectVariables(const Node &node, std::vector<std::string> &names)
+    {
+        if (node.kind == Node::E_Kind::Variable)
+            names.push_back(node.name);
+        if (node.pA)
+            collectVariables(*node.pA, names);
+        if (node.pB)
+            collectVariables(*node.pB, names);
+    }
+
+    /// Parsed channel during the compilation
+    struct ParsedChannel
+    {
+        std::string name;
+        std::unique_ptr<Node> pRoot;
+        /// Indices of the derived channels the expression references
+        std::vector<std::size_t> dependencies;
+        /// 0 unvisited, 1 on the sort stack, 2 sorted, 3 invalid
+        int state = 0;
+    };
+
+    /**
+     * @brief Depth-first topological sort of the channels
+     * @return False if the channel or one of its dependencies is invalid or part of a cycle
+     */
+    bool sortChannel(std::vector<ParsedChannel> &channels, std::size_t index, std::vector<std::size_t> &order)
+    {
+        ParsedChannel &channel = channels[index];
+        if (channel.state == 2)
+            return true;
+        if (channel.state == 3)
+            return false;
+        if (channel.state == 1)
+        {
+            LOG_ERROR("Derived channel " + channel.name + " is part of a dependency cycle");
+            return false;
+        }
+
+        channel.state = 1;
+        for (std::size_t dependency : channel.dependencies)
+        {
+            if (!sortChannel(channels, dependency, order))
+            {
+                if (channel.state != 3)
+                    LOG_ERROR("Derived channel " + channel.name + " dropped, it depends on the invalid channel " + channels[dependency].name);
+                channel.state = 3;
+                return false;
+            }
+        }
+
+        channel.state = 2;
+        order.push_back(index);
+        return true;
+    }
+}
+
+// ============================================================================
+// DerivedProgram
+// ============================================================================
+
+/**
+ * @brief Constructor of the DerivedProgram, compiles the channels
+ * @param definitions Name and expression of every channel, the names without the "derived/" prefix
+ */
+DerivedProgram::DerivedProgram(const std::vector<std::pair<std::string, std::string>> &definitions)
+{
+    std::unordered_map<std::string, std::size_t> fieldIndices;
+    const std::vector<std::string> fieldNames = SnapshotFieldNames();
+    for (std::size_t i = 0; i < fieldNames.size(); i++)
+        fieldIndices.emplace(fieldNames[i], i);
+
+    // Parse every expression once
+    std::vector<ParsedChannel> channels(definitions.size());
+    std::unordered_map<std::string, std::size_t> channelIndices;
+    for (std::size_t i = 0; i < definitions.size(); i++)
+    {
+        channels[i].name = definitions[i].first;
+        channelIndices.emplace(DERIVED_PREFIX + definitions[i].first, i);
+        try
+        {
+            channels[i].pRoot = Parser(definitions[i].second).Parse();
+        }
+        catch (const std::exception &e)
+        {
+            LOG_ERROR("Invalid expression of derived channel " + channels[i].name + ": " + e.what());
+            channels[i].state = 3;
+        }
+    }
+
+    // Resolve the references, derived channels become dependencies
+    for (ParsedChannel &channel : channels)
+    {
+        if (channel.state == 3)
+            continue;
+
+        std::vector<std::string> variables;
+        collectVariables(*channel.pRoot, variables);
+        for (const std::string &variable : variables)
+        {
+            if (const auto it = channelIndices.find(variable); it != channelIndices.end())
+                channel.dependencies.push_back(it->second);
+            else if (!fieldIndices.contains(variable))
+            {
+                LOG_ERROR("Derived channel " + channel.name + " references the unknown channel " + variable);
+                channel.state = 3;
+                break;
+            }
+        }
+    }
+
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < channels.size(); i++)
+        sortChannel(channels, i, order);
+
+    // Inputs and constants occupy the first registers, so every evaluation loads them in one pass
+    std::unordered_map<std::size_t, uint16_t> inputRegisters;
+    std::vector<const Node *> pending;
+    for (std::size_t index : order)
+        pending.push_back(channels[index].pRoot.get());
+    std::vector<const Node *> numbers;
+    while (!pending.empty())
+    {
+        const Node *pNode = pending.back();
+        pending.pop_back();
+        if (pNode->kind == Node::E_Kind::Variable && !channelIndices.contains(pNode->name) &&
+            inputRegisters.emplace(fieldIndices.at(pNode->name), static_cast<uint16_t>(m_inputFields.size())).second)
+            m_inputFields.push_back(fieldIndices.at(pNode->name));
+        if (pNode->kind == Node::E_Kind::Number)
+            numbers.push_back(pNode);
+        if (pNode->pA)
+            pending.push_back(pNode->pA.get());
+        if (pNode->pB)
+            pending.push_back(pNode->pB.get());
+    }
+
+    std::unordered_map<const Node *, uint16_t> constantRegisters;
+    for (const Node *pNode : numbers)
+    {
+        constantRegisters.emplace(pNode, static_cast<uint16_t>(m_inputFields.size() + m_constants.size()));
+        m_constants.push_back(pNode->value);
+    }
+    m_registerCount = m_inputFields.size() + m_constants.size();
+
+    // Every operation writes a register of its own, the result of a channel stays available for the channels using it
+    std::unordered_map<std::string, uint16_t> channelRegisters;
+    const auto emit = [&](const auto &self, const Node &node) -> uint16_t
+    {
+        switch (node.kind)
+        {
+        case Node::E_Kind::Number:
+            return constantRegisters.at(&node);
+        case Node::E_Kind::Variable:
+        {
+            if (const auto it = channelRegisters.find(node.name); it != channelRegisters.end())
+                return it->second;
+            return inputRegisters.at(fieldIndices.at(node.name));
+        }
+        default:
+        {
+            const uint16_t a = self(self, *node.pA);
+            const uint16_t b = node.pB ? self(self, *node.pB) : a;
+            if (m_registerCount >= std::numeric_limits<uint16_t>::max())
+                throw std::length_error("Too many derived channel registers");
+            const uint16_t dst = static_cast<uint16_t>(m_registerCount++);
+            m_instructions.push_back({node.op, dst, a, b});
+            return dst;
+        }
+        }
+    };
+
+    for (std::size_t index : order)
+    {
+        const uint16_t result = emit(emit, *channels[index].pRoot);
+        channelRegisters.emplace(DERIVED_PREFIX + channels[index].name, result);
+        m_channelNames.push_back(channels[index].name);
+        m_channelRegisters.push_back(result);
+    }
+
+    LOG_INFO("Compiled " + std::to_string(m_channelNames.size()) + " derived channels into " + std::to_string(m_instructions.size()) +
+             " instructions over " + std::to_string(m_inputFields.size()) + " inputs");
+}
+
+// ============================================================================
+// DerivedEvaluator
+// ============================================================================
+
+/**
+ * @brief Constructor of the DerivedEvaluator
+ * @param pProgram The compiled channels
+ * @param store Store the results are appended to
+ * @param channelPrefix Prefix of the channel names, e.g. to separate vehicles
+ */
+DerivedEvaluator::DerivedEvaluator(std::shared_ptr<const DerivedProgram> pProgram, TelemetryStore &store, const std::string &channelPrefix)
+    : m_pProgram(std::move(pProgram)),
+      m_registers(m_pProgram->RegisterCount())
+{
+    for (const std::string &name : m_pProgram->ChannelNames())
+        m_channels.push_back(store.GetOrAddChannel(channelPrefix + DERIVED_PREFIX + name));
+
+    const std::size_t firstConstant = m_pProgram->InputFields().size();
+    for (std::size_t i = 0; i < m_pProgram->Constants().size(); i++)
+        m_registers[firstConstant + i].fill(m_pProgram->Constants()[i]);
+}
+
+/**
+ * @brief Destructor, evaluates the remaining samples
+ */
+DerivedEvaluator::~DerivedEvaluator()
+{
+    Flush();
+}
+
+/**
+ * @brief Adds a sample to the batch
+ * @details Evaluates the batch first if the sample would stretch it beyond MAX_BATCH_SPAN_NS, and afterwards if it is full.
+ * @param values Latest values of all telemetry fields, the program computes in float
+ * @param timestampNs Timestamp of the sample
+ */
+void DerivedEvaluator::Push(const std::array<double, SNAPSHOT_FIELD_COUNT> &values, int64_t timestampNs)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_pushedSinceIdle = true;
+
+    if (m_count > 0 && timestampNs - m_timestamps[0] > MAX_BATCH_SPAN_NS)
+        evaluate();
+
+    const std::vector<std::size_t> &inputs = m_pProgram->InputFields();
+    for (std::size_t i = 0; i < inputs.size(); i++)
+        m_registers[i][m_count] = static_cast<float>(values[inputs[i]]);
+    m_timestamps[m_count] = timestampNs;
+
+    if (++m_count == DERIVED_BATCH_SIZE)
+        evaluate();
+}
+
+/**
+ * @brief Evaluates the batch and appends the results to the channels
+ */
+void DerivedEvaluator::Flush()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    evaluate();
+}
+
+/**
+ * @brief Evaluates the batch if no sample was pushed since the previous call
+ * @details Called periodically, so the derived channels of a stream that stopped catch up with their inputs
+ *          after at most two periods, while a running stream keeps its full batches.
+ */
+void DerivedEvaluator::FlushIdle()
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    if (!m_pushedSinceIdle)
+        evaluate();
+    m_pushedSinceIdle = false;
+}
+
+void DerivedEvaluator::evaluate()
+{
+    const std::size_t count = m_count;
+    if (count == 0)
+        return;
+
+    for (const DerivedInstruction &instruction : m_pProgram->Instructions())
+    {
+        float *pDst = m_registers[instruction.dst].data();
+        const float *pA = m_registers[instruction.a].data();
+        const float *pB = m_registers[instruction.b].data();
+
+        // One loop per instruction, the registers never alias, so the loops vectorize
+        switch (instruction.op)
+        {
+        case E_DerivedOp::Add:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = pA[i] + pB[i];
+            break;
+        case E_DerivedOp::Sub:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = pA[i] - pB[i];
+            break;
+        case E_DerivedOp::Mul:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = pA[i] * pB[i];
+            break;
+        case E_DerivedOp::Div:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = pA[i] / pB[i];
+            break;
+        case E_DerivedOp::Pow:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = std::pow(pA[i], pB[i]);
+            break;
+        case E_DerivedOp::Min:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = pA[i] < pB[i] ? pA[i] : pB[i];
+            break;
+        case E_DerivedOp::Max:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = pA[i] > pB[i] ? pA[i] : pB[i];
+            break;
+        case E_DerivedOp::Atan2:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = std::atan2(pA[i], pB[i]);
+            break;
+        case E_DerivedOp::Neg:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = -pA[i];
+            break;
+        case E_DerivedOp::Abs:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = std::fabs(pA[i]);
+            break;
+        case E_DerivedOp::Sqrt:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = std::sqrt(pA[i]);
+            break;
+        case E_DerivedOp::Sin:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = std::sin(pA[i]);
+            break;
+        case E_DerivedOp::Cos:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = std::cos(pA[i]);
+            break;
+        case E_DerivedOp::Tan:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = std::tan(pA[i]);
+            break;
+        case E_DerivedOp::Asin:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = std::asin(pA[i]);
+            break;
+        case E_DerivedOp::Acos:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = std::acos(pA[i]);
+            break;
+        case E_DerivedOp::Atan:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = std::atan(pA[i]);
+            break;
+        case E_DerivedOp::Exp:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = std::exp(pA[i]);
+            break;
+        case E_DerivedOp::Log:
+            for (std::size_t i = 0; i < count; i++)
+                pDst[i] = std::log(pA[i]);
+            break;
+        }
+    }
+
+    const std::vector<uint16_t> &results = m_pProgram->ChannelRegisters();
+    for (std::size_t c = 0; c < m_channels.size(); c++)
+    {
+        const float *pResult = m_registers[results[c]].data();
+        for (std::size_t i = 0; i < count; i++)
+            m_channels[c]->Append(m_timestamps[i], pResult[i]);
+    }
+
+    m_count = 0;
+}
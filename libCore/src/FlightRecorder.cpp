@@ -0,0 +1,325 @@
+#include "FlightRecorder.h"
+#include "Logger.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace aerolab::Core;
+
+namespace
+{
+    /// The file is grown by this number of chunks at once
+    constexpr uint64_t PREALLOCATE_CHUNKS = 8;
+    /// Maximum number of datagrams written per wakeup of the writer thread
+    constexpr std::size_t WRITE_BATCH = 256;
+    /// Wakeup interval of the writer thread if nothing is received
+    constexpr auto WRITER_WAIT = std::chrono::milliseconds(100);
+
+    int64_t toNanoseconds(std::chrono::system_clock::time_point timestamp)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+    }
+}
+
+/// Memory mapping of the current chunk
+struct FlightRecorder::MappedChunk
+{
+    boost::interprocess::file_mapping file;
+    boost::interprocess::mapped_region region;
+    /// Start of the mapped chunk
+    uint8_t *pBase = nullptr;
+    /// Header at the start of the chunk
+    RecordingChunkHeader *pHeader = nullptr;
+    /// Offset of the next record from the chunk start
+    std::size_t writeOffset = sizeof(RecordingChunkHeader);
+};
+
+/**
+ * @brief Constructor of the FlightRecorder
+ * @param filePath Path of the recording file, an existing file is overwritten
+ * @param chunkSize Size of every chunk, must hold at least one datagram of MAX_DATAGRAM_SIZE
+ * @param queueCapacity Number of datagrams which can wait for the writer thread
+ */
+FlightRecorder::FlightRecorder(std::string filePath, std::size_t chunkSize, std::size_t queueCapacity)
+    : m_filePath(std::move(filePath)),
+      m_chunkSize(chunkSize),
+      m_queue(queueCapacity, E_OverflowPolicy::DropNewest)
+{
+    const std::size_t minimumChunkSize = sizeof(RecordingChunkHeader) + RecordingRecordSize(MAX_DATAGRAM_SIZE) + sizeof(RecordingIndexEntry);
+    if (m_chunkSize < minimumChunkSize || m_chunkSize > UINT32_MAX)
+        throw std::invalid_argument("FlightRecorder: invalid chunk size " + std::to_string(m_chunkSize));
+}
+
+FlightRecorder::~FlightRecorder()
+{
+    Stop();
+}
+
+/**
+ * @brief Creates the recording file and starts the writer thread
+ * @return True if the recording was started
+ */
+bool FlightRecorder::Start()
+{
+    if (m_running)
+        return true;
+
+    std::ofstream file(m_filePath, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        LOG_ERROR("Could not create recording " + m_filePath);
+        return false;
+    }
+
+    RecordingFileHeader header{};
+    std::memcpy(header.magic, RECORDING_MAGIC, sizeof(header.magic));
+    header.version = RECORDING_VERSION;
+    header.chunkSize = static_cast<uint32_t>(m_chunkSize);
+    header.createdNs = toNanoseconds(std::chrono::system_clock::now());
+    header.indexInterval = RECORDING_INDEX_INTERVAL;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.close();
+    if (!file)
+    {
+        LOG_ERROR("Could not write recording header to " + m_filePath);
+        return false;
+    }
+
+    m_fileSize = sizeof(RecordingFileHeader);
+    m_chunkSequence = 0;
+    if (!openChunk())
+        return false;
+
+    m_running = true;
+    m_thread = std::thread(&FlightRecorder::run, this);
+
+    LOG_INFO("Recording to " + m_filePath);
+    return true;
+}
+
+/**
+ * @brief Writes the queued datagrams, finishes the file and stops the writer thread
+ */
+void FlightRecorder::Stop()
+{
+    if (!m_running.exchange(false))
+        return;
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    closeChunk();
+
+    // Cut off the preallocated chunks, a reader stops at the first chunk without magic anyway
+    const uint64_t usedSize = sizeof(RecordingFileHeader) + m_chunkSequence * m_chunkSize;
+    std::error_code error;
+    std::filesystem::resize_file(m_filePath, usedSize, error);
+    if (error)
+        LOG_WARNING("Could not truncate recording " + m_filePath + ": " + error.message());
+
+    LOG_INFO("Recorded " + std::to_string(RecordedCount()) + " datagrams to " + m_filePath + ", dropped " +
+             std::to_string(DroppedCount()));
+}
+
+// ============================================================================
+// Writer thread
+// ============================================================================
+
+void FlightRecorder::run()
+{
+    std::array<Datagram, WRITE_BATCH> batch;
+
+    while (true)
+    {
+        // Read the flag first, so everything queued before Stop() is written by the last pass
+        const bool running = m_running.load(std::memory_order_acquire);
+
+        std::size_t count;
+        while ((count = m_queue.PopBatch(batch)) > 0)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                writeRecord(batch[i]);
+                // Return the buffer to the pool right away
+                batch[i] = Datagram();
+            }
+        }
+
+        if (!running)
+            break;
+
+        m_queue.WaitForData(WRITER_WAIT);
+    }
+}
+
+/**
+ * @brief Copies a datagram into the current chunk, starts a new chunk if it is full
+ * @param datagram The datagram to write
+ */
+void FlightRecorder::writeRecord(const Datagram &datagram)
+{
+    if (!m_pChunk)
+        return;
+
+    const std::size_t recordSize = RecordingRecordSize(datagram.Size());
+    RecordingChunkHeader *pHeader = m_pChunk->pHeader;
+
+    // Records and the index must not overlap, keep room for the next index entry
+    const std::size_t indexBytes = (pHeader->indexCount + 1) * sizeof(RecordingIndexEntry);
+    if (m_pChunk->writeOffset + recordSize + indexBytes > m_chunkSize)
+    {
+        closeChunk();
+        if (!openChunk())
+            return;
+        pHeader = m_pChunk->pHeader;
+    }
+
+    uint8_t *pRecord = m_pChunk->pBase + m_pChunk->writeOffset;
+
+    RecordingRecordHeader record{};
+    record.timestampNs = toNanoseconds(datagram.Timestamp());
+    record.length = static_cast<uint16_t>(datagram.Size());
+    record.port = datagram.Sender().port();
+
+    const boost::asio::ip::address address = datagram.Sender().address();
+    if (address.is_v6())
+    {
+        record.addressFamily = 6;
+        const auto bytes = address.to_v6().to_bytes();
+        std::memcpy(record.address, bytes.data(), bytes.size());
+    }
+    else
+    {
+        record.addressFamily = 4;
+        const auto bytes = address.to_v4().to_bytes();
+        std::memcpy(record.address, bytes.data(), bytes.size());
+    }
+
+    std::memcpy(pRecord, &record, sizeof(record));
+    std::memcpy(pRecord + sizeof(record), datagram.Data(), datagram.Size());
+
+    // Timestamps from several receive threads are not strictly ordered, the index keeps the maximum
+    if (pHeader->recordCount % RECORDING_INDEX_INTERVAL == 0)
+    {
+        RecordingIndexEntry entry{};
+        entry.timestampNs = pHeader->recordCount == 0 ? record.timestampNs : std::max(record.timestampNs, pHeader->lastTimestampNs);
+        entry.offset = static_cast<uint32_t>(m_pChunk->writeOffset);
+        entry.recordIndex = pHeader->recordCount;
+        std::memcpy(m_pChunk->pBase + m_chunkSize - (pHeader->indexCount + 1) * sizeof(RecordingIndexEntry), &entry, sizeof(entry));
+        pHeader->indexCount++;
+    }
+
+    if (pHeader->recordCount == 0)
+    {
+        pHeader->firstTimestampNs = record.timestampNs;
+        pHeader->lastTimestampNs = record.timestampNs;
+    }
+    else
+    {
+        pHeader->lastTimestampNs = std::max(pHeader->lastTimestampNs, record.timestampNs);
+    }
+
+    m_pChunk->writeOffset += recordSize;
+    pHeader->dataBytes = static_cast<uint32_t>(m_pChunk->writeOffset - sizeof(RecordingChunkHeader));
+    pHeader->recordCount++;
+
+    m_recordedCount.fetch_add(1, std::memory_order_relaxed);
+    m_bytesWritten.fetch_add(recordSize, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Maps the next chunk of the file, grows the file if necessary
+ * @return True if the chunk was mapped
+ */
+bool FlightRecorder::openChunk()
+{
+    const uint64_t offset = sizeof(RecordingFileHeader) + m_chunkSequence * m_chunkSize;
+
+    if (offset + m_chunkSize > m_fileSize && !growFile(offset + PREALLOCATE_CHUNKS * m_chunkSize))
+        return false;
+
+    try
+    {
+        auto pChunk = std::make_unique<MappedChunk>();
+        pChunk->file = boost::interprocess::file_mapping(m_filePath.c_str(), boost::interprocess::read_write);
+        pChunk->region = boost::interprocess::mapped_region(pChunk->file, boost::interprocess::read_write,
+                                                            static_cast<boost::interprocess::offset_t>(offset), m_chunkSize);
+        pChunk->pBase = static_cast<uint8_t *>(pChunk->region.get_address());
+        pChunk->pHeader = reinterpret_cast<RecordingChunkHeader *>(pChunk->pBase);
+
+        *pChunk->pHeader = RecordingChunkHeader{};
+        pChunk->pHeader->magic = RECORDING_CHUNK_MAGIC;
+        pChunk->pHeader->sequence = m_chunkSequence;
+
+        m_pChunk = std::move(pChunk);
+    }
+    catch (const boost::interprocess::interprocess_exception &e)
+    {
+        LOG_ERROR("Could not map recording chunk " + std::to_string(m_chunkSequence) + ": " + e.what());
+        m_pChunk.reset();
+        return false;
+    }
+
+    m_chunkSequence++;
+    return true;
+}
+
+/**
+ * @brief Unmaps the current chunk, the written pages are flushed asynchronously by the OS
+ */
+void FlightRecorder::closeChunk()
+{
+    if (!m_pChunk)
+        return;
+
+    m_pChunk->region.flush(0, 0, true);
+    m_pChunk.reset();
+}
+
+/**
+ * @brief Grows the recording file
+ * @details The new space is reserved on the disk. A sparse file would only run out of space on a store through
+ *          the mapping, which raises SIGBUS instead of an error.
+ * @param minimumSize New size of the file
+ * @return True if the file was grown
+ */
+bool FlightRecorder::growFile(uint64_t minimumSize)
+{
+#ifndef _WIN32
+    const int fd = ::open(m_filePath.c_str(), O_WRONLY);
+    const int result = fd < 0 ? errno : ::posix_fallocate(fd, static_cast<off_t>(m_fileSize), static_cast<off_t>(minimumSize - m_fileSize));
+    if (fd >= 0)
+        ::close(fd);
+    if (result != 0)
+    {
+        LOG_ERROR("Could not grow recording " + m_filePath + ": " + std::strerror(result));
+        return false;
+    }
+#else
+    // NTFS allocates the extended range, files are only sparse if marked so
+    std::error_code error;
+    std::filesystem::resize_file(m_filePath, minimumSize, error);
+    if (error)
+    {
+        LOG_ERROR("Could not grow recording " + m_filePath + ": " + error.message());
+        return false;
+    }
+#endif
+
+    m_fileSize = minimumSize;
+    return true;
+}
@@ -1,8 +1,69 @@
 #include "InputManager.h"
 
+#ifdef __linux__
+#include <cerrno>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <time.h>
+#endif
+
 using namespace aerolab::Core;
 
-void logReceivedData(const std::vector<uint8_t> &data);
+/**
+ * @brief Socket and receive state of a single ingest shard
+ * @details Every shard owns its own socket bound to the local endpoint. All handlers of a shard
+ *          run on its own strand, so shards are processed in parallel on a multi-threaded executor.
+ *          The pending handlers own the shard, so it outlives the InputManager until they ran. Stop() marks
+ *          the shard stopped and closes the socket under handlerMutex, afterwards the handlers return without
+ *          touching the InputManager. The shard keeps the pool alive for the buffers it still holds.
+ *          For the batched receive mode the message headers point directly into pooled datagram buffers,
+ *          so the kernel copies the payload straight into the buffer handed to the consumers.
+ */
+struct InputManager::Shard : std::enable_shared_from_this<InputManager::Shard>
+{
+    Shard(boost::asio::io_context::executor_type exec, std::size_t shardIndex, std::shared_ptr<DatagramPool> pDatagramPool)
+        : pPool(std::move(pDatagramPool)),
+          index(shardIndex),
+          socket(boost::asio::make_strand(exec))
+    {
+        receivedData.reserve(MAX_DATAGRAM_SIZE);
+    }
+
+    /// Pool of the receive buffers, declared first so it is destroyed after the buffers of the shard
+    std::shared_ptr<DatagramPool> pPool;
+    /// Index of the shard
+    std::size_t index;
+    /// Held by the handlers while they run, by Stop() while it closes the socket
+    std::mutex handlerMutex;
+    /// Set by Stop(), the handlers return right away afterwards
+    bool stopped = false;
+    /// UDP input socket of the shard, typed on the strand of the concrete executor so completing a handler does not allocate
+    boost::asio::basic_datagram_socket<boost::asio::ip::udp, boost::asio::strand<boost::asio::io_context::executor_type>> socket;
+    /// Reused buffer for the copying callback
+    std::vector<uint8_t> receivedData;
+    /// Buffer the pending single receive writes into
+    Datagram pendingDatagram;
+    /// Datagrams received by this shard
+    MetricCounter *pDatagramCounter = nullptr;
+
+#ifdef __linux__
+    /// Size of the control buffer for a single SCM_TIMESTAMPNS message
+    static constexpr std::size_t CONTROL_SIZE = CMSG_SPACE(sizeof(timespec));
+
+    /// Pooled buffers the next batch is received into
+    std::vector<Datagram> datagrams;
+    /// Message headers for recvmmsg
+    std::vector<mmsghdr> messages;
+    /// Scatter entries, one per message
+    std::vector<iovec> iovecs;
+    /// Sender addresses, one per message
+    std::vector<sockaddr_storage> addresses;
+    /// Control buffers receiving the kernel timestamps
+    std::vector<std::array<char, CONTROL_SIZE>> controls;
+#endif
+};
+
+void logReceivedData(std::span<const uint8_t> data);
 
 /**
  * @brief Constructor of the InputManager
@@ -10,10 +71,19 @@ void logReceivedData(const std::vector<uint8_t> &data);
  * @param ip The IPv4 address to bind the socket to
  * @param port The port to bind the socket to
  */
-InputManager::InputManager(boost::asio::any_io_executor exec, std::string ip, int port) : m_ioExecutor(exec),
-                                                                                          m_socket(m_ioExecutor)
+InputManager::InputManager(boost::asio::io_context::executor_type exec, std::string ip, int port) : m_pDatagramPool(std::make_shared<DatagramPool>()),
+                                                                                                   m_ioExecutor(exec),
+                                                                                                   m_pMetrics(MetricsRegistry::GetInstance())
 {
     m_localEndpoint = boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4::from_string(ip), port);
+
+    const std::string labels = "port=\"" + std::to_string(port) + "\"";
+    m_pDatagramCounter = &m_pMetrics->GetCounter("aerolab_input_datagrams_total", "Received datagrams", labels);
+    m_pByteCounter = &m_pMetrics->GetCounter("aerolab_input_bytes_total", "Received payload bytes", labels);
+    m_pErrorCounter = &m_pMetrics->GetCounter("aerolab_input_receive_errors_total", "Failed receive calls", labels);
+    m_pQueueDropCounter = &m_pMetrics->GetCounter("aerolab_input_queue_drops_total", "Datagrams dropped because the consumer queue was full", labels);
+    m_pQueueDepthGauge = &m_pMetrics->GetGauge("aerolab_input_queue_depth", "Datagrams waiting in the consumer queue", labels);
+    m_pCallbackHistogram = &m_pMetrics->GetHistogram("aerolab_input_callback_seconds", "Time spent in the receive callbacks per datagram", labels);
     LOG_INFO("Created InputManager");
 }
 
@@ -37,59 +107,169 @@ void InputManager::Start()
 {
     LOG_INFO("*** Starting InputManager ***");
 
-    boost::system::error_code ec;
-
-    LOG_INFO("Opening UDP Socket");
-    m_socket.open(boost::asio::ip::udp::v4(), ec);
-    if (ec)
+    std::size_t shardCount = m_shardCount > 0 ? m_shardCount : 1;
+#ifndef __linux__
+    if (shardCount > 1)
     {
-        LOG_ERROR("open failed: " + ec.message());
-        return;
+        LOG_WARNING("Sharded receiving is only supported on Linux, falling back to a single socket");
+        shardCount = 1;
     }
+#endif
 
-    m_socket.set_option(boost::asio::socket_base::reuse_address(true), ec);
-    if (ec)
+    // Restarting, the previous sockets have to be closed before the new ones are bound
+    if (!m_shards.empty())
+        Stop();
+
+    for (std::size_t i = 0; i < shardCount; i++)
     {
-        LOG_ERROR("set_option failed: " + ec.message());
-        return;
+        auto pShard = std::make_shared<Shard>(m_ioExecutor, i, m_pDatagramPool);
+        const std::string labels = "port=\"" + std::to_string(m_localEndpoint.port()) + "\",shard=\"" + std::to_string(i) + "\"";
+        pShard->pDatagramCounter = &m_pMetrics->GetCounter("aerolab_input_shard_datagrams_total", "Received datagrams by ingest shard", labels);
+        if (!openShard(*pShard, shardCount > 1))
+        {
+            for (auto &pOpened : m_shards)
+            {
+                boost::system::error_code ec;
+                pOpened->socket.close(ec);
+            }
+            m_shards.clear();
+            return;
+        }
+        m_shards.push_back(std::move(pShard));
     }
 
-    LOG_INFO("Binding socket to IP " + m_localEndpoint.address().to_string() + ":" + std::to_string(m_localEndpoint.port()));
-    m_socket.bind(m_localEndpoint, ec);
-    if (ec)
+    // Start receiving only after all shards are bound, so the kernel distributes over all of them
+    for (auto &pShard : m_shards)
     {
-        LOG_ERROR("bind failed: " + ec.message());
-        return;
+        if (m_maxBatch > 1)
+        {
+#ifdef __linux__
+            LOG_INFO("Shard " + std::to_string(pShard->index) + ": Starting to receive Data in batches of " + std::to_string(m_maxBatch));
+            receiveBatch(*pShard);
+#else
+            LOG_WARNING("Batched receiving is only supported on Linux, falling back to single receive");
+            LOG_INFO("Shard " + std::to_string(pShard->index) + ": Starting to receive Data");
+            receiveData(*pShard);
+#endif
+        }
+        else
+        {
+            LOG_INFO("Shard " + std::to_string(pShard->index) + ": Starting to receive Data");
+            receiveData(*pShard);
+        }
     }
 
-    LOG_INFO("Starting to receive Data");
-    receiveData;
-
     LOG_INFO("*** InputManager started ***\n");
 }
 
 /**
  * @brief Stops the InputManager
  * @details This function cleans up resources and stops ongoing operations.
+ *          Waits for the running handler of every shard, so no callback is called once Stop() returned
+ *          and the InputManager may be destroyed while handlers are still pending.
+ *          Must not be called from the callbacks.
  */
 void InputManager::Stop()
 {
     LOG_INFO("*** Stopping InputManager ***");
 
+    LOG_INFO("Closing UDP sockets...");
+    for (auto &pShard : m_shards)
+    {
+        std::lock_guard<std::mutex> guard(pShard->handlerMutex);
+        pShard->stopped = true;
+
+        if (pShard->socket.is_open())
+        {
+            boost::system::error_code ec;
+            pShard->socket.cancel(ec);
+            pShard->socket.close(ec);
+            if (ec)
+                LOG_WARNING("close reported: " + ec.message());
+
+            LOG_INFO("UDP socket of shard " + std::to_string(pShard->index) + " closed");
+        }
+    }
+    m_shards.clear();
+
+    LOG_INFO("*** InputManager stopped ***\n");
+}
+
+/**
+ * @brief Opens and binds the socket of a shard
+ * @param shard The shard to set up
+ * @param reusePort True to bind with SO_REUSEPORT so several shards share the endpoint
+ * @return True on success, False otherwise
+ */
+bool InputManager::openShard(Shard &shard, bool reusePort)
+{
     boost::system::error_code ec;
+    auto &socket = shard.socket;
+
+    LOG_INFO("Opening UDP Socket");
+    socket.open(boost::asio::ip::udp::v4(), ec);
+    if (ec)
+    {
+        LOG_ERROR("open failed: " + ec.message());
+        return false;
+    }
+
+    socket.set_option(boost::asio::socket_base::reuse_address(true), ec);
+    if (ec)
+    {
+        LOG_ERROR("set_option failed: " + ec.message());
+        return false;
+    }
 
-    LOG_INFO("Closing UDP socket...");
-    if (m_socket.is_open())
+#ifdef __linux__
+    if (reusePort)
     {
-        m_socket.cancel(ec);
-        m_socket.close(ec);
+        socket.set_option(boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true), ec);
         if (ec)
-            LOG_WARNING("close reported: " + ec.message());
+        {
+            LOG_ERROR("Setting SO_REUSEPORT failed: " + ec.message());
+            return false;
+        }
+    }
+#else
+    (void)reusePort;
+#endif
+
+    if (m_receiveBufferSize > 0)
+    {
+        socket.set_option(boost::asio::socket_base::receive_buffer_size(m_receiveBufferSize), ec);
+        if (ec)
+            LOG_WARNING("Setting receive buffer size failed: " + ec.message());
 
-        LOG_INFO("UDP socket closed");
+        boost::asio::socket_base::receive_buffer_size actualSize;
+        socket.get_option(actualSize, ec);
+        LOG_INFO("Receive buffer size: " + std::to_string(actualSize.value()) + " bytes");
     }
 
-    LOG_INFO("*** InputManager stopped ***\n");
+    LOG_INFO("Binding socket to IP " + m_localEndpoint.address().to_string() + ":" + std::to_string(m_localEndpoint.port()));
+    socket.bind(m_localEndpoint, ec);
+    if (ec)
+    {
+        LOG_ERROR("bind failed: " + ec.message());
+        return false;
+    }
+
+#ifdef __linux__
+    if (m_maxBatch > 1)
+    {
+        int enable = 1;
+        if (setsockopt(socket.native_handle(), SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) != 0)
+            LOG_WARNING("Enabling SO_TIMESTAMPNS failed: " + std::string(std::strerror(errno)));
+
+        shard.datagrams.resize(m_maxBatch);
+        shard.messages.resize(m_maxBatch);
+        shard.iovecs.resize(m_maxBatch);
+        shard.addresses.resize(m_maxBatch);
+        shard.controls.resize(m_maxBatch);
+    }
+#endif
+
+    return true;
 }
 
 // ============================================================================
@@ -99,56 +279,233 @@ void InputManager::Stop()
 /**
  * @brief Initiates asynchronous data reception
  * @details This function sets up an asynchronous receive operation on the UDP socket.
- * When data is received, it logs the number of bytes, the data itself and the sender's address.
- * It then recursively calls itself to continue listening for incoming data.
+ * The datagram is received directly into a buffer taken from the datagram pool, so no heap
+ * allocation is performed per packet. It then recursively calls itself to continue listening for incoming data.
  */
-void InputManager::receiveData()
+void InputManager::receiveData(Shard &shard)
 {
-    auto buffer = std::make_shared<std::vector<char>>(4096);
-    auto senderEndpoint = std::make_shared<boost::asio::ip::udp::endpoint>();
-
-    if (!m_socket.is_open())
+    if (!shard.socket.is_open())
     {
         LOG_WARNING("Trying to receive data before opening the socket!");
         return;
     }
 
-    m_socket.async_receive_from(
-        boost::asio::buffer(*buffer), *senderEndpoint,
-        [this, buffer, senderEndpoint](boost::system::error_code ec, std::size_t bytesReceived)
+    // Kept in the shard, not in the handler, so the shard releases it before the pool
+    shard.pendingDatagram = m_pDatagramPool->Acquire();
+    auto buffer = boost::asio::buffer(shard.pendingDatagram.MutableBuffer().data(), MAX_DATAGRAM_SIZE);
+    auto &senderEndpoint = shard.pendingDatagram.MutableSender();
+
+    shard.socket.async_receive_from(
+        buffer, senderEndpoint,
+        [this, pShard = shard.shared_from_this()](boost::system::error_code ec, std::size_t bytesReceived)
         {
+            Shard &shard = *pShard;
+            std::lock_guard<std::mutex> guard(shard.handlerMutex);
+            if (shard.stopped || ec == boost::asio::error::operation_aborted)
+                return;
+
+            Datagram datagram = std::move(shard.pendingDatagram);
             if (!ec)
             {
-                std::vector<uint8_t> receivedData(buffer->begin(), buffer->begin() + bytesReceived);
-                LOG_DEBUG("Received " + std::to_string(bytesReceived) + " bytes from " + senderEndpoint->address().to_string());
-                logReceivedData(receivedData);
-
-                if (m_messageReceivedCallback)
-                    m_messageReceivedCallback(receivedData);
+                datagram.SetSize(bytesReceived);
+                datagram.SetTimestamp(std::chrono::system_clock::now());
+                handleDatagram(shard, datagram);
             }
             else
+            {
+                m_pErrorCounter->Inc();
                 LOG_ERROR("Error receiving data: " + ec.message());
+            }
+
+            // Release the buffer before re-arming so it can be reused right away
+            datagram = Datagram();
+
+            if (shard.socket.is_open())
+                receiveData(shard);
+        });
+}
+
+/**
+ * @brief Initiates asynchronous batched data reception
+ * @details Waits until the socket becomes readable and then drains it with recvmmsg.
+ * It then recursively calls itself to continue listening for incoming data.
+ */
+void InputManager::receiveBatch(Shard &shard)
+{
+    if (!shard.socket.is_open())
+    {
+        LOG_WARNING("Trying to receive data before opening the socket!");
+        return;
+    }
 
-            if (m_socket.is_open())
-                receiveData();
+    shard.socket.async_wait(
+        boost::asio::ip::udp::socket::wait_read,
+        [this, pShard = shard.shared_from_this()](boost::system::error_code ec)
+        {
+            Shard &shard = *pShard;
+            std::lock_guard<std::mutex> guard(shard.handlerMutex);
+            if (shard.stopped || ec == boost::asio::error::operation_aborted)
+                return;
+
+            if (!ec)
+                drainBatch(shard);
+            else
+            {
+                m_pErrorCounter->Inc();
+                LOG_ERROR("Error waiting for data: " + ec.message());
+            }
+
+            if (shard.socket.is_open())
+                receiveBatch(shard);
         });
 }
 
+/**
+ * @brief Reads all pending datagrams from the socket
+ * @details Calls recvmmsg with up to m_maxBatch messages until the socket would block.
+ * Every datagram is stamped with its kernel receive timestamp.
+ */
+void InputManager::drainBatch(Shard &shard)
+{
+#ifdef __linux__
+    const std::size_t batchSize = shard.messages.size();
+
+    while (true)
+    {
+        // Prepare the message headers, reusing buffers which have not been filled last time
+        for (std::size_t i = 0; i < batchSize; i++)
+        {
+            if (!shard.datagrams[i])
+                shard.datagrams[i] = m_pDatagramPool->Acquire();
+
+            shard.iovecs[i].iov_base = shard.datagrams[i].MutableBuffer().data();
+            shard.iovecs[i].iov_len = MAX_DATAGRAM_SIZE;
+
+            msghdr &header = shard.messages[i].msg_hdr;
+            header.msg_name = &shard.addresses[i];
+            header.msg_namelen = sizeof(sockaddr_storage);
+            header.msg_iov = &shard.iovecs[i];
+            header.msg_iovlen = 1;
+            header.msg_control = shard.controls[i].data();
+            header.msg_controllen = shard.controls[i].size();
+            header.msg_flags = 0;
+        }
+
+        const int count = recvmmsg(shard.socket.native_handle(), shard.messages.data(), static_cast<unsigned int>(batchSize), MSG_DONTWAIT, nullptr);
+        if (count < 0)
+        {
+            // A closed socket is no error, Stop() may have cancelled the wait
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && shard.socket.is_open())
+            {
+                m_pErrorCounter->Inc();
+                LOG_ERROR("Error receiving data: " + std::string(std::strerror(errno)));
+            }
+            return;
+        }
+
+        const auto now = std::chrono::system_clock::now();
+
+        for (int i = 0; i < count; i++)
+        {
+            Datagram &datagram = shard.datagrams[i];
+            msghdr &header = shard.messages[i].msg_hdr;
+
+            datagram.SetSize(shard.messages[i].msg_len);
+
+            // Sender address
+            auto &sender = datagram.MutableSender();
+            std::memcpy(sender.data(), &shard.addresses[i], header.msg_namelen);
+            sender.resize(header.msg_namelen);
+
+            // Kernel receive timestamp, fall back to the current time if it is missing
+            datagram.SetTimestamp(now);
+            for (cmsghdr *pControl = CMSG_FIRSTHDR(&header); pControl != nullptr; pControl = CMSG_NXTHDR(&header, pControl))
+            {
+                if (pControl->cmsg_level == SOL_SOCKET && pControl->cmsg_type == SCM_TIMESTAMPNS)
+                {
+                    timespec ts;
+                    std::memcpy(&ts, CMSG_DATA(pControl), sizeof(ts));
+                    datagram.SetTimestamp(std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec))));
+                }
+            }
+
+            handleDatagram(shard, datagram);
+
+            // Hand the buffer over to the consumers, a fresh one is acquired for the next batch
+            datagram = Datagram();
+        }
+
+        // Socket is drained if the batch has not been filled
+        if (static_cast<std::size_t>(count) < batchSize)
+            return;
+    }
+#else
+    (void)shard;
+#endif
+}
+
+/**
+ * @brief Hands a received datagram to the registered callbacks
+ * @param shard The shard the datagram was received on
+ * @param datagram The received datagram
+ */
+void InputManager::handleDatagram(Shard &shard, const Datagram &datagram)
+{
+    LOG_DEBUG_F("Received {} bytes from {}", datagram.Size(), datagram.Sender());
+    if (LOG_ENABLED(E_LogLevel::Debug))
+        logReceivedData(datagram.Span());
+
+    m_pDatagramCounter->Inc();
+    shard.pDatagramCounter->Inc();
+    m_pByteCounter->Inc(datagram.Size());
+
+    if (m_pQueue)
+    {
+        if (!m_pQueue->Push(datagram))
+            m_pQueueDropCounter->Inc();
+        m_pQueueDepthGauge->Set(static_cast<int64_t>(m_pQueue->Size()));
+    }
+
+    if (!m_datagramCallback && !m_messageReceivedCallback)
+        return;
+
+    const auto callbackStart = std::chrono::steady_clock::now();
+
+    if (m_datagramCallback)
+        m_datagramCallback(datagram);
+
+    if (m_messageReceivedCallback)
+    {
+        // assign reuses the reserved capacity of the member
+        shard.receivedData.assign(datagram.Data(), datagram.Data() + datagram.Size());
+        m_messageReceivedCallback(shard.receivedData);
+    }
+
+    m_pCallbackHistogram->ObserveSince(callbackStart);
+}
+
 // ============================================================================
 // Utility Functions
 // ============================================================================
 
 /**
  * @brief Logs incoming data in hex
- * @param data The vector of incoming data to log
+ * @param data The incoming data to log
  */
-void logReceivedData(const std::vector<uint8_t> &data)
+void logReceivedData(std::span<const uint8_t> data)
 {
-    std::ostringstream oss;
-    oss << "Received data: " << std::hex << std::uppercase;
+    static constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+
+    std::string message = "Received data: ";
+    message.reserve(message.size() + 3 * data.size());
 
     for (const auto &byte : data)
-        oss << std::setw(2) << std::setfill('0') << static_cast<int>(byte) << " ";
+    {
+        message += HEX_DIGITS[byte >> 4];
+        message += HEX_DIGITS[byte & 0x0F];
+        message += ' ';
+    }
 
-    LOG_DEBUG(oss.str());
+    LOG_DEBUG(message);
 }
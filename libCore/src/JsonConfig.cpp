@@ -1,7 +1,82 @@
 #include "JsonConfig.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
 using namespace aerolab::Core;
 
+namespace
+{
+    /// Interval the watch thread checks for changes and for the stop flag
+    constexpr int WATCH_INTERVAL_MS = 250;
+    /// Editors write in several steps, the reload waits until the file has been quiet this long
+    constexpr auto RELOAD_DEBOUNCE = std::chrono::milliseconds(50);
+
+    /// @brief Converts a json pointer ("/node/parameter") into a parameter path ("node/parameter")
+    std::string pointerToPath(const std::string &pointer)
+    {
+        std::string path;
+        for (std::size_t i = 0; i < pointer.size(); i++)
+        {
+            if (pointer[i] == '~' && i + 1 < pointer.size())
+            {
+                path += pointer[i + 1] == '1' ? '/' : '~';
+                i++;
+            }
+            else if (pointer[i] != '/' || i > 0)
+            {
+                path += pointer[i];
+            }
+        }
+        return path;
+    }
+
+    /// @brief True if one of the paths is a prefix of the other, compared key by key
+    bool pathsOverlap(const std::vector<std::string> &a, const std::vector<std::string> &b)
+    {
+        const std::size_t common = std::min(a.size(), b.size());
+        return std::equal(a.begin(), a.begin() + static_cast<std::ptrdiff_t>(common), b.begin());
+    }
+
+    /// @brief Writes a file to the disk before returning
+    bool syncFile(std::FILE *pFile)
+    {
+        if (std::fflush(pFile) != 0)
+            return false;
+#ifdef _WIN32
+        return _commit(_fileno(pFile)) == 0;
+#else
+        return fsync(fileno(pFile)) == 0;
+#endif
+    }
+
+    /// @brief Writes the directory entry of a renamed file to the disk
+    void syncDirectory(const std::filesystem::path &directory)
+    {
+#ifndef _WIN32
+        const int fd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd < 0)
+            return;
+        fsync(fd);
+        close(fd);
+#else
+        (void)directory;
+#endif
+    }
+}
+
 std::shared_ptr<JsonConfig> JsonConfig::s_instance = nullptr;
 std::once_flag JsonConfig::s_once{};
 
@@ -13,7 +88,6 @@ std::shared_ptr<JsonConfig> JsonConfig::GetInstance()
 {
     if (!s_instance)
         throw std::runtime_error("Config not yet initialized.");
-    LOG_DEBUG("Fetching Instance");
     return s_instance;
 }
 
@@ -38,8 +112,15 @@ void JsonConfig::Init(const std::string &configFilePath)
  * @brief Constructor for the JsonConfig class
  * @details Sets the configFilePath member and reads the config file
  */
-JsonConfig::JsonConfig(const std::string &configFilePath) : m_configFilePath(configFilePath)
+JsonConfig::JsonConfig(const std::string &configFilePath) : m_configFilePath(configFilePath),
+                                                             m_pMetrics(MetricsRegistry::GetInstance())
 {
+    m_pReloadCounter = &m_pMetrics->GetCounter("aerolab_config_reloads_total", "Reloads of the config file which changed the config");
+    m_pReloadErrorCounter = &m_pMetrics->GetCounter("aerolab_config_reload_errors_total", "Reloads of config files which could not be read or parsed");
+    m_pSaveCounter = &m_pMetrics->GetCounter("aerolab_config_saves_total", "Written config files");
+    m_pSaveErrorCounter = &m_pMetrics->GetCounter("aerolab_config_save_errors_total", "Failed writes of the config file");
+    m_pSaveHistogram = &m_pMetrics->GetHistogram("aerolab_config_save_seconds", "Duration of a config file write including the sync to the disk");
+
     std::ifstream fileStream(configFilePath);
 
     LOG_DEBUG("Created Filestream with path: " + configFilePath);
@@ -47,7 +128,18 @@ JsonConfig::JsonConfig(const std::string &configFilePath) : m_configFilePath(con
     if (!fileStream.is_open())
         throw std::runtime_error("Could not open config file");
 
-    fileStream >> m_json;
+    auto pJson = std::make_shared<nlohmann::json>();
+    fileStream >> *pJson;
+    m_snapshot.store(std::move(pJson));
+}
+
+/**
+ * @brief Destructor of the JsonConfig class
+ */
+JsonConfig::~JsonConfig()
+{
+    StopWatching();
+    stopSaver();
 }
 
 // ============================================================================
@@ -56,30 +148,414 @@ JsonConfig::JsonConfig(const std::string &configFilePath) : m_configFilePath(con
 
 /**
  * @brief Saves the member json to the config file
+ * @details The config is written to a temporary file first, which replaces the config file once it is
+ *          on the disk. A crash during the write leaves the previous config file intact.
  * @return True if the config has been written successfully, False otherwise
  */
 bool JsonConfig::SaveJson()
 {
-    std::ofstream fileStream(m_configFilePath);
+    return writeSnapshot(GetSnapshot());
+}
+
+/**
+ * @brief Saves the config to the config file on a background thread
+ * @details The write is delayed by the save delay (see SetSaveDelay()). Requests arriving in the meantime
+ *          delay it further and share the same write, so a burst of changes is written once.
+ *          The config is serialized on the background thread, the caller never waits for the disk.
+ * @param onSaved Optional callback called on the background thread once the config has been written
+ * @return Future becoming ready with the result of the write
+ */
+std::shared_future<bool> JsonConfig::SaveJsonAsync(std::function<void(bool saved)> onSaved)
+{
+    std::shared_future<bool> future;
+    {
+        std::lock_guard<std::mutex> guard(m_saveMutex);
 
-    // Open filestream for writing config
-    if (!fileStream.is_open())
+        if (!m_saverRunning)
+        {
+            if (m_saveThread.joinable())
+                m_saveThread.join();
+
+            m_saverRunning = true;
+            m_saveThread = std::thread(&JsonConfig::runSaver, this);
+        }
+
+        if (!m_savePending)
+        {
+            m_savePromise = std::promise<bool>();
+            m_saveFuture = m_savePromise.get_future().share();
+            m_savePending = true;
+        }
+
+        m_saveDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_saveDelayMs.load(std::memory_order_relaxed));
+        if (onSaved)
+            m_saveCallbacks.push_back(std::move(onSaved));
+
+        future = m_saveFuture;
+    }
+
+    m_saveCondition.notify_one();
+    return future;
+}
+
+void JsonConfig::runSaver()
+{
+    std::unique_lock<std::mutex> lock(m_saveMutex);
+
+    while (true)
+    {
+        m_saveCondition.wait(lock, [this]()
+                             { return m_savePending || !m_saverRunning; });
+        if (!m_savePending)
+            break;
+
+        // Wait until no further request arrived for the save delay, a stop writes right away
+        while (m_saverRunning && std::chrono::steady_clock::now() < m_saveDeadline)
+            m_saveCondition.wait_until(lock, m_saveDeadline);
+
+        std::promise<bool> promise = std::move(m_savePromise);
+        std::vector<std::function<void(bool)>> callbacks = std::move(m_saveCallbacks);
+        m_saveCallbacks.clear();
+        m_savePending = false;
+        lock.unlock();
+
+        const bool saved = writeSnapshot(GetSnapshot());
+        promise.set_value(saved);
+        for (const auto &callback : callbacks)
+            callback(saved);
+
+        lock.lock();
+    }
+}
+
+/**
+ * @brief Stops the save thread after writing a pending save
+ */
+void JsonConfig::stopSaver()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_saveMutex);
+        m_saverRunning = false;
+    }
+    m_saveCondition.notify_all();
+
+    if (m_saveThread.joinable())
+        m_saveThread.join();
+}
+
+/**
+ * @brief Writes a snapshot to the config file
+ * @details Writes a temporary file next to the config file, syncs it to the disk and renames it
+ *          over the config file.
+ * @param pSnapshot The snapshot to write
+ * @return True if the config file has been replaced
+ */
+bool JsonConfig::writeSnapshot(const Snapshot &pSnapshot)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    std::string content;
+    try
+    {
+        content = pSnapshot->dump(4); // Indent 4 spaces
+    }
+    catch (const nlohmann::json::exception &e)
+    {
+        LOG_ERROR(std::string("Could not serialize config: ") + e.what());
+        m_pSaveErrorCounter->Inc();
+        return false;
+    }
+
+    const std::filesystem::path filePath(m_configFilePath);
+    const std::filesystem::path tempPath(m_configFilePath + ".tmp");
+
+    std::lock_guard<std::mutex> guard(m_fileMutex);
+
+    std::FILE *pFile = std::fopen(tempPath.string().c_str(), "wb");
+    if (!pFile)
+    {
+        LOG_ERROR("Could not open " + tempPath.string());
+        m_pSaveErrorCounter->Inc();
+        return false;
+    }
+
+    const bool written = std::fwrite(content.data(), 1, content.size(), pFile) == content.size() && syncFile(pFile);
+    if (std::fclose(pFile) != 0 || !written)
+    {
+        LOG_ERROR("Could not write " + tempPath.string());
+        std::error_code error;
+        std::filesystem::remove(tempPath, error);
+        m_pSaveErrorCounter->Inc();
+        return false;
+    }
+
+    // Set before the rename, the watch thread may see the new file right away
+    m_pSavedSnapshot = pSnapshot;
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, filePath, error);
+    if (error)
+    {
+        LOG_ERROR("Could not replace " + m_configFilePath + ": " + error.message());
+        std::filesystem::remove(tempPath, error);
+        m_pSaveErrorCounter->Inc();
         return false;
+    }
+
+    syncDirectory(filePath.parent_path());
+    m_pSaveCounter->Inc();
+    m_pSaveHistogram->ObserveSince(start);
+    return true;
+}
 
-    // Write config to file
+/**
+ * @brief Reads the config file again
+ * @details Publishes the file content as new snapshot and notifies the subscribers of all paths
+ *          which differ from the current snapshot. A file which can not be parsed is ignored.
+ * @return True if the file has been read, False otherwise
+ */
+bool JsonConfig::Reload()
+{
+    auto pJson = std::make_shared<nlohmann::json>();
     try
     {
-        fileStream << m_json.dump(4); // Indent 4 spaces
-        fileStream.close();
+        std::ifstream fileStream(m_configFilePath);
+        if (!fileStream.is_open())
+        {
+            LOG_ERROR("Could not open config file " + m_configFilePath);
+            m_pReloadErrorCounter->Inc();
+            return false;
+        }
+        fileStream >> *pJson;
     }
-    catch (...)
+    catch (const nlohmann::json::exception &e)
     {
+        LOG_ERROR("Could not parse config file " + m_configFilePath + ": " + e.what());
+        m_pReloadErrorCounter->Inc();
         return false;
     }
 
+    {
+        // Our own save, the file may already be behind newer changes. Matched once only, afterwards
+        // or once the file was changed by someone else, the file content is taken again.
+        std::lock_guard<std::mutex> guard(m_fileMutex);
+        const bool ownSave = m_pSavedSnapshot && *m_pSavedSnapshot == *pJson;
+        m_pSavedSnapshot.reset();
+        if (ownSave)
+            return true;
+    }
+
+    std::vector<std::string> changedPaths;
+    {
+        std::lock_guard<std::mutex> guard(m_writeMutex);
+
+        const Snapshot pCurrent = GetSnapshot();
+        if (*pCurrent == *pJson)
+            return true;
+
+        for (const auto &operation : nlohmann::json::diff(*pCurrent, *pJson))
+            changedPaths.push_back(pointerToPath(operation["path"].get<std::string>()));
+
+        publish(std::move(pJson));
+    }
+
+    m_pReloadCounter->Inc();
+    LOG_INFO("Reloaded config file, " + std::to_string(changedPaths.size()) + " changes");
+    notifySubscribers(changedPaths);
     return true;
 }
 
+/**
+ * @brief Publishes a new snapshot
+ * @details Has to be called with m_writeMutex locked. The version is incremented after the snapshot
+ *          has been stored, so a handle which sees the new version also sees the new snapshot.
+ * @param pJson The new snapshot
+ */
+void JsonConfig::publish(std::shared_ptr<const nlohmann::json> pJson)
+{
+    m_snapshot.store(std::move(pJson), std::memory_order_release);
+    m_version.fetch_add(1, std::memory_order_acq_rel);
+}
+
+// ============================================================================
+// Change notification
+// ============================================================================
+
+/**
+ * @brief Registers a callback for changes of a parameter or of a whole node
+ * @details The callback is called on the thread which made the change, i.e. the writer or the
+ *          watch thread, once for every changed path below or above the subscribed path.
+ * @param parameterPath The path to the parameter or node, empty for the whole config
+ * @param callback The callback function
+ * @return Id of the subscription for Unsubscribe()
+ */
+uint64_t JsonConfig::Subscribe(const std::string &parameterPath, ChangeCallback callback)
+{
+    std::lock_guard<std::mutex> guard(m_subscriptionMutex);
+    const uint64_t id = m_nextSubscriptionId++;
+    m_subscriptions.push_back({id, splitPath(parameterPath), std::move(callback)});
+    return id;
+}
+
+/**
+ * @brief Removes a subscription
+ * @param subscriptionId The id returned by Subscribe()
+ */
+void JsonConfig::Unsubscribe(uint64_t subscriptionId)
+{
+    std::lock_guard<std::mutex> guard(m_subscriptionMutex);
+    std::erase_if(m_subscriptions, [subscriptionId](const Subscription &subscription)
+                  { return subscription.id == subscriptionId; });
+}
+
+/**
+ * @brief Calls the callbacks of all subscriptions matching the changed paths
+ * @param changedPaths The changed paths
+ */
+void JsonConfig::notifySubscribers(const std::vector<std::string> &changedPaths)
+{
+    // Copy, so callbacks may subscribe and unsubscribe
+    std::vector<Subscription> subscriptions;
+    {
+        std::lock_guard<std::mutex> guard(m_subscriptionMutex);
+        subscriptions = m_subscriptions;
+    }
+
+    for (const auto &changedPath : changedPaths)
+    {
+        const auto changedKeys = splitPath(changedPath);
+        for (const auto &subscription : subscriptions)
+        {
+            if (pathsOverlap(subscription.keys, changedKeys))
+                subscription.callback(changedPath);
+        }
+    }
+}
+
+// ============================================================================
+// File watching
+// ============================================================================
+
+/**
+ * @brief Starts a thread reloading the config whenever the file changes on disk
+ * @details Uses inotify on Linux and polls the modification time on other platforms.
+ */
+void JsonConfig::StartWatching()
+{
+    if (m_watching.exchange(true))
+        return;
+
+    m_watchThread = std::thread(&JsonConfig::watchFile, this);
+}
+
+/**
+ * @brief Stops watching the config file
+ */
+void JsonConfig::StopWatching()
+{
+    m_watching = false;
+    if (m_watchThread.joinable())
+        m_watchThread.join();
+}
+
+void JsonConfig::watchFile()
+{
+    const std::filesystem::path filePath = std::filesystem::absolute(m_configFilePath);
+    LOG_INFO("Watching config file " + filePath.string());
+
+    if (!watchInotify(filePath.filename().string(), filePath.parent_path().string()))
+        pollFile();
+}
+
+/**
+ * @brief Waits for inotify events of the config file
+ * @details The directory is watched instead of the file, because editors often replace the file.
+ * @param fileName Name of the config file
+ * @param directory Directory of the config file
+ * @return False if inotify is not available
+ */
+bool JsonConfig::watchInotify(const std::string &fileName, const std::string &directory)
+{
+#ifdef __linux__
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+    {
+        LOG_WARNING("Could not watch " + directory + ", polling the config file instead");
+        close(fd);
+        return false;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+
+    // True if one of the pending events concerns the config file
+    const auto readEvents = [&]()
+    {
+        bool changed = false;
+        ssize_t length;
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0)
+        {
+            for (char *p = buffer; p < buffer + length;)
+            {
+                const auto *pEvent = reinterpret_cast<const inotify_event *>(p);
+                if (pEvent->len > 0 && fileName == pEvent->name)
+                    changed = true;
+                p += sizeof(inotify_event) + pEvent->len;
+            }
+        }
+        return changed;
+    };
+
+    while (m_watching)
+    {
+        pollfd pollFd{fd, POLLIN, 0};
+        if (poll(&pollFd, 1, WATCH_INTERVAL_MS) <= 0 || !readEvents())
+            continue;
+
+        // Wait until the writer is done
+        pollFd.revents = 0;
+        while (poll(&pollFd, 1, static_cast<int>(RELOAD_DEBOUNCE.count())) > 0)
+        {
+            readEvents();
+            pollFd.revents = 0;
+        }
+
+        Reload();
+    }
+
+    close(fd);
+    return true;
+#else
+    (void)fileName;
+    (void)directory;
+    return false;
+#endif
+}
+
+/**
+ * @brief Polls the modification time of the config file
+ */
+void JsonConfig::pollFile()
+{
+    std::error_code error;
+    auto lastWrite = std::filesystem::last_write_time(m_configFilePath, error);
+
+    while (m_watching)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(WATCH_INTERVAL_MS));
+
+        const auto writeTime = std::filesystem::last_write_time(m_configFilePath, error);
+        if (error || writeTime == lastWrite)
+            continue;
+
+        lastWrite = writeTime;
+        std::this_thread::sleep_for(RELOAD_DEBOUNCE);
+        Reload();
+    }
+}
+
 // ============================================================================
 // Utility functions
 // ============================================================================
@@ -89,15 +565,62 @@ bool JsonConfig::SaveJson()
  * @param parameterPath The path to a config parameter formatted as follows: "node/node/.../parameter"
  * @return vector of strings containing the parts of the path -> {"node", "node", ..., "parameter"}
  */
-std::vector<std::string> JsonConfig::splitPath(const std::string &parameterPath)
+std::vector<std::string> JsonConfig::splitPath(std::string_view parameterPath)
 {
     std::vector<std::string> parts;
-    std::stringstream ss(parameterPath);
-    std::string item;
-    while (std::getline(ss, item, '/'))
+    std::size_t start = 0;
+    while (start <= parameterPath.size())
     {
-        if (!item.empty())
-            parts.push_back(item);
+        std::size_t end = parameterPath.find('/', start);
+        if (end == std::string_view::npos)
+            end = parameterPath.size();
+
+        if (end > start)
+            parts.emplace_back(parameterPath.substr(start, end - start));
+        start = end + 1;
     }
     return parts;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Walks the json along the given keys
+ * @details A single find() per level instead of contains() and operator[].
+ * @param root The json to walk
+ * @param keys The split path to the parameter
+ * @return The node at the path, nullptr if it does not exist
+ */
+const nlohmann::json *JsonConfig::findNode(const nlohmann::json &root, const std::vector<std::string> &keys)
+{
+    const nlohmann::json *pNode = &root;
+
+    for (const auto &key : keys)
+    {
+        if (!pNode->is_object())
+            return nullptr;
+
+        const auto it = pNode->find(key);
+        if (it == pNode->end())
+            return nullptr;
+
+        pNode = &(*it);
+    }
+
+    return pNode;
+}
+
+/**
+ * @brief Joins split path keys into a parameter path
+ * @param keys The keys of the path
+ * @return The path formatted as "node/node/.../parameter"
+ */
+std::string JsonConfig::joinPath(const std::vector<std::string> &keys)
+{
+    std::string path;
+    for (const auto &key : keys)
+    {
+        if (!path.empty())
+            path += '/';
+        path += key;
+    }
+    return path;
+}
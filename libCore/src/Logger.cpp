@@ -1,7 +1,88 @@
 #include "Logger.h"
 
+#include <array>
+#include <ctime>
+#include <vector>
+
 using namespace aerolab::Core;
 
+namespace
+{
+    /// Maximum number of records the writer thread formats per write
+    constexpr std::size_t WRITE_BATCH = 256;
+
+    const char *levelName(E_LogLevel level)
+    {
+        switch (level)
+        {
+        case E_LogLevel::Error:
+            return "ERROR";
+        case E_LogLevel::Warning:
+            return "WARNING";
+        case E_LogLevel::Debug:
+            return "DEBUG";
+        case E_LogLevel::Info:
+        default:
+            return "INFO";
+        }
+    }
+
+    const char *levelColor(E_LogLevel level)
+    {
+        switch (level)
+        {
+        case E_LogLevel::Error:
+            return "\033[1;31m";
+        case E_LogLevel::Warning:
+            return "\033[33m";
+        case E_LogLevel::Debug:
+            return "\033[34m";
+        case E_LogLevel::Info:
+        default:
+            return nullptr;
+        }
+    }
+
+    /// @brief File name of a path without allocating
+    const char *fileName(const char *path)
+    {
+        const char *pName = path;
+        for (const char *p = path; *p != '\0'; p++)
+        {
+            if (*p == '/' || *p == '\\')
+                pName = p + 1;
+        }
+        return pName;
+    }
+
+    /// ISO 8601 time string, only rebuilt when the second changes
+    class TimestampCache
+    {
+    public:
+        const char *Format(std::time_t time)
+        {
+            if (time == m_second)
+                return m_text.data();
+
+            std::tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &time);
+#else
+            localtime_r(&time, &local);
+#endif
+            if (!std::strftime(m_text.data(), m_text.size(), "%FT%T%z", &local))
+                std::strcpy(m_text.data(), "no time");
+            m_second = time;
+            return m_text.data();
+        }
+
+    private:
+        std::time_t m_second = -1;
+        std::array<char, 64> m_text{};
+    };
+}
+
+std::atomic<int> Logger::s_logLevel{static_cast<int>(E_LogLevel::Debug)};
 std::once_flag Logger::s_once;
 std::shared_ptr<Logger> Logger::s_instance = nullptr;
 
@@ -46,10 +127,304 @@ std::shared_ptr<Logger> Logger::GetInstance()
  * @throws std::runtime_error if the file cannot be opened
  */
 Logger::Logger(const std::string &filePath) : m_fileStream(filePath, std::ios::app),
-                                              m_logLevel(E_LogLevel::Debug)
+                                               m_pMetrics(MetricsRegistry::GetInstance())
 {
     if (!m_fileStream.is_open())
         throw std::runtime_error("Unable to open log file");
+
+    static constexpr const char *LEVEL_LABELS[] = {"level=\"error\"", "level=\"warning\"", "level=\"info\"", "level=\"debug\""};
+    for (std::size_t i = 0; i < m_messageCounters.size(); i++)
+        m_messageCounters[i] = &m_pMetrics->GetCounter("aerolab_log_messages_total", "Logged messages by level", LEVEL_LABELS[i]);
+    m_pDroppedCounter = &m_pMetrics->GetCounter("aerolab_log_dropped_total", "Messages dropped because the queue of the asynchronous logger was full");
+}
+
+/**
+ * @brief Destructor of the Logger class
+ * @details Writes all queued messages of the asynchronous mode before the file is closed.
+ */
+Logger::~Logger()
+{
+    stopWriter();
+}
+
+// ============================================================================
+// Asynchronous mode
+// ============================================================================
+
+/**
+ * @brief Enables or disables the asynchronous mode
+ * @details In the asynchronous mode callers only push a record into a bounded queue, a writer thread
+ *          formats the records and writes them in batches. The streams are flushed every flush interval,
+ *          after every error and on shutdown. An error message blocks the caller until it has been flushed,
+ *          so it is never lost and everything logged before is on disk as well.
+ *          Should be called once during startup. The queue is created on the first call,
+ *          so the capacity and the policy of later calls are ignored.
+ * @param enabled True to enable the asynchronous mode
+ * @param queueCapacity Number of records which can wait for the writer thread
+ * @param overflowPolicy What happens to non-error messages if the queue is full
+ */
+void Logger::SetAsync(bool enabled, std::size_t queueCapacity, E_OverflowPolicy overflowPolicy)
+{
+    if (enabled == m_async.load())
+        return;
+
+    if (!enabled)
+    {
+        stopWriter();
+        return;
+    }
+
+    if (!m_pQueue)
+        m_pQueue = std::make_unique<RingBuffer<LogRecord>>(queueCapacity, overflowPolicy);
+
+    m_writerRunning = true;
+    m_writerThread = std::thread(&Logger::runWriter, this);
+    m_async = true;
+}
+
+/**
+ * @brief Writes and flushes all messages logged so far
+ */
+void Logger::Flush()
+{
+    if (m_async.load(std::memory_order_acquire))
+    {
+        // A record without file is only a flush marker. The flag is shared, the writer may set it after
+        // the caller stopped waiting.
+        auto pFlushed = std::make_shared<std::atomic<bool>>(false);
+        LogRecord marker;
+        marker.file = nullptr;
+        marker.pFlushed = pFlushed;
+
+        if (pushWaiting(marker))
+        {
+            std::unique_lock<std::mutex> lock(m_flushMutex);
+            m_flushCondition.wait(lock, [&]()
+                                  { return pFlushed->load(); });
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_fileStream.flush();
+    std::cout.flush();
+}
+
+/**
+ * @brief Queues a message for the writer thread
+ * @details Errors bypass the overflow policy and wait until they are flushed.
+ */
+void Logger::enqueue(E_LogLevel level, const std::string &msg, const char *file, int line, const char *func)
+{
+    LogRecord record;
+    record.level = level;
+    record.time = std::chrono::system_clock::now();
+    record.file = file;
+    record.line = line;
+    record.func = func;
+    record.message = msg;
+
+    if (level != E_LogLevel::Error)
+    {
+        // Registered before the check, stopWriter() drains the queue only after the push
+        m_activeProducers.fetch_add(1, std::memory_order_seq_cst);
+        if (m_writerRunning.load(std::memory_order_seq_cst))
+        {
+            if (!m_pQueue->Push(std::move(record)))
+                m_pDroppedCounter->Inc();
+            m_activeProducers.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+        m_activeProducers.fetch_sub(1, std::memory_order_release);
+
+        // Late messages of threads still running while the asynchronous mode stops are written directly
+        log(levelName(level), msg, file, line, func, std::cout);
+        return;
+    }
+
+    // The flag is shared, the writer may set it after the caller stopped waiting on a stop
+    auto pFlushed = std::make_shared<std::atomic<bool>>(false);
+    record.pFlushed = pFlushed;
+
+    if (!pushWaiting(record))
+    {
+        log(levelName(level), msg, file, line, func, std::cout);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(m_flushMutex);
+    m_flushCondition.wait(lock, [&]()
+                          { return pFlushed->load(); });
+}
+
+/**
+ * @brief Pushes a record somebody waits for, regardless of the overflow policy
+ * @details The record is flushed either by the writer thread or by writeLate(), which stopWriter() only
+ *          calls once no producer can push anymore.
+ * @param record The record with pFlushed set
+ * @return True if the record has been queued, False if the writer stopped
+ */
+bool Logger::pushWaiting(LogRecord &record)
+{
+    m_activeProducers.fetch_add(1, std::memory_order_seq_cst);
+
+    bool queued = false;
+    while (m_writerRunning.load(std::memory_order_seq_cst) && !(queued = m_pQueue->TryPush(record)))
+        std::this_thread::yield();
+
+    m_activeProducers.fetch_sub(1, std::memory_order_release);
+    return queued;
+}
+
+/**
+ * @brief Stops the writer thread after it has written all queued records
+ */
+void Logger::stopWriter()
+{
+    if (!m_async.exchange(false))
+        return;
+
+    m_writerRunning.store(false, std::memory_order_seq_cst);
+
+    if (m_writerThread.joinable())
+        m_writerThread.join();
+
+    // Producers which saw the writer running may still push, a blocking push needs the queue drained
+    while (m_activeProducers.load(std::memory_order_acquire) > 0)
+    {
+        writeLate();
+        std::this_thread::yield();
+    }
+    writeLate();
+}
+
+/**
+ * @brief Writes the records queued after the last pass of the writer thread and releases their waiters
+ * @details Producers may still push a record between the last pass and the join.
+ */
+void Logger::writeLate()
+{
+    std::vector<LogRecord> batch(WRITE_BATCH);
+    std::vector<std::shared_ptr<std::atomic<bool>>> waiting;
+    std::size_t count;
+    while ((count = m_pQueue->PopBatch(batch)) > 0)
+    {
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (batch[i].pFlushed)
+                waiting.push_back(std::move(batch[i].pFlushed));
+            if (batch[i].file)
+                log(levelName(batch[i].level), batch[i].message, batch[i].file, batch[i].line, batch[i].func, std::cout);
+        }
+    }
+
+    if (waiting.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_fileStream.flush();
+        std::cout.flush();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_flushMutex);
+        for (const std::shared_ptr<std::atomic<bool>> &pFlushed : waiting)
+            pFlushed->store(true);
+    }
+    m_flushCondition.notify_all();
+}
+
+/**
+ * @brief Writer thread of the asynchronous mode
+ * @details Formats the queued records into one buffer per batch and writes it with a single call per stream.
+ */
+void Logger::runWriter()
+{
+    std::vector<LogRecord> batch(WRITE_BATCH);
+    std::vector<std::shared_ptr<std::atomic<bool>>> waiting;
+    std::string fileBuffer;
+    std::string consoleBuffer;
+    TimestampCache timestamp;
+    auto lastFlush = std::chrono::steady_clock::now();
+
+    while (true)
+    {
+        // Read the flag first, so everything queued before the stop is written by the last pass
+        const bool running = m_writerRunning.load(std::memory_order_acquire);
+        const bool console = m_consoleOutput.load(std::memory_order_relaxed);
+
+        std::size_t count;
+        while ((count = m_pQueue->PopBatch(batch)) > 0)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                const LogRecord &record = batch[i];
+
+                if (record.pFlushed)
+                    waiting.push_back(record.pFlushed);
+                if (!record.file)
+                    continue;
+
+                const std::size_t lineStart = fileBuffer.size();
+                fileBuffer += timestamp.Format(std::chrono::system_clock::to_time_t(record.time));
+                fileBuffer += '|';
+                fileBuffer += levelName(record.level);
+                fileBuffer += '|';
+                fileBuffer += fileName(record.file);
+                fileBuffer += ':';
+                fileBuffer += std::to_string(record.line);
+                fileBuffer += '|';
+                fileBuffer += record.func;
+                fileBuffer += '|';
+                fileBuffer += record.message;
+
+                if (console)
+                {
+                    const char *pColor = levelColor(record.level);
+                    if (pColor)
+                        consoleBuffer += pColor;
+                    consoleBuffer.append(fileBuffer, lineStart, std::string::npos);
+                    if (pColor)
+                        consoleBuffer += "\033[0m";
+                    consoleBuffer += '\n';
+                }
+
+                fileBuffer += '\n';
+            }
+
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_fileStream.write(fileBuffer.data(), static_cast<std::streamsize>(fileBuffer.size()));
+            if (console)
+                std::cout.write(consoleBuffer.data(), static_cast<std::streamsize>(consoleBuffer.size()));
+            fileBuffer.clear();
+            consoleBuffer.clear();
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (!waiting.empty() || !running || now - lastFlush >= m_flushInterval)
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            m_fileStream.flush();
+            std::cout.flush();
+            lastFlush = now;
+        }
+
+        if (!waiting.empty())
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_flushMutex);
+                for (const std::shared_ptr<std::atomic<bool>> &pFlushed : waiting)
+                    pFlushed->store(true);
+            }
+            m_flushCondition.notify_all();
+            waiting.clear();
+        }
+
+        if (!running)
+            break;
+
+        m_pQueue->WaitForData(m_flushInterval);
+    }
 }
 
 // ============================================================================
@@ -79,6 +454,9 @@ void Logger::log(const std::string &type, const std::string &msg, const char *fi
     // Write log message to file stream
     m_fileStream << logMessage << std::endl;
 
+    if (!m_consoleOutput.load(std::memory_order_relaxed))
+        return;
+
     // Color terminal output and write message to terminal
     if (type.find("ERROR") != std::string::npos)
         stream << "\033[1;31m" << logMessage << "\033[0m" << std::endl;
@@ -102,7 +480,13 @@ void Logger::log(const std::string &type, const std::string &msg, const char *fi
  */
 void Logger::logError(const std::string &msg, const char *file, int line, const char *func)
 {
-    if (m_logLevel >= E_LogLevel::Error)
+    if (!IsEnabled(E_LogLevel::Error))
+        return;
+    m_messageCounters[static_cast<std::size_t>(E_LogLevel::Error)]->Inc();
+
+    if (m_async.load(std::memory_order_acquire))
+        enqueue(E_LogLevel::Error, msg, file, line, func);
+    else
         log("ERROR", msg, file, line, func, std::cout);
 }
 
@@ -115,7 +499,13 @@ void Logger::logError(const std::string &msg, const char *file, int line, const
  */
 void Logger::logWarning(const std::string &msg, const char *file, int line, const char *func)
 {
-    if (m_logLevel >= E_LogLevel::Warning)
+    if (!IsEnabled(E_LogLevel::Warning))
+        return;
+    m_messageCounters[static_cast<std::size_t>(E_LogLevel::Warning)]->Inc();
+
+    if (m_async.load(std::memory_order_acquire))
+        enqueue(E_LogLevel::Warning, msg, file, line, func);
+    else
         log("WARNING", msg, file, line, func, std::cout);
 }
 
@@ -128,7 +518,13 @@ void Logger::logWarning(const std::string &msg, const char *file, int line, cons
  */
 void Logger::logInfo(const std::string &msg, const char *file, int line, const char *func)
 {
-    if (m_logLevel >= E_LogLevel::Info)
+    if (!IsEnabled(E_LogLevel::Info))
+        return;
+    m_messageCounters[static_cast<std::size_t>(E_LogLevel::Info)]->Inc();
+
+    if (m_async.load(std::memory_order_acquire))
+        enqueue(E_LogLevel::Info, msg, file, line, func);
+    else
         log("INFO", msg, file, line, func, std::cout);
 }
 
@@ -141,6 +537,12 @@ void Logger::logInfo(const std::string &msg, const char *file, int line, const c
  */
 void Logger::logDebug(const std::string &msg, const char *file, int line, const char *func)
 {
-    if (m_logLevel >= E_LogLevel::Debug)
+    if (!IsEnabled(E_LogLevel::Debug))
+        return;
+    m_messageCounters[static_cast<std::size_t>(E_LogLevel::Debug)]->Inc();
+
+    if (m_async.load(std::memory_order_acquire))
+        enqueue(E_LogLevel::Debug, msg, file, line, func);
+    else
         log("DEBUG", msg, file, line, func, std::cout);
 }
@@ -0,0 +1,400 @@
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using namespace aerolab::Core;
+
+std::shared_ptr<MetricsRegistry> MetricsRegistry::s_instance = nullptr;
+std::once_flag MetricsRegistry::s_once{};
+
+namespace
+{
+    const char *typeName(E_MetricType type)
+    {
+        switch (type)
+        {
+        case E_MetricType::Counter:
+            return "counter";
+        case E_MetricType::Gauge:
+            return "gauge";
+        case E_MetricType::Histogram:
+        default:
+            return "histogram";
+        }
+    }
+
+    /// @brief Formats a sample value, short enough for the bucket bounds to read like 2.5e-06
+    std::string formatValue(double value)
+    {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+        return buffer;
+    }
+
+    /// @brief Builds the label set of a sample, e.g. {level="error",le="0.5"}
+    std::string labelSet(const std::string &labels, const std::string &extra = "")
+    {
+        if (labels.empty() && extra.empty())
+            return "";
+        if (labels.empty() || extra.empty())
+            return "{" + labels + extra + "}";
+        return "{" + labels + "," + extra + "}";
+    }
+}
+
+// ============================================================================
+// Histogram
+// ============================================================================
+
+/**
+ * @brief Constructor of the MetricHistogram
+ * @param upperBounds Inclusive upper bounds of the buckets in ascending order, at most METRIC_MAX_BUCKETS
+ * @param scale Factor converting the recorded values into the exported unit
+ * @throws std::invalid_argument if there are too many bounds
+ */
+MetricHistogram::MetricHistogram(std::vector<uint64_t> upperBounds, double scale)
+    : m_scale(scale),
+      m_pShards(std::make_unique<Shard[]>(METRIC_SHARDS))
+{
+    if (upperBounds.size() > METRIC_MAX_BUCKETS)
+        throw std::invalid_argument("Too many histogram buckets");
+
+    std::sort(upperBounds.begin(), upperBounds.end());
+    std::copy(upperBounds.begin(), upperBounds.end(), m_upperBounds.begin());
+    m_bucketCount = upperBounds.size();
+}
+
+/**
+ * @brief Default latency buckets from 1 us to 1 s in nanoseconds
+ */
+std::vector<uint64_t> MetricHistogram::LatencyBoundsNs()
+{
+    std::vector<uint64_t> bounds;
+    for (uint64_t decade = 1000; decade < 1000000000; decade *= 10)
+    {
+        bounds.push_back(decade);
+        bounds.push_back(decade * 5 / 2);
+        bounds.push_back(decade * 5);
+    }
+    bounds.push_back(1000000000);
+    return bounds;
+}
+
+/**
+ * @brief Sums the shards
+ * @details Shards are read one after another while values are recorded, the count and the buckets
+ *          may therefore differ by the values recorded meanwhile.
+ * @return Copy of the histogram in exported units
+ */
+HistogramSnapshot MetricHistogram::Snapshot() const
+{
+    HistogramSnapshot snapshot;
+    std::vector<uint64_t> counts(m_bucketCount + 1, 0);
+    uint64_t sum = 0;
+
+    for (std::size_t s = 0; s < METRIC_SHARDS; s++)
+    {
+        const Shard &shard = m_pShards[s];
+        for (std::size_t i = 0; i <= m_bucketCount; i++)
+            counts[i] += shard.counts[i].load(std::memory_order_relaxed);
+        sum += shard.sum.load(std::memory_order_relaxed);
+    }
+
+    uint64_t cumulative = 0;
+    for (std::size_t i = 0; i <= m_bucketCount; i++)
+    {
+        cumulative += counts[i];
+        snapshot.cumulativeCounts.push_back(cumulative);
+        if (i < m_bucketCount)
+            snapshot.bounds.push_back(static_cast<double>(m_upperBounds[i]) * m_scale);
+    }
+
+    snapshot.count = cumulative;
+    snapshot.sum = static_cast<double>(sum) * m_scale;
+    return snapshot;
+}
+
+/**
+ * @brief Estimates a quantile by linear interpolation inside the bucket, like histogram_quantile()
+ * @param q The quantile, 0 to 1
+ * @return The estimated value in exported units, the largest bound if it falls into the +Inf bucket
+ */
+double HistogramSnapshot::Quantile(double q) const
+{
+    if (count == 0 || cumulativeCounts.empty())
+        return 0.0;
+
+    const double rank = std::clamp(q, 0.0, 1.0) * static_cast<double>(count);
+    for (std::size_t i = 0; i < bounds.size(); i++)
+    {
+        if (static_cast<double>(cumulativeCounts[i]) < rank)
+            continue;
+
+        const double lower = i > 0 ? bounds[i - 1] : 0.0;
+        const double below = i > 0 ? static_cast<double>(cumulativeCounts[i - 1]) : 0.0;
+        const double inBucket = static_cast<double>(cumulativeCounts[i]) - below;
+        return inBucket > 0.0 ? lower + (bounds[i] - lower) * (rank - below) / inBucket : bounds[i];
+    }
+
+    return bounds.empty() ? 0.0 : bounds.back();
+}
+
+// ============================================================================
+// Registry
+// ============================================================================
+
+/**
+ * @brief Get the singleton instance
+ * @return Shared pointer to the singleton instance
+ */
+std::shared_ptr<MetricsRegistry> MetricsRegistry::GetInstance()
+{
+    std::call_once(s_once, []()
+                   { s_instance = std::shared_ptr<MetricsRegistry>(new MetricsRegistry()); });
+    return s_instance;
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    StopExport();
+}
+
+/**
+ * @brief Returns the counter with the given name and labels, creating it on the first call
+ * @param name Name of the metric, e.g. aerolab_input_datagrams_total
+ * @param help Description of the metric
+ * @param labels Labels in the Prometheus form, e.g. port="5005"
+ * @return The counter, valid for the lifetime of the registry
+ * @throws std::logic_error if the name is registered with another type
+ */
+MetricCounter &MetricsRegistry::GetCounter(const std::string &name, const std::string &help, const std::string &labels)
+{
+    return *getOrAdd(name, help, labels, E_MetricType::Counter).pCounter;
+}
+
+/**
+ * @brief Returns the gauge with the given name and labels, creating it on the first call
+ * @param name Name of the metric
+ * @param help Description of the metric
+ * @param labels Labels in the Prometheus form
+ * @return The gauge, valid for the lifetime of the registry
+ * @throws std::logic_error if the name is registered with another type
+ */
+MetricGauge &MetricsRegistry::GetGauge(const std::string &name, const std::string &help, const std::string &labels)
+{
+    return *getOrAdd(name, help, labels, E_MetricType::Gauge).pGauge;
+}
+
+/**
+ * @brief Returns the histogram with the given name and labels, creating it on the first call
+ * @param name Name of the metric, e.g. aerolab_input_callback_seconds
+ * @param help Description of the metric
+ * @param labels Labels in the Prometheus form
+ * @param upperBounds Bucket bounds in recorded units, only used when the histogram is created
+ * @param scale Factor converting recorded values into the exported unit, only used when the histogram is created
+ * @return The histogram, valid for the lifetime of the registry
+ * @throws std::logic_error if the name is registered with another type
+ */
+MetricHistogram &MetricsRegistry::GetHistogram(const std::string &name, const std::string &help, const std::string &labels,
+                                               std::vector<uint64_t> upperBounds, double scale)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto it = m_entries.find({name, labels});
+    if (it == m_entries.end())
+    {
+        Entry entry{name, labels, help, E_MetricType::Histogram, nullptr, nullptr, std::make_unique<MetricHistogram>(std::move(upperBounds), scale)};
+        it = m_entries.emplace(std::make_pair(name, labels), std::move(entry)).first;
+    }
+    else if (it->second.type != E_MetricType::Histogram)
+    {
+        throw std::logic_error("Metric " + name + " is registered with another type");
+    }
+
+    return *it->second.pHistogram;
+}
+
+MetricsRegistry::Entry &MetricsRegistry::getOrAdd(const std::string &name, const std::string &help, const std::string &labels, E_MetricType type)
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    auto it = m_entries.find({name, labels});
+    if (it != m_entries.end())
+    {
+        if (it->second.type != type)
+            throw std::logic_error("Metric " + name + " is registered with another type");
+        return it->second;
+    }
+
+    Entry entry{name, labels, help, type, nullptr, nullptr, nullptr};
+    if (type == E_MetricType::Counter)
+        entry.pCounter = std::make_unique<MetricCounter>();
+    else
+        entry.pGauge = std::make_unique<MetricGauge>();
+
+    return m_entries.emplace(std::make_pair(name, labels), std::move(entry)).first->second;
+}
+
+/**
+ * @brief Copies the current values of all metrics
+ * @return The metrics sorted by name and labels
+ */
+std::vector<MetricSnapshot> MetricsRegistry::Snapshot() const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    std::vector<MetricSnapshot> snapshots;
+    snapshots.reserve(m_entries.size());
+    for (const auto &[key, entry] : m_entries)
+    {
+        MetricSnapshot snapshot;
+        snapshot.name = entry.name;
+        snapshot.labels = entry.labels;
+        snapshot.help = entry.help;
+        snapshot.type = entry.type;
+
+        switch (entry.type)
+        {
+        case E_MetricType::Counter:
+            snapshot.value = static_cast<double>(entry.pCounter->Value());
+            break;
+        case E_MetricType::Gauge:
+            snapshot.value = static_cast<double>(entry.pGauge->Value());
+            break;
+        case E_MetricType::Histogram:
+            snapshot.histogram = entry.pHistogram->Snapshot();
+            snapshot.value = static_cast<double>(snapshot.histogram.count);
+            break;
+        }
+
+        snapshots.push_back(std::move(snapshot));
+    }
+
+    return snapshots;
+}
+
+/**
+ * @brief Formats all metrics in the Prometheus text exposition format
+ * @return The metrics, one HELP and TYPE line per name
+ */
+std::string MetricsRegistry::FormatPrometheus() const
+{
+    std::ostringstream stream;
+    std::string previousName;
+
+    for (const auto &metric : Snapshot())
+    {
+        if (metric.name != previousName)
+        {
+            stream << "# HELP " << metric.name << ' ' << metric.help << '\n';
+            stream << "# TYPE " << metric.name << ' ' << typeName(metric.type) << '\n';
+            previousName = metric.name;
+        }
+
+        if (metric.type != E_MetricType::Histogram)
+        {
+            stream << metric.name << labelSet(metric.labels) << ' ' << formatValue(metric.value) << '\n';
+            continue;
+        }
+
+        const auto &histogram = metric.histogram;
+        for (std::size_t i = 0; i < histogram.cumulativeCounts.size(); i++)
+        {
+            const std::string bound = i < histogram.bounds.size() ? formatValue(histogram.bounds[i]) : "+Inf";
+            stream << metric.name << "_bucket" << labelSet(metric.labels, "le=\"" + bound + "\"") << ' ' << histogram.cumulativeCounts[i] << '\n';
+        }
+        stream << metric.name << "_sum" << labelSet(metric.labels) << ' ' << formatValue(histogram.sum) << '\n';
+        stream << metric.name << "_count" << labelSet(metric.labels) << ' ' << histogram.count << '\n';
+    }
+
+    return stream.str();
+}
+
+/**
+ * @brief Writes all metrics in the Prometheus text format
+ * @details The file is replaced atomically, so a scraper never reads a partial file.
+ * @param filePath Path of the file
+ * @return True on success
+ */
+bool MetricsRegistry::WritePrometheus(const std::string &filePath) const
+{
+    const std::string tempPath = filePath + ".tmp";
+    {
+        std::ofstream fileStream(tempPath, std::ios::trunc);
+        if (!fileStream.is_open())
+            return false;
+
+        fileStream << FormatPrometheus();
+        if (!fileStream)
+            return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, filePath, error);
+    return !error;
+}
+
+// ============================================================================
+// Export
+// ============================================================================
+
+/**
+ * @brief Starts writing the metrics to a file periodically
+ * @details A running export is stopped first.
+ * @param filePath Path of the file, see WritePrometheus()
+ * @param interval Time between two writes
+ */
+void MetricsRegistry::StartExport(const std::string &filePath, std::chrono::milliseconds interval)
+{
+    StopExport();
+
+    {
+        std::lock_guard<std::mutex> guard(m_exportMutex);
+        m_exporting = true;
+    }
+    m_exportThread = std::thread(&MetricsRegistry::runExport, this, filePath, interval);
+}
+
+/**
+ * @brief Stops the periodic export after writing the file a last time
+ */
+void MetricsRegistry::StopExport()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_exportMutex);
+        m_exporting = false;
+    }
+    m_exportCondition.notify_all();
+
+    if (m_exportThread.joinable())
+        m_exportThread.join();
+}
+
+void MetricsRegistry::runExport(std::string filePath, std::chrono::milliseconds interval)
+{
+    std::unique_lock<std::mutex> lock(m_exportMutex);
+    bool reportedError = false;
+
+    while (true)
+    {
+        const bool stopping = m_exportCondition.wait_for(lock, interval, [this]()
+                                                         { return !m_exporting; });
+        lock.unlock();
+
+        // The registry can not log, the logger itself is instrumented, report on stderr once
+        if (!WritePrometheus(filePath) && !reportedError)
+        {
+            std::fprintf(stderr, "Could not write metrics to %s\n", filePath.c_str());
+            reportedError = true;
+        }
+
+        if (stopping)
+            return;
+        lock.lock();
+    }
+}
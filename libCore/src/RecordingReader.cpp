@@ -0,0 +1,250 @@
+#include "RecordingReader.h"
+
+#include "Logger.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace aerolab::Core;
+
+/// Read-only mapping of the whole file
+struct RecordingReader::Mapping
+{
+    boost::interprocess::file_mapping file;
+    boost::interprocess::mapped_region region;
+};
+
+/**
+ * @brief Constructor of the RecordingReader
+ * @details Chunks are counted up to the first chunk without records or with an invalid header, so a
+ *          recording of a crashed or still running recorder can be read as well.
+ * @param filePath Path of the recording file
+ * @throws std::runtime_error If the file can not be mapped or is no recording
+ */
+RecordingReader::RecordingReader(const std::string &filePath) : m_pMapping(std::make_unique<Mapping>())
+{
+    try
+    {
+        m_pMapping->file = boost::interprocess::file_mapping(filePath.c_str(), boost::interprocess::read_only);
+        m_pMapping->region = boost::interprocess::mapped_region(m_pMapping->file, boost::interprocess::read_only);
+    }
+    catch (const boost::interprocess::interprocess_exception &e)
+    {
+        throw std::runtime_error("Could not map recording " + filePath + ": " + e.what());
+    }
+
+    m_pBase = static_cast<const uint8_t *>(m_pMapping->region.get_address());
+    const std::size_t fileSize = m_pMapping->region.get_size();
+
+    RecordingFileHeader header;
+    if (fileSize < sizeof(header))
+        throw std::runtime_error("Recording " + filePath + " is too short");
+    std::memcpy(&header, m_pBase, sizeof(header));
+
+    if (std::memcmp(header.magic, RECORDING_MAGIC, sizeof(header.magic)) != 0 || header.version != RECORDING_VERSION ||
+        header.chunkSize < sizeof(RecordingChunkHeader))
+        throw std::runtime_error(filePath + " is no recording");
+
+    m_chunkSize = header.chunkSize;
+
+    // A chunk torn by a crash may claim more records or index entries than fit into it
+    const std::size_t chunks = (fileSize - sizeof(RecordingFileHeader)) / m_chunkSize;
+    while (m_chunkCount < chunks)
+    {
+        const RecordingChunkHeader &chunk = chunkHeader(m_chunkCount);
+        if (chunk.magic != RECORDING_CHUNK_MAGIC || chunk.recordCount == 0)
+            break;
+        if (sizeof(RecordingChunkHeader) + static_cast<uint64_t>(chunk.dataBytes) + static_cast<uint64_t>(chunk.indexCount) * sizeof(RecordingIndexEntry) >
+            m_chunkSize)
+        {
+            LOG_WARNING("Recording " + filePath + " ends with an invalid chunk " + std::to_string(m_chunkCount));
+            break;
+        }
+        m_recordCount += chunk.recordCount;
+        m_chunkCount++;
+    }
+}
+
+RecordingReader::~RecordingReader() = default;
+
+int64_t RecordingReader::FirstTimestamp() const
+{
+    return m_chunkCount > 0 ? chunkHeader(0).firstTimestampNs : 0;
+}
+
+int64_t RecordingReader::LastTimestamp() const
+{
+    return m_chunkCount > 0 ? chunkHeader(m_chunkCount - 1).lastTimestampNs : 0;
+}
+
+/**
+ * @brief Reads the next datagram
+ * @details A record reaching beyond the data of its chunk, e.g. torn by a crash, ends the recording.
+ * @param datagram Receives the datagram, the payload points into the mapped file
+ * @return False at the end of the recording
+ */
+bool RecordingReader::Next(RecordedDatagram &datagram)
+{
+    while (m_chunk < m_chunkCount && m_record >= chunkRecords(m_chunk))
+    {
+        m_chunk++;
+        m_record = 0;
+        m_offset = sizeof(RecordingChunkHeader);
+    }
+
+    if (m_chunk >= m_chunkCount)
+        return false;
+
+    const std::size_t dataEnd = sizeof(RecordingChunkHeader) + chunkHeader(m_chunk).dataBytes;
+    if (m_offset < sizeof(RecordingChunkHeader) || m_offset + sizeof(RecordingRecordHeader) > dataEnd)
+        return stopInvalid();
+
+    const uint8_t *pRecord = m_pBase + sizeof(RecordingFileHeader) + m_chunk * m_chunkSize + m_offset;
+
+    RecordingRecordHeader record;
+    std::memcpy(&record, pRecord, sizeof(record));
+    if (m_offset + RecordingRecordSize(record.length) > dataEnd)
+        return stopInvalid();
+
+    datagram.timestampNs = record.timestampNs;
+    datagram.payload = std::span<const uint8_t>(pRecord + sizeof(record), record.length);
+
+    if (record.addressFamily == 6)
+    {
+        boost::asio::ip::address_v6::bytes_type bytes;
+        std::memcpy(bytes.data(), record.address, bytes.size());
+        datagram.sender = boost::asio::ip::udp::endpoint(boost::asio::ip::address_v6(bytes), record.port);
+    }
+    else
+    {
+        boost::asio::ip::address_v4::bytes_type bytes;
+        std::memcpy(bytes.data(), record.address, bytes.size());
+        datagram.sender = boost::asio::ip::udp::endpoint(boost::asio::ip::address_v4(bytes), record.port);
+    }
+
+    m_offset += RecordingRecordSize(record.length);
+    m_record++;
+    return true;
+}
+
+/**
+ * @brief Positions the reader on the first record with a timestamp of at least timestampNs
+ * @details Binary search over the chunk headers and the chunk index, then a linear scan over
+ *          at most RECORDING_INDEX_INTERVAL records.
+ * @param timestampNs Timestamp in nanoseconds since epoch
+ */
+void RecordingReader::Seek(int64_t timestampNs)
+{
+    Rewind();
+
+    // First chunk which reaches the timestamp
+    std::size_t low = 0;
+    std::size_t high = m_chunkCount;
+    while (low < high)
+    {
+        const std::size_t middle = (low + high) / 2;
+        if (chunkHeader(middle).lastTimestampNs < timestampNs)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    m_chunk = low;
+    if (m_chunk >= m_chunkCount)
+        return;
+
+    // Last index entry before the timestamp, the index holds the running maximum of the timestamps
+    const uint32_t indexCount = chunkHeader(m_chunk).indexCount;
+    uint32_t first = 0;
+    uint32_t last = indexCount;
+    while (first < last)
+    {
+        const uint32_t middle = (first + last) / 2;
+        if (indexEntry(m_chunk, middle).timestampNs < timestampNs)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    // An invalid entry is skipped, the scan then starts at the chunk start
+    if (first > 0)
+    {
+        const RecordingIndexEntry &entry = indexEntry(m_chunk, first - 1);
+        const RecordingChunkHeader &chunk = chunkHeader(m_chunk);
+        if (entry.recordIndex < chunkRecords(m_chunk) && entry.offset >= sizeof(RecordingChunkHeader) &&
+            entry.offset < sizeof(RecordingChunkHeader) + static_cast<std::size_t>(chunk.dataBytes))
+        {
+            m_record = entry.recordIndex;
+            m_offset = entry.offset;
+        }
+    }
+
+    // Step forward to the first matching record
+    RecordedDatagram datagram;
+    while (true)
+    {
+        const std::size_t chunkBefore = m_chunk;
+        const uint32_t recordBefore = m_record;
+        const std::size_t offsetBefore = m_offset;
+
+        if (!Next(datagram))
+            return;
+
+        if (datagram.timestampNs >= timestampNs)
+        {
+            m_chunk = chunkBefore;
+            m_record = recordBefore;
+            m_offset = offsetBefore;
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Positions the reader on the first record
+ */
+void RecordingReader::Rewind()
+{
+    m_chunk = 0;
+    m_record = 0;
+    m_offset = sizeof(RecordingChunkHeader);
+}
+
+/**
+ * @brief Ends the recording at an invalid record
+ * @return False, the result of Next()
+ */
+bool RecordingReader::stopInvalid()
+{
+    LOG_WARNING("Recording ends with an invalid record " + std::to_string(m_record) + " in chunk " + std::to_string(m_chunk));
+
+    // The records before stay readable, the chunk is kept if it has some
+    for (std::size_t chunk = m_chunk; chunk < m_chunkCount; chunk++)
+        m_recordCount -= chunkRecords(chunk);
+    m_recordCount += m_record;
+    m_chunkCount = m_record > 0 ? m_chunk + 1 : m_chunk;
+    m_lastChunkRecords = m_record > 0 ? m_record : UINT32_MAX;
+    return false;
+}
+
+/// @brief Number of readable records of a chunk, the last chunk may end early at an invalid record
+uint32_t RecordingReader::chunkRecords(std::size_t chunk) const
+{
+    const uint32_t count = chunkHeader(chunk).recordCount;
+    return chunk + 1 == m_chunkCount ? std::min(count, m_lastChunkRecords) : count;
+}
+
+const RecordingChunkHeader &RecordingReader::chunkHeader(std::size_t chunk) const
+{
+    return *reinterpret_cast<const RecordingChunkHeader *>(m_pBase + sizeof(RecordingFileHeader) + chunk * m_chunkSize);
+}
+
+const RecordingIndexEntry &RecordingReader::indexEntry(std::size_t chunk, uint32_t entry) const
+{
+    return *reinterpret_cast<const RecordingIndexEntry *>(m_pBase + sizeof(RecordingFileHeader) + (chunk + 1) * m_chunkSize -
+                                                         (entry + 1) * sizeof(RecordingIndexEntry));
+}
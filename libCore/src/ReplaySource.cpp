@@ -0,0 +1,237 @@
+#include "ReplaySource.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+using namespace aerolab::Core;
+
+namespace
+{
+    uint64_t elapsedNs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    void appendLatency(std::ostringstream &stream, const std::string &name, const LatencyHistogram &histogram)
+    {
+        stream << "\n  " << std::left << std::setw(18) << name << std::right
+               << " mean " << std::setw(9) << histogram.Mean() / 1000.0
+               << " us  p50 " << std::setw(9) << static_cast<double>(histogram.Percentile(50.0)) / 1000.0
+               << " us  p99 " << std::setw(9) << static_cast<double>(histogram.Percentile(99.0)) / 1000.0
+               << " us  p99.9 " << std::setw(9) << static_cast<double>(histogram.Percentile(99.9)) / 1000.0
+               << " us  max " << std::setw(9) << static_cast<double>(histogram.Max()) / 1000.0 << " us";
+    }
+}
+
+/**
+ * @brief Formats the statistics for the log
+ * @return Throughput and latency percentiles of all stages
+ */
+std::string ReplayStats::Report() const
+{
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(2);
+    stream << "Replayed " << datagrams << " datagrams (" << bytes << " bytes) in " << elapsedSeconds << " s, "
+           << PacketsPerSecond() << " packets/s";
+
+    appendLatency(stream, "read", readLatency);
+    for (const auto &stage : stages)
+        appendLatency(stream, stage.name, stage.latency);
+    if (lateness.Count() > 0)
+        appendLatency(stream, "lateness", lateness);
+
+    return stream.str();
+}
+
+/**
+ * @brief Constructor of the ReplaySource
+ * @param filePath Path of the recording
+ * @throws std::runtime_error If the file is no recording
+ */
+ReplaySource::ReplaySource(const std::string &filePath)
+    : m_reader(filePath),
+      m_pDatagramPool(std::make_shared<DatagramPool>())
+{
+    LOG_INFO("Loaded recording " + filePath + " with " + std::to_string(m_reader.RecordCount()) + " datagrams");
+}
+
+ReplaySource::~ReplaySource()
+{
+    Stop();
+}
+
+void ReplaySource::SetCallback(std::function<void(const std::vector<uint8_t> &datagram)> callback)
+{
+    AddStage("vector callback",
+             [this, callback = std::move(callback)](const Datagram &datagram)
+             {
+                 m_receivedData.assign(datagram.Data(), datagram.Data() + datagram.Size());
+                 callback(m_receivedData);
+             });
+}
+
+/**
+ * @brief Adds a stage called for every replayed datagram
+ * @details Stages are called in the order they were added, the time spent in every stage is measured
+ *          separately. A stage with an already used name replaces the existing one.
+ *          Has to be called before Start() or Run().
+ * @param name Name of the stage in the statistics
+ * @param stage The callback function
+ */
+void ReplaySource::AddStage(const std::string &name, DatagramCallback stage)
+{
+    auto it = std::find_if(m_stages.begin(), m_stages.end(), [&name](const Stage &existing)
+                           { return existing.name == name; });
+    if (it != m_stages.end())
+        it->callback = std::move(stage);
+    else
+        m_stages.push_back({name, std::move(stage)});
+}
+
+/**
+ * @brief Replays the recording on the calling thread
+ * @return Statistics of the run
+ */
+ReplayStats ReplaySource::Run()
+{
+    if (m_running)
+    {
+        LOG_WARNING("Replay is already running");
+        return {};
+    }
+
+    // Join the thread of a finished Start()
+    if (m_thread.joinable())
+        m_thread.join();
+
+    m_running = true;
+    return replay();
+}
+
+/**
+ * @brief Starts the replay on its own thread
+ */
+void ReplaySource::Start()
+{
+    if (m_running)
+        return;
+
+    if (m_thread.joinable())
+        m_thread.join();
+
+    m_running = true;
+    m_thread = std::thread([this]()
+                           { replay(); });
+}
+
+/**
+ * @brief Stops the replay and waits for the replay thread
+ */
+void ReplaySource::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_stopCondition.notify_all();
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+// ============================================================================
+// Replay
+// ============================================================================
+
+ReplayStats ReplaySource::replay()
+{
+    ReplayStats stats;
+    for (const auto &stage : m_stages)
+        stats.stages.push_back({stage.name, {}});
+
+    if (m_startTimeNs > 0)
+        m_reader.Seek(m_startTimeNs);
+    else
+        m_reader.Rewind();
+
+    m_delivered = 0;
+
+    const bool paced = m_mode != E_ReplayMode::AsFastAsPossible;
+    const double speed = m_mode == E_ReplayMode::Scaled ? m_speed : 1.0;
+
+    const auto start = std::chrono::steady_clock::now();
+    int64_t firstTimestampNs = 0;
+    RecordedDatagram record;
+
+    while (m_running.load(std::memory_order_relaxed))
+    {
+        const auto readStart = std::chrono::steady_clock::now();
+
+        if (!m_reader.Next(record))
+            break;
+
+        Datagram datagram = m_pDatagramPool->Acquire();
+        const std::size_t size = std::min(record.payload.size(), MAX_DATAGRAM_SIZE);
+        std::memcpy(datagram.MutableBuffer().data(), record.payload.data(), size);
+        datagram.SetSize(size);
+        datagram.MutableSender() = record.sender;
+        datagram.SetTimestamp(std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(record.timestampNs))));
+
+        auto stageStart = std::chrono::steady_clock::now();
+        stats.readLatency.Record(elapsedNs(readStart, stageStart));
+
+        if (paced)
+        {
+            if (stats.datagrams == 0)
+                firstTimestampNs = record.timestampNs;
+
+            // Out of order timestamps of sharded recordings are delivered right away
+            const auto offset = std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(record.timestampNs - firstTimestampNs) / speed));
+            const auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(offset);
+            if (deadline > stageStart)
+            {
+                if (!waitUntil(deadline))
+                    break;
+                stageStart = std::chrono::steady_clock::now();
+            }
+            stats.lateness.Record(elapsedNs(std::min(deadline, stageStart), stageStart));
+        }
+
+        for (std::size_t i = 0; i < m_stages.size(); i++)
+        {
+            m_stages[i].callback(datagram);
+
+            const auto stageEnd = std::chrono::steady_clock::now();
+            stats.stages[i].latency.Record(elapsedNs(stageStart, stageEnd));
+            stageStart = stageEnd;
+        }
+
+        stats.datagrams++;
+        stats.bytes += size;
+        m_delivered.store(stats.datagrams, std::memory_order_relaxed);
+    }
+
+    stats.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    m_running = false;
+
+    LOG_INFO(stats.Report());
+
+    m_stats = stats;
+    return stats;
+}
+
+/**
+ * @brief Sleeps until the deadline or until the replay is stopped
+ * @param deadline Time to wake up
+ * @return False if the replay was stopped
+ */
+bool ReplaySource::waitUntil(std::chrono::steady_clock::time_point deadline)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return !m_stopCondition.wait_until(lock, deadline, [this]()
+                                       { return !m_running.load(std::memory_order_relaxed); });
+}
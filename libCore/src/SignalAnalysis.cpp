@@ -0,0 +1,411 @@
+#include "SignalAnalysis.h"
+
+#include "Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Samples read from a channel per call
+    constexpr std::size_t READ_CHUNK = 1024;
+}
+
+// ==== Fft ====
+
+/**
+ * @brief Constructor
+ * @param size Length of the transform, a power of two
+ * @param kernels Kernels running the stages
+ */
+Fft::Fft(std::size_t size, const SignalKernels &kernels)
+    : m_size(size), m_kernels(kernels)
+{
+    if (size < 2 || (size & (size - 1)) != 0)
+        throw std::invalid_argument("FFT size " + std::to_string(size) + " is no power of two");
+
+    std::size_t bits = 0;
+    while ((std::size_t{1} << bits) < size)
+        bits++;
+
+    for (std::size_t i = 0; i < size; i++)
+    {
+        std::size_t reversed = 0;
+        for (std::size_t bit = 0; bit < bits; bit++)
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        if (i < reversed)
+            m_swaps.emplace_back(static_cast<uint32_t>(i), static_cast<uint32_t>(reversed));
+    }
+
+    // Stage with butterfly distance half uses the factors exp(-2 pi i j / (2 half)), j < half
+    m_twiddleRe.reserve(size - 1);
+    m_twiddleIm.reserve(size - 1);
+    for (std::size_t half = 1; half < size; half *= 2)
+    {
+        for (std::size_t j = 0; j < half; j++)
+        {
+            const double angle = -std::numbers::pi * static_cast<double>(j) / static_cast<double>(half);
+            m_twiddleRe.push_back(static_cast<float>(std::cos(angle)));
+            m_twiddleIm.push_back(static_cast<float>(std::sin(angle)));
+        }
+    }
+}
+
+/**
+ * @brief Transforms the data in place
+ * @param re Real parts, Size() values
+ * @param im Imaginary parts, Size() values
+ */
+void Fft::Transform(std::span<float> re, std::span<float> im) const
+{
+    for (const auto &[first, second] : m_swaps)
+    {
+        std::swap(re[first], re[second]);
+        std::swap(im[first], im[second]);
+    }
+
+    std::size_t offset = 0;
+    for (std::size_t half = 1; half < m_size; half *= 2)
+    {
+        m_kernels.butterflies(re.data(), im.data(), m_twiddleRe.data() + offset, m_twiddleIm.data() + offset, m_size, half);
+        offset += half;
+    }
+}
+
+// ==== RollingStats ====
+
+/**
+ * @brief Constructor
+ * @param window Number of samples, rounded down to whole blocks
+ * @param kernels Kernels summarizing the blocks
+ */
+RollingStats::RollingStats(std::size_t window, const SignalKernels &kernels)
+    : m_kernels(kernels), m_blocks(std::max<std::size_t>(window / BLOCK_SIZE, 1))
+{
+    m_partial.reserve(BLOCK_SIZE);
+}
+
+/**
+ * @brief Adds samples to the window
+ */
+void RollingStats::Append(std::span<const float> values)
+{
+    while (!values.empty())
+    {
+        const float *pBlock = values.data();
+        std::size_t taken = BLOCK_SIZE;
+
+        // Whole blocks are summarized in place, only the remainders are copied
+        if (!m_partial.empty() || values.size() < BLOCK_SIZE)
+        {
+            taken = std::min(BLOCK_SIZE - m_partial.size(), values.size());
+            m_partial.insert(m_partial.end(), values.begin(), values.begin() + static_cast<std::ptrdiff_t>(taken));
+            values = values.subspan(taken);
+            if (m_partial.size() < BLOCK_SIZE)
+                return;
+            pBlock = m_partial.data();
+        }
+        else
+        {
+            values = values.subspan(BLOCK_SIZE);
+        }
+
+        m_kernels.blockStats(pBlock, BLOCK_SIZE, m_blocks[m_nextBlock]);
+        m_nextBlock = (m_nextBlock + 1) % m_blocks.size();
+        m_blockCount = std::min(m_blockCount + 1, m_blocks.size());
+        m_partial.clear();
+    }
+}
+
+/**
+ * @brief Statistics of the complete blocks and the partial block
+ */
+RollingStatsResult RollingStats::Result() const
+{
+    BlockStats total;
+    for (std::size_t i = 0; i < m_blockCount; i++)
+        total.Merge(m_blocks[i]);
+    if (!m_partial.empty())
+    {
+        BlockStats partial;
+        m_kernels.blockStats(m_partial.data(), m_partial.size(), partial);
+        total.Merge(partial);
+    }
+
+    RollingStatsResult result;
+    if (total.count == 0)
+        return result;
+
+    const double count = static_cast<double>(total.count);
+    const double mean = total.sum / count;
+    const double meanSquare = total.sumSquares / count;
+    result.count = total.count;
+    result.mean = static_cast<float>(mean);
+    result.rms = static_cast<float>(std::sqrt(meanSquare));
+    result.variance = static_cast<float>(std::max(meanSquare - mean * mean, 0.0));
+    result.min = total.min;
+    result.max = total.max;
+    return result;
+}
+
+// ==== Spectrum ====
+
+/**
+ * @brief Constructor
+ * @param size Length of the transform, a power of two
+ * @param kernels Kernels of the window, the transform and the power
+ */
+Spectrum::Spectrum(std::size_t size, const SignalKernels &kernels)
+    : m_kernels(kernels), m_fft(size, kernels), m_window(size), m_values(size), m_timestamps(size), m_re(size), m_im(size),
+      m_power(size / 2 + 1)
+{
+    double windowPower = 0.0;
+    for (std::size_t i = 0; i < size; i++)
+    {
+        const double coefficient = 0.5 - 0.5 * std::cos(2.0 * std::numbers::pi * static_cast<double>(i) / static_cast<double>(size));
+        m_window[i] = static_cast<float>(coefficient);
+        windowPower += coefficient * coefficient;
+    }
+    m_windowPower = static_cast<float>(windowPower);
+}
+
+/**
+ * @brief Adds samples to the ring, only the latest Size() samples are kept
+ */
+void Spectrum::Append(std::span<const TelemetrySample> samples)
+{
+    const std::size_t size = m_values.size();
+    if (samples.size() > size)
+        samples = samples.last(size);
+
+    for (const TelemetrySample &sample : samples)
+    {
+        m_values[m_next] = static_cast<float>(sample.value);
+        m_timestamps[m_next] = sample.timestampNs;
+        m_next = (m_next + 1) & (size - 1);
+    }
+    m_count = std::min(m_count + samples.size(), size);
+}
+
+/**
+ * @brief Computes the spectrum of the latest samples
+ * @param averaging Weight of the new spectrum in the average, 1 replaces the previous spectra
+ * @param result Receives the averaged spectrum
+ * @return False if there are not enough samples or their timestamps give no sample rate
+ */
+bool Spectrum::Compute(float averaging, SpectrumResult &result)
+{
+    if (!Ready())
+        return false;
+
+    const std::size_t size = m_values.size();
+    const int64_t durationNs = m_timestamps[(m_next + size - 1) & (size - 1)] - m_timestamps[m_next];
+    if (durationNs <= 0)
+        return false;
+    const float sampleRate = static_cast<float>(static_cast<double>(size - 1) * 1e9 / static_cast<double>(durationNs));
+
+    // Oldest sample first, m_im is free until the transform
+    const auto split = m_values.begin() + static_cast<std::ptrdiff_t>(m_next);
+    std::copy(m_values.begin(), split, std::copy(split, m_values.end(), m_im.begin()));
+
+    BlockStats stats;
+    m_kernels.blockStats(m_im.data(), size, stats);
+    m_kernels.applyWindow(m_im.data(), m_window.data(), static_cast<float>(stats.sum / static_cast<double>(size)), m_re.data(), size);
+    std::fill(m_im.begin(), m_im.end(), 0.0f);
+    m_fft.Transform(m_re, m_im);
+
+    // One-sided density, the bins between 0 Hz and the Nyquist frequency also hold the negative frequencies
+    const std::size_t bins = m_power.size();
+    m_kernels.power(m_re.data(), m_im.data(), m_power.data(), bins, 1.0f / (sampleRate * m_windowPower));
+    for (std::size_t i = 1; i + 1 < bins; i++)
+        m_power[i] *= 2.0f;
+
+    if (m_average.size() != bins || averaging >= 1.0f)
+    {
+        m_average = m_power;
+    }
+    else
+    {
+        for (std::size_t i = 0; i < bins; i++)
+            m_average[i] += averaging * (m_power[i] - m_average[i]);
+    }
+
+    const auto peak = std::max_element(m_average.begin() + 1, m_average.end());
+    result.psd = m_average;
+    result.binWidth = sampleRate / static_cast<float>(size);
+    result.peakFrequency = static_cast<float>(peak - m_average.begin()) * result.binWidth;
+    result.peakDensity = *peak;
+    return true;
+}
+
+// ==== SignalAnalyzer ====
+
+/**
+ * @brief Constructor, selects the widest kernels of the CPU
+ * @param pStore Store of the analyzed channels
+ * @param options Settings
+ */
+SignalAnalyzer::SignalAnalyzer(std::shared_ptr<TelemetryStore> pStore, AnalysisOptions options)
+    : m_pStore(std::move(pStore)), m_options(options), m_kernels(BestSignalKernels()), m_samples(READ_CHUNK)
+{
+    m_values.reserve(READ_CHUNK);
+    LOG_INFO_F("Created SignalAnalyzer with {} kernels, window {}, FFT size {}", m_kernels.name, m_options.window, m_options.fftSize);
+}
+
+/**
+ * @brief Destructor, stops the thread
+ */
+SignalAnalyzer::~SignalAnalyzer()
+{
+    Stop();
+}
+
+/**
+ * @brief Adds a channel to the analysis, the channel is created if it does not exist yet
+ * @details The first update analyzes the samples the store already holds.
+ */
+void SignalAnalyzer::AddChannel(const std::string &name)
+{
+    std::lock_guard<std::mutex> guard(m_channelMutex);
+    for (const auto &pState : m_channels)
+    {
+        if (pState->pChannel->Name() == name)
+            return;
+    }
+
+    m_channels.push_back(std::make_unique<ChannelState>(m_pStore->GetOrAddChannel(name), m_options, m_kernels));
+    m_channels.back()->result.channel = name;
+
+    std::lock_guard<std::mutex> resultGuard(m_resultMutex);
+    m_results.push_back(m_channels.back()->result);
+}
+
+/**
+ * @brief Starts updating the results periodically
+ * @details A running thread is stopped first.
+ */
+void SignalAnalyzer::Start()
+{
+    Stop();
+
+    {
+        std::lock_guard<std::mutex> guard(m_runMutex);
+        m_running = true;
+    }
+    m_thread = std::thread(&SignalAnalyzer::run, this);
+}
+
+/**
+ * @brief Stops the periodic updates
+ */
+void SignalAnalyzer::Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_runMutex);
+        m_running = false;
+    }
+    m_runCondition.notify_all();
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+/**
+ * @brief Reads the new samples of all channels and publishes the results
+ * @details Called by the thread started with Start(), or directly when there is no thread.
+ */
+void SignalAnalyzer::Update()
+{
+    std::lock_guard<std::mutex> guard(m_channelMutex);
+
+    for (const auto &pState : m_channels)
+    {
+        bool received = false;
+        while (true)
+        {
+            const uint64_t position = pState->position;
+            const std::size_t count = pState->pChannel->ReadFrom(pState->position, m_samples);
+            if (pState->position == position)
+                break;
+            if (count == 0)
+                continue;
+
+            const std::span<const TelemetrySample> samples(m_samples.data(), count);
+            m_values.clear();
+            for (const TelemetrySample &sample : samples)
+                m_values.push_back(static_cast<float>(sample.value));
+
+            pState->stats.Append(m_values);
+            pState->spectrum.Append(samples);
+            received = true;
+        }
+
+        if (!received)
+            continue;
+
+        AnalysisResult &result = pState->result;
+        result.stats = pState->stats.Result();
+        if (pState->spectrum.Compute(m_options.averaging, result.spectrum))
+            result.sampleRate = result.spectrum.binWidth * static_cast<float>(m_options.fftSize);
+        result.updates++;
+    }
+
+    std::lock_guard<std::mutex> resultGuard(m_resultMutex);
+    for (std::size_t i = 0; i < m_channels.size(); i++)
+    {
+        if (m_results[i].updates != m_channels[i]->result.updates)
+            m_results[i] = m_channels[i]->result;
+    }
+}
+
+/**
+ * @brief Copies the latest result of a channel
+ * @return False if the channel is not analyzed
+ */
+bool SignalAnalyzer::GetResult(const std::string &name, AnalysisResult &result) const
+{
+    std::lock_guard<std::mutex> guard(m_resultMutex);
+    for (const AnalysisResult &candidate : m_results)
+    {
+        if (candidate.channel == name)
+        {
+            result = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Names of the analyzed channels in the order they were added
+ */
+std::vector<std::string> SignalAnalyzer::Channels() const
+{
+    std::lock_guard<std::mutex> guard(m_resultMutex);
+    std::vector<std::string> names;
+    names.reserve(m_results.size());
+    for (const AnalysisResult &result : m_results)
+        names.push_back(result.channel);
+    return names;
+}
+
+void SignalAnalyzer::run()
+{
+    std::unique_lock<std::mutex> lock(m_runMutex);
+
+    while (true)
+    {
+        if (m_runCondition.wait_for(lock, m_options.interval, [this]()
+                                    { return !m_running; }))
+            return;
+        lock.unlock();
+
+        Update();
+
+        lock.lock();
+    }
+}
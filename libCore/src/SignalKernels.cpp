@@ -0,0 +1,262 @@
+#include "SignalKernels.h"
+
+#include <initializer_list>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AEROLAB_HAS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+using namespace aerolab::Core;
+
+namespace aerolab::Core
+{
+    // Defined in SignalKernelsAvx2.cpp, the only file compiled with AVX2 enabled
+    const SignalKernels *Avx2SignalKernels();
+}
+
+namespace
+{
+    // ==== Scalar ====
+
+    void scalarBlockStats(const float *pData, std::size_t count, BlockStats &out)
+    {
+        out = BlockStats();
+        out.count = count;
+        float sum = 0.0f;
+        float sumSquares = 0.0f;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const float value = pData[i];
+            sum += value;
+            sumSquares += value * value;
+            out.min = value < out.min ? value : out.min;
+            out.max = value > out.max ? value : out.max;
+        }
+        out.sum = sum;
+        out.sumSquares = sumSquares;
+    }
+
+    void scalarApplyWindow(const float *pIn, const float *pWindow, float offset, float *pOut, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++)
+            pOut[i] = (pIn[i] - offset) * pWindow[i];
+    }
+
+    void scalarButterflies(float *pRe, float *pIm, const float *pTwiddleRe, const float *pTwiddleIm, std::size_t count, std::size_t half)
+    {
+        for (std::size_t base = 0; base < count; base += 2 * half)
+        {
+            float *pRe0 = pRe + base;
+            float *pIm0 = pIm + base;
+            float *pRe1 = pRe0 + half;
+            float *pIm1 = pIm0 + half;
+            for (std::size_t j = 0; j < half; j++)
+            {
+                const float re = pRe1[j] * pTwiddleRe[j] - pIm1[j] * pTwiddleIm[j];
+                const float im = pRe1[j] * pTwiddleIm[j] + pIm1[j] * pTwiddleRe[j];
+                pRe1[j] = pRe0[j] - re;
+                pIm1[j] = pIm0[j] - im;
+                pRe0[j] += re;
+                pIm0[j] += im;
+            }
+        }
+    }
+
+    void scalarPower(const float *pRe, const float *pIm, float *pOut, std::size_t count, float scale)
+    {
+        for (std::size_t i = 0; i < count; i++)
+            pOut[i] = (pRe[i] * pRe[i] + pIm[i] * pIm[i]) * scale;
+    }
+
+    const SignalKernels SCALAR_KERNELS{E_SimdLevel::Scalar, "scalar", &scalarBlockStats, &scalarApplyWindow, &scalarButterflies, &scalarPower};
+
+    // ==== SSE2 ====
+
+#ifdef AEROLAB_HAS_SSE2
+    /// @brief Sum of the four lanes
+    float sse2Sum(__m128 v)
+    {
+        v = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_cvtss_f32(v);
+    }
+
+    void sse2BlockStats(const float *pData, std::size_t count, BlockStats &out)
+    {
+        __m128 sum = _mm_setzero_ps();
+        __m128 sumSquares = _mm_setzero_ps();
+        __m128 min = _mm_set1_ps(std::numeric_limits<float>::infinity());
+        __m128 max = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 v = _mm_loadu_ps(pData + i);
+            sum = _mm_add_ps(sum, v);
+            sumSquares = _mm_add_ps(sumSquares, _mm_mul_ps(v, v));
+            min = _mm_min_ps(min, v);
+            max = _mm_max_ps(max, v);
+        }
+
+        alignas(16) float mins[4];
+        alignas(16) float maxs[4];
+        _mm_store_ps(mins, min);
+        _mm_store_ps(maxs, max);
+
+        BlockStats tail;
+        scalarBlockStats(pData + i, count - i, tail);
+        out.count = count;
+        out.sum = static_cast<double>(sse2Sum(sum)) + tail.sum;
+        out.sumSquares = static_cast<double>(sse2Sum(sumSquares)) + tail.sumSquares;
+        out.min = tail.min;
+        out.max = tail.max;
+        for (int lane = 0; lane < 4; lane++)
+        {
+            out.min = mins[lane] < out.min ? mins[lane] : out.min;
+            out.max = maxs[lane] > out.max ? maxs[lane] : out.max;
+        }
+    }
+
+    void sse2ApplyWindow(const float *pIn, const float *pWindow, float offset, float *pOut, std::size_t count)
+    {
+        const __m128 offsets = _mm_set1_ps(offset);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            _mm_storeu_ps(pOut + i, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pIn + i), offsets), _mm_loadu_ps(pWindow + i)));
+        scalarApplyWindow(pIn + i, pWindow + i, offset, pOut + i, count - i);
+    }
+
+    void sse2Butterflies(float *pRe, float *pIm, const float *pTwiddleRe, const float *pTwiddleIm, std::size_t count, std::size_t half)
+    {
+        // The first stages are too short for a full register
+        if (half < 4)
+        {
+            scalarButterflies(pRe, pIm, pTwiddleRe, pTwiddleIm, count, half);
+            return;
+        }
+
+        for (std::size_t base = 0; base < count; base += 2 * half)
+        {
+            float *pRe0 = pRe + base;
+            float *pIm0 = pIm + base;
+            float *pRe1 = pRe0 + half;
+            float *pIm1 = pIm0 + half;
+            for (std::size_t j = 0; j < half; j += 4)
+            {
+                const __m128 twiddleRe = _mm_loadu_ps(pTwiddleRe + j);
+                const __m128 twiddleIm = _mm_loadu_ps(pTwiddleIm + j);
+                const __m128 re1 = _mm_loadu_ps(pRe1 + j);
+                const __m128 im1 = _mm_loadu_ps(pIm1 + j);
+                const __m128 re = _mm_sub_ps(_mm_mul_ps(re1, twiddleRe), _mm_mul_ps(im1, twiddleIm));
+                const __m128 im = _mm_add_ps(_mm_mul_ps(re1, twiddleIm), _mm_mul_ps(im1, twiddleRe));
+                const __m128 re0 = _mm_loadu_ps(pRe0 + j);
+                const __m128 im0 = _mm_loadu_ps(pIm0 + j);
+                _mm_storeu_ps(pRe1 + j, _mm_sub_ps(re0, re));
+                _mm_storeu_ps(pIm1 + j, _mm_sub_ps(im0, im));
+                _mm_storeu_ps(pRe0 + j, _mm_add_ps(re0, re));
+                _mm_storeu_ps(pIm0 + j, _mm_add_ps(im0, im));
+            }
+        }
+    }
+
+    void sse2Power(const float *pRe, const float *pIm, float *pOut, std::size_t count, float scale)
+    {
+        const __m128 scales = _mm_set1_ps(scale);
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 re = _mm_loadu_ps(pRe + i);
+            const __m128 im = _mm_loadu_ps(pIm + i);
+            _mm_storeu_ps(pOut + i, _mm_mul_ps(_mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im)), scales));
+        }
+        scalarPower(pRe + i, pIm + i, pOut + i, count - i, scale);
+    }
+
+    const SignalKernels SSE2_KERNELS{E_SimdLevel::Sse2, "sse2", &sse2BlockStats, &sse2ApplyWindow, &sse2Butterflies, &sse2Power};
+#endif
+
+    // ==== Dispatch ====
+
+    /// @brief True if the CPU and the operating system support AVX2 and FMA
+    bool cpuSupportsAvx2()
+    {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+            return false;
+
+        __cpuid(info, 1);
+        const bool osSavesAvx = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        const bool fma = (info[2] & (1 << 12)) != 0;
+        if (!osSavesAvx || !avx || !fma || (_xgetbv(0) & 0x6) != 0x6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+        return false;
+#endif
+    }
+}
+
+/**
+ * @brief The portable kernels, the reference of the other sets
+ */
+const SignalKernels &aerolab::Core::ScalarSignalKernels()
+{
+    return SCALAR_KERNELS;
+}
+
+/**
+ * @brief The kernels of an instruction set
+ * @param level The instruction set
+ * @return The kernels, nullptr if the build or the CPU does not support the instruction set
+ */
+const SignalKernels *aerolab::Core::SignalKernelsFor(E_SimdLevel level)
+{
+    switch (level)
+    {
+    case E_SimdLevel::Scalar:
+        return &SCALAR_KERNELS;
+    case E_SimdLevel::Sse2:
+#ifdef AEROLAB_HAS_SSE2
+        return &SSE2_KERNELS;
+#else
+        return nullptr;
+#endif
+    case E_SimdLevel::Avx2:
+    {
+        static const bool supported = cpuSupportsAvx2();
+        return supported ? Avx2SignalKernels() : nullptr;
+    }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief The widest kernels the build and the CPU support, detected once
+ */
+const SignalKernels &aerolab::Core::BestSignalKernels()
+{
+    static const SignalKernels &best = []() -> const SignalKernels &
+    {
+        for (E_SimdLevel level : {E_SimdLevel::Avx2, E_SimdLevel::Sse2})
+        {
+            if (const SignalKernels *pKernels = SignalKernelsFor(level))
+                return *pKernels;
+        }
+        return SCALAR_KERNELS;
+    }();
+    return best;
+}
@@ -0,0 +1,176 @@
+// Compiled with AVX2 and FMA enabled, see CMakeLists.txt. The functions are only called after the CPU check in
+// SignalKernels.cpp, so this file must not define anything the rest of the library could pick up implicitly,
+// e.g. instantiations of inline functions or templates from shared headers.
+#include "SignalKernels.h"
+
+namespace aerolab::Core
+{
+    const SignalKernels *Avx2SignalKernels();
+}
+
+#if (defined(__AVX2__) && defined(__FMA__)) || (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+
+namespace
+{
+    /// @brief Sum of the eight lanes
+    float avx2Sum(__m256 v)
+    {
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+        sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 0x55));
+        return _mm_cvtss_f32(sum);
+    }
+
+    /// @brief Smallest of the eight lanes
+    float avx2Min(__m256 v)
+    {
+        __m128 min = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        min = _mm_min_ps(min, _mm_movehl_ps(min, min));
+        min = _mm_min_ss(min, _mm_shuffle_ps(min, min, 0x55));
+        return _mm_cvtss_f32(min);
+    }
+
+    /// @brief Largest of the eight lanes
+    float avx2Max(__m256 v)
+    {
+        __m128 max = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        max = _mm_max_ps(max, _mm_movehl_ps(max, max));
+        max = _mm_max_ss(max, _mm_shuffle_ps(max, max, 0x55));
+        return _mm_cvtss_f32(max);
+    }
+
+    void avx2BlockStats(const float *pData, std::size_t count, aerolab::Core::BlockStats &out)
+    {
+        __m256 sum = _mm256_setzero_ps();
+        __m256 sumSquares = _mm256_setzero_ps();
+        __m256 min = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+        __m256 max = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 v = _mm256_loadu_ps(pData + i);
+            sum = _mm256_add_ps(sum, v);
+            sumSquares = _mm256_fmadd_ps(v, v, sumSquares);
+            min = _mm256_min_ps(min, v);
+            max = _mm256_max_ps(max, v);
+        }
+
+        float tailSum = avx2Sum(sum);
+        float tailSumSquares = avx2Sum(sumSquares);
+        float tailMin = avx2Min(min);
+        float tailMax = avx2Max(max);
+        for (; i < count; i++)
+        {
+            const float value = pData[i];
+            tailSum += value;
+            tailSumSquares += value * value;
+            tailMin = value < tailMin ? value : tailMin;
+            tailMax = value > tailMax ? value : tailMax;
+        }
+
+        out.count = count;
+        out.sum = tailSum;
+        out.sumSquares = tailSumSquares;
+        out.min = tailMin;
+        out.max = tailMax;
+    }
+
+    void avx2ApplyWindow(const float *pIn, const float *pWindow, float offset, float *pOut, std::size_t count)
+    {
+        const __m256 offsets = _mm256_set1_ps(offset);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+            _mm256_storeu_ps(pOut + i, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(pIn + i), offsets), _mm256_loadu_ps(pWindow + i)));
+        for (; i < count; i++)
+            pOut[i] = (pIn[i] - offset) * pWindow[i];
+    }
+
+    void avx2Butterflies(float *pRe, float *pIm, const float *pTwiddleRe, const float *pTwiddleIm, std::size_t count, std::size_t half)
+    {
+        for (std::size_t base = 0; base < count; base += 2 * half)
+        {
+            float *pRe0 = pRe + base;
+            float *pIm0 = pIm + base;
+            float *pRe1 = pRe0 + half;
+            float *pIm1 = pIm0 + half;
+
+            std::size_t j = 0;
+            for (; j + 8 <= half; j += 8)
+            {
+                const __m256 twiddleRe = _mm256_loadu_ps(pTwiddleRe + j);
+                const __m256 twiddleIm = _mm256_loadu_ps(pTwiddleIm + j);
+                const __m256 re1 = _mm256_loadu_ps(pRe1 + j);
+                const __m256 im1 = _mm256_loadu_ps(pIm1 + j);
+                const __m256 re = _mm256_fmsub_ps(re1, twiddleRe, _mm256_mul_ps(im1, twiddleIm));
+                const __m256 im = _mm256_fmadd_ps(re1, twiddleIm, _mm256_mul_ps(im1, twiddleRe));
+                const __m256 re0 = _mm256_loadu_ps(pRe0 + j);
+                const __m256 im0 = _mm256_loadu_ps(pIm0 + j);
+                _mm256_storeu_ps(pRe1 + j, _mm256_sub_ps(re0, re));
+                _mm256_storeu_ps(pIm1 + j, _mm256_sub_ps(im0, im));
+                _mm256_storeu_ps(pRe0 + j, _mm256_add_ps(re0, re));
+                _mm256_storeu_ps(pIm0 + j, _mm256_add_ps(im0, im));
+            }
+
+            // The first stages are too short for a full register
+            for (; j + 4 <= half; j += 4)
+            {
+                const __m128 twiddleRe = _mm_loadu_ps(pTwiddleRe + j);
+                const __m128 twiddleIm = _mm_loadu_ps(pTwiddleIm + j);
+                const __m128 re1 = _mm_loadu_ps(pRe1 + j);
+                const __m128 im1 = _mm_loadu_ps(pIm1 + j);
+                const __m128 re = _mm_fmsub_ps(re1, twiddleRe, _mm_mul_ps(im1, twiddleIm));
+                const __m128 im = _mm_fmadd_ps(re1, twiddleIm, _mm_mul_ps(im1, twiddleRe));
+                const __m128 re0 = _mm_loadu_ps(pRe0 + j);
+                const __m128 im0 = _mm_loadu_ps(pIm0 + j);
+                _mm_storeu_ps(pRe1 + j, _mm_sub_ps(re0, re));
+                _mm_storeu_ps(pIm1 + j, _mm_sub_ps(im0, im));
+                _mm_storeu_ps(pRe0 + j, _mm_add_ps(re0, re));
+                _mm_storeu_ps(pIm0 + j, _mm_add_ps(im0, im));
+            }
+            for (; j < half; j++)
+            {
+                const float re = pRe1[j] * pTwiddleRe[j] - pIm1[j] * pTwiddleIm[j];
+                const float im = pRe1[j] * pTwiddleIm[j] + pIm1[j] * pTwiddleRe[j];
+                pRe1[j] = pRe0[j] - re;
+                pIm1[j] = pIm0[j] - im;
+                pRe0[j] += re;
+                pIm0[j] += im;
+            }
+        }
+    }
+
+    void avx2Power(const float *pRe, const float *pIm, float *pOut, std::size_t count, float scale)
+    {
+        const __m256 scales = _mm256_set1_ps(scale);
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 re = _mm256_loadu_ps(pRe + i);
+            const __m256 im = _mm256_loadu_ps(pIm + i);
+            _mm256_storeu_ps(pOut + i, _mm256_mul_ps(_mm256_fmadd_ps(re, re, _mm256_mul_ps(im, im)), scales));
+        }
+        for (; i < count; i++)
+            pOut[i] = (pRe[i] * pRe[i] + pIm[i] * pIm[i]) * scale;
+    }
+
+    const aerolab::Core::SignalKernels AVX2_KERNELS{aerolab::Core::E_SimdLevel::Avx2, "avx2", &avx2BlockStats, &avx2ApplyWindow, &avx2Butterflies, &avx2Power};
+}
+
+/**
+ * @brief The AVX2 kernels, only to be used after checking the CPU
+ */
+const aerolab::Core::SignalKernels *aerolab::Core::Avx2SignalKernels()
+{
+    return &AVX2_KERNELS;
+}
+#else
+/**
+ * @brief No AVX2 kernels in this build, e.g. on ARM
+ */
+const aerolab::Core::SignalKernels *aerolab::Core::Avx2SignalKernels()
+{
+    return nullptr;
+}
+#endif
@@ -0,0 +1,546 @@
+#include "TelemetryArchive.h"
+
+#include "Logger.h"
+#include "TelemetryFrames.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <tuple>
+#include <type_traits>
+
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Samples read from a channel per call
+    constexpr std::size_t READ_CHUNK = 4096;
+
+    /// @brief Upper bound of the payload of a block, 64 bits per timestamp and value plus the group bytes
+    std::size_t maxPayloadBytes(std::size_t columns)
+    {
+        return (columns + 1) * (TELEMETRY_BLOCK_SAMPLES * sizeof(int64_t) + 64);
+    }
+
+    /// Channels of a frame layout
+    struct FrameLayout
+    {
+        /// Name of the frame
+        std::string name;
+        /// Field names
+        std::vector<std::string> fields;
+        /// Factor of the scaled groups per field, zero for float fields
+        std::vector<double> scales;
+    };
+
+    template <typename Frame>
+    FrameLayout frameLayout()
+    {
+        FrameLayout layout{Frame::NAME, {}, {}};
+        std::apply([&layout](const auto &...field)
+                   {
+                       ((layout.fields.push_back(field.name),
+                         layout.scales.push_back(std::is_integral_v<typename std::decay_t<decltype(field)>::RawType> ? static_cast<double>(field.scale) : 0.0)),
+                        ...);
+                   },
+                   Frame::FIELDS);
+        return layout;
+    }
+
+    /// @brief Layouts of all frames, see TelemetryIngest
+    const std::vector<FrameLayout> &frameLayouts()
+    {
+        static const std::vector<FrameLayout> layouts{frameLayout<Frames::Imu>(), frameLayout<Frames::Attitude>(), frameLayout<Frames::Battery>(),
+                                                      frameLayout<Frames::Gps>(), frameLayout<Frames::AirData>()};
+        return layouts;
+    }
+
+    /**
+     * @brief Rounds a value read from the store to the raw integer grid of its field
+     * @details The store keeps float offsets, the rounding restores raw * scale bit exactly, so the codec
+     *          stores the value in a scaled group.
+     * @param value The value
+     * @param scale Factor of the field, zero for float fields
+     * @return The rounded value, value itself for float fields
+     */
+    double snapToScale(double value, double scale)
+    {
+        // Beyond 2^53 the raw integers are not exact in double, the codec does not scale them either
+        if (scale == 0.0 || !(std::fabs(value / scale) < 9007199254740992.0))
+            return value;
+        return static_cast<double>(std::llround(value / scale)) * scale;
+    }
+
+    /// @brief Writes a trivially copyable value
+    template <typename T>
+    void writeValue(std::ofstream &stream, const T &value)
+    {
+        stream.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    /// @brief Reads a trivially copyable value, false at the end of the stream
+    template <typename T>
+    bool readValue(std::ifstream &stream, T &value)
+    {
+        return static_cast<bool>(stream.read(reinterpret_cast<char *>(&value), sizeof(value)));
+    }
+}
+
+/**
+ * @brief Constructor
+ * @param pStore Store of the archived channels, nullptr to only load an archive file
+ */
+TelemetryArchive::TelemetryArchive(std::shared_ptr<TelemetryStore> pStore)
+    : m_pStore(std::move(pStore)), m_pMetrics(MetricsRegistry::GetInstance())
+{
+    m_pBytesGauge = &m_pMetrics->GetGauge("aerolab_archive_bytes", "Compressed size of the telemetry archive");
+    m_pSamplesGauge = &m_pMetrics->GetGauge("aerolab_archive_samples", "Samples in the telemetry archive");
+}
+
+/**
+ * @brief Destructor, stops the thread
+ */
+TelemetryArchive::~TelemetryArchive()
+{
+    Stop();
+}
+
+// ============================================================================
+// Updates
+// ============================================================================
+
+/**
+ * @brief Starts archiving the store periodically
+ * @details A running thread is stopped first.
+ * @param interval Time between two updates, the store rings have to hold the samples of an interval
+ */
+void TelemetryArchive::Start(std::chrono::milliseconds interval)
+{
+    Stop();
+
+    {
+        std::lock_guard<std::mutex> guard(m_runMutex);
+        m_running = true;
+    }
+    m_thread = std::thread(&TelemetryArchive::run, this, interval);
+}
+
+/**
+ * @brief Stops the periodic updates after a last update
+ */
+void TelemetryArchive::Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_runMutex);
+        m_running = false;
+    }
+    m_runCondition.notify_all();
+
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+/**
+ * @brief Compresses the samples appended to the store since the previous update
+ * @details New channels of the store are added. Called by the thread started with Start(), or directly
+ *          when there is no thread.
+ */
+void TelemetryArchive::Update()
+{
+    if (!m_pStore)
+        return;
+
+    const std::vector<std::string> names = m_pStore->ChannelNames();
+    std::lock_guard<std::mutex> guard(m_mutex);
+
+    std::vector<std::string> added;
+    for (const std::string &name : names)
+    {
+        if (!m_locations.contains(name))
+            added.push_back(name);
+    }
+    if (!added.empty())
+        addSeries(added);
+
+    for (ArchivedSeries &archived : m_series)
+        updateSeries(archived);
+
+    updateMetrics();
+}
+
+/**
+ * @brief Adds series for new channels of the store
+ * @details All channels of a frame with the same prefix share a series, the remaining channels get a series each
+ *          once they have samples.
+ * @param names Names of the new channels
+ */
+void TelemetryArchive::addSeries(const std::vector<std::string> &names)
+{
+    const auto add = [this](std::vector<std::string> seriesNames, std::vector<double> scales)
+    {
+        ArchivedSeries archived{{}, std::move(seriesNames), 0, CompressedSeries(std::move(scales))};
+        for (std::size_t c = 0; c < archived.names.size(); c++)
+        {
+            archived.channels.push_back(m_pStore->GetChannel(archived.names[c]));
+            m_locations[archived.names[c]] = ChannelLocation{m_series.size(), c};
+        }
+        m_series.push_back(std::move(archived));
+    };
+
+    std::set<std::string> remaining(names.begin(), names.end());
+    for (const FrameLayout &layout : frameLayouts())
+    {
+        const std::string firstField = layout.name + "/" + layout.fields.front();
+        for (const std::string &name : names)
+        {
+            if (!name.ends_with(firstField) || !remaining.contains(name))
+                continue;
+            const std::string prefix = name.substr(0, name.size() - firstField.size());
+            if (!prefix.empty() && prefix.back() != '/')
+                continue;
+
+            std::vector<std::string> fieldNames;
+            for (const std::string &field : layout.fields)
+                fieldNames.push_back(prefix + layout.name + "/" + field);
+            if (!std::all_of(fieldNames.begin(), fieldNames.end(), [&remaining](const std::string &fieldName)
+                             { return remaining.contains(fieldName); }))
+                continue;
+
+            for (const std::string &fieldName : fieldNames)
+                remaining.erase(fieldName);
+            add(std::move(fieldNames), layout.scales);
+        }
+    }
+
+    // Waits for the first sample, until then the other fields of a frame may still be added to the store
+    for (const std::string &name : remaining)
+    {
+        if (m_pStore->GetChannel(name)->SampleCount() > 0)
+            add({name}, {0.0});
+    }
+}
+
+/**
+ * @brief Compresses the rows appended to the channels of a series since the previous update
+ * @details The fields of a frame are appended one after the other, only the rows complete in all channels are
+ *          read. Rows overwritten in any channel before they were read are dropped in all channels.
+ * @param archived The series
+ */
+void TelemetryArchive::updateSeries(ArchivedSeries &archived)
+{
+    const std::size_t columns = archived.channels.size();
+    if (columns == 0)
+        return;
+    if (m_samples.size() < columns)
+        m_samples.resize(columns, std::vector<TelemetrySample>(READ_CHUNK));
+    if (m_values.size() < columns)
+        m_values.resize(columns);
+    std::vector<uint64_t> starts(columns);
+    std::vector<std::span<const double>> values(columns);
+
+    while (true)
+    {
+        uint64_t written = UINT64_MAX;
+        for (const std::shared_ptr<TelemetryChannel> &pChannel : archived.channels)
+            written = std::min(written, pChannel->SampleCount());
+        if (written <= archived.position)
+            return;
+        const std::size_t count = static_cast<std::size_t>(std::min<uint64_t>(READ_CHUNK, written - archived.position));
+
+        // Rows [first, last) were read from all channels
+        uint64_t first = 0;
+        uint64_t last = UINT64_MAX;
+        for (std::size_t c = 0; c < columns; c++)
+        {
+            uint64_t position = archived.position;
+            const std::size_t read = archived.channels[c]->ReadFrom(position, std::span<TelemetrySample>(m_samples[c].data(), count));
+            starts[c] = position - read;
+            first = std::max(first, starts[c]);
+            last = std::min(last, position);
+        }
+
+        // Samples overwritten before the first update are not reported, the archive may start late
+        if (first > archived.position && archived.position > 0)
+            LOG_WARNING_LIMITED(10000, "Telemetry archive of " + archived.names.front() + " lost " + std::to_string(first - archived.position) +
+                                           " samples, the store ring is too short for the update interval");
+
+        if (first < last)
+        {
+            const std::size_t rows = static_cast<std::size_t>(last - first);
+            const TelemetrySample *pTimes = m_samples[0].data() + (first - starts[0]);
+            m_timestamps.resize(rows);
+            for (std::size_t i = 0; i < rows; i++)
+                m_timestamps[i] = pTimes[i].timestampNs;
+
+            for (std::size_t c = 0; c < columns; c++)
+            {
+                const TelemetrySample *pSamples = m_samples[c].data() + (first - starts[c]);
+                const double scale = archived.series.Scale(c);
+                m_values[c].resize(rows);
+                for (std::size_t i = 0; i < rows; i++)
+                    m_values[c][i] = snapToScale(pSamples[i].value, scale);
+                values[c] = m_values[c];
+            }
+            archived.series.Append(m_timestamps, values);
+        }
+        archived.position = std::max(first, last);
+    }
+}
+
+void TelemetryArchive::run(std::chrono::milliseconds interval)
+{
+    std::unique_lock<std::mutex> lock(m_runMutex);
+
+    while (true)
+    {
+        const bool stopping = m_runCondition.wait_for(lock, interval, [this]()
+                                                      { return !m_running; });
+        lock.unlock();
+
+        Update();
+
+        if (stopping)
+            return;
+        lock.lock();
+    }
+}
+
+void TelemetryArchive::updateMetrics()
+{
+    uint64_t samples = 0;
+    std::size_t bytes = 0;
+    for (const ArchivedSeries &archived : m_series)
+    {
+        samples += archived.series.RowCount() * archived.series.ColumnCount();
+        bytes += archived.series.CompressedBytes();
+    }
+    m_pSamplesGauge->Set(static_cast<int64_t>(samples));
+    m_pBytesGauge->Set(static_cast<int64_t>(bytes));
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+/**
+ * @brief Reads all archived samples of a channel within a time window
+ * @param channel Name of the channel
+ * @param startNs Start of the window
+ * @param endNs End of the window (inclusive)
+ * @param out Receives the samples, cleared first
+ * @return Number of samples, 0 for an unknown channel
+ */
+std::size_t TelemetryArchive::ReadRaw(const std::string &channel, int64_t startNs, int64_t endNs, std::vector<TelemetrySample> &out) const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    const auto it = m_locations.find(channel);
+    if (it == m_locations.end())
+    {
+        out.clear();
+        return 0;
+    }
+    return m_series[it->second.series].series.ReadRaw(it->second.column, startNs, endNs, out);
+}
+
+/**
+ * @brief Names of all archived channels in alphabetical order
+ */
+std::vector<std::string> TelemetryArchive::ChannelNames() const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::vector<std::string> names;
+    names.reserve(m_locations.size());
+    for (const auto &[name, location] : m_locations)
+        names.push_back(name);
+    return names;
+}
+
+/**
+ * @brief Number of archived samples of all channels
+ */
+uint64_t TelemetryArchive::SampleCount() const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    uint64_t samples = 0;
+    for (const ArchivedSeries &archived : m_series)
+        samples += archived.series.RowCount() * archived.series.ColumnCount();
+    return samples;
+}
+
+/**
+ * @brief Memory used by the archived samples of all channels
+ */
+std::size_t TelemetryArchive::CompressedBytes() const
+{
+    std::lock_guard<std::mutex> guard(m_mutex);
+    std::size_t bytes = 0;
+    for (const ArchivedSeries &archived : m_series)
+        bytes += archived.series.CompressedBytes();
+    return bytes;
+}
+
+// ============================================================================
+// Files
+// ============================================================================
+
+/**
+ * @brief Writes all archived channels into a file
+ * @details The file is written under a temporary name and renamed when complete.
+ *          Samples not yet archived by an update are not included.
+ * @param filePath Path of the archive file
+ * @return False if the file could not be written
+ */
+bool TelemetryArchive::Save(const std::string &filePath) const
+{
+    const std::string tempPath = filePath + ".tmp";
+    {
+        std::ofstream stream(tempPath, std::ios::binary | std::ios::trunc);
+        if (!stream.is_open())
+        {
+            LOG_ERROR("Could not create telemetry archive " + tempPath);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> guard(m_mutex);
+
+        ArchiveFileHeader fileHeader{};
+        std::memcpy(fileHeader.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+        fileHeader.version = ARCHIVE_VERSION;
+        fileHeader.seriesCount = static_cast<uint32_t>(m_series.size());
+        fileHeader.createdNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        writeValue(stream, fileHeader);
+
+        std::vector<uint8_t> pendingBlock;
+        for (const ArchivedSeries &archived : m_series)
+        {
+            // The incomplete block is encoded for the file only, the series keeps collecting rows
+            const CompressedSeries &series = archived.series;
+            pendingBlock.clear();
+            series.EncodePending(pendingBlock);
+
+            ArchiveSeriesHeader seriesHeader{};
+            seriesHeader.columnCount = static_cast<uint32_t>(series.ColumnCount());
+            seriesHeader.blockCount = static_cast<uint32_t>(series.BlockCount() + (pendingBlock.empty() ? 0 : 1));
+            seriesHeader.rowCount = series.RowCount();
+            writeValue(stream, seriesHeader);
+            for (const std::string &name : archived.names)
+            {
+                writeValue(stream, static_cast<uint32_t>(name.size()));
+                stream.write(name.data(), static_cast<std::streamsize>(name.size()));
+            }
+
+            for (std::size_t i = 0; i < series.BlockCount(); i++)
+            {
+                const std::span<const uint8_t> block = series.Block(i);
+                stream.write(reinterpret_cast<const char *>(block.data()), static_cast<std::streamsize>(block.size()));
+            }
+            stream.write(reinterpret_cast<const char *>(pendingBlock.data()), static_cast<std::streamsize>(pendingBlock.size()));
+        }
+
+        if (!stream)
+        {
+            LOG_ERROR("Could not write telemetry archive " + tempPath);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, filePath, error);
+    if (error)
+    {
+        LOG_ERROR("Could not rename telemetry archive to " + filePath + ": " + error.message());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Replaces the archived channels by the channels of a file written by Save()
+ * @details Only for an archive without store, e.g. to inspect a flight after landing.
+ * @param filePath Path of the archive file
+ * @return False if the file could not be read or is invalid, the archive is unchanged then
+ */
+bool TelemetryArchive::Load(const std::string &filePath)
+{
+    if (m_pStore)
+    {
+        LOG_ERROR("Can not load " + filePath + " into a telemetry archive of a store");
+        return false;
+    }
+
+    std::ifstream stream(filePath, std::ios::binary);
+    ArchiveFileHeader fileHeader{};
+    if (!stream.is_open() || !readValue(stream, fileHeader) || std::memcmp(fileHeader.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 ||
+        fileHeader.version != ARCHIVE_VERSION)
+    {
+        LOG_ERROR(filePath + " is no telemetry archive");
+        return false;
+    }
+
+    std::vector<ArchivedSeries> allSeries;
+    std::map<std::string, ChannelLocation> locations;
+    for (uint32_t i = 0; i < fileHeader.seriesCount; i++)
+    {
+        ArchiveSeriesHeader seriesHeader{};
+        if (!readValue(stream, seriesHeader) || seriesHeader.columnCount == 0 || seriesHeader.columnCount > UINT16_MAX)
+        {
+            LOG_ERROR("Telemetry archive " + filePath + " is truncated or corrupt");
+            return false;
+        }
+
+        ArchivedSeries archived{{}, {}, 0, CompressedSeries(std::vector<double>(seriesHeader.columnCount, 0.0))};
+        for (uint32_t column = 0; column < seriesHeader.columnCount; column++)
+        {
+            uint32_t nameLength = 0;
+            std::string name;
+            if (readValue(stream, nameLength) && nameLength <= UINT16_MAX)
+            {
+                name.resize(nameLength);
+                stream.read(name.data(), static_cast<std::streamsize>(name.size()));
+            }
+            if (!stream || !locations.emplace(name, ChannelLocation{allSeries.size(), column}).second)
+            {
+                LOG_ERROR("Telemetry archive " + filePath + " has an invalid channel name");
+                return false;
+            }
+            archived.names.push_back(std::move(name));
+        }
+
+        CompressedSeries &series = archived.series;
+        for (uint32_t block = 0; block < seriesHeader.blockCount; block++)
+        {
+            CompressedBlockHeader blockHeader{};
+            if (!readValue(stream, blockHeader) || blockHeader.payloadBytes > maxPayloadBytes(seriesHeader.columnCount))
+            {
+                LOG_ERROR("Telemetry archive " + filePath + " is truncated or corrupt");
+                return false;
+            }
+
+            std::vector<uint8_t> data(sizeof(CompressedBlockHeader) + blockHeader.payloadBytes);
+            std::memcpy(data.data(), &blockHeader, sizeof(blockHeader));
+            stream.read(reinterpret_cast<char *>(data.data() + sizeof(CompressedBlockHeader)), blockHeader.payloadBytes);
+            if (!stream || !series.AppendBlock(std::move(data)))
+            {
+                LOG_ERROR("Telemetry archive " + filePath + " has an invalid block in channel " + archived.names.front());
+                return false;
+            }
+        }
+
+        if (series.RowCount() != seriesHeader.rowCount)
+        {
+            LOG_ERROR("Telemetry archive " + filePath + " has an invalid row count in channel " + archived.names.front());
+            return false;
+        }
+        allSeries.push_back(std::move(archived));
+    }
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_series = std::move(allSeries);
+    m_locations = std::move(locations);
+    updateMetrics();
+    LOG_INFO("Loaded " + std::to_string(m_locations.size()) + " channels from telemetry archive " + filePath);
+    return true;
+}
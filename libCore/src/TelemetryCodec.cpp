@@ -0,0 +1,653 @@
+#include "TelemetryCodec.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+using namespace aerolab::Core;
+
+namespace
+{
+    /// @brief Lowest width bits set, width up to 32
+    uint32_t mask32(unsigned width)
+    {
+        return width >= 32 ? 0xFFFFFFFFu : (1u << width) - 1u;
+    }
+
+    /// @brief Unaligned little endian load
+    uint64_t load64(const uint8_t *pData)
+    {
+        uint64_t value;
+        std::memcpy(&value, pData, sizeof(value));
+        return value;
+    }
+
+    /**
+     * @brief Appends values of a fixed bit width to a byte vector, least significant bit first
+     * @details Values wider than 32 bits are written as their low 32 bits followed by the remaining bits.
+     */
+    class BitPacker
+    {
+    public:
+        explicit BitPacker(std::vector<uint8_t> &out) : m_out(out) {}
+
+        void Put(uint64_t value, unsigned width)
+        {
+            if (width > 32)
+            {
+                put32(static_cast<uint32_t>(value), 32);
+                put32(static_cast<uint32_t>(value >> 32), width - 32);
+            }
+            else
+            {
+                put32(static_cast<uint32_t>(value), width);
+            }
+        }
+
+        /// @brief Writes the incomplete bytes, the next value starts at a byte boundary
+        void Finish()
+        {
+            for (; m_count > 0; m_count = m_count > 8 ? m_count - 8 : 0)
+            {
+                m_out.push_back(static_cast<uint8_t>(m_bits));
+                m_bits >>= 8;
+            }
+            m_bits = 0;
+        }
+
+    private:
+        void put32(uint32_t value, unsigned width)
+        {
+            if (width == 0)
+                return;
+
+            // m_count stays below 32, so the value always fits into the accumulator
+            m_bits |= static_cast<uint64_t>(value & mask32(width)) << m_count;
+            m_count += width;
+            if (m_count >= 32)
+            {
+                const uint32_t word = static_cast<uint32_t>(m_bits);
+                const auto *pBytes = reinterpret_cast<const uint8_t *>(&word);
+                m_out.insert(m_out.end(), pBytes, pBytes + sizeof(word));
+                m_bits >>= 32;
+                m_count -= 32;
+            }
+        }
+
+        /// Receives the bytes
+        std::vector<uint8_t> &m_out;
+        /// Bits not yet written
+        uint64_t m_bits = 0;
+        /// Number of valid bits in m_bits
+        unsigned m_count = 0;
+    };
+
+    /**
+     * @brief Reads count values of a fixed bit width written by the BitPacker
+     * @details Every value is loaded from its own byte offset, the lanes do not depend on each other, so the
+     *          compiler vectorizes the loop. Reads up to 7 bytes past the packed values, see TELEMETRY_BLOCK_PADDING.
+     */
+    void unpack(const uint8_t *pData, std::size_t count, unsigned width, uint64_t *pOut)
+    {
+        if (width == 0)
+        {
+            std::fill_n(pOut, count, uint64_t{0});
+            return;
+        }
+
+        if (width <= 32)
+        {
+            const uint64_t mask = mask32(width);
+            for (std::size_t i = 0; i < count; i++)
+            {
+                const std::size_t bit = i * width;
+                pOut[i] = (load64(pData + (bit >> 3)) >> (bit & 7)) & mask;
+            }
+            return;
+        }
+
+        const uint64_t highMask = mask32(width - 32);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const std::size_t bit = i * width;
+            const std::size_t highBit = bit + 32;
+            const uint64_t low = (load64(pData + (bit >> 3)) >> (bit & 7)) & 0xFFFFFFFFu;
+            const uint64_t high = (load64(pData + (highBit >> 3)) >> (highBit & 7)) & highMask;
+            pOut[i] = low | (high << 32);
+        }
+    }
+
+    /// @brief Number of bytes of count bit-packed values
+    std::size_t packedBytes(std::size_t count, unsigned width)
+    {
+        return (count * width + 7) / 8;
+    }
+
+    /// @brief Zigzag encoding, small negative and positive numbers become small unsigned numbers
+    uint64_t zigzag(uint64_t value)
+    {
+        return (value << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(value) >> 63);
+    }
+
+    /// @brief Inverse of zigzag()
+    uint64_t unzigzag(uint64_t value)
+    {
+        return (value >> 1) ^ (0 - (value & 1));
+    }
+
+    /// Largest raw integer of a scaled value, far beyond the 32 bit fields of the frames
+    constexpr double MAX_SCALED_RAW = 9007199254740992.0;
+
+    /**
+     * @brief Raw integer of a scaled value, the same on encoding and decoding
+     * @param value The value
+     * @param scale Factor of the column, not zero
+     * @param raw Receives the integer
+     * @return False if raw * scale does not restore the value bit exactly
+     */
+    bool scaledRaw(double value, double scale, int64_t &raw)
+    {
+        const double quotient = value / scale;
+        if (!(std::fabs(quotient) < MAX_SCALED_RAW))
+            return false;
+
+        raw = std::llround(quotient);
+        return std::bit_cast<uint64_t>(static_cast<double>(raw) * scale) == std::bit_cast<uint64_t>(value);
+    }
+
+    /// @brief Bits of a value rounded to float, the XOR groups work on them
+    uint32_t floatBits(double value)
+    {
+        return std::bit_cast<uint32_t>(static_cast<float>(value));
+    }
+
+    /// @brief Checks if a value is restored bit exactly from its float bits
+    bool isFloatExact(double value)
+    {
+        return std::bit_cast<uint64_t>(static_cast<double>(static_cast<float>(value))) == std::bit_cast<uint64_t>(value);
+    }
+
+    /// @brief Appends the timestamp groups of a block, see TelemetryCodec.h
+    void encodeTimestamps(std::span<const int64_t> timestamps, std::vector<uint8_t> &out)
+    {
+        // Unsigned arithmetic wraps instead of overflowing
+        BitPacker packer(out);
+        std::array<uint64_t, TELEMETRY_GROUP_SAMPLES> packed{};
+        for (std::size_t group = 2; group < timestamps.size(); group += TELEMETRY_GROUP_SAMPLES)
+        {
+            const std::size_t groupSize = std::min(TELEMETRY_GROUP_SAMPLES, timestamps.size() - group);
+            uint64_t any = 0;
+            for (std::size_t j = 0; j < groupSize; j++)
+            {
+                const std::size_t i = group + j;
+                const uint64_t delta = static_cast<uint64_t>(timestamps[i]) - static_cast<uint64_t>(timestamps[i - 1]);
+                const uint64_t previous = static_cast<uint64_t>(timestamps[i - 1]) - static_cast<uint64_t>(timestamps[i - 2]);
+                packed[j] = zigzag(delta - previous);
+                any |= packed[j];
+            }
+
+            const unsigned width = static_cast<unsigned>(64 - std::countl_zero(any));
+            out.push_back(static_cast<uint8_t>(width));
+            for (std::size_t j = 0; j < groupSize; j++)
+                packer.Put(packed[j], width);
+            packer.Finish();
+        }
+    }
+
+    /**
+     * @brief Appends the value groups of a column, see TelemetryCodec.h
+     * @details Every group uses the smaller of the XOR and the scaled encoding, the XOR encoding only if it is
+     *          exact or the scaled encoding is not possible.
+     */
+    void encodeValues(const TelemetryColumn &column, std::size_t count, std::vector<uint8_t> &out)
+    {
+        BitPacker packer(out);
+        std::array<uint32_t, TELEMETRY_GROUP_SAMPLES> xors{};
+        std::array<uint64_t, TELEMETRY_GROUP_SAMPLES> deltas{};
+
+        // The value the decoder restored last, the groups continue from it
+        double previous = column.values[0];
+        for (std::size_t group = 1; group < count; group += TELEMETRY_GROUP_SAMPLES)
+        {
+            const std::size_t groupSize = std::min(TELEMETRY_GROUP_SAMPLES, count - group);
+            uint32_t anyXor = 0;
+            std::size_t changed = 0;
+            bool unchanged = true;
+            bool floatExact = true;
+            uint32_t previousBits = floatBits(previous);
+            for (std::size_t j = 0; j < groupSize; j++)
+            {
+                const double value = column.values[group + j];
+                const uint32_t bits = floatBits(value);
+                xors[j] = bits ^ previousBits;
+                anyXor |= xors[j];
+                changed += xors[j] != 0 ? 1 : 0;
+                unchanged = unchanged && std::bit_cast<uint64_t>(value) == std::bit_cast<uint64_t>(previous);
+                floatExact = floatExact && isFloatExact(value);
+                previousBits = bits;
+            }
+
+            if (unchanged)
+            {
+                out.push_back(VALUE_GROUP_UNCHANGED);
+                continue;
+            }
+
+            // The bits below the lowest changed bit are dropped
+            const unsigned shift = anyXor != 0 ? static_cast<unsigned>(std::countr_zero(anyXor)) : 0;
+            const unsigned xorWidth = anyXor != 0 ? 32 - static_cast<unsigned>(std::countl_zero(anyXor)) - shift : 0;
+            const std::size_t bitmapBytes = (groupSize + 7) / 8;
+            const std::size_t xorBytes = 3 + bitmapBytes + packedBytes(changed, xorWidth);
+
+            // The raw integer of the previous value continues the deltas, the decoder derives it the same way
+            bool scaled = column.scale != 0.0;
+            int64_t previousRaw = 0;
+            uint64_t anyDelta = 0;
+            if (scaled)
+                scaled = scaledRaw(previous, column.scale, previousRaw);
+            for (std::size_t j = 0; scaled && j < groupSize; j++)
+            {
+                int64_t raw = 0;
+                scaled = scaledRaw(column.values[group + j], column.scale, raw);
+                deltas[j] = zigzag(static_cast<uint64_t>(raw) - static_cast<uint64_t>(previousRaw));
+                anyDelta |= deltas[j];
+                previousRaw = raw;
+            }
+            const unsigned scaledWidth = static_cast<unsigned>(64 - std::countl_zero(anyDelta));
+
+            if (scaled && (!floatExact || anyXor == 0 || 2 + packedBytes(groupSize, scaledWidth) < xorBytes))
+            {
+                out.push_back(VALUE_GROUP_SCALED);
+                out.push_back(static_cast<uint8_t>(scaledWidth));
+                for (std::size_t j = 0; j < groupSize; j++)
+                    packer.Put(deltas[j], scaledWidth);
+                packer.Finish();
+                previous = column.values[group + groupSize - 1];
+                continue;
+            }
+
+            // The values differ only beyond float precision and are no scaled integers
+            if (anyXor == 0)
+            {
+                out.push_back(VALUE_GROUP_UNCHANGED);
+                continue;
+            }
+
+            out.push_back(VALUE_GROUP_XOR);
+            out.push_back(static_cast<uint8_t>(xorWidth));
+            out.push_back(static_cast<uint8_t>(shift));
+            const std::size_t bitmapStart = out.size();
+            out.resize(bitmapStart + bitmapBytes, 0);
+            for (std::size_t j = 0; j < groupSize; j++)
+            {
+                if (xors[j] != 0)
+                    out[bitmapStart + j / 8] |= static_cast<uint8_t>(1u << (j % 8));
+            }
+            for (std::size_t j = 0; j < groupSize; j++)
+            {
+                if (xors[j] != 0)
+                    packer.Put(xors[j] >> shift, xorWidth);
+            }
+            packer.Finish();
+            previous = static_cast<float>(column.values[group + groupSize - 1]);
+        }
+    }
+
+    /**
+     * @brief Decodes the value groups of a column
+     * @param pData Start of the value groups
+     * @param pEnd End of the value groups
+     * @param header Header of the column
+     * @param count Number of rows
+     * @param pOut Receives the values of all rows
+     * @return False if the groups are corrupt
+     */
+    bool decodeValues(const uint8_t *pData, const uint8_t *pEnd, const CompressedColumnHeader &header, std::size_t count, TelemetrySample *pOut)
+    {
+        // One more slot than a group, read but masked out by the branchless scatter of the XOR groups
+        std::array<uint64_t, TELEMETRY_GROUP_SAMPLES + 1> unpacked{};
+
+        double previous = header.firstValue;
+        pOut[0].value = previous;
+        for (std::size_t group = 1; group < count; group += TELEMETRY_GROUP_SAMPLES)
+        {
+            const std::size_t groupSize = std::min(TELEMETRY_GROUP_SAMPLES, count - group);
+            if (pData >= pEnd)
+                return false;
+            const uint8_t mode = *pData++;
+
+            if (mode == VALUE_GROUP_UNCHANGED)
+            {
+                for (std::size_t j = 0; j < groupSize; j++)
+                    pOut[group + j].value = previous;
+                continue;
+            }
+
+            if (mode == VALUE_GROUP_SCALED)
+            {
+                if (pData >= pEnd || header.scale == 0.0)
+                    return false;
+                const unsigned width = *pData++;
+                const std::size_t bytes = packedBytes(groupSize, width);
+                int64_t raw = 0;
+                if (width > 64 || bytes > static_cast<std::size_t>(pEnd - pData) || !scaledRaw(previous, header.scale, raw))
+                    return false;
+
+                unpack(pData, groupSize, width, unpacked.data());
+                pData += bytes;
+                uint64_t value = static_cast<uint64_t>(raw);
+                for (std::size_t j = 0; j < groupSize; j++)
+                {
+                    value += unzigzag(unpacked[j]);
+                    pOut[group + j].value = static_cast<double>(static_cast<int64_t>(value)) * header.scale;
+                }
+                previous = pOut[group + groupSize - 1].value;
+                continue;
+            }
+
+            const std::size_t bitmapBytes = (groupSize + 7) / 8;
+            if (mode != VALUE_GROUP_XOR || static_cast<std::size_t>(pEnd - pData) < 2 + bitmapBytes)
+                return false;
+            const unsigned width = *pData++;
+            const unsigned shift = *pData++;
+            if (width == 0 || shift + width > 32)
+                return false;
+            const uint8_t *pBitmap = pData;
+            pData += bitmapBytes;
+
+            std::size_t changed = 0;
+            for (std::size_t i = 0; i < bitmapBytes; i++)
+                changed += static_cast<std::size_t>(std::popcount(pBitmap[i]));
+            const std::size_t bytes = packedBytes(changed, width);
+            if (changed > groupSize || bytes > static_cast<std::size_t>(pEnd - pData))
+                return false;
+
+            unpack(pData, changed, width, unpacked.data());
+            unpacked[changed] = 0;
+            pData += bytes;
+
+            std::size_t next = 0;
+            uint32_t bits = floatBits(previous);
+            for (std::size_t j = 0; j < groupSize; j++)
+            {
+                const uint32_t flag = (pBitmap[j / 8] >> (j % 8)) & 1u;
+                bits ^= static_cast<uint32_t>(unpacked[next] << shift) & (0u - flag);
+                next += flag;
+                pOut[group + j].value = std::bit_cast<float>(bits);
+            }
+            previous = std::bit_cast<float>(bits);
+        }
+        return pData == pEnd;
+    }
+}
+
+// ==== Block codec ====
+
+/**
+ * @brief Compresses rows of columns sharing their timestamps into a block
+ * @details The timestamps are encoded as delta-of-deltas, the values as XOR with the previous value or as
+ *          deltas of the raw integers, all bit-packed per group of TELEMETRY_GROUP_SAMPLES (see TelemetryCodec.h).
+ * @param timestamps Timestamp per row in time order, at most TELEMETRY_BLOCK_SAMPLES rows are encoded
+ * @param columns The columns, each with a value per row
+ * @param out Receives the block, appended
+ * @return Number of appended bytes, 0 if there are no rows
+ */
+std::size_t aerolab::Core::EncodeTelemetryBlock(std::span<const int64_t> timestamps, std::span<const TelemetryColumn> columns, std::vector<uint8_t> &out)
+{
+    if (timestamps.empty())
+        return 0;
+    if (timestamps.size() > TELEMETRY_BLOCK_SAMPLES)
+        timestamps = timestamps.first(TELEMETRY_BLOCK_SAMPLES);
+
+    const std::size_t start = out.size();
+    const std::size_t count = timestamps.size();
+    out.resize(start + sizeof(CompressedBlockHeader));
+    encodeTimestamps(timestamps, out);
+    const std::size_t timestampBytes = out.size() - start - sizeof(CompressedBlockHeader);
+
+    for (const TelemetryColumn &column : columns)
+    {
+        const std::size_t columnStart = out.size();
+        out.resize(columnStart + sizeof(CompressedColumnHeader));
+        encodeValues(column, count, out);
+
+        CompressedColumnHeader columnHeader{};
+        columnHeader.bytes = static_cast<uint32_t>(out.size() - columnStart - sizeof(CompressedColumnHeader));
+        columnHeader.firstValue = column.values[0];
+        columnHeader.scale = column.scale;
+        std::memcpy(out.data() + columnStart, &columnHeader, sizeof(columnHeader));
+    }
+
+    out.resize(out.size() + TELEMETRY_BLOCK_PADDING, 0);
+
+    CompressedBlockHeader header{};
+    header.firstTimestampNs = timestamps.front();
+    header.lastTimestampNs = timestamps.back();
+    header.firstDeltaNs = count > 1 ? timestamps[1] - timestamps[0] : 0;
+    header.rowCount = static_cast<uint32_t>(count);
+    header.payloadBytes = static_cast<uint32_t>(out.size() - start - sizeof(CompressedBlockHeader));
+    header.timestampBytes = static_cast<uint32_t>(timestampBytes);
+    header.columnCount = static_cast<uint16_t>(columns.size());
+    std::memcpy(out.data() + start, &header, sizeof(header));
+    return out.size() - start;
+}
+
+/**
+ * @brief Reads and checks the header of a block
+ * @param data The block, may be followed by further data
+ * @param header Receives the header
+ * @return False if data is too short or the header is invalid
+ */
+bool aerolab::Core::ReadBlockHeader(std::span<const uint8_t> data, CompressedBlockHeader &header)
+{
+    if (data.size() < sizeof(CompressedBlockHeader))
+        return false;
+
+    std::memcpy(&header, data.data(), sizeof(header));
+    return header.rowCount > 0 && header.rowCount <= TELEMETRY_BLOCK_SAMPLES && header.payloadBytes <= data.size() - sizeof(CompressedBlockHeader) &&
+           static_cast<uint64_t>(header.timestampBytes) + TELEMETRY_BLOCK_PADDING <= header.payloadBytes;
+}
+
+/**
+ * @brief Decompresses a column of a block written by EncodeTelemetryBlock()
+ * @details The value groups of the other columns are skipped.
+ * @param block The block, may be followed by further data
+ * @param column Index of the column
+ * @param out Receives the samples, appended
+ * @return False if the block is corrupt or has no such column, out is unchanged then
+ */
+bool aerolab::Core::DecodeTelemetryBlock(std::span<const uint8_t> block, std::size_t column, std::vector<TelemetrySample> &out)
+{
+    CompressedBlockHeader header;
+    if (!ReadBlockHeader(block, header) || column >= header.columnCount)
+        return false;
+
+    const std::size_t count = header.rowCount;
+    const uint8_t *pData = block.data() + sizeof(CompressedBlockHeader);
+    const uint8_t *pTimestampsEnd = pData + header.timestampBytes;
+    const uint8_t *pEnd = pData + header.payloadBytes - TELEMETRY_BLOCK_PADDING;
+
+    // Skip the columns before
+    const uint8_t *pColumn = pTimestampsEnd;
+    CompressedColumnHeader columnHeader;
+    for (std::size_t i = 0; i <= column; i++)
+    {
+        if (static_cast<std::size_t>(pEnd - pColumn) < sizeof(CompressedColumnHeader))
+            return false;
+        std::memcpy(&columnHeader, pColumn, sizeof(columnHeader));
+        pColumn += sizeof(CompressedColumnHeader);
+        if (columnHeader.bytes > static_cast<std::size_t>(pEnd - pColumn))
+            return false;
+        if (i < column)
+            pColumn += columnHeader.bytes;
+    }
+
+    const std::size_t base = out.size();
+    out.resize(base + count);
+    TelemetrySample *pOut = out.data() + base;
+    const auto fail = [&out, base]()
+    {
+        out.resize(base);
+        return false;
+    };
+
+    std::array<uint64_t, TELEMETRY_GROUP_SAMPLES> unpacked{};
+    uint64_t timestamp = static_cast<uint64_t>(header.firstTimestampNs);
+    uint64_t delta = static_cast<uint64_t>(header.firstDeltaNs);
+    pOut[0].timestampNs = header.firstTimestampNs;
+    if (count > 1)
+    {
+        timestamp += delta;
+        pOut[1].timestampNs = static_cast<int64_t>(timestamp);
+    }
+    for (std::size_t group = 2; group < count; group += TELEMETRY_GROUP_SAMPLES)
+    {
+        const std::size_t groupSize = std::min(TELEMETRY_GROUP_SAMPLES, count - group);
+        if (pData >= pTimestampsEnd)
+            return fail();
+        const unsigned width = *pData++;
+        const std::size_t bytes = packedBytes(groupSize, width);
+        if (width > 64 || bytes > static_cast<std::size_t>(pTimestampsEnd - pData))
+            return fail();
+
+        unpack(pData, groupSize, width, unpacked.data());
+        pData += bytes;
+        for (std::size_t j = 0; j < groupSize; j++)
+        {
+            delta += unzigzag(unpacked[j]);
+            timestamp += delta;
+            pOut[group + j].timestampNs = static_cast<int64_t>(timestamp);
+        }
+    }
+    if (pData != pTimestampsEnd || !decodeValues(pColumn, pColumn + columnHeader.bytes, columnHeader, count, pOut))
+        return fail();
+    return true;
+}
+
+// ==== CompressedSeries ====
+
+/**
+ * @brief Constructor
+ * @param scales Factor converting the raw integers into the values per column, zero for values that are
+ *               no scaled integers, see TelemetryColumn
+ */
+CompressedSeries::CompressedSeries(std::vector<double> scales)
+    : m_scales(std::move(scales)), m_pendingValues(m_scales.size())
+{
+}
+
+/**
+ * @brief Appends rows, every complete block is encoded
+ * @param timestamps Timestamp per row, not older than the rows appended before
+ * @param columns Value per row of every column
+ */
+void CompressedSeries::Append(std::span<const int64_t> timestamps, std::span<const std::span<const double>> columns)
+{
+    m_rowCount += timestamps.size();
+    std::size_t offset = 0;
+    while (offset < timestamps.size())
+    {
+        const std::size_t taken = std::min(TELEMETRY_BLOCK_SAMPLES - m_pendingTimestamps.size(), timestamps.size() - offset);
+        m_pendingTimestamps.insert(m_pendingTimestamps.end(), timestamps.begin() + static_cast<std::ptrdiff_t>(offset),
+                                   timestamps.begin() + static_cast<std::ptrdiff_t>(offset + taken));
+        for (std::size_t c = 0; c < m_pendingValues.size(); c++)
+        {
+            const std::span<const double> values = columns[c].subspan(offset, taken);
+            m_pendingValues[c].insert(m_pendingValues[c].end(), values.begin(), values.end());
+        }
+        offset += taken;
+        if (m_pendingTimestamps.size() == TELEMETRY_BLOCK_SAMPLES)
+            encodePending();
+    }
+}
+
+/**
+ * @brief Appends an encoded block, e.g. read from an archive file
+ * @details Every column is decoded once to check the block. Pending rows are encoded first to keep the time order.
+ * @param block The block, exactly one block without trailing data
+ * @return False if the block is invalid
+ */
+bool CompressedSeries::AppendBlock(std::vector<uint8_t> block)
+{
+    CompressedBlockHeader header;
+    if (!ReadBlockHeader(block, header) || block.size() != sizeof(CompressedBlockHeader) + header.payloadBytes ||
+        header.columnCount != ColumnCount())
+        return false;
+
+    std::vector<TelemetrySample> samples;
+    for (std::size_t c = 0; c < ColumnCount(); c++)
+    {
+        samples.clear();
+        if (!DecodeTelemetryBlock(block, c, samples))
+            return false;
+    }
+
+    if (!m_pendingTimestamps.empty())
+        encodePending();
+
+    m_rowCount += header.rowCount;
+    m_blockBytes += block.size();
+    m_blocks.push_back(EncodedBlock{header.firstTimestampNs, header.lastTimestampNs, std::move(block)});
+    return true;
+}
+
+/**
+ * @brief Reads all samples of a column within a time window
+ * @details Only the blocks overlapping the window are decoded.
+ * @param column Index of the column
+ * @param startNs Start of the window
+ * @param endNs End of the window (inclusive)
+ * @param out Receives the samples, cleared first
+ * @return Number of samples
+ */
+std::size_t CompressedSeries::ReadRaw(std::size_t column, int64_t startNs, int64_t endNs, std::vector<TelemetrySample> &out) const
+{
+    out.clear();
+    if (column >= ColumnCount())
+        return 0;
+
+    auto block = std::partition_point(m_blocks.begin(), m_blocks.end(), [startNs](const EncodedBlock &candidate)
+                                      { return candidate.lastTimestampNs < startNs; });
+    for (; block != m_blocks.end() && block->firstTimestampNs <= endNs; ++block)
+        DecodeTelemetryBlock(block->data, column, out);
+    for (std::size_t i = 0; i < m_pendingTimestamps.size(); i++)
+        out.push_back(TelemetrySample{m_pendingTimestamps[i], m_pendingValues[column][i]});
+
+    // Only the first and the last decoded block can reach beyond the window
+    const auto first = std::partition_point(out.begin(), out.end(), [startNs](const TelemetrySample &sample)
+                                            { return sample.timestampNs < startNs; });
+    const auto last = std::partition_point(first, out.end(), [endNs](const TelemetrySample &sample)
+                                           { return sample.timestampNs <= endNs; });
+    out.erase(last, out.end());
+    out.erase(out.begin(), first);
+    return out.size();
+}
+
+/**
+ * @brief Encodes the rows not yet in a block, the series keeps collecting them
+ * @param out Receives the block, appended
+ * @return Number of appended bytes, 0 without pending rows
+ */
+std::size_t CompressedSeries::EncodePending(std::vector<uint8_t> &out) const
+{
+    std::vector<TelemetryColumn> columns(ColumnCount());
+    for (std::size_t c = 0; c < columns.size(); c++)
+        columns[c] = TelemetryColumn{m_pendingValues[c], m_scales[c]};
+    return EncodeTelemetryBlock(m_pendingTimestamps, columns, out);
+}
+
+void CompressedSeries::encodePending()
+{
+    m_scratch.clear();
+    EncodePending(m_scratch);
+
+    // Exactly sized, hours of blocks are kept
+    m_blockBytes += m_scratch.size();
+    m_blocks.push_back(EncodedBlock{m_pendingTimestamps.front(), m_pendingTimestamps.back(),
+                                    std::vector<uint8_t>(m_scratch.begin(), m_scratch.end())});
+    m_pendingTimestamps.clear();
+    for (std::vector<double> &values : m_pendingValues)
+        values.clear();
+}
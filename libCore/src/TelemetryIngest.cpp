@@ -0,0 +1,83 @@
+#include "TelemetryIngest.h"
+
+using namespace aerolab::Core;
+
+/**
+ * @brief Constructor of the TelemetryIngest
+ * @param pStore The store to append the samples to
+ * @param channelPrefix Prefix of all channel names, e.g. to separate vehicles
+ */
+TelemetryIngest::TelemetryIngest(std::shared_ptr<TelemetryStore> pStore, const std::string &channelPrefix)
+    : m_pStore(std::move(pStore)),
+      m_channelPrefix(channelPrefix),
+      m_channels(FrameChannels<Frames::Imu>(*m_pStore, channelPrefix),
+                 FrameChannels<Frames::Attitude>(*m_pStore, channelPrefix),
+                 FrameChannels<Frames::Battery>(*m_pStore, channelPrefix),
+                 FrameChannels<Frames::Gps>(*m_pStore, channelPrefix),
+                 FrameChannels<Frames::AirData>(*m_pStore, channelPrefix))
+{
+}
+
+/**
+ * @brief Sets the derived channels computed from the decoded fields
+ * @details The channels are added to the store with the prefix of the ingest, e.g. "v1/derived/airspeed".
+ *          They are computed once per decoded datagram from the latest values of all fields, in batches
+ *          see DerivedEvaluator. Has to be set before the first Process().
+ * @param pProgram The compiled channels, nullptr to disable
+ */
+void TelemetryIngest::SetDerivedProgram(std::shared_ptr<const DerivedProgram> pProgram)
+{
+    if (pProgram && !pProgram->ChannelNames().empty())
+        m_pDerived = std::make_unique<DerivedEvaluator>(std::move(pProgram), *m_pStore, m_channelPrefix);
+    else
+        m_pDerived.reset();
+}
+
+/**
+ * @brief Evaluates the pending samples of the derived channels once the datagrams stopped
+ * @details Thread-safe, to be called periodically, e.g. by a timer, see DerivedEvaluator::FlushIdle().
+ */
+void TelemetryIngest::FlushIdle()
+{
+    if (m_pDerived)
+        m_pDerived->FlushIdle();
+}
+
+/**
+ * @brief Decodes a datagram and appends the contained frames to the store
+ * @param datagram The received datagram
+ */
+void TelemetryIngest::Process(const Datagram &datagram)
+{
+    const int64_t timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(datagram.Timestamp().time_since_epoch()).count();
+
+    const std::size_t decoded = Frames::TelemetryDecoder::Decode(
+        datagram.Span(),
+        [&](const auto &view)
+        {
+            using Frame = typename std::remove_cvref_t<decltype(view)>::FrameType;
+            std::get<FrameChannels<Frame>>(m_channels).Append(view, timestampNs);
+
+            if (m_pSnapshot || m_pDerived)
+                view.ForEachField([&](std::size_t index, const char *, double value)
+                                  { m_latest.values[SNAPSHOT_OFFSET<Frame> + index] = value; });
+        });
+
+    if (decoded > 0)
+    {
+        m_decodedFrames.fetch_add(decoded, std::memory_order_relaxed);
+
+        // One publication per datagram, the reader only ever sees complete datagrams
+        if (m_pSnapshot)
+        {
+            m_latest.timestampNs = timestampNs;
+            m_latest.sequence++;
+            m_pSnapshot->Write(m_latest);
+        }
+
+        if (m_pDerived)
+            m_pDerived->Push(m_latest.values, timestampNs);
+    }
+    else
+        m_invalidDatagrams.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,451 @@
+#include "TelemetryStore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+using namespace aerolab::Core;
+
+namespace
+{
+    /**
+     * @brief Rounds up to the next power of two
+     * @param value The value to round
+     * @return The smallest power of two >= value
+     */
+    std::size_t roundUpToPowerOfTwo(std::size_t value)
+    {
+        std::size_t result = 1;
+        while (result < value)
+            result <<= 1;
+        return result;
+    }
+
+    /**
+     * @brief Allocates the arrays of a level ring
+     */
+    template <typename T>
+    std::unique_ptr<std::atomic<T>[]> makeRing(std::size_t capacity)
+    {
+        auto ring = std::make_unique<std::atomic<T>[]>(capacity);
+        for (std::size_t i = 0; i < capacity; i++)
+            ring[i].store(T{}, std::memory_order_relaxed);
+        return ring;
+    }
+}
+
+// ============================================================================
+// TelemetryChannel
+// ============================================================================
+
+/**
+ * @brief Constructor of the TelemetryChannel
+ * @param name Name of the channel
+ * @param capacity Entries kept per level, rounded up to the next power of two
+ */
+TelemetryChannel::TelemetryChannel(std::string name, std::size_t capacity) : m_name(std::move(name)),
+                                                                             m_capacity(roundUpToPowerOfTwo(std::max<std::size_t>(capacity, 16))),
+                                                                             m_mask(m_capacity - 1)
+{
+    m_raw.timestamps = makeRing<int64_t>(m_capacity);
+    m_raw.mins = makeRing<float>(m_capacity);
+
+    for (auto &level : m_levels)
+    {
+        level.timestamps = makeRing<int64_t>(m_capacity);
+        level.mins = makeRing<float>(m_capacity);
+        level.maxs = makeRing<float>(m_capacity);
+        level.means = makeRing<float>(m_capacity);
+    }
+}
+
+/**
+ * @brief Appends a sample
+ * @details Must only be called from a single writer thread. Updates the decimation levels incrementally.
+ *          The first sample becomes the origin of the stored offsets, 0 if it is not finite.
+ * @param timestampNs Timestamp of the sample in nanoseconds
+ * @param value Value of the sample
+ */
+void TelemetryChannel::Append(int64_t timestampNs, double value)
+{
+    // Readers only access the origin after acquiring a written count > 0
+    if (m_raw.written.load(std::memory_order_relaxed) == 0 && std::isfinite(value))
+        m_origin = value;
+
+    timestampNs = std::max(timestampNs, m_lastTimestamp);
+    m_lastTimestamp = timestampNs;
+
+    const TelemetryBucket sample{timestampNs, value, value, value};
+    publish(m_raw, sample, false);
+    accumulate(0, sample);
+}
+
+/**
+ * @brief Adds an entry of the finer level to the pending entry of a decimation level
+ * @param levelIndex Index into m_levels
+ * @param entry The entry of the finer level
+ */
+void TelemetryChannel::accumulate(std::size_t levelIndex, const TelemetryBucket &entry)
+{
+    Level &level = m_levels[levelIndex];
+    TelemetryBucket &pending = level.pending;
+
+    if (level.pendingCount == 0)
+        pending = TelemetryBucket{entry.timestampNs, entry.min, entry.max, 0.0};
+    else
+    {
+        pending.min = std::min(pending.min, entry.min);
+        pending.max = std::max(pending.max, entry.max);
+    }
+
+    // The mean is accumulated as sum and divided on publishing
+    pending.mean += entry.mean;
+
+    const std::size_t ratio = LEVEL_FACTORS[levelIndex + 1] / LEVEL_FACTORS[levelIndex];
+    if (++level.pendingCount < ratio)
+        return;
+
+    pending.mean /= static_cast<double>(ratio);
+    publish(level, pending, true);
+    level.pendingCount = 0;
+
+    if (levelIndex + 1 < m_levels.size())
+        accumulate(levelIndex + 1, pending);
+}
+
+/**
+ * @brief Writes an entry into a level ring
+ * @details The entry is announced in reserved before it is written, so readers can detect overwritten slots.
+ *          Values are stored relative to m_origin.
+ */
+void TelemetryChannel::publish(Level &level, const TelemetryBucket &entry, bool aggregated)
+{
+    const uint64_t index = level.written.load(std::memory_order_relaxed);
+    const std::size_t slot = index & m_mask;
+
+    level.reserved.store(index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    level.timestamps[slot].store(entry.timestampNs, std::memory_order_relaxed);
+    level.mins[slot].store(static_cast<float>(entry.min - m_origin), std::memory_order_relaxed);
+    if (aggregated)
+    {
+        level.maxs[slot].store(static_cast<float>(entry.max - m_origin), std::memory_order_relaxed);
+        level.means[slot].store(static_cast<float>(entry.mean - m_origin), std::memory_order_relaxed);
+    }
+
+    level.written.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Reads a single entry of a level ring, the result has to be checked with isValid afterwards
+ * @details Must only be called for entries below an acquired written count, which publishes m_origin as well.
+ */
+TelemetryBucket TelemetryChannel::readEntry(const Level &level, uint64_t index, bool aggregated) const
+{
+    const std::size_t slot = index & m_mask;
+    TelemetryBucket entry;
+    entry.timestampNs = level.timestamps[slot].load(std::memory_order_relaxed);
+    entry.min = m_origin + level.mins[slot].load(std::memory_order_relaxed);
+    entry.max = aggregated ? m_origin + level.maxs[slot].load(std::memory_order_relaxed) : entry.min;
+    entry.mean = aggregated ? m_origin + level.means[slot].load(std::memory_order_relaxed) : entry.min;
+    return entry;
+}
+
+/**
+ * @brief Checks if entries read with index or later have not been overwritten meanwhile
+ */
+bool TelemetryChannel::isValid(const Level &level, uint64_t index) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return index + m_capacity > level.reserved.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Finds the first readable entry with a timestamp >= timestampNs
+ * @return The index of the entry, the written count if there is none
+ */
+uint64_t TelemetryChannel::lowerBound(const Level &level, int64_t timestampNs) const
+{
+    const uint64_t written = level.written.load(std::memory_order_acquire);
+    const uint64_t reserved = level.reserved.load(std::memory_order_relaxed);
+    uint64_t low = reserved >= m_capacity ? reserved - m_capacity + 1 : 0;
+    uint64_t high = written;
+
+    while (low < high)
+    {
+        const uint64_t middle = low + (high - low) / 2;
+        if (level.timestamps[middle & m_mask].load(std::memory_order_relaxed) < timestampNs)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+// ============================================================================
+// Reading
+// ============================================================================
+
+/**
+ * @brief Reads the latest sample
+ * @param sample Receives the sample
+ * @return True if the channel contains a sample
+ */
+bool TelemetryChannel::Latest(TelemetrySample &sample) const
+{
+    const uint64_t written = m_raw.written.load(std::memory_order_acquire);
+    if (written == 0)
+        return false;
+
+    const TelemetryBucket entry = readEntry(m_raw, written - 1, false);
+    if (!isValid(m_raw, written - 1))
+        return false;
+
+    sample = TelemetrySample{entry.timestampNs, entry.min};
+    return true;
+}
+
+/**
+ * @brief Reads raw samples sequentially
+ * @details Meant for consumers following the channel incrementally. If position fell so far behind that
+ *          the samples have been overwritten, reading continues with the oldest available sample.
+ * @param position Index of the next sample to read, advanced by the number of read samples
+ * @param out Storage receiving the samples
+ * @return Number of read samples
+ */
+std::size_t TelemetryChannel::ReadFrom(uint64_t &position, std::span<TelemetrySample> out) const
+{
+    const uint64_t written = m_raw.written.load(std::memory_order_acquire);
+    const uint64_t reserved = m_raw.reserved.load(std::memory_order_relaxed);
+    const uint64_t oldest = reserved >= m_capacity ? reserved - m_capacity + 1 : 0;
+
+    position = std::max(position, oldest);
+    if (position >= written)
+        return 0;
+
+    const std::size_t count = static_cast<std::size_t>(std::min<uint64_t>(out.size(), written - position));
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const TelemetryBucket entry = readEntry(m_raw, position + i, false);
+        out[i] = TelemetrySample{entry.timestampNs, entry.min};
+    }
+
+    // Drop the samples the writer overwrote while copying
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t reservedAfter = m_raw.reserved.load(std::memory_order_relaxed);
+    const uint64_t firstValid = reservedAfter >= m_capacity ? reservedAfter - m_capacity + 1 : 0;
+    std::size_t skipped = 0;
+    if (firstValid > position)
+    {
+        skipped = static_cast<std::size_t>(std::min<uint64_t>(firstValid - position, count));
+        std::copy(out.begin() + skipped, out.begin() + count, out.begin());
+    }
+
+    position += count;
+    return count - skipped;
+}
+
+/**
+ * @brief Reads all raw samples within a time window
+ * @param startNs Start of the window
+ * @param endNs End of the window (inclusive)
+ * @param out Receives the samples, cleared first
+ * @return Number of samples
+ */
+std::size_t TelemetryChannel::ReadRaw(int64_t startNs, int64_t endNs, std::vector<TelemetrySample> &out) const
+{
+    out.clear();
+
+    std::vector<TelemetryBucket> entries;
+    gather(0, startNs, endNs, entries);
+
+    out.reserve(entries.size());
+    for (const auto &entry : entries)
+        out.push_back(TelemetrySample{entry.timestampNs, entry.min});
+
+    return out.size();
+}
+
+/**
+ * @brief Collects the entries of a level within a time window
+ * @details Entries newer than the last complete entry of the level are taken from the finer levels,
+ *          so the result always reaches up to the latest sample.
+ */
+void TelemetryChannel::gather(std::size_t levelIndex, int64_t startNs, int64_t endNs, std::vector<TelemetryBucket> &out) const
+{
+    const bool aggregated = levelIndex > 0;
+    const Level &level = aggregated ? m_levels[levelIndex - 1] : m_raw;
+
+    const uint64_t written = level.written.load(std::memory_order_acquire);
+    const uint64_t first = lowerBound(level, startNs);
+    const std::size_t offset = out.size();
+
+    for (uint64_t i = first; i < written; i++)
+    {
+        const TelemetryBucket entry = readEntry(level, i, aggregated);
+        if (entry.timestampNs > endNs)
+            break;
+        out.push_back(entry);
+    }
+
+    // Drop the entries the writer overwrote while copying
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t reserved = level.reserved.load(std::memory_order_relaxed);
+    const uint64_t firstValid = reserved >= m_capacity ? reserved - m_capacity + 1 : 0;
+    if (firstValid > first)
+    {
+        const std::size_t invalid = static_cast<std::size_t>(std::min<uint64_t>(firstValid - first, out.size() - offset));
+        out.erase(out.begin() + offset, out.begin() + offset + invalid);
+    }
+
+    if (!aggregated)
+        return;
+
+    // Fill the time after the last complete entry from the finer level
+    const std::size_t ratio = LEVEL_FACTORS[levelIndex] / LEVEL_FACTORS[levelIndex - 1];
+    const Level &finer = levelIndex > 1 ? m_levels[levelIndex - 2] : m_raw;
+    const uint64_t finerFirst = written * ratio;
+    const uint64_t finerWritten = finer.written.load(std::memory_order_acquire);
+
+    if (finerFirst >= finerWritten)
+        return;
+
+    const int64_t tailStart = std::max(startNs, finer.timestamps[finerFirst & m_mask].load(std::memory_order_relaxed));
+    if (tailStart <= endNs)
+        gather(levelIndex - 1, tailStart, endNs, out);
+}
+
+/**
+ * @brief Queries a time window decimated to a number of points
+ * @details Picks the finest decimation level with a few entries per point, then merges the entries into
+ *          maxPoints equally wide time bins. The cost is proportional to maxPoints, not to the number of samples.
+ * @param startNs Start of the window
+ * @param endNs End of the window (inclusive)
+ * @param maxPoints Maximum number of returned buckets, usually the width in pixels
+ * @param out Receives the buckets, cleared first
+ * @return Number of buckets
+ */
+std::size_t TelemetryChannel::Query(int64_t startNs, int64_t endNs, std::size_t maxPoints, std::vector<TelemetryBucket> &out) const
+{
+    out.clear();
+    if (maxPoints == 0 || endNs < startNs)
+        return 0;
+
+    // Finest level with at most 4 entries per point which still reaches back to the window start
+    std::size_t levelIndex = 0;
+    for (; levelIndex + 1 < LEVEL_FACTORS.size(); levelIndex++)
+    {
+        const Level &level = levelIndex > 0 ? m_levels[levelIndex - 1] : m_raw;
+        const uint64_t first = lowerBound(level, startNs);
+        const uint64_t last = lowerBound(level, endNs == std::numeric_limits<int64_t>::max() ? endNs : endNs + 1);
+        const uint64_t reserved = level.reserved.load(std::memory_order_relaxed);
+        const bool reachesStart = reserved < m_capacity || level.timestamps[first & m_mask].load(std::memory_order_relaxed) <= startNs;
+
+        if (last - first <= 4 * maxPoints && reachesStart)
+            break;
+    }
+
+    std::vector<TelemetryBucket> entries;
+    gather(levelIndex, startNs, endNs, entries);
+
+    if (entries.size() <= maxPoints)
+    {
+        out = std::move(entries);
+        return out.size();
+    }
+
+    // Merge into time bins
+    const int64_t width = std::max<int64_t>(1, (endNs - startNs) / static_cast<int64_t>(maxPoints) + 1);
+    out.reserve(maxPoints);
+
+    // The mean of a bin is the mean of its entries, the few finer tail entries only affect the newest bin
+    int64_t currentBin = -1;
+    std::size_t binCount = 0;
+    for (const auto &entry : entries)
+    {
+        const int64_t bin = (entry.timestampNs - startNs) / width;
+
+        if (bin != currentBin)
+        {
+            if (!out.empty())
+                out.back().mean /= static_cast<double>(binCount);
+            out.push_back(entry);
+            binCount = 1;
+            currentBin = bin;
+        }
+        else
+        {
+            TelemetryBucket &bucket = out.back();
+            bucket.min = std::min(bucket.min, entry.min);
+            bucket.max = std::max(bucket.max, entry.max);
+            bucket.mean += entry.mean;
+            binCount++;
+        }
+    }
+
+    if (!out.empty())
+        out.back().mean /= static_cast<double>(binCount);
+
+    return out.size();
+}
+
+// ============================================================================
+// TelemetryStore
+// ============================================================================
+
+/**
+ * @brief Constructor of the TelemetryStore
+ * @param capacity Entries per level of every channel
+ */
+TelemetryStore::TelemetryStore(std::size_t capacity) : m_capacity(capacity)
+{
+}
+
+/**
+ * @brief Returns the channel with the given name, creating it if it does not exist
+ * @param name Name of the channel
+ * @return The channel
+ */
+std::shared_ptr<TelemetryChannel> TelemetryStore::GetOrAddChannel(const std::string &name)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        auto it = m_channels.find(name);
+        if (it != m_channels.end())
+            return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    auto &pChannel = m_channels[name];
+    if (!pChannel)
+        pChannel = std::make_shared<TelemetryChannel>(name, m_capacity);
+    return pChannel;
+}
+
+/**
+ * @brief Returns the channel with the given name
+ * @param name Name of the channel
+ * @return The channel, nullptr if it does not exist
+ */
+std::shared_ptr<TelemetryChannel> TelemetryStore::GetChannel(const std::string &name) const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    auto it = m_channels.find(name);
+    return it != m_channels.end() ? it->second : nullptr;
+}
+
+/**
+ * @brief Names of all channels in alphabetical order
+ */
+std::vector<std::string> TelemetryStore::ChannelNames() const
+{
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+
+    std::vector<std::string> names;
+    names.reserve(m_channels.size());
+    for (const auto &[name, pChannel] : m_channels)
+        names.push_back(name);
+    return names;
+}
@@ -0,0 +1,296 @@
+#include "VehicleDemux.h"
+
+#include "Logger.h"
+
+#include <cstring>
+
+using namespace aerolab::Core;
+
+// ==== VehiclePipeline ====
+
+/**
+ * @brief Constructor of the VehiclePipeline
+ * @param pool Pool the tasks of the pipeline run on
+ * @param name Name of the vehicle, used as metric label
+ * @param parts Store, channel prefix and recorder of the vehicle
+ * @param inboxCapacity Maximum number of datagrams waiting for the task
+ * @param onProcessed Called for every processed datagram, may be empty
+ */
+VehiclePipeline::VehiclePipeline(WorkStealingPool &pool, std::string name, VehicleParts parts, std::size_t inboxCapacity,
+                                 VehicleProcessedCallback onProcessed)
+    : m_pool(pool),
+      m_name(std::move(name)),
+      m_parts(std::move(parts)),
+      m_inbox(inboxCapacity, E_OverflowPolicy::DropNewest),
+      m_onProcessed(std::move(onProcessed)),
+      m_pMetrics(MetricsRegistry::GetInstance())
+{
+    const std::string labels = "vehicle=\"" + m_name + "\"";
+    m_pProcessedCounter = &m_pMetrics->GetCounter("aerolab_vehicle_datagrams_total", "Datagrams processed by the vehicle pipeline", labels);
+    m_pDropCounter = &m_pMetrics->GetCounter("aerolab_vehicle_drops_total", "Datagrams dropped because the vehicle pipeline fell behind", labels);
+}
+
+/**
+ * @brief Queues a datagram for processing
+ * @details Never blocks. Datagrams of one vehicle have to be posted from one thread at a time to keep their order.
+ * @param datagram The received datagram
+ * @return True if queued, False if the inbox is full
+ */
+bool VehiclePipeline::Post(const Datagram &datagram)
+{
+    if (!m_inbox.Push(datagram))
+    {
+        m_pDropCounter->Inc();
+        return false;
+    }
+
+    if (!m_scheduled.exchange(true, std::memory_order_acq_rel))
+        schedule();
+    return true;
+}
+
+/**
+ * @brief Number of frames decoded by the pipeline
+ */
+uint64_t VehiclePipeline::DecodedFrames() const
+{
+    return m_ingestReady.load(std::memory_order_acquire) ? m_pIngest->DecodedFrames() : 0;
+}
+
+/**
+ * @brief Number of datagrams without a valid frame
+ */
+uint64_t VehiclePipeline::InvalidDatagrams() const
+{
+    return m_ingestReady.load(std::memory_order_acquire) ? m_pIngest->InvalidDatagrams() : 0;
+}
+
+/**
+ * @brief Evaluates the pending derived samples of a vehicle that stopped sending, see TelemetryIngest::FlushIdle()
+ */
+void VehiclePipeline::FlushIdle()
+{
+    if (m_ingestReady.load(std::memory_order_acquire))
+        m_pIngest->FlushIdle();
+}
+
+void VehiclePipeline::schedule()
+{
+    m_pool.Submit([pSelf = shared_from_this()]()
+                  { pSelf->drain(); });
+}
+
+/**
+ * @brief Processes the queued datagrams, runs as task on the pool
+ * @details Only one task per pipeline exists at a time, the scheduled flag is its token. The flag is cleared
+ *          before the final check of the inbox, so a datagram posted in between either sees the cleared flag
+ *          and schedules a task itself or is found by the check.
+ */
+void VehiclePipeline::drain()
+{
+    if (!m_pIngest)
+    {
+        m_pIngest = std::make_unique<TelemetryIngest>(m_parts.pStore, m_parts.channelPrefix);
+        m_pIngest->SetSnapshotBuffer(m_parts.pSnapshot);
+        m_pIngest->SetDerivedProgram(m_parts.pDerived);
+        m_ingestReady.store(true, std::memory_order_release);
+    }
+
+    Datagram datagram;
+    std::size_t processed = 0;
+    while (processed < DRAIN_BUDGET && m_inbox.TryPop(datagram))
+    {
+        if (m_parts.pRecorder)
+            m_parts.pRecorder->Record(datagram);
+        m_pIngest->Process(datagram);
+        if (m_onProcessed)
+            m_onProcessed(*this, datagram);
+        processed++;
+    }
+    datagram = Datagram();
+    m_pProcessedCounter->Inc(processed);
+
+    m_scheduled.store(false, std::memory_order_release);
+    // Pairs with the fence after the push in the RingBuffer, so a concurrent Post() is never missed
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_inbox.Size() > 0 && !m_scheduled.exchange(true, std::memory_order_acq_rel))
+        schedule();
+}
+
+// ==== VehicleDemux ====
+
+/**
+ * @brief Constructor of the VehicleDemux
+ * @param pool Pool the pipelines run on
+ * @param key Key the datagrams are assigned to a vehicle by
+ * @param factory Creates the parts of new vehicles, empty for a separate store per vehicle
+ */
+VehicleDemux::VehicleDemux(WorkStealingPool &pool, E_DemuxKey key, PipelineFactory factory)
+    : m_pool(pool),
+      m_key(key),
+      m_factory(std::move(factory)),
+      m_pMetrics(MetricsRegistry::GetInstance())
+{
+    if (!m_factory)
+    {
+        m_factory = [](const std::string &)
+        { return VehicleParts{.pStore = std::make_shared<TelemetryStore>(), .channelPrefix = "", .pRecorder = nullptr, .pSnapshot = nullptr, .pDerived = nullptr}; };
+    }
+
+    m_pUnroutedCounter = &m_pMetrics->GetCounter("aerolab_demux_unrouted_total", "Datagrams which could not be assigned to a vehicle");
+    m_pVehicleGauge = &m_pMetrics->GetGauge("aerolab_demux_vehicles", "Vehicles with their own pipeline");
+}
+
+/**
+ * @brief Hands a datagram to the pipeline of its vehicle
+ * @details Creates the pipeline on the first datagram of a vehicle. Thread-safe, but the datagrams of a
+ *          vehicle keep their order only if they are dispatched from one thread at a time.
+ * @param datagram The received datagram
+ * @return True if the datagram has been queued, False if it has been dropped
+ */
+bool VehicleDemux::Dispatch(const Datagram &datagram)
+{
+    VehiclePipeline *pPipeline = nullptr;
+
+    if (m_key == E_DemuxKey::SystemId)
+    {
+        FrameHeader header;
+        if (datagram.Size() < FRAME_OVERHEAD)
+        {
+            m_pUnroutedCounter->Inc();
+            return false;
+        }
+        std::memcpy(&header, datagram.Data(), sizeof(header));
+        if (header.sync != FRAME_SYNC)
+        {
+            m_pUnroutedCounter->Inc();
+            return false;
+        }
+        pPipeline = findBySystemId(header.systemId);
+    }
+    else
+    {
+        pPipeline = findByEndpoint(datagram.Sender());
+    }
+
+    if (!pPipeline)
+    {
+        m_pUnroutedCounter->Inc();
+        return false;
+    }
+    return pPipeline->Post(datagram);
+}
+
+/**
+ * @brief All pipelines in the order the vehicles appeared
+ */
+std::vector<std::shared_ptr<VehiclePipeline>> VehicleDemux::Vehicles() const
+{
+    std::lock_guard<std::mutex> guard(m_vehicleMutex);
+    return m_vehicles;
+}
+
+/**
+ * @brief Evaluates the pending derived samples of all vehicles that stopped sending
+ * @details Thread-safe, to be called periodically, e.g. by a timer.
+ */
+void VehicleDemux::FlushIdle()
+{
+    for (const std::shared_ptr<VehiclePipeline> &pVehicle : Vehicles())
+        pVehicle->FlushIdle();
+}
+
+VehiclePipeline *VehicleDemux::findBySystemId(uint8_t systemId)
+{
+    std::atomic<VehiclePipeline *> &slot = m_bySystemId[systemId];
+    VehiclePipeline *pPipeline = slot.load(std::memory_order_acquire);
+    if (pPipeline)
+        return pPipeline;
+
+    std::lock_guard<std::mutex> guard(m_vehicleMutex);
+    pPipeline = slot.load(std::memory_order_relaxed);
+    if (pPipeline)
+        return pPipeline;
+
+    std::string name = "v";
+    name += std::to_string(systemId);
+    auto pCreated = createPipeline(name);
+    if (pCreated)
+        slot.store(pCreated.get(), std::memory_order_release);
+    return pCreated.get();
+}
+
+VehiclePipeline *VehicleDemux::findByEndpoint(const boost::asio::ip::udp::endpoint &endpoint)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(m_endpointMutex);
+        auto it = m_byEndpoint.find(endpoint);
+        if (it != m_byEndpoint.end())
+            return it->second;
+    }
+
+    std::lock_guard<std::mutex> guard(m_vehicleMutex);
+    {
+        std::shared_lock<std::shared_mutex> lock(m_endpointMutex);
+        auto it = m_byEndpoint.find(endpoint);
+        if (it != m_byEndpoint.end())
+            return it->second;
+    }
+
+    auto pCreated = createPipeline(endpoint.address().to_string() + ":" + std::to_string(endpoint.port()));
+    if (pCreated)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_endpointMutex);
+        m_byEndpoint.emplace(endpoint, pCreated.get());
+    }
+    return pCreated.get();
+}
+
+/**
+ * @brief Creates the pipeline of a new vehicle, m_vehicleMutex has to be held
+ * @return The pipeline, nullptr if the vehicle limit is reached or the factory failed
+ */
+std::shared_ptr<VehiclePipeline> VehicleDemux::createPipeline(const std::string &name)
+{
+    if (m_vehicles.size() >= m_maxVehicles)
+    {
+        if (!m_limitReported)
+            LOG_WARNING("Vehicle limit of " + std::to_string(m_maxVehicles) + " reached, dropping datagrams of " + name);
+        m_limitReported = true;
+        return nullptr;
+    }
+
+    VehicleParts parts;
+    try
+    {
+        parts = m_factory(name);
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("Could not create pipeline of vehicle " + name + ": " + e.what());
+        return nullptr;
+    }
+
+    if (!parts.pStore)
+    {
+        LOG_ERROR("Pipeline factory returned no store for vehicle " + name);
+        return nullptr;
+    }
+
+    auto pPipeline = std::make_shared<VehiclePipeline>(m_pool, name, std::move(parts), m_inboxCapacity, m_onProcessed);
+    m_vehicles.push_back(pPipeline);
+    m_pVehicleGauge->Set(static_cast<double>(m_vehicles.size()));
+
+    LOG_INFO("New vehicle " + name);
+    return pPipeline;
+}
+
+std::size_t VehicleDemux::EndpointHash::operator()(const boost::asio::ip::udp::endpoint &endpoint) const
+{
+    std::size_t hash = std::hash<unsigned short>()(endpoint.port());
+    if (endpoint.address().is_v4())
+        hash ^= std::hash<uint32_t>()(endpoint.address().to_v4().to_uint()) * 0x9E3779B9u;
+    else
+        hash ^= std::hash<std::string>()(endpoint.address().to_string()) * 0x9E3779B9u;
+    return hash;
+}
@@ -0,0 +1,159 @@
+#include "WorkStealingPool.h"
+
+#include "Logger.h"
+
+using namespace aerolab::Core;
+
+namespace
+{
+    /// Pool and index of the worker running on the calling thread
+    thread_local const WorkStealingPool *t_pPool = nullptr;
+    thread_local std::size_t t_workerIndex = 0;
+}
+
+/**
+ * @brief Constructor of the WorkStealingPool
+ * @details Starts the worker threads.
+ * @param threadCount Number of worker threads, 0 for one per hardware thread
+ */
+WorkStealingPool::WorkStealingPool(std::size_t threadCount) : m_pMetrics(MetricsRegistry::GetInstance())
+{
+    if (threadCount == 0)
+        threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+    m_pTaskCounter = &m_pMetrics->GetCounter("aerolab_pool_tasks_total", "Tasks executed by the worker pool");
+    m_pStealCounter = &m_pMetrics->GetCounter("aerolab_pool_steals_total", "Tasks a worker took from the queue of another worker");
+
+    for (std::size_t i = 0; i < threadCount; i++)
+        m_workers.push_back(std::make_unique<Worker>());
+
+    // Started after all queues exist, the workers steal from each other right away
+    for (std::size_t i = 0; i < threadCount; i++)
+        m_workers[i]->thread = std::thread(&WorkStealingPool::run, this, i);
+
+    LOG_INFO("Started worker pool with " + std::to_string(threadCount) + " threads");
+}
+
+/**
+ * @brief Destructor of the WorkStealingPool
+ */
+WorkStealingPool::~WorkStealingPool()
+{
+    Stop();
+}
+
+/**
+ * @brief Stops the workers
+ * @details Tasks which are still queued are discarded.
+ */
+void WorkStealingPool::Stop()
+{
+    if (!m_running.exchange(false))
+        return;
+
+    {
+        std::lock_guard<std::mutex> guard(m_wakeMutex);
+        m_wakeCondition.notify_all();
+    }
+
+    for (auto &pWorker : m_workers)
+        if (pWorker->thread.joinable())
+            pWorker->thread.join();
+
+    for (auto &pWorker : m_workers)
+    {
+        std::lock_guard<std::mutex> guard(pWorker->mutex);
+        m_pending.fetch_sub(pWorker->tasks.size(), std::memory_order_relaxed);
+        pWorker->tasks.clear();
+    }
+}
+
+/**
+ * @brief Queues a task
+ * @details Thread-safe. Called from a worker the task is queued on that worker, otherwise round robin.
+ * @param task The task to run
+ */
+void WorkStealingPool::Submit(Task task)
+{
+    const std::size_t index = t_pPool == this ? t_workerIndex
+                                               : m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+
+    Worker &worker = *m_workers[index];
+    {
+        std::lock_guard<std::mutex> guard(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+
+    // Pairs with the sleeping count of the workers, so a worker going to sleep never misses the task
+    m_pending.fetch_add(1, std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_seq_cst) > 0)
+    {
+        std::lock_guard<std::mutex> guard(m_wakeMutex);
+        m_wakeCondition.notify_one();
+    }
+}
+
+void WorkStealingPool::run(std::size_t index)
+{
+    t_pPool = this;
+    t_workerIndex = index;
+
+    Task task;
+    while (m_running.load(std::memory_order_relaxed))
+    {
+        if (popLocal(index, task) || steal(index, task))
+        {
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+            task();
+            task = nullptr;
+            m_pTaskCounter->Inc();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+        m_wakeCondition.wait(lock, [this]()
+                             { return m_pending.load(std::memory_order_seq_cst) > 0 || !m_running.load(); });
+        m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    t_pPool = nullptr;
+}
+
+/**
+ * @brief Takes the oldest task of the own queue
+ */
+bool WorkStealingPool::popLocal(std::size_t index, Task &task)
+{
+    Worker &worker = *m_workers[index];
+    std::lock_guard<std::mutex> guard(worker.mutex);
+
+    if (worker.tasks.empty())
+        return false;
+
+    task = std::move(worker.tasks.front());
+    worker.tasks.pop_front();
+    return true;
+}
+
+/**
+ * @brief Takes the newest task of another worker
+ * @details The victims are visited starting with the next worker, so thieves spread over the queues.
+ */
+bool WorkStealingPool::steal(std::size_t index, Task &task)
+{
+    for (std::size_t offset = 1; offset < m_workers.size(); offset++)
+    {
+        Worker &victim = *m_workers[(index + offset) % m_workers.size()];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty())
+            continue;
+
+        task = std::move(victim.tasks.back());
+        victim.tasks.pop_back();
+        m_pStealCounter->Inc();
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,233 @@
+#include "Test.h"
+
+#include <CommandUplink.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace aerolab::Core;
+using namespace aerolab::Test;
+
+namespace
+{
+    /// Heartbeat interval of the uplinks under test
+    constexpr auto HEARTBEAT_INTERVAL = std::chrono::milliseconds(10);
+
+    /**
+     * @brief Flight controller side of the loopback tests
+     * @details Acknowledges every frame which requests it, unless acknowledging is disabled, and tracks the
+     *          gaps between the heartbeats.
+     */
+    class EchoPeer
+    {
+    public:
+        explicit EchoPeer(bool acknowledge) : m_socket(m_ioContext, boost::asio::ip::udp::endpoint(boost::asio::ip::make_address_v4("127.0.0.1"), 0)),
+                                              m_acknowledge(acknowledge)
+        {
+            m_socket.set_option(boost::asio::socket_base::receive_buffer_size(4 * 1024 * 1024));
+            m_thread = std::thread(&EchoPeer::run, this);
+        }
+
+        ~EchoPeer()
+        {
+            m_running = false;
+            boost::system::error_code ec;
+            // Wake the blocking receive
+            m_socket.send_to(boost::asio::buffer("", 1), m_socket.local_endpoint(), 0, ec);
+            m_thread.join();
+        }
+
+        boost::asio::ip::udp::endpoint Endpoint() const { return m_socket.local_endpoint(); }
+
+        /// @brief Longest gap between two heartbeats in nanoseconds
+        int64_t MaxHeartbeatGapNs() const { return m_maxGapNs.load(); }
+        /// @brief Number of received heartbeats
+        int Heartbeats() const { return m_heartbeats.load(); }
+
+    private:
+        void run()
+        {
+            std::array<uint8_t, MAX_DATAGRAM_SIZE> buffer;
+            boost::asio::ip::udp::endpoint sender;
+            std::chrono::steady_clock::time_point lastHeartbeat;
+
+            while (m_running)
+            {
+                boost::system::error_code ec;
+                const std::size_t bytes = m_socket.receive_from(boost::asio::buffer(buffer), sender, 0, ec);
+                if (ec || !m_running || bytes < FRAME_OVERHEAD)
+                    continue;
+
+                FrameHeader header;
+                std::memcpy(&header, buffer.data(), sizeof(header));
+
+                if (header.messageId == Frames::Heartbeat::ID)
+                {
+                    const auto now = std::chrono::steady_clock::now();
+                    if (m_heartbeats.fetch_add(1) > 0)
+                        m_maxGapNs = std::max(m_maxGapNs.load(), std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastHeartbeat).count());
+                    lastHeartbeat = now;
+                }
+
+                if (!m_acknowledge || (header.flags & Frames::FRAME_FLAG_ACK_REQUESTED) == 0)
+                    continue;
+
+                std::array<uint8_t, FRAME_OVERHEAD + FramePayloadSize<Frames::Ack>()> ack{};
+                FrameHeader ackHeader{FRAME_SYNC, 1, Frames::Ack::ID, 0, 0, static_cast<uint16_t>(FramePayloadSize<Frames::Ack>()), 0};
+                std::memcpy(ack.data(), &ackHeader, sizeof(ackHeader));
+                std::memcpy(ack.data() + sizeof(FrameHeader) + Frames::Ack::SEQUENCE.offset, &header.sequence, sizeof(header.sequence));
+                ack[sizeof(FrameHeader) + Frames::Ack::MESSAGE_ID.offset] = header.messageId;
+                const uint16_t checksum = FrameChecksum(std::span<const uint8_t>(ack.data(), ack.size() - FRAME_CHECKSUM_SIZE));
+                std::memcpy(ack.data() + ack.size() - FRAME_CHECKSUM_SIZE, &checksum, sizeof(checksum));
+
+                m_socket.send_to(boost::asio::buffer(ack), sender, 0, ec);
+            }
+        }
+
+        boost::asio::io_context m_ioContext;
+        boost::asio::ip::udp::socket m_socket;
+        bool m_acknowledge;
+        std::atomic<bool> m_running{true};
+        std::atomic<int> m_heartbeats{0};
+        std::atomic<int64_t> m_maxGapNs{0};
+        std::thread m_thread;
+    };
+
+    /**
+     * @brief IO context run by several threads, so the handlers of the uplink may run on any of them
+     */
+    class IoThreads
+    {
+    public:
+        explicit IoThreads(std::size_t threadCount) : m_work(boost::asio::make_work_guard(m_ioContext))
+        {
+            for (std::size_t i = 0; i < threadCount; i++)
+                m_threads.emplace_back([this]()
+                                       { m_ioContext.run(); });
+        }
+
+        ~IoThreads()
+        {
+            m_work.reset();
+            for (auto &thread : m_threads)
+                thread.join();
+        }
+
+        boost::asio::io_context &Context() { return m_ioContext; }
+
+    private:
+        boost::asio::io_context m_ioContext;
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> m_work;
+        std::vector<std::thread> m_threads;
+    };
+
+    UplinkOptions loopbackOptions(const EchoPeer &peer)
+    {
+        UplinkOptions options;
+        options.target = peer.Endpoint();
+        options.heartbeatInterval = HEARTBEAT_INTERVAL;
+        return options;
+    }
+}
+
+/**
+ * A large parameter upload is sent in bulk batches between which the strand is released, so the
+ * heartbeats keep their rate while the upload is running.
+ */
+CORE_TEST(CommandUplinkHeartbeatDuringUpload)
+{
+    constexpr int PARAMETERS = 20000;
+
+    EchoPeer peer(true);
+    IoThreads io(2);
+    CommandUplink uplink(io.Context().get_executor(), loopbackOptions(peer));
+    if (!CORE_CHECK(uplink.Start()))
+        return;
+
+    // The gaps are measured from the first heartbeat on, it is sent right after the start
+    if (!CORE_CHECK(WaitFor([&]()
+                            { return peer.Heartbeats() > 0; })))
+        return;
+
+    std::atomic<int> acked{0};
+    for (int i = 0; i < PARAMETERS; i++)
+        uplink.SendParameter(static_cast<uint16_t>(i), static_cast<float>(i), [&acked](bool success, std::chrono::nanoseconds)
+                             {
+                                 if (success)
+                                     acked.fetch_add(1); });
+
+    const int heartbeatsBefore = peer.Heartbeats();
+    const auto start = std::chrono::steady_clock::now();
+    CORE_CHECK(WaitFor([&]()
+                       { return acked.load() == PARAMETERS; }, std::chrono::seconds(30)));
+    const auto uploadTime = std::chrono::steady_clock::now() - start;
+    const int heartbeats = peer.Heartbeats() - heartbeatsBefore;
+    uplink.Stop();
+
+    // Allows one late timer, a heartbeat stuck behind the upload would open a gap of the whole upload
+    const int64_t maxGapNs = peer.MaxHeartbeatGapNs();
+    if (!CORE_CHECK(maxGapNs < std::chrono::duration_cast<std::chrono::nanoseconds>(3 * HEARTBEAT_INTERVAL).count()))
+        std::fprintf(stderr, "longest heartbeat gap %.1f ms\n", static_cast<double>(maxGapNs) / 1e6);
+    CORE_CHECK(heartbeats >= static_cast<int>(uploadTime / HEARTBEAT_INTERVAL) - 1);
+}
+
+/**
+ * Stop() runs on the strand while other IO threads keep retransmitting, every pending frame is reported
+ * as failed exactly once.
+ */
+CORE_TEST(CommandUplinkStopWhileRetransmitting)
+{
+    constexpr int PARAMETERS = 2000;
+
+    EchoPeer peer(false);
+    IoThreads io(4);
+    UplinkOptions options = loopbackOptions(peer);
+    options.initialRto = std::chrono::milliseconds(1);
+    options.minRto = std::chrono::milliseconds(1);
+    options.maxRetries = 1000;
+    CommandUplink uplink(io.Context().get_executor(), options);
+    if (!CORE_CHECK(uplink.Start()))
+        return;
+
+    std::atomic<int> acked{0};
+    std::atomic<int> failed{0};
+    for (int i = 0; i < PARAMETERS; i++)
+        uplink.SendParameter(static_cast<uint16_t>(i), static_cast<float>(i), [&](bool success, std::chrono::nanoseconds)
+                             { (success ? acked : failed).fetch_add(1); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    uplink.Stop();
+    CORE_CHECK(acked.load() == 0);
+    CORE_CHECK(failed.load() == PARAMETERS);
+
+    // Timers which expired before the shutdown find the socket closed and do not retransmit
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    CORE_CHECK(failed.load() == PARAMETERS);
+}
+
+/**
+ * Stop() called from an acknowledgement callback runs on the strand and must not wait for it.
+ */
+CORE_TEST(CommandUplinkStopFromCallback)
+{
+    EchoPeer peer(true);
+    IoThreads io(1);
+    CommandUplink uplink(io.Context().get_executor(), loopbackOptions(peer));
+    if (!CORE_CHECK(uplink.Start()))
+        return;
+
+    std::atomic<bool> stopped{false};
+    uplink.SendCommand(Frames::E_UplinkCommand::Arm, 0.0f, 0.0f, [&](bool, std::chrono::nanoseconds)
+                       {
+                           uplink.Stop();
+                           stopped = true; });
+
+    CORE_CHECK(WaitFor([&]()
+                       { return stopped.load(); }));
+    CORE_CHECK(!uplink.SendCommand(Frames::E_UplinkCommand::Arm));
+}
@@ -0,0 +1,245 @@
+#include "Test.h"
+
+#include <Bench.h>
+#include <DatagramPool.h>
+#include <InputManager.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace aerolab::Core;
+using namespace aerolab::Test;
+
+namespace
+{
+    /// Datagrams sent before the allocations are counted
+    constexpr int WARM_UP_DATAGRAMS = 2000;
+    /// Datagrams sent while the allocations are counted
+    constexpr int COUNTED_DATAGRAMS = 20000;
+    /// Datagrams sent before waiting for the receiver, well below the socket buffer
+    constexpr int BURST_DATAGRAMS = 50;
+
+    /**
+     * @brief InputManager on a loopback port with its own IO thread
+     */
+    class LoopbackReceiver
+    {
+    public:
+        LoopbackReceiver(int port, std::size_t shardCount, std::size_t maxBatch, std::size_t threadCount = 1)
+            : m_work(boost::asio::make_work_guard(m_ioContext)),
+              m_inputManager(m_ioContext.get_executor(), "127.0.0.1", port),
+              m_endpoint(boost::asio::ip::make_address_v4("127.0.0.1"), static_cast<uint16_t>(port))
+        {
+            m_inputManager.SetShardCount(shardCount);
+            m_inputManager.SetBatchReceive(maxBatch);
+            for (std::size_t i = 0; i < threadCount; i++)
+                m_threads.emplace_back([this]()
+                                       { m_ioContext.run(); });
+        }
+
+        ~LoopbackReceiver()
+        {
+            m_inputManager.Stop();
+            m_work.reset();
+            m_ioContext.stop();
+            for (auto &thread : m_threads)
+                thread.join();
+        }
+
+        InputManager &Input() { return m_inputManager; }
+        const boost::asio::ip::udp::endpoint &Endpoint() const { return m_endpoint; }
+
+    private:
+        boost::asio::io_context m_ioContext;
+        boost::asio::executor_work_guard<boost::asio::io_context::executor_type> m_work;
+        InputManager m_inputManager;
+        boost::asio::ip::udp::endpoint m_endpoint;
+        std::vector<std::thread> m_threads;
+    };
+
+    /**
+     * @brief Sends datagrams in bursts and waits for the receiver after each burst
+     * @return False if the receiver did not keep up
+     */
+    bool sendAndWait(boost::asio::ip::udp::socket &socket, const boost::asio::ip::udp::endpoint &endpoint, const std::atomic<int> &received, int count)
+    {
+        std::array<uint8_t, 64> payload{};
+        const int start = received.load();
+        for (int sent = 0; sent < count; sent += BURST_DATAGRAMS)
+        {
+            const int burst = std::min(BURST_DATAGRAMS, count - sent);
+            for (int i = 0; i < burst; i++)
+                socket.send_to(boost::asio::buffer(payload), endpoint);
+            const int expected = start + sent + burst;
+            if (!WaitFor([&]()
+                         { return received.load() >= expected; }))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Receives datagrams after a warm-up and counts the heap allocations of the whole process
+     * @details Runs at log level Info, the debug output formats every datagram.
+     */
+    void checkSteadyStateReceive(int port, std::size_t maxBatch)
+    {
+        Logger::GetInstance()->SetLogLevel(E_LogLevel::Info);
+
+        LoopbackReceiver receiver(port, 1, maxBatch);
+        std::atomic<int> received{0};
+        receiver.Input().SetCallback([&received](const Datagram &)
+                                     { received.fetch_add(1); });
+        receiver.Input().Start();
+
+        boost::asio::io_context senderContext;
+        boost::asio::ip::udp::socket sender(senderContext, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+
+        if (!CORE_CHECK(sendAndWait(sender, receiver.Endpoint(), received, WARM_UP_DATAGRAMS)))
+            return;
+
+        const aerolab::Bench::AllocationScope allocations;
+        CORE_CHECK(sendAndWait(sender, receiver.Endpoint(), received, COUNTED_DATAGRAMS));
+        const double perDatagram = allocations.PerOp(COUNTED_DATAGRAMS);
+        if (!CORE_CHECK(perDatagram < 0.001))
+            std::fprintf(stderr, "%.4f allocations per datagram after warm-up\n", perDatagram);
+    }
+}
+
+/**
+ * The pool only allocates while it grows, buffers cycling through it afterwards allocate nothing.
+ */
+CORE_TEST(DatagramPoolSteadyState)
+{
+    DatagramPool pool(16);
+    const uint64_t initial = pool.AllocationCount();
+
+    std::vector<Datagram> held;
+    for (int i = 0; i < 64; i++)
+        held.push_back(pool.Acquire());
+    CORE_CHECK(pool.Capacity() >= 64);
+    held.clear();
+
+    const uint64_t grown = pool.AllocationCount();
+    CORE_CHECK(grown > initial);
+
+    const aerolab::Bench::AllocationScope allocations;
+    for (int i = 0; i < 100000; i++)
+    {
+        Datagram datagram = pool.Acquire();
+        Datagram copy = datagram;
+    }
+    CORE_CHECK(pool.AllocationCount() == grown);
+    CORE_CHECK(allocations.PerOp(100000) == 0.0);
+}
+
+/**
+ * Single receives allocate nothing per datagram once the receive loop is running.
+ */
+CORE_TEST(InputManagerSteadyStateReceive)
+{
+    checkSteadyStateReceive(47311, 0);
+}
+
+/**
+ * Batched receives allocate nothing per datagram once the receive loop is running.
+ */
+CORE_TEST(InputManagerSteadyStateBatchReceive)
+{
+    checkSteadyStateReceive(47312, 32);
+}
+
+/**
+ * Several shards share the load, while all datagrams of one source are received in order by the same shard.
+ */
+CORE_TEST(InputManagerShardedReceive)
+{
+    constexpr int PORT = 47313;
+    constexpr std::size_t SHARDS = 4;
+    constexpr int SOURCES = 16;
+    constexpr int DATAGRAMS_PER_SOURCE = 200;
+
+    LoopbackReceiver receiver(PORT, SHARDS, 0, SHARDS);
+
+    // Payload: source index and sequence number
+    std::mutex mutex;
+    std::vector<uint32_t> nextSequence(SOURCES, 0);
+    int outOfOrder = 0;
+    std::atomic<int> received{0};
+    receiver.Input().SetCallback([&](const Datagram &datagram)
+                                 {
+                                     uint32_t source = 0;
+                                     uint32_t sequence = 0;
+                                     std::memcpy(&source, datagram.Data(), sizeof(source));
+                                     std::memcpy(&sequence, datagram.Data() + sizeof(source), sizeof(sequence));
+                                     {
+                                         std::lock_guard<std::mutex> guard(mutex);
+                                         if (source >= SOURCES || sequence != nextSequence[source])
+                                             outOfOrder++;
+                                         else
+                                             nextSequence[source]++;
+                                     }
+                                     received.fetch_add(1); });
+    receiver.Input().Start();
+
+    const auto pMetrics = MetricsRegistry::GetInstance();
+    std::vector<MetricCounter *> shardCounters;
+    for (std::size_t i = 0; i < SHARDS; i++)
+        shardCounters.push_back(&pMetrics->GetCounter("aerolab_input_shard_datagrams_total", "Received datagrams by ingest shard",
+                                                      "port=\"" + std::to_string(PORT) + "\",shard=\"" + std::to_string(i) + "\""));
+
+    boost::asio::io_context senderContext;
+    std::vector<bool> shardUsed(SHARDS, false);
+
+    for (uint32_t source = 0; source < SOURCES; source++)
+    {
+        // Every source has its own socket, so its own source port
+        boost::asio::ip::udp::socket sender(senderContext, boost::asio::ip::udp::endpoint(boost::asio::ip::udp::v4(), 0));
+
+        std::vector<uint64_t> before;
+        for (auto *pCounter : shardCounters)
+            before.push_back(pCounter->Value());
+
+        std::array<uint8_t, 64> payload{};
+        std::memcpy(payload.data(), &source, sizeof(source));
+        const int start = received.load();
+        for (uint32_t sequence = 0; sequence < DATAGRAMS_PER_SOURCE; sequence++)
+        {
+            std::memcpy(payload.data() + sizeof(source), &sequence, sizeof(sequence));
+            sender.send_to(boost::asio::buffer(payload), receiver.Endpoint());
+            if ((sequence + 1) % BURST_DATAGRAMS != 0)
+                continue;
+
+            const int expected = start + static_cast<int>(sequence) + 1;
+            if (!CORE_CHECK(WaitFor([&]()
+                                    { return received.load() >= expected; })))
+                return;
+        }
+
+        // Exactly one shard received all datagrams of the source
+        int receivingShards = 0;
+        for (std::size_t i = 0; i < SHARDS; i++)
+        {
+            const uint64_t delta = shardCounters[i]->Value() - before[i];
+            if (delta == 0)
+                continue;
+            receivingShards++;
+            shardUsed[i] = true;
+            CORE_CHECK(delta == DATAGRAMS_PER_SOURCE);
+        }
+        CORE_CHECK(receivingShards == 1);
+    }
+
+    CORE_CHECK(std::count(shardUsed.begin(), shardUsed.end(), true) > 1);
+
+    std::lock_guard<std::mutex> guard(mutex);
+    CORE_CHECK(outOfOrder == 0);
+    for (uint32_t source = 0; source < SOURCES; source++)
+        CORE_CHECK(nextSequence[source] == DATAGRAMS_PER_SOURCE);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace aerolab::Test
+{
+    /// A registered test
+    struct TestCase
+    {
+        std::string name;
+        std::function<void()> function;
+    };
+
+    std::vector<TestCase> &Tests();
+    bool Check(bool condition, const char *expression, const char *file, int line);
+
+    /// Registers a test function on startup
+    struct TestRegistrar
+    {
+        TestRegistrar(const std::string &name, std::function<void()> function) { Tests().push_back({name, std::move(function)}); }
+    };
+
+    /**
+     * @brief Polls a condition until it holds or the timeout expired
+     * @param condition The condition
+     * @param timeout Maximum time to wait
+     * @return The last result of the condition
+     */
+    template <typename Condition>
+    bool WaitFor(Condition &&condition, std::chrono::milliseconds timeout = std::chrono::seconds(5))
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (!condition())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return condition();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+}
+
+/// Defines and registers a test, the name is used to select tests on the command line and by ctest
+#define CORE_TEST(name)                                                                             \
+    static void name();                                                                             \
+    [[maybe_unused]] static const ::aerolab::Test::TestRegistrar s_##name##Registrar(#name, &name); \
+    static void name()
+
+/// Checks a condition, a failure is reported and fails the test, the result allows to return early
+#define CORE_CHECK(condition) ::aerolab::Test::Check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
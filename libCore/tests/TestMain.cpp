@@ -0,0 +1,76 @@
+#include "Test.h"
+
+#include <Logger.h>
+
+#include <atomic>
+#include <cstdio>
+
+using namespace aerolab::Test;
+
+namespace
+{
+    /// Number of failed checks of the running test, checks may run on other threads
+    std::atomic<int> s_failedChecks{0};
+}
+
+/**
+ * @brief All registered tests
+ */
+std::vector<TestCase> &aerolab::Test::Tests()
+{
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+/**
+ * @brief Reports a failed check
+ * @param condition Result of the check
+ * @param expression The checked expression
+ * @param file Source file of the check
+ * @param line Line of the check
+ * @return The condition
+ */
+bool aerolab::Test::Check(bool condition, const char *expression, const char *file, int line)
+{
+    if (!condition)
+    {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        s_failedChecks.fetch_add(1);
+    }
+    return condition;
+}
+
+/**
+ * @brief Runs all tests whose name contains one of the filter arguments, all if there is none
+ * @details Usage: core_test [filter...]
+ * @return 0 if all selected tests passed, 1 otherwise
+ */
+int main(int argc, char *argv[])
+{
+    LOG_INIT("core_test.txt");
+    aerolab::Core::Logger::GetInstance()->SetConsoleOutput(false);
+
+    std::vector<std::string> filters(argv + 1, argv + argc);
+
+    int failed = 0;
+    int run = 0;
+    for (const auto &test : Tests())
+    {
+        bool selected = filters.empty();
+        for (const auto &filter : filters)
+            selected |= test.name.find(filter) != std::string::npos;
+        if (!selected)
+            continue;
+
+        s_failedChecks.store(0);
+        test.function();
+        run++;
+
+        std::fprintf(stderr, "%s %s\n", s_failedChecks == 0 ? "PASS" : "FAIL", test.name.c_str());
+        if (s_failedChecks > 0)
+            failed++;
+    }
+
+    std::fprintf(stderr, "%d of %d tests passed\n", run - failed, run);
+    return failed == 0 && run > 0 ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+#include "Test.h"
+
+#include <InputManager.h>
+#include <TelemetryFrames.h>
+#include <VehicleDemux.h>
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace aerolab::Core;
+using namespace aerolab::Test;
+
+namespace
+{
+    /// Size of an attitude frame on the wire
+    constexpr std::size_t FRAME_SIZE = FRAME_OVERHEAD + FramePayloadSize<Frames::Attitude>();
+
+    /// @brief Encodes an attitude frame, the header sequence counts the frames of a vehicle
+    std::array<uint8_t, FRAME_SIZE> encodeFrame(uint8_t systemId, uint16_t sequence)
+    {
+        std::array<uint8_t, FRAME_SIZE> frame{};
+        const FrameHeader header{FRAME_SYNC, systemId, Frames::Attitude::ID, 0, sequence,
+                                 static_cast<uint16_t>(FramePayloadSize<Frames::Attitude>()), 0};
+        std::memcpy(frame.data(), &header, sizeof(header));
+
+        const uint16_t checksum = FrameChecksum(std::span<const uint8_t>(frame.data(), frame.size() - FRAME_CHECKSUM_SIZE));
+        std::memcpy(frame.data() + frame.size() - FRAME_CHECKSUM_SIZE, &checksum, sizeof(checksum));
+        return frame;
+    }
+}
+
+/**
+ * Frames of many vehicles on one port reach their pipelines complete and in order. The sender waits for the
+ * pipelines after every round, so neither the socket nor the inboxes drop anything.
+ */
+CORE_TEST(VehicleDemuxLoopback)
+{
+    constexpr unsigned short PORT = 47321;
+    constexpr int VEHICLES = 8;
+    constexpr int FRAMES_PER_VEHICLE = 1000;
+    constexpr int FRAMES_PER_ROUND = 25;
+
+    boost::asio::io_context ioContext;
+    auto workGuard = boost::asio::make_work_guard(ioContext);
+    InputManager inputManager(ioContext.get_executor(), "127.0.0.1", PORT);
+    inputManager.SetBatchReceive(64);
+
+    WorkStealingPool pool(4);
+    // Small stores, allocating the default capacity for every vehicle would take longer than the test
+    VehicleDemux demux(pool, E_DemuxKey::SystemId, [](const std::string &)
+                       { return VehicleParts{.pStore = std::make_shared<TelemetryStore>(1 << 12), .channelPrefix = "", .pRecorder = nullptr, .pSnapshot = nullptr, .pDerived = nullptr}; });
+
+    // Every vehicle is processed by one worker at a time, so the entries need no synchronization
+    std::vector<uint16_t> lastSequence(VEHICLES + 1, 0);
+    std::atomic<int> processed{0};
+    std::atomic<int> violations{0};
+    demux.SetProcessedCallback([&](const VehiclePipeline &, const Datagram &datagram)
+                               {
+        FrameHeader header;
+        std::memcpy(&header, datagram.Data(), sizeof(header));
+        if (header.systemId > VEHICLES || header.sequence != lastSequence[header.systemId] + 1)
+            violations.fetch_add(1);
+        else
+            lastSequence[header.systemId] = header.sequence;
+        processed.fetch_add(1); });
+
+    inputManager.SetCallback([&demux](const Datagram &datagram)
+                             { demux.Dispatch(datagram); });
+    inputManager.Start();
+    std::thread ioThread([&ioContext]()
+                         { ioContext.run(); });
+
+    // Every vehicle sends from its own socket
+    boost::asio::io_context senderContext;
+    const boost::asio::ip::udp::endpoint target(boost::asio::ip::make_address_v4("127.0.0.1"), PORT);
+    std::vector<std::unique_ptr<boost::asio::ip::udp::socket>> senders;
+    for (int v = 0; v < VEHICLES; v++)
+        senders.push_back(std::make_unique<boost::asio::ip::udp::socket>(senderContext, boost::asio::ip::udp::v4()));
+
+    bool delivered = true;
+    for (int sequence = 1; delivered && sequence <= FRAMES_PER_VEHICLE; sequence++)
+    {
+        for (int v = 0; v < VEHICLES; v++)
+        {
+            const auto frame = encodeFrame(static_cast<uint8_t>(v + 1), static_cast<uint16_t>(sequence));
+            senders[v]->send_to(boost::asio::buffer(frame), target);
+        }
+
+        if (sequence % FRAMES_PER_ROUND == 0)
+            delivered = CORE_CHECK(WaitFor([&]()
+                                           { return processed.load() >= sequence * VEHICLES; }));
+    }
+
+    inputManager.Stop();
+    workGuard.reset();
+    ioThread.join();
+    pool.Stop();
+
+    CORE_CHECK(violations.load() == 0);
+    CORE_CHECK(processed.load() == VEHICLES * FRAMES_PER_VEHICLE);
+    CORE_CHECK(demux.Vehicles().size() == VEHICLES);
+
+    uint64_t decoded = 0;
+    for (const auto &pVehicle : demux.Vehicles())
+    {
+        decoded += pVehicle->DecodedFrames();
+        CORE_CHECK(pVehicle->DroppedCount() == 0);
+    }
+    CORE_CHECK(decoded == static_cast<uint64_t>(VEHICLES) * FRAMES_PER_VEHICLE);
+}
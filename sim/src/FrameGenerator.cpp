@@ -0,0 +1,195 @@
+#include "FrameGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <numbers>
+
+using namespace aerolab::Core;
+using namespace aerolab::Sim;
+
+namespace
+{
+    /// Center of the simulated circuit
+    constexpr double HOME_LATITUDE = 48.7758;
+    constexpr double HOME_LONGITUDE = 9.1829;
+    /// Radius of the circuit in m
+    constexpr double CIRCUIT_RADIUS = 150.0;
+    /// Ground speed on the circuit in m/s
+    constexpr double GROUND_SPEED = 18.0;
+    /// Meters per degree latitude
+    constexpr double METERS_PER_DEGREE = 111320.0;
+
+    /**
+     * @brief Writes the physical value of a field as its raw wire value
+     * @details The value is divided by the scale of the field, rounded and clamped to the wire type.
+     */
+    template <typename Raw>
+    void setField(uint8_t *pPayload, const FieldDesc<Raw> &field, double value)
+    {
+        double raw = value / static_cast<double>(field.scale);
+        Raw wire;
+        if constexpr (std::is_integral_v<Raw>)
+        {
+            raw = std::clamp(std::round(raw), static_cast<double>(std::numeric_limits<Raw>::lowest()), static_cast<double>(std::numeric_limits<Raw>::max()));
+            wire = static_cast<Raw>(raw);
+        }
+        else
+        {
+            wire = static_cast<Raw>(raw);
+        }
+        std::memcpy(pPayload + field.offset, &wire, sizeof(Raw));
+    }
+}
+
+/**
+ * @brief Constructor of the FrameGenerator
+ * @param systemId ID of the simulated vehicle written into every header
+ */
+FrameGenerator::FrameGenerator(uint8_t systemId) : m_systemId(systemId)
+{
+}
+
+// ============================================================================
+// Flight data
+// ============================================================================
+
+template <>
+void FrameGenerator::writePayload<Frames::Imu>(double t, uint8_t *pPayload)
+{
+    using Frames::Imu;
+    const double yawRate = GROUND_SPEED / CIRCUIT_RADIUS;
+
+    setField(pPayload, Imu::ACC_X, 0.3 * std::sin(2.0 * t) + noise(0.05f));
+    setField(pPayload, Imu::ACC_Y, GROUND_SPEED * yawRate + noise(0.05f));
+    setField(pPayload, Imu::ACC_Z, -Frames::GRAVITY + noise(0.08f));
+    setField(pPayload, Imu::GYRO_X, 0.2 * std::cos(0.5 * t) + noise(0.01f));
+    setField(pPayload, Imu::GYRO_Y, 0.1 * std::cos(0.3 * t) + noise(0.01f));
+    setField(pPayload, Imu::GYRO_Z, yawRate + noise(0.01f));
+    setField(pPayload, Imu::TEMPERATURE, 41.5 + 0.5 * std::sin(0.01 * t));
+}
+
+template <>
+void FrameGenerator::writePayload<Frames::Attitude>(double t, uint8_t *pPayload)
+{
+    using Frames::Attitude;
+    const double yawRate = GROUND_SPEED / CIRCUIT_RADIUS;
+
+    setField(pPayload, Attitude::ROLL, std::atan(GROUND_SPEED * yawRate / Frames::GRAVITY) + 0.4 * std::sin(0.5 * t));
+    setField(pPayload, Attitude::PITCH, 0.05 + 0.33 * std::sin(0.3 * t));
+    setField(pPayload, Attitude::YAW, std::remainder(yawRate * t, 2.0 * std::numbers::pi));
+    setField(pPayload, Attitude::ROLL_RATE, 0.2 * std::cos(0.5 * t));
+    setField(pPayload, Attitude::PITCH_RATE, 0.1 * std::cos(0.3 * t));
+    setField(pPayload, Attitude::YAW_RATE, yawRate);
+}
+
+template <>
+void FrameGenerator::writePayload<Frames::Battery>(double t, uint8_t *pPayload)
+{
+    using Frames::Battery;
+    // 4S pack, discharging over half an hour and starting over
+    const double charge = 1.0 - std::fmod(t, 1800.0) / 1800.0;
+
+    setField(pPayload, Battery::VOLTAGE, 13.2 + 3.6 * charge + noise(0.02f));
+    setField(pPayload, Battery::CURRENT, 12.0 + 3.0 * std::sin(0.3 * t) + noise(0.2f));
+    setField(pPayload, Battery::REMAINING, 100.0 * charge);
+}
+
+template <>
+void FrameGenerator::writePayload<Frames::Gps>(double t, uint8_t *pPayload)
+{
+    using Frames::Gps;
+    const double angle = GROUND_SPEED / CIRCUIT_RADIUS * t;
+    const double north = CIRCUIT_RADIUS * std::cos(angle);
+    const double east = CIRCUIT_RADIUS * std::sin(angle);
+
+    setField(pPayload, Gps::LATITUDE, HOME_LATITUDE + north / METERS_PER_DEGREE);
+    setField(pPayload, Gps::LONGITUDE, HOME_LONGITUDE + east / (METERS_PER_DEGREE * std::cos(HOME_LATITUDE * std::numbers::pi / 180.0)));
+    setField(pPayload, Gps::ALTITUDE, 320.0 + noise(0.5f));
+    setField(pPayload, Gps::GROUND_SPEED, GROUND_SPEED + noise(0.2f));
+    setField(pPayload, Gps::COURSE, std::fmod(angle + std::numbers::pi / 2.0, 2.0 * std::numbers::pi));
+    setField(pPayload, Gps::SATELLITES, 14);
+    setField(pPayload, Gps::FIX_TYPE, 3);
+}
+
+template <>
+void FrameGenerator::writePayload<Frames::AirData>(double t, uint8_t *pPayload)
+{
+    using Frames::AirData;
+    // Dynamic pressure of the airspeed, density at 320 m
+    const double airspeed = GROUND_SPEED + 2.0 * std::sin(0.1 * t);
+
+    setField(pPayload, AirData::DIFF_PRESSURE, 0.5 * 1.19 * airspeed * airspeed + noise(1.0f));
+    setField(pPayload, AirData::STATIC_PRESSURE, 97530.0 + noise(3.0f));
+    setField(pPayload, AirData::TEMPERATURE, 12.0 + noise(0.05f));
+}
+
+// ============================================================================
+// Frames
+// ============================================================================
+
+/**
+ * @brief Builds a single frame
+ * @param messageId Message ID of the frame layout
+ * @param timeSeconds Simulation time the frame data is generated for
+ * @param sequence Sequence number of the frame
+ * @param minSize The payload is padded so the frame has at least this size
+ * @param out Buffer receiving the frame
+ * @return Size of the frame, 0 for an unknown message ID
+ */
+std::size_t FrameGenerator::Build(uint8_t messageId, double timeSeconds, uint16_t sequence, std::size_t minSize, std::span<uint8_t> out)
+{
+    switch (messageId)
+    {
+    case Frames::Imu::ID:
+        return buildFrame<Frames::Imu>(timeSeconds, sequence, minSize, out);
+    case Frames::Attitude::ID:
+        return buildFrame<Frames::Attitude>(timeSeconds, sequence, minSize, out);
+    case Frames::Battery::ID:
+        return buildFrame<Frames::Battery>(timeSeconds, sequence, minSize, out);
+    case Frames::Gps::ID:
+        return buildFrame<Frames::Gps>(timeSeconds, sequence, minSize, out);
+    case Frames::AirData::ID:
+        return buildFrame<Frames::AirData>(timeSeconds, sequence, minSize, out);
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief Writes the send timestamp into the header and updates the checksum
+ * @param frame A frame built by Build()
+ * @param timestampNs Monotonic send time in nanoseconds
+ */
+void FrameGenerator::Stamp(std::span<uint8_t> frame, uint64_t timestampNs)
+{
+    std::memcpy(frame.data() + offsetof(FrameHeader, timestampNs), &timestampNs, sizeof(timestampNs));
+
+    const uint16_t checksum = FrameChecksum(frame.first(frame.size() - FRAME_CHECKSUM_SIZE));
+    std::memcpy(frame.data() + frame.size() - FRAME_CHECKSUM_SIZE, &checksum, sizeof(checksum));
+}
+
+template <typename Frame>
+std::size_t FrameGenerator::buildFrame(double timeSeconds, uint16_t sequence, std::size_t minSize, std::span<uint8_t> out)
+{
+    const std::size_t payloadSize = std::max(FramePayloadSize<Frame>(), minSize > FRAME_OVERHEAD ? minSize - FRAME_OVERHEAD : 0);
+    const std::size_t frameSize = std::min(FRAME_OVERHEAD + payloadSize, out.size());
+    if (frameSize < FRAME_OVERHEAD + FramePayloadSize<Frame>())
+        return 0;
+
+    FrameHeader header{};
+    header.sync = FRAME_SYNC;
+    header.systemId = m_systemId;
+    header.messageId = Frame::ID;
+    header.sequence = sequence;
+    header.payloadLength = static_cast<uint16_t>(frameSize - FRAME_OVERHEAD);
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    uint8_t *pPayload = out.data() + sizeof(FrameHeader);
+    std::memset(pPayload, 0, header.payloadLength);
+    writePayload<Frame>(timeSeconds, pPayload);
+
+    return frameSize;
+}
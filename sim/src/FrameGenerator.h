@@ -0,0 +1,65 @@
+#pragma once
+
+#include <TelemetryFrames.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <span>
+
+namespace aerolab::Sim
+{
+    /// Nominal send rate of a frame layout on the flight controller
+    struct FrameRate
+    {
+        /// Message ID of the frame layout
+        uint8_t messageId;
+        /// Frames per second
+        double hz;
+    };
+
+    /// Nominal rates of all frames sent by the flight controller
+    constexpr std::array<FrameRate, 5> NOMINAL_RATES{{
+        {Core::Frames::Imu::ID, 1000.0},
+        {Core::Frames::Attitude::ID, 250.0},
+        {Core::Frames::AirData::ID, 50.0},
+        {Core::Frames::Gps::ID, 10.0},
+        {Core::Frames::Battery::ID, 5.0},
+    }};
+
+    /// Largest datagram the generator builds
+    constexpr std::size_t MAX_FRAME_SIZE = 1400;
+
+    /**
+     * @brief The FrameGenerator class
+     * @details Builds telemetry frames with plausible flight data: a vehicle circling at constant altitude
+     *          with a slow attitude oscillation, sensor noise and a discharging battery.
+     *          The header timestamp and the checksum are written separately by Stamp() right before sending,
+     *          so the receiver measures the latency from the send call.
+     */
+    class FrameGenerator
+    {
+    public:
+        explicit FrameGenerator(uint8_t systemId);
+
+        std::size_t Build(uint8_t messageId, double timeSeconds, uint16_t sequence, std::size_t minSize, std::span<uint8_t> out);
+        static void Stamp(std::span<uint8_t> frame, uint64_t timestampNs);
+
+    private:
+        template <typename Frame>
+        std::size_t buildFrame(double timeSeconds, uint16_t sequence, std::size_t minSize, std::span<uint8_t> out);
+
+        template <typename Frame>
+        void writePayload(double timeSeconds, uint8_t *pPayload);
+
+        /// @brief Gaussian sensor noise
+        float noise(float sigma) { return sigma * m_noise(m_random); }
+
+        /// ID of the simulated vehicle
+        uint8_t m_systemId;
+        /// Random source of the sensor noise
+        std::mt19937 m_random{42};
+        /// Unit gaussian distribution
+        std::normal_distribution<float> m_noise{0.0f, 1.0f};
+    };
+}
@@ -0,0 +1,87 @@
+#include "LatencyMonitor.h"
+#include "TelemetrySender.h"
+
+#include <cstring>
+
+using namespace aerolab::Core;
+using namespace aerolab::Sim;
+
+/**
+ * @brief Constructor of the LatencyMonitor
+ * @param exec The IO Executor of the receive socket
+ * @param ip The IPv4 address to bind to
+ * @param port The port to bind to
+ * @param batchSize Datagrams per receive syscall, see InputManager::SetBatchReceive()
+ */
+LatencyMonitor::LatencyMonitor(boost::asio::io_context::executor_type exec, const std::string &ip, int port, std::size_t batchSize)
+    : m_pStore(std::make_shared<TelemetryStore>(1 << 12)),
+      m_ingest(m_pStore),
+      m_inputManager(std::move(exec), ip, port)
+{
+    m_inputManager.SetBatchReceive(batchSize);
+    m_inputManager.SetReceiveBufferSize(8 << 20);
+    m_inputManager.SetCallback([this](const Datagram &datagram)
+                               { onDatagram(datagram); });
+}
+
+void LatencyMonitor::Start()
+{
+    m_inputManager.Start();
+}
+
+void LatencyMonitor::Stop()
+{
+    m_inputManager.Stop();
+}
+
+/**
+ * @brief Returns the statistics since the last call and starts a new interval
+ * @return The statistics of the interval
+ */
+MonitorStats LatencyMonitor::TakeInterval()
+{
+    MonitorStats stats;
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        std::swap(stats, m_interval);
+    }
+
+    const uint64_t invalid = m_ingest.InvalidDatagrams();
+    stats.invalid = invalid - m_invalidReported;
+    m_invalidReported = invalid;
+    return stats;
+}
+
+void LatencyMonitor::onDatagram(const Datagram &datagram)
+{
+    m_ingest.Process(datagram);
+    const uint64_t nowNs = MonotonicNs();
+
+    if (datagram.Size() < sizeof(FrameHeader))
+        return;
+
+    FrameHeader header;
+    std::memcpy(&header, datagram.Data(), sizeof(header));
+    if (header.sync != FRAME_SYNC)
+        return;
+
+    std::lock_guard<std::mutex> guard(m_mutex);
+    m_interval.received++;
+    m_interval.latency.Record(nowNs > header.timestampNs ? nowNs - header.timestampNs : 0);
+
+    // Sequence numbers wrap, a gap of less than half the range is loss, anything else is late
+    uint16_t &expected = m_expectedSequence[header.systemId];
+    if (m_seen[header.systemId])
+    {
+        const uint16_t gap = static_cast<uint16_t>(header.sequence - expected);
+        if (gap >= 0x8000)
+        {
+            m_interval.reordered++;
+            return;
+        }
+        m_interval.lost += gap;
+    }
+
+    m_seen[header.systemId] = true;
+    expected = static_cast<uint16_t>(header.sequence + 1);
+}
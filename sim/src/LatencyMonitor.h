@@ -0,0 +1,78 @@
+#pragma once
+
+#include <InputManager.h>
+#include <LatencyHistogram.h>
+#include <TelemetryIngest.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace aerolab::Sim
+{
+    /// Snapshot of the receive statistics
+    struct MonitorStats
+    {
+        /// Received datagrams
+        uint64_t received = 0;
+        /// Frames missing in the sequence numbers
+        uint64_t lost = 0;
+        /// Frames arriving with an older sequence number than expected
+        uint64_t reordered = 0;
+        /// Datagrams the ingest could not decode
+        uint64_t invalid = 0;
+        /// Latency from the send call to the end of the consumer callback in nanoseconds
+        Core::LatencyHistogram latency;
+
+        /// @brief Adds the statistics of another interval
+        void Merge(const MonitorStats &other)
+        {
+            received += other.received;
+            lost += other.lost;
+            reordered += other.reordered;
+            invalid += other.invalid;
+            latency.Merge(other.latency);
+        }
+    };
+
+    /**
+     * @brief The LatencyMonitor class
+     * @details Receives the simulated telemetry through the production pipeline, an InputManager feeding
+     *          a TelemetryIngest, and measures for every datagram the time from the send timestamp in the frame
+     *          header to the end of the consumer callback. Lost frames are detected by the sequence numbers.
+     * @note The send timestamps are monotonic clock readings, sender and receiver have to run on the same host.
+     */
+    class LatencyMonitor
+    {
+    public:
+        LatencyMonitor(boost::asio::io_context::executor_type exec, const std::string &ip, int port, std::size_t batchSize);
+
+        void Start();
+        void Stop();
+
+        MonitorStats TakeInterval();
+
+    private:
+        void onDatagram(const Core::Datagram &datagram);
+
+        /// Store of the decoded samples, kept small since nobody reads it
+        std::shared_ptr<Core::TelemetryStore> m_pStore;
+        /// The consumer of the pipeline
+        Core::TelemetryIngest m_ingest;
+        /// The receiver of the pipeline
+        Core::InputManager m_inputManager;
+
+        /// Guards the interval statistics, only contended while reporting
+        std::mutex m_mutex;
+        /// Statistics since the last TakeInterval()
+        MonitorStats m_interval;
+        /// Next expected sequence number per vehicle
+        std::array<uint16_t, 256> m_expectedSequence{};
+        /// Vehicles a frame has been received from
+        std::array<bool, 256> m_seen{};
+        /// Invalid datagrams reported by the ingest at the last TakeInterval()
+        uint64_t m_invalidReported = 0;
+    };
+}
@@ -0,0 +1,139 @@
+#include "TelemetrySender.h"
+
+#include <Logger.h>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+
+using namespace aerolab::Sim;
+
+namespace
+{
+    /// A schedule further behind than this is reset instead of sending the backlog at once
+    constexpr uint64_t MAX_BACKLOG_NS = 100'000'000;
+    /// Waits longer than this sleep, shorter ones yield
+    constexpr uint64_t SLEEP_THRESHOLD_NS = 200'000;
+}
+
+/**
+ * @brief Constructor of the TelemetrySender
+ * @param options Settings of the link
+ */
+TelemetrySender::TelemetrySender(SenderOptions options)
+    : m_options(std::move(options)),
+      m_generator(m_options.systemId),
+      m_socket(m_ioContext, boost::asio::ip::udp::v4())
+{
+    m_options.burst = std::max<std::size_t>(m_options.burst, 1);
+    m_options.datagramSize = std::min(m_options.datagramSize, MAX_FRAME_SIZE);
+    m_pending.resize(m_options.burst);
+
+    boost::system::error_code ec;
+    m_socket.set_option(boost::asio::socket_base::send_buffer_size(4 << 20), ec);
+}
+
+/**
+ * @brief Sends frames until running is cleared
+ * @param running Cleared by the caller to stop sending
+ */
+void TelemetrySender::Run(const std::atomic<bool> &running)
+{
+    struct Schedule
+    {
+        uint8_t messageId;
+        uint64_t periodNs;
+        uint64_t nextNs;
+    };
+
+    const uint64_t startNs = MonotonicNs();
+    std::vector<Schedule> schedules;
+    for (const auto &rate : NOMINAL_RATES)
+    {
+        const double hz = rate.hz * m_options.load;
+        if (hz > 0.0)
+            schedules.push_back({rate.messageId, static_cast<uint64_t>(1e9 / hz), startNs});
+    }
+
+    if (schedules.empty())
+    {
+        LOG_ERROR("Nothing to send, the load is 0");
+        return;
+    }
+
+    std::mt19937 random(std::random_device{}());
+    std::bernoulli_distribution lose(std::clamp(m_options.loss, 0.0, 1.0));
+    uint16_t sequence = 0;
+
+    LOG_INFO_F("Sending to {} at {} times the nominal rate, bursts of {}, {} loss",
+               m_options.target, m_options.load, m_options.burst, m_options.loss);
+
+    while (running.load(std::memory_order_relaxed))
+    {
+        uint64_t nowNs = MonotonicNs();
+        uint64_t nextDueNs = UINT64_MAX;
+
+        for (auto &schedule : schedules)
+        {
+            if (nowNs - std::min(nowNs, schedule.nextNs) > MAX_BACKLOG_NS)
+            {
+                LOG_WARNING_LIMITED(1000, "Sender fell behind, skipping the backlog");
+                schedule.nextNs = nowNs;
+            }
+
+            while (schedule.nextNs <= nowNs)
+            {
+                const double timeSeconds = static_cast<double>(schedule.nextNs - startNs) * 1e-9;
+                schedule.nextNs += schedule.periodNs;
+
+                if (lose(random))
+                {
+                    sequence++;
+                    m_dropped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+
+                Pending &pending = m_pending[m_pendingCount];
+                pending.size = m_generator.Build(schedule.messageId, timeSeconds, sequence++, m_options.datagramSize, pending.data);
+                if (pending.size > 0 && ++m_pendingCount == m_pending.size())
+                    flush();
+            }
+
+            nextDueNs = std::min(nextDueNs, schedule.nextNs);
+        }
+
+        nowNs = MonotonicNs();
+        if (nextDueNs > nowNs + SLEEP_THRESHOLD_NS)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(nextDueNs - nowNs - SLEEP_THRESHOLD_NS / 2));
+        else if (nextDueNs > nowNs)
+            std::this_thread::yield();
+    }
+
+    flush();
+}
+
+/**
+ * @brief Stamps and sends the frames of the current burst
+ */
+void TelemetrySender::flush()
+{
+    for (std::size_t i = 0; i < m_pendingCount; i++)
+    {
+        Pending &pending = m_pending[i];
+        const std::span<uint8_t> frame(pending.data.data(), pending.size);
+        FrameGenerator::Stamp(frame, MonotonicNs());
+
+        boost::system::error_code ec;
+        m_socket.send_to(boost::asio::buffer(frame.data(), frame.size()), m_options.target, 0, ec);
+        if (ec)
+        {
+            m_sendErrors.fetch_add(1, std::memory_order_relaxed);
+            LOG_WARNING_LIMITED(1000, "send_to failed: " + ec.message());
+            continue;
+        }
+
+        m_sent.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_add(frame.size(), std::memory_order_relaxed);
+    }
+    m_pendingCount = 0;
+}
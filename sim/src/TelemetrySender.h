@@ -0,0 +1,94 @@
+#pragma once
+
+#include "FrameGenerator.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+namespace aerolab::Sim
+{
+    /// Settings of the simulated flight controller link
+    struct SenderOptions
+    {
+        /// Endpoint of the InputManager
+        boost::asio::ip::udp::endpoint target{boost::asio::ip::make_address_v4("127.0.0.1"), 5005};
+        /// ID of the simulated vehicle
+        uint8_t systemId = 1;
+        /// Factor applied to the nominal frame rates, e.g. 10 for a soak test at ten times the nominal load
+        double load = 1.0;
+        /// Number of datagrams sent back to back, the average rate stays the same
+        std::size_t burst = 1;
+        /// Minimum datagram size, smaller frames are padded
+        std::size_t datagramSize = 0;
+        /// Share of datagrams dropped before sending, 0 to 1
+        double loss = 0.0;
+    };
+
+    /**
+     * @brief The TelemetrySender class
+     * @details Impersonates the flight controller: every frame layout is sent at its nominal rate times the load,
+     *          one frame per datagram. Every frame carries a sequence number per vehicle and the monotonic
+     *          (steady clock) send time in the header, so a receiver on the same host can measure the latency
+     *          and the loss. Dropped frames consume their sequence number like frames lost on the radio link.
+     */
+    class TelemetrySender
+    {
+    public:
+        explicit TelemetrySender(SenderOptions options);
+
+        void Run(const std::atomic<bool> &running);
+
+        /// @brief Number of sent datagrams
+        uint64_t SentCount() const { return m_sent.load(std::memory_order_relaxed); }
+        /// @brief Number of datagrams dropped on purpose
+        uint64_t DroppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+        /// @brief Number of sent bytes
+        uint64_t SentBytes() const { return m_bytes.load(std::memory_order_relaxed); }
+        /// @brief Number of datagrams the socket refused, e.g. because the send buffer was full
+        uint64_t SendErrors() const { return m_sendErrors.load(std::memory_order_relaxed); }
+
+    private:
+        /// A built frame waiting for its burst
+        struct Pending
+        {
+            std::array<uint8_t, MAX_FRAME_SIZE> data;
+            std::size_t size;
+        };
+
+        void flush();
+
+        /// Settings of the link
+        SenderOptions m_options;
+        /// Generator of the frame data
+        FrameGenerator m_generator;
+        /// IO context of the socket
+        boost::asio::io_context m_ioContext;
+        /// Socket the frames are sent from
+        boost::asio::ip::udp::socket m_socket;
+        /// Frames of the current burst
+        std::vector<Pending> m_pending;
+        /// Number of frames in m_pending
+        std::size_t m_pendingCount = 0;
+
+        /// Number of sent datagrams
+        std::atomic<uint64_t> m_sent{0};
+        /// Number of datagrams dropped on purpose
+        std::atomic<uint64_t> m_dropped{0};
+        /// Number of sent bytes
+        std::atomic<uint64_t> m_bytes{0};
+        /// Number of failed sends
+        std::atomic<uint64_t> m_sendErrors{0};
+    };
+
+    /// @brief Monotonic time in nanoseconds, the clock of the embedded send timestamps
+    inline uint64_t MonotonicNs()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+}
@@ -0,0 +1,252 @@
+#include "LatencyMonitor.h"
+#include "TelemetrySender.h"
+
+#include <Logger.h>
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <thread>
+
+using namespace aerolab::Core;
+using namespace aerolab::Sim;
+
+namespace
+{
+    /// Cleared by Ctrl+C or when the duration is over
+    std::atomic<bool> s_running{true};
+
+    /// Command line settings
+    struct Options
+    {
+        /// "send", "receive" or "loopback"
+        std::string mode = "loopback";
+        /// Settings of the sender
+        SenderOptions sender;
+        /// Address the receiver binds to
+        std::string bindIp = "0.0.0.0";
+        /// Port the receiver binds to
+        int bindPort = 5005;
+        /// Datagrams per receive syscall
+        std::size_t batch = 32;
+        /// Seconds to run, 0 until Ctrl+C
+        double duration = 0.0;
+        /// Seconds between two reports
+        double reportInterval = 10.0;
+    };
+
+    void printUsage()
+    {
+        std::printf(
+            "Usage: telemetry_sim [options]\n"
+            "Impersonates the flight controller and measures the ground station ingest latency.\n\n"
+            "  --mode <send|receive|loopback>  send frames, receive and measure, or both (default loopback)\n"
+            "  --target <ip:port>              endpoint the frames are sent to (default 127.0.0.1:5005)\n"
+            "  --bind <ip:port>                endpoint the receiver binds to (default 0.0.0.0:5005)\n"
+            "  --load <factor>                 multiple of the nominal frame rates (default 1)\n"
+            "  --burst <n>                     datagrams sent back to back (default 1)\n"
+            "  --size <bytes>                  minimum datagram size, frames are padded (default 0)\n"
+            "  --loss <percent>                datagrams dropped before sending (default 0)\n"
+            "  --system-id <id>                vehicle id in the frame headers (default 1)\n"
+            "  --batch <n>                     datagrams per receive syscall (default 32)\n"
+            "  --duration <s>                  run time, 0 until Ctrl+C (default 0)\n"
+            "  --report <s>                    seconds between reports (default 10)\n");
+    }
+
+    /// @brief Splits "ip:port"
+    bool parseEndpoint(const std::string &text, std::string &ip, int &port)
+    {
+        const auto colon = text.rfind(':');
+        if (colon == std::string::npos)
+            return false;
+        ip = text.substr(0, colon);
+        port = std::atoi(text.c_str() + colon + 1);
+        return port > 0 && port < 65536;
+    }
+
+    std::optional<Options> parseOptions(int argc, char *argv[])
+    {
+        Options options;
+        for (int i = 1; i < argc; i++)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h" || i + 1 >= argc)
+                return std::nullopt;
+
+            const std::string value = argv[++i];
+            if (arg == "--mode")
+                options.mode = value;
+            else if (arg == "--target")
+            {
+                std::string ip;
+                int port = 0;
+                if (!parseEndpoint(value, ip, port))
+                    return std::nullopt;
+                options.sender.target = boost::asio::ip::udp::endpoint(boost::asio::ip::make_address_v4(ip), static_cast<unsigned short>(port));
+            }
+            else if (arg == "--bind")
+            {
+                if (!parseEndpoint(value, options.bindIp, options.bindPort))
+                    return std::nullopt;
+            }
+            else if (arg == "--load")
+                options.sender.load = std::atof(value.c_str());
+            else if (arg == "--burst")
+                options.sender.burst = static_cast<std::size_t>(std::atol(value.c_str()));
+            else if (arg == "--size")
+                options.sender.datagramSize = static_cast<std::size_t>(std::atol(value.c_str()));
+            else if (arg == "--loss")
+                options.sender.loss = std::atof(value.c_str()) / 100.0;
+            else if (arg == "--system-id")
+                options.sender.systemId = static_cast<uint8_t>(std::atoi(value.c_str()));
+            else if (arg == "--batch")
+                options.batch = static_cast<std::size_t>(std::atol(value.c_str()));
+            else if (arg == "--duration")
+                options.duration = std::atof(value.c_str());
+            else if (arg == "--report")
+                options.reportInterval = std::atof(value.c_str());
+            else
+                return std::nullopt;
+        }
+
+        if (options.mode != "send" && options.mode != "receive" && options.mode != "loopback")
+            return std::nullopt;
+        return options;
+    }
+
+    /// @brief Prints one report line
+    void report(const char *label, double seconds, uint64_t sent, const MonitorStats *pStats)
+    {
+        std::printf("%-8s %9.1f s  tx %10.0f pps", label, seconds, seconds > 0.0 ? static_cast<double>(sent) / seconds : 0.0);
+
+        if (pStats)
+        {
+            const auto &latency = pStats->latency;
+            const double expected = static_cast<double>(pStats->received + pStats->lost);
+            std::printf("  rx %10.0f pps  lost %8llu (%6.3f%%)  late %6llu  invalid %6llu  latency us: p50 %8.1f  p99 %8.1f  p99.9 %8.1f  max %9.1f",
+                        seconds > 0.0 ? static_cast<double>(pStats->received) / seconds : 0.0,
+                        static_cast<unsigned long long>(pStats->lost),
+                        expected > 0.0 ? 100.0 * static_cast<double>(pStats->lost) / expected : 0.0,
+                        static_cast<unsigned long long>(pStats->reordered),
+                        static_cast<unsigned long long>(pStats->invalid),
+                        static_cast<double>(latency.Percentile(50.0)) / 1000.0,
+                        static_cast<double>(latency.Percentile(99.0)) / 1000.0,
+                        static_cast<double>(latency.Percentile(99.9)) / 1000.0,
+                        static_cast<double>(latency.Max()) / 1000.0);
+        }
+
+        std::printf("\n");
+        std::fflush(stdout);
+    }
+}
+
+/**
+ * @brief Flight controller telemetry simulator
+ * @details Sends the telemetry frames at a multiple of their nominal rates and, in the receive and loopback
+ *          modes, measures the latency from the send call to the end of the ingest callback.
+ *          A report line is printed every interval and a summary over the whole run at the end.
+ */
+int main(int argc, char *argv[])
+{
+    const auto parsed = parseOptions(argc, argv);
+    if (!parsed)
+    {
+        printUsage();
+        return 1;
+    }
+    const Options &options = *parsed;
+
+    LOG_INIT("telemetry_sim.txt");
+    Logger::GetInstance()->SetConsoleOutput(false);
+    Logger::GetInstance()->SetAsync(true);
+
+    std::signal(SIGINT, [](int)
+                { s_running = false; });
+
+    const bool sending = options.mode != "receive";
+    const bool receiving = options.mode != "send";
+
+    boost::asio::io_context ioContext;
+    auto workGuard = boost::asio::make_work_guard(ioContext);
+    std::unique_ptr<LatencyMonitor> pMonitor;
+    std::thread ioThread;
+    if (receiving)
+    {
+        pMonitor = std::make_unique<LatencyMonitor>(ioContext.get_executor(), options.bindIp, options.bindPort, options.batch);
+        pMonitor->Start();
+        ioThread = std::thread([&ioContext]()
+                               { ioContext.run(); });
+    }
+
+    std::unique_ptr<TelemetrySender> pSender;
+    std::thread senderThread;
+    if (sending)
+    {
+        pSender = std::make_unique<TelemetrySender>(options.sender);
+        senderThread = std::thread([&pSender]()
+                                   { pSender->Run(s_running); });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    auto intervalStart = start;
+    uint64_t sentAtIntervalStart = 0;
+    MonitorStats total;
+
+    while (s_running)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - start).count();
+        if (options.duration > 0.0 && elapsed >= options.duration)
+            s_running = false;
+
+        const double intervalSeconds = std::chrono::duration<double>(now - intervalStart).count();
+        if (intervalSeconds < options.reportInterval && s_running)
+            continue;
+
+        const uint64_t sent = pSender ? pSender->SentCount() : 0;
+        if (pMonitor)
+        {
+            const MonitorStats interval = pMonitor->TakeInterval();
+            report("interval", intervalSeconds, sent - sentAtIntervalStart, &interval);
+            total.Merge(interval);
+        }
+        else
+        {
+            report("interval", intervalSeconds, sent - sentAtIntervalStart, nullptr);
+        }
+
+        intervalStart = now;
+        sentAtIntervalStart = sent;
+    }
+
+    if (senderThread.joinable())
+        senderThread.join();
+
+    if (pMonitor)
+    {
+        // Datagrams still in flight
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        boost::asio::post(ioContext, [&pMonitor]()
+                          { pMonitor->Stop(); });
+    }
+    workGuard.reset();
+    if (ioThread.joinable())
+        ioThread.join();
+
+    if (pMonitor)
+        total.Merge(pMonitor->TakeInterval());
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report("total", elapsed, pSender ? pSender->SentCount() : 0, pMonitor ? &total : nullptr);
+
+    if (pSender)
+        LOG_INFO_F("Sent {} datagrams ({} bytes), dropped {} on purpose, {} send errors",
+                   pSender->SentCount(), pSender->SentBytes(), pSender->DroppedCount(), pSender->SendErrors());
+
+    return 0;
+}